@@ -0,0 +1,12 @@
+netnewseg 0 1024 300000000 1000000 1 0 0 0 0 0 0 0 0
+netnodenewifc 0 0.0891 0.0330 0.0000033 0 0 0 0 0 256 256
+netsegnicattach 0 0
+srecl		netsend.sr
+run
+newnode superH 1 0 0
+netnodenewifc 0 0.0891 0.0330 0.0000033 0 0 0 0 0 256 256
+netsegnicattach 0 0
+srecl		netsend.sr
+run
+bpt instrs 1000000
+on
@@ -0,0 +1,9 @@
+newnode msp430
+srecl		smoke.sr
+run
+nodetach	1
+bpt		cycles 21000000
+on
+dumpregs
+showclk
+q
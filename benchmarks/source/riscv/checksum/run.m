@@ -0,0 +1,5 @@
+newnode riscv
+sizemem		1048576
+srecl		checksum.sr
+run
+on
@@ -166,6 +166,21 @@ mfsize(int fd)
 	return length;
 }
 
+int
+mfexists(char *path)
+{
+	Dir	*d;
+
+	d = kdirstat(path);
+	if (d == nil)
+	{
+		return 0;
+	}
+	free(d);
+
+	return 1;
+}
+
 char *
 mfgets(char *buf, int len, int fd)
 {
@@ -196,6 +211,16 @@ mfgets(char *buf, int len, int fd)
 	return buf;
 }
 
+void *
+mmapfile(int fd, long size)
+{
+	USED(fd);
+	USED(size);
+
+	/*	No mmap(); callers fall back to reading the file	*/
+	return nil;
+}
+
 void
 mprintfd(int fd, char* buf)
 {
@@ -298,6 +323,21 @@ mkillscheduler(Engine *E)
 	return 0;
 }
 
+int
+mfork(void)
+{
+	/*	Sweep jobs need separate host processes	*/
+	return -1;
+}
+
+int
+mwaitchild(int *status)
+{
+	USED(status);
+
+	return -1;
+}
+
 int
 mchdir(char *path)
 {
@@ -342,6 +382,25 @@ mwallclockusecs(void)
 
 	return t.tv_usec;
 }
+
+uvlong
+mwalltimeusecs(void)
+{
+	struct timeval 	t;
+	gettimeofday(&t, NULL);
+
+	return (uvlong)t.tv_sec*1000000 + t.tv_usec;
+}
+
+ulong
+mmaxrsskbytes(void)
+{
+	struct rusage 	r;
+
+	getrusage(RUSAGE_SELF, &r);
+
+	return (ulong)r.ru_maxrss;
+}
 #else
 ulong
 musercputimeusecs(void)
@@ -360,6 +419,18 @@ mwallclockusecs(void)
 {
 	return osusectime();
 }
+
+uvlong
+mwalltimeusecs(void)
+{
+	return osusectime();
+}
+
+ulong
+mmaxrsskbytes(void)
+{
+	return 0;
+}
 #endif
 
 
@@ -369,8 +440,9 @@ mexit(Engine *E, char *str, int status)
 	extern void	cleanexit(int);
 
 	print("\n\n\tExiting: %s\n", str);
-	print("\tWriting all node information to sunflower.out\n\n");
+	print("\tWriting all node information to %s\n\n", E->logfilename);
 	m_dumpall(E, E->logfilename, M_OWRITE, "Exit", "");
+	mvtracecloseall(E);
 
 //	pexit(str, 0);
 //	cleanexit(0);
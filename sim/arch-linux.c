@@ -45,6 +45,7 @@
 #include <sys/times.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
 #include <sched.h>
 #include "sf.h"
 #include "mextern.h"
@@ -64,6 +65,14 @@ mfsize(int fd)
 	return sb.st_size;
 }
 
+int
+mfexists(char *path)
+{
+	struct stat	sb;
+
+	return stat(path, &sb) == 0;
+}
+
 void
 mstatelock(void)
 {
@@ -127,12 +136,33 @@ mfgets(char *buf, int len, int fd)
 	return buf;
 }
 
+void *
+mmapfile(int fd, long size)
+{
+	void	*p;
+
+
+	/*							*/
+	/*	Read-only, private mapping of a whole file. The	*/
+	/*	mapping outlives fd, which callers may close.	*/
+	/*							*/
+	p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	return p;
+}
+
 void
 mexit(Engine *E, char *str, int status)
 {	
 	printf("\n\n\tExiting: %s\n", str);
-	printf("\tWriting all node information to sunflower.out\n\n");
+	printf("\tWriting all node information to %s\n\n", E->logfilename);
 	m_dumpall(E, E->logfilename, M_OWRITE, "Exit", "");
+	mvtracecloseall(E);
+	mvfsflush(E);
 
 	exit(status);
 }
@@ -243,6 +273,32 @@ mkillscheduler(Engine *E)
 	return 0;
 }
 
+int
+mfork(void)
+{
+	return fork();
+}
+
+/*								*/
+/*	Wait for any child. Returns its pid, with its exit	*/
+/*	status in *status, or -1 if it was killed by a signal.	*/
+/*								*/
+int
+mwaitchild(int *status)
+{
+	int	pid, s;
+
+
+	pid = wait(&s);
+	if (pid < 0)
+	{
+		return -1;
+	}
+	*status = WIFEXITED(s) ? WEXITSTATUS(s) : -1;
+
+	return pid;
+}
+
 int
 mchdir(char *path)
 {
@@ -291,6 +347,25 @@ mwallclockusecs(void)
 	return t.tv_usec;
 }
 
+uvlong
+mwalltimeusecs(void)
+{
+	struct timeval 	t;
+	gettimeofday(&t, NULL);
+
+	return (uvlong)t.tv_sec*1000000 + t.tv_usec;
+}
+
+ulong
+mmaxrsskbytes(void)
+{
+	struct rusage 	r;
+
+	getrusage(RUSAGE_SELF, &r);
+
+	return (ulong)r.ru_maxrss;
+}
+
 void
 mlog(Engine *E, State *S, char *fmt, ...)
 {
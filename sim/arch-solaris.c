@@ -45,6 +45,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include "sf.h"
 #include "mextern.h"
 
@@ -64,6 +66,14 @@ mfsize(int fd)
 	return sb.st_size;
 }
 
+int
+mfexists(char *path)
+{
+	struct stat	sb;
+
+	return stat(path, &sb) == 0;
+}
+
 void
 mstatelock(void)
 {
@@ -109,12 +119,33 @@ mfgets(char *buf, int len, int fd)
 	return buf;
 }
 
+void *
+mmapfile(int fd, long size)
+{
+	void	*p;
+
+
+	/*							*/
+	/*	Read-only, private mapping of a whole file. The	*/
+	/*	mapping outlives fd, which callers may close.	*/
+	/*							*/
+	p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	return p;
+}
+
 void
 mexit(Engine *E, char *str, int status)
 {	
 	printf("\n\n\tExiting: %s\n", str);
-	printf("\tWriting all node information to sunflower.out\n\n");
+	printf("\tWriting all node information to %s\n\n", E->logfilename);
 	m_dumpall(E, E->logfilename, M_OWRITE, "Exit", "");
+	mvtracecloseall(E);
+	mvfsflush(E);
 
 	exit(status);
 }
@@ -225,6 +256,32 @@ mkillscheduler(Engine *E)
 	return 0;
 }
 
+int
+mfork(void)
+{
+	return fork();
+}
+
+/*								*/
+/*	Wait for any child. Returns its pid, with its exit	*/
+/*	status in *status, or -1 if it was killed by a signal.	*/
+/*								*/
+int
+mwaitchild(int *status)
+{
+	int	pid, s;
+
+
+	pid = wait(&s);
+	if (pid < 0)
+	{
+		return -1;
+	}
+	*status = WIFEXITED(s) ? WEXITSTATUS(s) : -1;
+
+	return pid;
+}
+
 int
 mchdir(char *path)
 {
@@ -267,6 +324,26 @@ mwallclockusecs(void)
 	return t.tv_usec;
 }
 
+uvlong
+mwalltimeusecs(void)
+{
+	struct timeval 	t;
+	gettimeofday(&t, NULL);
+
+	return (uvlong)t.tv_sec*1000000 + t.tv_usec;
+}
+
+ulong
+mmaxrsskbytes(void)
+{
+	struct rusage 	r;
+
+	getrusage(RUSAGE_SELF, &r);
+
+	/*	Solaris reports ru_maxrss in pages	*/
+	return (ulong)(r.ru_maxrss*(getpagesize()/1024));
+}
+
 void
 mlog(Engine *E, State *S, char *fmt, ...)
 {
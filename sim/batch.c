@@ -0,0 +1,270 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+extern int	sf_superh_parse(void);
+extern int	sf_riscv_parse(void);
+
+enum
+{
+	kSunflowerBatchMaxjobs		= 4096,
+	kSunflowerBatchMaxnamelen	= 1024,
+};
+
+static void	batchjob(Engine *E, int job, char *cmds, char *statsfile, char **scripts, int nscripts) __attribute__((noreturn));
+
+
+/*									*/
+/*	Headless run: load the scripts on the calling thread, with	*/
+/*	'ON' running the scheduler inline so each script runs to	*/
+/*	completion, then dump the state of all nodes to statsfile	*/
+/*	(the usual sunflower.out if NULL) and exit. The exit status is	*/
+/*	that of the first guest to exit with a nonzero status, or -1	*/
+/*	if the simulator itself gave up.				*/
+/*									*/
+void
+m_batch(Engine *E, char *statsfile, char **scripts, int nscripts)
+{
+	int	i, fd;
+
+
+	E->batch = 1;
+	if (statsfile != NULL)
+	{
+		E->logfilename = (char *)mcalloc(E, strlen(statsfile)+1, sizeof(char), "E->logfilename in batch.c");
+		if (E->logfilename == NULL)
+		{
+			mexit(E, "Could not allocate memory for E->logfilename.", -1);
+		}
+		strcpy(E->logfilename, statsfile);
+	}
+
+	for (i = 0; i < nscripts; i++)
+	{
+		if ((fd = mopen(scripts[i], M_OREAD)) < 0)
+		{
+			merror(E, "Cannot open batch script \"%s\".", scripts[i]);
+			mexit(E, "See above messages.", -1);
+		}
+		mclose(fd);
+
+		loadcmds(E, scripts[i]);
+	}
+
+	mexit(E, "Batch run complete.", E->exitstatus);
+}
+
+/*									*/
+/*	Parameter sweep. Each non-blank line of sweepfile that does not	*/
+/*	start with '#' is one job: a list of commands, separated by	*/
+/*	';', run before the scripts. Jobs run as batch runs in up to	*/
+/*	njobs concurrent host processes, each with its own Engine.	*/
+/*	Job i writes its stats to statsfile.i and its console output	*/
+/*	to statsfile.i.log, and starts from seed (E's seed + i) unless	*/
+/*	its commands set one. Exits with the number of failed jobs.	*/
+/*									*/
+void
+m_sweep(Engine *E, char *statsfile, char *sweepfile, int njobs, char **scripts, int nscripts)
+{
+	char		buf[MAX_BUFLEN+1], *jobs[kSunflowerBatchMaxjobs];
+	int		pids[kSunflowerBatchMaxjobs];
+	int		i, pid, status, njobsin = 0, nrunning = 0, nfailed = 0, next = 0;
+	Linereader	*L;
+
+
+	if (statsfile == NULL)
+	{
+		statsfile = SF_LOGFILENAME;
+	}
+
+	L = mlineopen(E, sweepfile);
+	if (L == NULL)
+	{
+		merror(E, "Cannot open sweep file \"%s\".", sweepfile);
+		exit(-1);
+	}
+
+	while (mlinegets(L, buf, MAX_BUFLEN) != NULL)
+	{
+		char	*p = buf;
+
+
+		while ((*p == ' ') || (*p == '\t'))
+		{
+			p++;
+		}
+
+		if ((*p == '\0') || (*p == '\n') || (*p == '#'))
+		{
+			continue;
+		}
+
+		if (njobsin == kSunflowerBatchMaxjobs)
+		{
+			merror(E, "More than %d jobs in sweep file; ignoring the rest.", kSunflowerBatchMaxjobs);
+			break;
+		}
+
+		if (p[strlen(p)-1] == '\n')
+		{
+			p[strlen(p)-1] = '\0';
+		}
+
+		jobs[njobsin] = (char *)mcalloc(E, strlen(p)+1, sizeof(char), "jobs[] in batch.c");
+		if (jobs[njobsin] == NULL)
+		{
+			mexit(E, "Could not allocate memory for sweep job.", -1);
+		}
+		strcpy(jobs[njobsin++], p);
+	}
+	mlineclose(E, L);
+
+	if (njobs < 1)
+	{
+		njobs = 1;
+	}
+
+	mprint(E, NULL, siminfo, "Sweep of [%d] jobs, [%d] at a time\n", njobsin, njobs);
+
+	while ((next < njobsin) || (nrunning > 0))
+	{
+		if ((next < njobsin) && (nrunning < njobs))
+		{
+			/*						*/
+			/*	Flush before forking, so buffered	*/
+			/*	console output is not written again	*/
+			/*	when the job redirects its stdout.	*/
+			/*						*/
+			fflush(stdout);
+			fflush(stderr);
+
+			pid = mfork();
+			if (pid == 0)
+			{
+				batchjob(E, next, jobs[next], statsfile, scripts, nscripts);
+			}
+
+			if (pid < 0)
+			{
+				merror(E, "Could not start sweep job %d.", next);
+				nfailed++;
+			}
+			else
+			{
+				pids[next] = pid;
+				nrunning++;
+			}
+			next++;
+
+			continue;
+		}
+
+		pid = mwaitchild(&status);
+		if (pid < 0)
+		{
+			break;
+		}
+		nrunning--;
+
+		for (i = 0; i < next; i++)
+		{
+			if (pids[i] == pid)
+			{
+				break;
+			}
+		}
+
+		if (status != 0)
+		{
+			nfailed++;
+		}
+		mprint(E, NULL, siminfo, "Job %d [%s] exited with status %d\n",
+			i, (i < next ? jobs[i] : "?"), status);
+	}
+
+	mprint(E, NULL, siminfo, "Sweep done: [%d] of [%d] jobs failed\n", nfailed, njobsin);
+	fflush(stdout);
+
+	exit(nfailed);
+}
+
+static void
+batchjob(Engine *E, int job, char *cmds, char *statsfile, char **scripts, int nscripts)
+{
+	char	name[kSunflowerBatchMaxnamelen], *p;
+
+
+	msnprint(name, sizeof(name), "%s.%d.log", statsfile, job);
+	if ((freopen(name, "w", stdout) == NULL) || (freopen(name, "a", stderr) == NULL))
+	{
+		exit(-1);
+	}
+
+	E->randseed = mrandominit(E, E->randseed + job);
+	mprint(E, NULL, siminfo, "Sweep job %d with seed [" UVLONGFMT "]: %s\n", job, E->randseed, cmds);
+
+	for (p = cmds; *p != '\0'; p++)
+	{
+		if (*p == ';')
+		{
+			*p = '\n';
+		}
+	}
+
+	clearistream(E);
+	munchinput(E, cmds);
+	munchinput(E, "\n");
+
+	E->batch = 1;
+	yyengine = E;
+	if ((E->cp->machinetype == MACHINE_SUPERH) || (E->cp->machinetype == MACHINE_MSP430))
+	{
+		sf_superh_parse();
+	}
+	else if (E->cp->machinetype == MACHINE_RISCV)
+	{
+		sf_riscv_parse();
+	}
+
+	msnprint(name, sizeof(name), "%s.%d", statsfile, job);
+	m_batch(E, name, scripts, nscripts);
+}
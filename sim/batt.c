@@ -42,30 +42,45 @@
 #include "mextern.h"
 
 
+static void	battbankbuild(Engine *E);
+static void	battadaptperiod(Engine *E, double dsoc);
+
+/*									*/
+/*	Linear interpolation into a packed LUT, x in units of LUT	*/
+/*	entries. The last entry of each LUT has slope 0, so x is only	*/
+/*	clamped to the table, never the segment index.			*/
+/*									*/
+static double
+battlerp(BattBank *K, int base, double x, double xmax)
+{
+	int	k;
+
+	x = (x < 0.0) ? 0.0 : ((x > xmax) ? xmax : x);
+	k = (int)x;
+
+	return K->lut[base + k] + K->slope[base + k]*(x - k);
+}
+
 /*	The battery feed lags behind main simulation by one cycle.	*/
 void
 battery_feed(Engine *E, double force_current)
 {
 	int			i, j;
 	Batt			*B;
-	double	 		Iload;
+	BattBank		*K = &E->battbank;
+	double	 		Iload, dsoc, dsocmax = 0.0;
 	const double		Vload = 3.3;
-	double 			tmpval;
-	double 			tmpindex;
-	double	 		tmplow;
-	double 			tmphigh;
-	double	 		tmpdelta;
 
 
-	/*	First determine the total current drawn in this cycle	*/
-	for (i = 0; i < E->nactivebatts; i++)
+	if (K->dirty)
 	{
-		B = E->activebatts[i];
+		battbankbuild(E);
+	}
 
-		if (B->dead)
-		{
-			continue;
-		}
+	/*	First determine the total current drawn in this cycle	*/
+	for (i = 0; i < K->n; i++)
+	{
+		B = K->batt[i];
 
 		/*							*/
 		/*	Set min Iload to leak current, rather than 0 	*/
@@ -75,14 +90,21 @@ battery_feed(Engine *E, double force_current)
 
 		for (j = 0; j < B->num_attached; j++)
 		{	
-			if (((State *)B->node_ptrs[j])->last_stepclks == 0)
+			State	*N = (State *)B->node_ptrs[j];
+
+			/*							*/
+			/*	Fold the node's per-op cycle counts into its	*/
+			/*	cumulative draw; Iload is then the average	*/
+			/*	current over the clocks since the last feed.	*/
+			/*							*/
+			power_materialize(E, N);
+			if (N->energyinfo.drawclks == N->energyinfo.battclks)
 			{
 				continue;
 			}
 
-			/*	Iload was sum over last_stepclks clks	*/
-			Iload += ((State *)B->node_ptrs[j])->energyinfo.current_draw / 
-					((State *)B->node_ptrs[j])->last_stepclks;
+			Iload += (N->energyinfo.current_draw - N->energyinfo.battdraw) /
+					(N->energyinfo.drawclks - N->energyinfo.battclks);
 
 			/*						*/
 			/*	Keep information about the maximum 	*/
@@ -105,19 +127,11 @@ battery_feed(Engine *E, double force_current)
 			B->maxIload = Iload;
 		}
 
-
-		/*								*/
-		/*	First, scale Iload due to DC-DC converter ineff		*/
-		/*	where Ibatt (current at batt inputs):			*/
-		/*								*/
-		/*		Ibatt = Vload*Iload				*/
-		/*		      -----------				*/
-		/*		   eta(Vbatt, Iload)*Vbatt			*/
 		/*								*/
 		/*	LUT for eta is fxn of Iload only. Iload is a maximum	*/
 		/*	of 10x the nominal current draw.			*/
 		/*								*/
-		if (Iload/B->Inominal > 10.0)
+		if (Iload > 10.0*B->Inominal)
 		{
 			mprint(E, NULL, siminfo, 
 				"\nIload is absurdly high (%E). Shutting down...\n",
@@ -126,57 +140,70 @@ battery_feed(Engine *E, double force_current)
 			mexit(E, "See above messages", -1);
 		}
 
-		/*	We do linear interpolation:	*/
-		tmpval = (Iload/B->Inominal)/10.0;
-		tmpindex = tmpval*(B->etaLUTnentries-1);
-		tmplow = floor(tmpindex);
-		tmphigh = ceil(tmpindex);
-		tmpdelta = tmphigh-tmplow;
-
-		B->Ibatt = (Vload*Iload)/
-			((
-			((tmphigh-tmpindex)/tmpdelta)*B->etaLUT[(int)tmplow] +
-			((tmpindex-tmplow)/tmpdelta)*B->etaLUT[(int)tmphigh]
-			)*B->Vbatt);
-
-		B->tnow = E->globaltimepsec;
-
-		/*		Maximum Ibatt is 10x Inominal		*/
-		B->Vr = (B->Ibatt/B->Inominal)/10;
-
-		/*			Vrate				*/
-		B->Vrate = (B->Vrateold - B->Vr)*exp((0 - (B->tnow-B->told))/(B->Rf*B->Cf)) + B->Vr;
-		B->Vrateold = B->Vrate;
-
-		/*	Vlost models dependency on discharge rate	*/
-		/*	Entries 0 .. VlostLUTnentries-1 in LUT for 	*/
-		/*	Vrate = 0 .. 1.0. We do linear interpolation	*/
-		tmpindex = B->Vrate*(B->VlostLUTnentries-1);
-		tmplow = floor(tmpindex);
-		tmphigh = ceil(tmpindex);
-		tmpdelta = tmphigh-tmplow;
-		B->Vlost = ((tmphigh-tmpindex)/tmpdelta)*B->VlostLUT[(int)tmplow] +
-				((tmpindex-tmplow)/tmpdelta)*B->VlostLUT[(int)tmphigh];
-
+		K->Iload[i] = Iload;
+		K->dt[i] = E->globaltimepsec - B->told;
+	}
 
-		/*		Next, compute Vc for battery		*/
-		B->cap_act -= B->Ibatt_old*(B->tnow-B->told);
-		B->Vc = (B->cap_act/B->C) - B->Vlost;
+	/*								*/
+	/*	The Vrate lowpass filter decays by exp(-dt/RfCf). With	*/
+	/*	a fixed feed period dt never changes after the first	*/
+	/*	feed, so this is computed once per battery.		*/
+	/*								*/
+	for (i = 0; i < K->n; i++)
+	{
+		if (K->dt[i] != K->decaydt[i])
+		{
+			K->decay[i] = exp((0 - K->dt[i])/K->tau[i]);
+			K->decaydt[i] = K->dt[i];
+		}
+	}
 
+	/*								*/
+	/*	Update all batteries. Scale Iload due to DC-DC		*/
+	/*	converter ineff, where Ibatt (current at batt inputs):	*/
+	/*								*/
+	/*		Ibatt = Vload*Iload				*/
+	/*		      -----------				*/
+	/*		   eta(Vbatt, Iload)*Vbatt			*/
+	/*								*/
+	/*	Vrate is a lowpass-filtered Ibatt/(10*Inominal), Vlost	*/
+	/*	models dependency on discharge rate, and Vc acts as a	*/
+	/*	proxy for capacity remaining. Entries 0 .. n-1 of the	*/
+	/*	Vlost and Vbatt LUTs are for Vrate and Vc of 0 .. 1.0.	*/
+	/*								*/
+	for (i = 0; i < K->n; i++)
+	{
+		double	eta;
+
+		eta = battlerp(K, K->etabase[i], K->Iload[i]*K->etascale[i], K->etamax[i]);
+		K->Ibatt[i] = (Vload*K->Iload[i])/(eta*K->Vbatt[i]);
+		K->Vr[i] = K->Ibatt[i]*K->Vrscale[i];
+		K->Vrate[i] = (K->Vrate[i] - K->Vr[i])*K->decay[i] + K->Vr[i];
+		K->Vlost[i] = battlerp(K, K->Vlostbase[i], K->Vrate[i]*K->Vlostmax[i], K->Vlostmax[i]);
+		K->cap_act[i] -= K->Ibatt_old[i]*K->dt[i];
+		K->Vc[i] = K->cap_act[i]*K->invC[i] - K->Vlost[i];
+		K->Vbatt[i] = battlerp(K, K->Vbattbase[i], K->Vc[i]*K->Vbattmax[i], K->Vbattmax[i]);
+		K->Ibatt_old[i] = K->Ibatt[i];
+	}
 
-		/*							*/
-		/*	Vc acts as a proxy for capacity remaining	*/
-		/*	Entries 0 .. B->VbattLUTnentries-1 in LUT 	*/
-		/*	for Vc = 0 .. 1.0				*/
-		/*							*/
-		/*	We do linear interpolation	*/
-		tmpindex = B->Vc*(B->VbattLUTnentries-1);
-		tmplow = floor(tmpindex);
-		tmphigh = ceil(tmpindex);
-		tmpdelta = tmphigh-tmplow;
-		B->Vbatt = ((tmphigh-tmpindex)/tmpdelta)*B->VbattLUT[(int)tmplow] +
-				((tmpindex-tmplow)/tmpdelta)*B->VbattLUT[(int)tmphigh];
-		B->Ibatt_old = B->Ibatt;
+	/*	Write the results back, and retire depleted batteries	*/
+	for (i = 0; i < K->n; i++)
+	{
+		B = K->batt[i];
+
+		dsoc = fabs(K->Vc[i] - B->Vc);
+		dsocmax = max(dsocmax, dsoc);
+
+		B->Ibatt = K->Ibatt[i];
+		B->Ibatt_old = K->Ibatt_old[i];
+		B->Vr = K->Vr[i];
+		B->Vrate = K->Vrate[i];
+		B->Vrateold = K->Vrate[i];
+		B->Vlost = K->Vlost[i];
+		B->cap_act = K->cap_act[i];
+		B->Vc = K->Vc[i];
+		B->Vbatt = K->Vbatt[i];
+		B->tnow = E->globaltimepsec;
 		B->told = B->tnow;
 		B->battery_remaining = B->battery_capacity*B->Vc;
 
@@ -184,6 +211,7 @@ battery_feed(Engine *E, double force_current)
 		if (B->Vbatt <= B->Vbatt_expended)
 		{
 			B->dead = 1;
+			K->dirty = 1;
 			E->ndepletedbatts++;
 
 			if (E->ndepletedbatts == E->nactivebatts)
@@ -193,6 +221,171 @@ battery_feed(Engine *E, double force_current)
 		}
 	}
 
+	for (i = 0; i < E->nnodes; i++)
+	{
+		E->sp[i]->energyinfo.battdraw = E->sp[i]->energyinfo.current_draw;
+		E->sp[i]->energyinfo.battclks = E->sp[i]->energyinfo.drawclks;
+	}
+
+	if (E->battdsoc > 0)
+	{
+		battadaptperiod(E, dsocmax);
+	}
+
+	return;
+}
+
+/*									*/
+/*	Gather the live batteries into the bank, and rebuild the packed	*/
+/*	LUTs and their slope tables.					*/
+/*									*/
+static void
+battbankbuild(Engine *E)
+{
+	int		i, k, size, base;
+	Batt		*B;
+	BattBank	*K = &E->battbank;
+
+
+	K->n = 0;
+	size = 0;
+	for (i = 0; i < E->nactivebatts; i++)
+	{
+		B = E->activebatts[i];
+		if (B->dead)
+		{
+			continue;
+		}
+
+		K->batt[K->n++] = B;
+		size += B->etaLUTnentries + B->VbattLUTnentries + B->VlostLUTnentries;
+	}
+
+	if (size > K->lutsize)
+	{
+		if (K->lut != NULL)
+		{
+			mfree(E, K->lut, "K->lut in batt.c");
+			mfree(E, K->slope, "K->slope in batt.c");
+		}
+		K->lut = (double *)mcalloc(E, size, sizeof(double), "K->lut in batt.c");
+		K->slope = (double *)mcalloc(E, size, sizeof(double), "K->slope in batt.c");
+		if (K->lut == NULL || K->slope == NULL)
+		{
+			mexit(E, "Could not allocate memory for battery LUTs", -1);
+		}
+		K->lutsize = size;
+	}
+
+	base = 0;
+	for (i = 0; i < K->n; i++)
+	{
+		B = K->batt[i];
+
+		K->etabase[i] = base;
+		for (k = 0; k < B->etaLUTnentries; k++)
+		{
+			K->lut[base++] = B->etaLUT[k];
+		}
+		K->Vbattbase[i] = base;
+		for (k = 0; k < B->VbattLUTnentries; k++)
+		{
+			K->lut[base++] = B->VbattLUT[k];
+		}
+		K->Vlostbase[i] = base;
+		for (k = 0; k < B->VlostLUTnentries; k++)
+		{
+			K->lut[base++] = B->VlostLUT[k];
+		}
+
+		K->etamax[i] = B->etaLUTnentries - 1;
+		K->Vbattmax[i] = B->VbattLUTnentries - 1;
+		K->Vlostmax[i] = B->VlostLUTnentries - 1;
+
+		K->etascale[i] = K->etamax[i]/(10.0*B->Inominal);
+		K->Vrscale[i] = 1.0/(10.0*B->Inominal);
+		K->invC[i] = 1.0/B->C;
+
+		K->tau[i] = B->Rf*B->Cf;
+		K->decaydt[i] = -1.0;
+
+		K->Ibatt_old[i] = B->Ibatt_old;
+		K->Vrate[i] = B->Vrateold;
+		K->cap_act[i] = B->cap_act;
+		K->Vbatt[i] = B->Vbatt;
+	}
+
+	for (k = 0; k < base; k++)
+	{
+		K->slope[k] = 0.0;
+	}
+	for (i = 0; i < K->n; i++)
+	{
+		B = K->batt[i];
+
+		for (k = 0; k < B->etaLUTnentries - 1; k++)
+		{
+			K->slope[K->etabase[i] + k] = K->lut[K->etabase[i] + k + 1] - K->lut[K->etabase[i] + k];
+		}
+		for (k = 0; k < B->VbattLUTnentries - 1; k++)
+		{
+			K->slope[K->Vbattbase[i] + k] = K->lut[K->Vbattbase[i] + k + 1] - K->lut[K->Vbattbase[i] + k];
+		}
+		for (k = 0; k < B->VlostLUTnentries - 1; k++)
+		{
+			K->slope[K->Vlostbase[i] + k] = K->lut[K->Vlostbase[i] + k + 1] - K->lut[K->Vlostbase[i] + k];
+		}
+	}
+
+	K->dirty = 0;
+
+	return;
+}
+
+/*									*/
+/*	Halve the feed period when the largest change in state of	*/
+/*	charge (Vc) over the last feed exceeds battdsoc, and double it	*/
+/*	when the change is under a quarter of that, within the limits	*/
+/*	set by batt_setfeedadaptive().					*/
+/*									*/
+static void
+battadaptperiod(Engine *E, double dsoc)
+{
+	if (dsoc > E->battdsoc)
+	{
+		E->battperiodpsec = max(E->battperiodpsec/2, E->battperiodmin);
+	}
+	else if (dsoc < E->battdsoc/4)
+	{
+		E->battperiodpsec = min(E->battperiodpsec*2, E->battperiodmax);
+	}
+
+	return;
+}
+
+void
+batt_setfeedadaptive(Engine *E, double minperiod, double maxperiod, double dsoc)
+{
+	if (dsoc <= 0)
+	{
+		E->battdsoc = 0;
+		mprint(E, NULL, siminfo, "Battery feed period fixed at %E seconds\n", E->battperiodpsec);
+
+		return;
+	}
+
+	if (minperiod <= 0 || maxperiod < minperiod)
+	{
+		merror(E, "Invalid battery feed period limits (%E, %E).", minperiod, maxperiod);
+
+		return;
+	}
+
+	E->battdsoc = dsoc;
+	E->battperiodmin = minperiod;
+	E->battperiodmax = maxperiod;
+	E->battperiodpsec = min(max(E->battperiodpsec, minperiod), maxperiod);
+
 	return;
 }
 
@@ -538,6 +731,7 @@ batt_newbatt(Engine *E, int ID, double capacity_mAh)
 	E->activebatts[E->nactivebatts] = &E->batts[E->nbatts];
 	E->nactivebatts++;
 	E->nbatts++;
+	E->battbank.dirty = 1;
 
 	return;
 }
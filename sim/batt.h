@@ -90,3 +90,54 @@ typedef struct
 	int		VlostLUTnentries;
 	int		etaLUTnentries;
 } Batt;
+
+/*									*/
+/*	The per-feed state of all live batteries, one array per		*/
+/*	quantity, so battery_feed() can update every battery in a	*/
+/*	single loop with no pointer chasing. The Batt structures remain	*/
+/*	the authoritative copy: results are written back to them after	*/
+/*	each feed, and the bank is rebuilt from them whenever 'dirty'	*/
+/*	is set (new battery, battery death, parameter or LUT change).	*/
+/*									*/
+/*	The eta, Vbatt and Vlost LUTs of all batteries are packed into	*/
+/*	'lut', with 'slope' holding lut[k+1] - lut[k] for each entry,	*/
+/*	so interpolation is one multiply-add with no divide.		*/
+/*									*/
+typedef struct
+{
+	int		n;
+	int		dirty;
+	Batt		*batt[MAX_BATTERIES];
+
+	double		*lut;
+	double		*slope;
+	int		lutsize;
+
+	int		etabase[MAX_BATTERIES];
+	int		Vbattbase[MAX_BATTERIES];
+	int		Vlostbase[MAX_BATTERIES];
+	double		etamax[MAX_BATTERIES];
+	double		Vbattmax[MAX_BATTERIES];
+	double		Vlostmax[MAX_BATTERIES];
+
+	/*	Iload to eta LUT index, Ibatt to Vr, and 1/C	*/
+	double		etascale[MAX_BATTERIES];
+	double		Vrscale[MAX_BATTERIES];
+	double		invC[MAX_BATTERIES];
+
+	/*	exp(-dt/RfCf), cached for the dt it was computed for	*/
+	double		tau[MAX_BATTERIES];
+	double		decay[MAX_BATTERIES];
+	double		decaydt[MAX_BATTERIES];
+
+	double		Iload[MAX_BATTERIES];
+	double		dt[MAX_BATTERIES];
+	double		Ibatt[MAX_BATTERIES];
+	double		Ibatt_old[MAX_BATTERIES];
+	double		Vr[MAX_BATTERIES];
+	double		Vrate[MAX_BATTERIES];
+	double		Vlost[MAX_BATTERIES];
+	double		cap_act[MAX_BATTERIES];
+	double		Vc[MAX_BATTERIES];
+	double		Vbatt[MAX_BATTERIES];
+} BattBank;
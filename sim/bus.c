@@ -0,0 +1,564 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sf.h"
+#include "mextern.h"
+
+static Bus *	busof(Engine *E, State *S);
+static void	busarbitrate(Engine *E, Bus *B);
+static uvlong	buseffective(Bus *B, Busreq *R);
+static int	buspick(Bus *B, int head, int n, uvlong *t);
+static int	busrrdistance(Bus *B, int node);
+static uvlong	bustdmaslot(Bus *B, int node, uvlong t);
+static int	busreqcmp(const void *a, const void *b);
+
+static char	*busarbnames[] =
+{
+	[kSunflowerBusArbLock]		= "lock",
+	[kSunflowerBusArbRoundrobin]	= "roundrobin",
+	[kSunflowerBusArbPriority]	= "priority",
+	[kSunflowerBusArbTdma]		= "tdma",
+};
+
+
+/*									*/
+/*	Select the arbitration policy for the bus of node S, creating	*/
+/*	its memory controller on first use.				*/
+/*									*/
+void
+mbusarbitration(Engine *E, State *S, char *policy)
+{
+	Bus	*B;
+	int	i;
+
+
+	B = busof(E, S);
+	if (B == NULL)
+	{
+		return;
+	}
+
+	for (i = 0; i < (int)(sizeof(busarbnames)/sizeof(busarbnames[0])); i++)
+	{
+		if (!strcmp(policy, busarbnames[i]))
+		{
+			B->arbitration = i;
+			return;
+		}
+	}
+
+	merror(E, "Unknown bus arbitration policy \"%s\" (expected lock, roundrobin, priority or tdma).", policy);
+
+	return;
+}
+
+void
+mbusbanks(Engine *E, State *S, int nbanks, ulong interleave)
+{
+	Bus	*B;
+
+
+	if ((nbanks < 1) || (nbanks > kSunflowerBusMaxbanks) || (interleave == 0))
+	{
+		merror(E, "Bus needs between 1 and %d banks, and a non-zero interleave.",
+			kSunflowerBusMaxbanks);
+		return;
+	}
+
+	B = busof(E, S);
+	if (B == NULL)
+	{
+		return;
+	}
+
+	B->nbanks = nbanks;
+	B->interleave = interleave;
+
+	return;
+}
+
+void
+mbustiming(Engine *E, State *S, int xfercycles, int slotcycles)
+{
+	Bus	*B;
+
+
+	if ((xfercycles < 1) || (slotcycles < 1))
+	{
+		merror(E, "Bus transfer and TDMA slot must each be at least one cycle.");
+		return;
+	}
+
+	B = busof(E, S);
+	if (B == NULL)
+	{
+		return;
+	}
+
+	B->xfercycles = xfercycles;
+	B->slotcycles = slotcycles;
+
+	return;
+}
+
+/*									*/
+/*	Under priority arbitration, the waiting request from the node	*/
+/*	with the highest priority is granted first. Default is 0.	*/
+/*									*/
+void
+mbuspriority(Engine *E, State *S, int node, int priority)
+{
+	Bus	*B;
+
+
+	if ((node < 0) || (node >= kSunflowerBusMaxmasters))
+	{
+		merror(E, "Invalid node ID %d for bus priority.", node);
+		return;
+	}
+
+	B = busof(E, S);
+	if (B == NULL)
+	{
+		return;
+	}
+
+	B->priority[node] = priority;
+
+	return;
+}
+
+/*									*/
+/*	Queue an access by node S. The caller has already charged the	*/
+/*	access latency; any wait for the bus or the bank is added to	*/
+/*	*stall when the request is granted, in mbusclock().		*/
+/*									*/
+void
+mbusrequest(Engine *E, Bus *B, State *S, ulong addr, int type, int latency, int *stall)
+{
+	Busreq	*R, *tmp;
+
+
+	if (S->NODE_ID >= kSunflowerBusMaxmasters)
+	{
+		return;
+	}
+
+	if (B->nqueued == B->queuesize)
+	{
+		tmp = (Busreq *)mcalloc(E, B->queuesize*2, sizeof(Busreq), "Bus queue in bus.c");
+		if (tmp == NULL)
+		{
+			merror(E, "mcalloc failed for Bus queue in bus.c");
+			return;
+		}
+		memcpy(tmp, B->queue, B->nqueued*sizeof(Busreq));
+		mfree(E, B->queue, "Bus queue in bus.c");
+		B->queue = tmp;
+		B->queuesize *= 2;
+	}
+
+	R = &B->queue[B->nqueued++];
+	R->node = S->NODE_ID;
+	R->addr = addr;
+	R->type = type;
+	R->latency = max(latency, 0);
+	R->issue = (uvlong)(S->TIME / B->cycletime + 0.5);
+	R->stall = stall;
+	R->cycletime = S->CYCLETIME;
+
+	if ((B->arbitration == kSunflowerBusArbTdma) && (B->masterslot[S->NODE_ID] == 0))
+	{
+		B->masters[B->nmasters++] = S->NODE_ID;
+		B->masterslot[S->NODE_ID] = B->nmasters;
+	}
+
+	return;
+}
+
+/*									*/
+/*	Grant the requests queued on every bus during the scheduler	*/
+/*	round that just ended.						*/
+/*									*/
+void
+mbusclock(Engine *E)
+{
+	Bus	*B;
+
+
+	for (B = E->buses; B != NULL; B = B->next)
+	{
+		if (B->nqueued > 0)
+		{
+			busarbitrate(E, B);
+		}
+	}
+
+	return;
+}
+
+void
+mbusstats(Engine *E, State *S)
+{
+	Bus	*B;
+	int	i;
+
+
+	if ((S->superH == NULL) || (S->superH->B == NULL) || (S->superH->B->ctl == NULL))
+	{
+		mprint(E, NULL, siminfo,
+			"Node %d's bus has no memory controller (single bus lock).\n",
+			S->NODE_ID);
+		return;
+	}
+	B = S->superH->B->ctl;
+
+	mprint(E, NULL, siminfo, "\n%-24s %s\n", "Arbitration:", busarbnames[B->arbitration]);
+	mprint(E, NULL, siminfo, "%-24s %d\n", "Banks:", B->nbanks);
+	mprint(E, NULL, siminfo, "%-24s " ULONGFMT " bytes\n", "Interleave:", B->interleave);
+	mprint(E, NULL, siminfo, "%-24s %d cycles\n", "Transfer:", B->xfercycles);
+	mprint(E, NULL, siminfo, "%-24s %d cycles\n", "TDMA slot:", B->slotcycles);
+	mprint(E, NULL, siminfo, "%-24s " UVLONGFMT "\n", "Requests:", B->nrequests);
+	mprint(E, NULL, siminfo, "%-24s " UVLONGFMT "\n", "Wait cycles:", B->nwaitcycles);
+	mprint(E, NULL, siminfo, "%-24s %.3f\n", "Mean wait:",
+		(B->nrequests == 0) ? 0.0 : (double)B->nwaitcycles / B->nrequests);
+	mprint(E, NULL, siminfo, "%-24s " UVLONGFMT "\n", "Bank conflicts:", B->nbankconflicts);
+	mprint(E, NULL, siminfo, "%-24s %d\n", "Max queue depth:", B->maxqueued);
+
+	for (i = 0; i < kSunflowerBusMaxmasters; i++)
+	{
+		if (B->masterrequests[i] == 0)
+		{
+			continue;
+		}
+
+		mprint(E, NULL, siminfo,
+			"Node %-3d priority %-4d requests " UVLONGFMT ", wait cycles " UVLONGFMT "\n",
+			i, B->priority[i], B->masterrequests[i], B->masterwaitcycles[i]);
+	}
+
+	for (i = 0; i < B->nbanks; i++)
+	{
+		mprint(E, NULL, siminfo, "Bank %-3d requests " UVLONGFMT "\n",
+			i, B->bankrequests[i]);
+	}
+	mprint(E, NULL, siminfo, "\n");
+
+	return;
+}
+
+static Bus *
+busof(Engine *E, State *S)
+{
+	Bus	*B;
+
+
+	if ((S->superH == NULL) || (S->superH->B == NULL))
+	{
+		merror(E, "Node %d has no shared bus to configure.", S->NODE_ID);
+		return NULL;
+	}
+
+	if (S->superH->B->ctl != NULL)
+	{
+		return S->superH->B->ctl;
+	}
+
+	B = (Bus *)mcalloc(E, 1, sizeof(Bus), "Bus in bus.c");
+	if (B == NULL)
+	{
+		merror(E, "mcalloc failed for Bus in bus.c");
+		return NULL;
+	}
+
+	B->queue = (Busreq *)mcalloc(E, kSunflowerBusMinqueue, sizeof(Busreq), "Bus queue in bus.c");
+	if (B->queue == NULL)
+	{
+		merror(E, "mcalloc failed for Bus queue in bus.c");
+		mfree(E, B, "Bus in bus.c");
+		return NULL;
+	}
+	B->queuesize = kSunflowerBusMinqueue;
+
+	/*							*/
+	/*	The bus is clocked with the node that created	*/
+	/*	it; nodes with other clocks have their waits	*/
+	/*	converted to their own cycles.			*/
+	/*							*/
+	B->arbitration = kSunflowerBusArbLock;
+	B->cycletime = S->CYCLETIME;
+	B->xfercycles = kSunflowerBusDefaultxfer;
+	B->slotcycles = kSunflowerBusDefaultslot;
+	B->nbanks = kSunflowerBusDefaultbanks;
+	B->interleave = kSunflowerBusDefaultinterleave;
+	B->lastgrant = -1;
+
+	B->next = E->buses;
+	E->buses = B;
+	S->superH->B->ctl = B;
+
+	return B;
+}
+
+/*									*/
+/*	Requests are granted the bus in order of issue, subject to the	*/
+/*	arbitration policy. The bus is then held for the transfer, and	*/
+/*	the bank for the latency of the access, so that the next	*/
+/*	transfer can go to another bank while this one completes.	*/
+/*									*/
+static void
+busarbitrate(Engine *E, Bus *B)
+{
+	Busreq		R;
+	uvlong		t, grant, start, wait;
+	int		head, w, bank;
+
+
+	memset(B->roundissue, 0, sizeof(B->roundissue));
+	memset(B->roundcharged, 0, sizeof(B->roundcharged));
+	memset(B->roundshift, 0, sizeof(B->roundshift));
+
+	B->maxqueued = max(B->maxqueued, B->nqueued);
+	qsort(B->queue, B->nqueued, sizeof(Busreq), busreqcmp);
+
+	t = B->busfree;
+	for (head = 0; head < B->nqueued; head++)
+	{
+		/*							*/
+		/*	Under TDMA, each node only contends with itself	*/
+		/*	for the bus, in its own slots. Otherwise, the	*/
+		/*	policy picks among the requests waiting when	*/
+		/*	the bus frees up. The granted request is taken	*/
+		/*	out, keeping the rest in issue order.		*/
+		/*							*/
+		if (B->arbitration == kSunflowerBusArbTdma)
+		{
+			R = B->queue[head];
+			grant = bustdmaslot(B, R.node, max(buseffective(B, &R), B->masterfree[R.node]));
+			B->masterfree[R.node] = grant + B->xfercycles;
+		}
+		else
+		{
+			w = buspick(B, head, B->nqueued, &t);
+			R = B->queue[w];
+			memmove(&B->queue[head + 1], &B->queue[head], (w - head)*sizeof(Busreq));
+
+			grant = t;
+			B->busfree = grant + B->xfercycles;
+			t = B->busfree;
+		}
+
+		bank = (R.addr / B->interleave) % B->nbanks;
+		start = max(grant, B->bankfree[bank]);
+		if (B->bankfree[bank] > grant)
+		{
+			B->nbankconflicts++;
+		}
+		B->bankfree[bank] = start + R.latency + 1;
+
+		/*							*/
+		/*	Requests a node issues in the same cycle (an	*/
+		/*	instruction fetch and a data access) wait in	*/
+		/*	parallel, so only the longest wait is charged.	*/
+		/*	Waits charged for earlier cycles delay the	*/
+		/*	node's later requests in the same round.	*/
+		/*							*/
+		if (R.issue != B->roundissue[R.node])
+		{
+			B->roundshift[R.node] += B->roundcharged[R.node];
+			B->roundcharged[R.node] = 0;
+			B->roundissue[R.node] = R.issue;
+		}
+
+		wait = start - (R.issue + B->roundshift[R.node]);
+		if (wait > B->roundcharged[R.node])
+		{
+			*R.stall += (int)ceil((wait - B->roundcharged[R.node])*B->cycletime/R.cycletime - 1E-6);
+			B->roundcharged[R.node] = wait;
+		}
+
+		B->nrequests++;
+		B->nwaitcycles += wait;
+		B->masterrequests[R.node]++;
+		B->masterwaitcycles[R.node] += wait;
+		B->bankrequests[bank]++;
+		B->lastgrant = R.node;
+	}
+	B->nqueued = 0;
+
+	return;
+}
+
+/*									*/
+/*	Issue cycle of a request once its node has been stalled by the	*/
+/*	waits charged so far this round (see busarbitrate()).		*/
+/*									*/
+static uvlong
+buseffective(Bus *B, Busreq *R)
+{
+	if (R->issue != B->roundissue[R->node])
+	{
+		return R->issue + B->roundshift[R->node] + B->roundcharged[R->node];
+	}
+
+	return R->issue + B->roundshift[R->node];
+}
+
+/*									*/
+/*	Pick the request to grant once the bus is free at *t, among the	*/
+/*	requests issued by then, by priority if arbitration is by	*/
+/*	priority, and otherwise (and among equal priorities) in	*/
+/*	round-robin order of the requesting nodes. If none has been	*/
+/*	issued by *t, the bus idles until the next one is.		*/
+/*									*/
+static int
+buspick(Bus *B, int head, int n, uvlong *t)
+{
+	Busreq		*R, *W;
+	uvlong		e, next;
+	int		i, w;
+
+
+	for (;;)
+	{
+		w = -1;
+		W = NULL;
+		next = 0;
+		for (i = head; (i < n) && (B->queue[i].issue <= *t); i++)
+		{
+			R = &B->queue[i];
+			e = buseffective(B, R);
+			if (e > *t)
+			{
+				next = (next == 0) ? e : min(next, e);
+				continue;
+			}
+
+			if (W == NULL)
+			{
+				w = i;
+				W = R;
+				continue;
+			}
+
+			if ((B->arbitration == kSunflowerBusArbPriority) &&
+				(B->priority[R->node] != B->priority[W->node]))
+			{
+				if (B->priority[R->node] > B->priority[W->node])
+				{
+					w = i;
+					W = R;
+				}
+				continue;
+			}
+
+			if (busrrdistance(B, R->node) < busrrdistance(B, W->node))
+			{
+				w = i;
+				W = R;
+			}
+		}
+
+		if (W != NULL)
+		{
+			return w;
+		}
+
+		if ((i < n) && ((next == 0) || (B->queue[i].issue < next)))
+		{
+			next = B->queue[i].issue;
+		}
+		*t = next;
+	}
+}
+
+/*									*/
+/*	How far node is after the last granted node, in node ID order.	*/
+/*	The last granted node itself comes last.			*/
+/*									*/
+static int
+busrrdistance(Bus *B, int node)
+{
+	return (node - B->lastgrant - 1 + 2*kSunflowerBusMaxmasters) % kSunflowerBusMaxmasters;
+}
+
+/*									*/
+/*	First cycle at or after t in one of node's TDMA slots. Slots	*/
+/*	rotate over the nodes in the order they first used the bus.	*/
+/*									*/
+static uvlong
+bustdmaslot(Bus *B, int node, uvlong t)
+{
+	uvlong	slot;
+	int	owner, mine;
+
+
+	if ((B->nmasters <= 1) || (B->masterslot[node] == 0))
+	{
+		return t;
+	}
+
+	slot = t / B->slotcycles;
+	owner = slot % B->nmasters;
+	mine = B->masterslot[node] - 1;
+	if (owner == mine)
+	{
+		return t;
+	}
+
+	slot += (mine - owner + B->nmasters) % B->nmasters;
+
+	return slot * B->slotcycles;
+}
+
+static int
+busreqcmp(const void *a, const void *b)
+{
+	const Busreq	*x = a, *y = b;
+
+
+	if (x->issue != y->issue)
+	{
+		return (x->issue < y->issue) ? -1 : 1;
+	}
+
+	return x->node - y->node;
+}
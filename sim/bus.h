@@ -0,0 +1,144 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Memory controller behind a shared bus. Nodes created by SPLIT	*/
+/*	share their creator's bus, and NUMA accesses to another node's	*/
+/*	memory are sent to that node's bus. Each access becomes a	*/
+/*	request, queued until the end of the scheduler round, when the	*/
+/*	arbiter grants the queued requests one bus transfer at a time	*/
+/*	and sends each on to the bank selected by its address. Banks	*/
+/*	stay busy for the access latency, so accesses to different	*/
+/*	banks overlap while accesses to the same bank are serialized.	*/
+/*									*/
+/*	The time a request spends waiting for the bus and its bank is	*/
+/*	charged to the requesting node as stall cycles, on top of the	*/
+/*	access latency it already pays. With a quantum of 1 this is	*/
+/*	the delay seen cycle by cycle; with larger quanta, the delay	*/
+/*	is the same but is charged at the end of the quantum.		*/
+/*									*/
+/*	A bus without a controller (the default) keeps the old single	*/
+/*	bus lock. See bus.c.						*/
+/*									*/
+enum
+{
+	kSunflowerBusMaxbanks		= 64,
+	kSunflowerBusMaxmasters		= 32,	/*	one per node ID, as MAX_SIMNODES	*/
+	kSunflowerBusMinqueue		= 64,
+	kSunflowerBusDefaultbanks	= 1,
+	kSunflowerBusDefaultinterleave	= 32,
+	kSunflowerBusDefaultxfer	= 1,
+	kSunflowerBusDefaultslot	= 8,
+};
+
+typedef enum
+{
+	kSunflowerBusArbLock,
+	kSunflowerBusArbRoundrobin,
+	kSunflowerBusArbPriority,
+	kSunflowerBusArbTdma,
+} SunflowerBusArb;
+
+typedef struct
+{
+	int		node;
+	ulong		addr;
+	int		type;
+	int		latency;
+	uvlong		issue;
+
+	/*							*/
+	/*	Where the grant adds the requester's wait, and	*/
+	/*	the requester's clock, to convert bus cycles	*/
+	/*							*/
+	int		*stall;
+	double		cycletime;
+} Busreq;
+
+typedef struct Bus Bus;
+struct Bus
+{
+	SunflowerBusArb	arbitration;
+	double		cycletime;
+	int		xfercycles;
+	int		slotcycles;
+	int		nbanks;
+	ulong		interleave;
+
+	/*							*/
+	/*	Bus cycle at which the bus, each bank, and	*/
+	/*	under TDMA each node's slots, are next free	*/
+	/*							*/
+	uvlong		busfree;
+	uvlong		bankfree[kSunflowerBusMaxbanks];
+	uvlong		masterfree[kSunflowerBusMaxmasters];
+
+	/*							*/
+	/*	Per-node priority, round-robin pointer, and	*/
+	/*	TDMA slot order (masterslot[] is 1-based, 0	*/
+	/*	for nodes that have not used the bus yet)	*/
+	/*							*/
+	int		priority[kSunflowerBusMaxmasters];
+	int		lastgrant;
+	int		nmasters;
+	int		masters[kSunflowerBusMaxmasters];
+	int		masterslot[kSunflowerBusMaxmasters];
+
+	Busreq		*queue;
+	int		nqueued;
+	int		queuesize;
+
+	/*							*/
+	/*	Per node, during arbitration: the issue cycle	*/
+	/*	of its latest requests, the wait charged for	*/
+	/*	them, and the waits charged before those	*/
+	/*							*/
+	uvlong		roundissue[kSunflowerBusMaxmasters];
+	uvlong		roundcharged[kSunflowerBusMaxmasters];
+	uvlong		roundshift[kSunflowerBusMaxmasters];
+
+	/*			Statistics			*/
+	uvlong		nrequests;
+	uvlong		nwaitcycles;
+	uvlong		nbankconflicts;
+	int		maxqueued;
+	uvlong		masterrequests[kSunflowerBusMaxmasters];
+	uvlong		masterwaitcycles[kSunflowerBusMaxmasters];
+	uvlong		bankrequests[kSunflowerBusMaxbanks];
+
+	Bus		*next;
+};
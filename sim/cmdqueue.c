@@ -0,0 +1,248 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static void	cmdqueueparse(Engine *E);
+
+/*									*/
+/*	Called by the console for each line of input. While a		*/
+/*	detached scheduler is running, the line is left for it to	*/
+/*	execute at its next quantum boundary; otherwise the console	*/
+/*	executes it right away. If the ring is full, the console	*/
+/*	waits for the scheduler to catch up rather than drop input.	*/
+/*									*/
+void
+mcmdqueuesubmit(Engine *E, char *line)
+{
+	Cmdqueue	*Q = &E->cmdqueue;
+	ulong		head;
+
+
+	if (Q->slots == NULL)
+	{
+		Q->slots = (char *)mcalloc(E, kCmdqueueSlots, MAX_BUFLEN+1,
+				"Q->slots in mcmdqueuesubmit(), cmdqueue.c");
+		if (Q->slots == NULL)
+		{
+			mexit(E, "Could not allocate the command queue.", -1);
+		}
+	}
+
+	head = Q->head;
+	while (head - cmdqload(&Q->tail) >= kCmdqueueSlots)
+	{
+		if (!cmdqload(&Q->schedrunning))
+		{
+			mcmdqueuedrain(E, kCmdqueueConsole);
+		}
+		mnsleep(1000000);
+	}
+
+	strncpy(&Q->slots[(head % kCmdqueueSlots)*(MAX_BUFLEN+1)], line, MAX_BUFLEN);
+	Q->slots[(head % kCmdqueueSlots)*(MAX_BUFLEN+1) + MAX_BUFLEN] = '\0';
+	cmdqstore(&Q->head, head + 1);
+
+	/*								*/
+	/*	Pairs with the fence in mcmdqueuestop(): either the	*/
+	/*	exiting scheduler sees this line, or we see that it	*/
+	/*	has stopped and run the line ourselves.			*/
+	/*								*/
+	cmdqfence();
+	if (!cmdqload(&Q->schedrunning))
+	{
+		mcmdqueuedrain(E, kCmdqueueConsole);
+	}
+}
+
+/*									*/
+/*	Execute all queued lines, if no one else is already doing so.	*/
+/*	A caller that finds the queue owned just returns: the owner	*/
+/*	checks the queue again after giving up ownership, so nothing	*/
+/*	queued in the meantime is left behind.				*/
+/*									*/
+void
+mcmdqueuedrain(Engine *E, CmdqueueOwner who)
+{
+	Cmdqueue	*Q = &E->cmdqueue;
+	ulong		tail;
+	int		nobody;
+
+
+	while (cmdqload(&Q->head) != cmdqload(&Q->tail))
+	{
+		nobody = kCmdqueueNobody;
+		if (!cmdqclaim(&Q->owner, nobody, who))
+		{
+			return;
+		}
+
+		while ((tail = Q->tail) != cmdqload(&Q->head))
+		{
+			/*						*/
+			/*	Consume the slot before parsing it, so	*/
+			/*	that a command which ends in sfatal()	*/
+			/*	is not run again.			*/
+			/*						*/
+			mstatelock();
+			munchinput(E, &Q->slots[(tail % kCmdqueueSlots)*(MAX_BUFLEN+1)]);
+			cmdqstore(&Q->tail, tail + 1);
+			cmdqueueparse(E);
+			mcmdqueuepublish(E);
+			mstateunlock();
+		}
+
+		cmdqstore(&Q->owner, kCmdqueueNobody);
+		cmdqfence();
+	}
+}
+
+/*									*/
+/*	Called before spawning the scheduler thread, and by it when	*/
+/*	it exits. A detached scheduler leaves the queue to the		*/
+/*	console once it stops, after a last drain.			*/
+/*									*/
+void
+mcmdqueuestart(Engine *E)
+{
+	mcmdqueuepublish(E);
+	cmdqstore(&E->cmdqueue.schedrunning, 1);
+}
+
+void
+mcmdqueuestop(Engine *E)
+{
+	cmdqstore(&E->cmdqueue.schedrunning, 0);
+	cmdqfence();
+	mcmdqueuedrain(E, kCmdqueueScheduler);
+}
+
+/*									*/
+/*	A command run by the scheduler that ends in sfatal() longjmps	*/
+/*	back into scheduler() without returning through the drain;	*/
+/*	give up ownership so that the queue is not wedged. When the	*/
+/*	scheduler runs on the console thread (NODETACH), the console	*/
+/*	is the owner and keeps it.					*/
+/*									*/
+void
+mcmdqueueabandon(Engine *E, CmdqueueOwner who)
+{
+	int	owner = who;
+
+
+	cmdqclaim(&E->cmdqueue.owner, owner, kCmdqueueNobody);
+}
+
+/*									*/
+/*	Seqlock writer. Only the scheduler writes while it is running,	*/
+/*	and only the owner of the queue writes otherwise.		*/
+/*									*/
+void
+mcmdqueuepublish(Engine *E)
+{
+	Cmdqueue	*Q = &E->cmdqueue;
+	ulong		seq = Q->snapseq;
+
+
+	cmdqstore(&Q->snapseq, seq + 1);
+	cmdqfence();
+
+	Q->snapshot.nodeid = E->cp->NODE_ID;
+	Q->snapshot.nnodes = E->nnodes;
+	Q->snapshot.pc = E->cp->PC;
+	Q->snapshot.vdd = E->cp->VDD;
+	Q->snapshot.cycletime = E->cp->CYCLETIME;
+	Q->snapshot.globaltimepsec = E->globaltimepsec;
+
+	cmdqstore(&Q->snapseq, seq + 2);
+}
+
+/*									*/
+/*	Seqlock reader, for the console. With no scheduler running,	*/
+/*	the live state is already consistent and is read directly.	*/
+/*									*/
+void
+mcmdqueuesnapshot(Engine *E, Cmdsnapshot *snap)
+{
+	Cmdqueue	*Q = &E->cmdqueue;
+	ulong		seq;
+
+
+	if (!cmdqload(&Q->schedrunning) && (cmdqload(&Q->owner) != kCmdqueueScheduler))
+	{
+		snap->nodeid = E->cp->NODE_ID;
+		snap->nnodes = E->nnodes;
+		snap->pc = E->cp->PC;
+		snap->vdd = E->cp->VDD;
+		snap->cycletime = E->cp->CYCLETIME;
+		snap->globaltimepsec = E->globaltimepsec;
+
+		return;
+	}
+
+	do
+	{
+		while ((seq = cmdqload(&Q->snapseq)) & 1)
+		{
+		}
+		*snap = Q->snapshot;
+		cmdqfence();
+	} while (cmdqload(&Q->snapseq) != seq);
+}
+
+static void
+cmdqueueparse(Engine *E)
+{
+	yyengine = E;
+
+	/*							*/
+	/*	MSP430 has no grammar of its own; the superH one	*/
+	/*	covers the machine-independent commands.		*/
+	/*							*/
+	if ((yyengine->cp->machinetype == MACHINE_SUPERH) || (yyengine->cp->machinetype == MACHINE_MSP430))
+	{
+		sf_superh_parse();
+	}
+	else if (yyengine->cp->machinetype == MACHINE_RISCV)
+	{
+		sf_riscv_parse();
+	}
+}
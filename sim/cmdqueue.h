@@ -0,0 +1,105 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Command queue between the console and the scheduler thread.	*/
+/*	While a detached scheduler is running, the console does not	*/
+/*	parse its input itself: it copies each line into a ring of	*/
+/*	fixed slots, and the scheduler executes the queued lines at	*/
+/*	the next quantum boundary, so that commands never mutate the	*/
+/*	Engine or a State in the middle of a node step. There is one	*/
+/*	producer (the console) and at most one consumer at a time,	*/
+/*	the holder of 'owner'; when no scheduler is running the		*/
+/*	console drains the queue itself. See cmdqueue.c.		*/
+/*									*/
+/*	The console prompt is drawn from a snapshot of the current	*/
+/*	node that the scheduler republishes at every quantum boundary	*/
+/*	under a sequence count (a seqlock): the count is odd while	*/
+/*	the snapshot is being written, and a reader retries until it	*/
+/*	sees the same even count before and after its copy.		*/
+/*									*/
+enum
+{
+	kCmdqueueSlots		= 64,
+};
+
+typedef enum
+{
+	kCmdqueueNobody,
+	kCmdqueueConsole,
+	kCmdqueueScheduler,
+} CmdqueueOwner;
+
+typedef struct
+{
+	int		nodeid;
+	int		nnodes;
+	ulong		pc;
+	double		vdd;
+	double		cycletime;
+	Picosec		globaltimepsec;
+} Cmdsnapshot;
+
+typedef struct
+{
+	ulong		head;		/*	Next slot to fill; written only by the console		*/
+	ulong		tail;		/*	Next slot to execute; written only by the owner		*/
+	int		owner;
+	int		schedrunning;
+	char		*slots;		/*	kCmdqueueSlots lines of MAX_BUFLEN+1 chars		*/
+
+	ulong		snapseq;
+	Cmdsnapshot	snapshot;
+} Cmdqueue;
+
+/*									*/
+/*	The GCC/Clang atomic builtins give us the orderings we need	*/
+/*	without taking a lock. Elsewhere, fall back to plain		*/
+/*	accesses, as on hosts where the console and the scheduler	*/
+/*	are serialized by mstatelock() anyway.				*/
+/*									*/
+#if defined(__GNUC__) || defined(__clang__)
+#	define	cmdqload(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#	define	cmdqstore(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#	define	cmdqclaim(p, o, n)	__atomic_compare_exchange_n((p), &(o), (n), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#	define	cmdqfence()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#	define	cmdqload(p)		(*(p))
+#	define	cmdqstore(p, v)		(*(p) = (v))
+#	define	cmdqclaim(p, o, n)	((*(p) == (o)) ? (*(p) = (n), 1) : 0)
+#	define	cmdqfence()
+#endif
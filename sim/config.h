@@ -45,19 +45,48 @@
 #define	SF_MOBILITY		1
 #define	SF_SIMLOG		1
 #define	SF_PAU_DEFINED		0
-#define	SF_BITFLIP_ANALYSIS	0
-#define	SF_POWER_ANALYSIS	0
 #define	SF_MEMTRACE		1
 #define	SF_BATT			1
 #define	SF_BATTLOG		1
 #define	SF_FAULT		1
 #define	SF_DUMPPWR		0
-#define	SF_VALUETRACE_ANALYSIS	1
 #define	SF_FT_TANDEM		0
 #define	SF_BPTS			1
 #define	SF_TRAJECTORIES		1
-#define	SF_TAINTANALYSIS	0
-#define	SF_UNCERTAIN_UPE	0
-#define	SF_UNCERTAIN_HISTOGRAM	0
-#define	SF_NUMA			1
 #define	SF_EMBEDDED		0
+#define	SF_SIMPROFILE		1
+
+/*									*/
+/*	The analyses below are selected at run time (SETANALYSIS) from	*/
+/*	the bits in SF_ANALYSES rather than fixed at build time. Files	*/
+/*	that instantiate specialized copies of the step loops redefine	*/
+/*	SF_ANALYSES to a constant before including the loop source.	*/
+/*									*/
+#define	SF_ANALYSIS_BITFLIP	(1 << 0)
+#define	SF_ANALYSIS_POWER	(1 << 1)
+#define	SF_ANALYSIS_VALUETRACE	(1 << 2)
+#define	SF_ANALYSIS_TAINT	(1 << 3)
+#define	SF_ANALYSIS_UPE		(1 << 4)
+#define	SF_ANALYSIS_HISTOGRAM	(1 << 5)
+#define	SF_ANALYSIS_NUMA	(1 << 6)
+
+#define	SF_DEFAULT_ANALYSES	(SF_ANALYSIS_VALUETRACE | SF_ANALYSIS_NUMA)
+
+#ifndef SF_ANALYSES
+#define	SF_ANALYSES		sfanalyses
+#endif
+
+#define	SF_BITFLIP_ANALYSIS	(SF_ANALYSES & SF_ANALYSIS_BITFLIP)
+#define	SF_POWER_ANALYSIS	(SF_ANALYSES & SF_ANALYSIS_POWER)
+#define	SF_VALUETRACE_ANALYSIS	(SF_ANALYSES & SF_ANALYSIS_VALUETRACE)
+#define	SF_TAINTANALYSIS	(SF_ANALYSES & SF_ANALYSIS_TAINT)
+#define	SF_UNCERTAIN_UPE	(SF_ANALYSES & SF_ANALYSIS_UPE)
+#define	SF_UNCERTAIN_HISTOGRAM	(SF_ANALYSES & SF_ANALYSIS_HISTOGRAM)
+#define	SF_NUMA			(SF_ANALYSES & SF_ANALYSIS_NUMA)
+
+/*									*/
+/*	Index of the step-loop instance for a set of analyses: only	*/
+/*	power and bit-flip analysis are tested inside the step loops.	*/
+/*									*/
+#define	SF_NSTEPVARIANTS	4
+#define	SF_STEPVARIANT(a)	((((a) & SF_ANALYSIS_POWER) ? 1 : 0) | (((a) & SF_ANALYSIS_BITFLIP) ? 2 : 0))
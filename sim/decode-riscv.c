@@ -8,6 +8,21 @@ riscvdecode(Engine *  E, State *  S, uint32_t instr, RiscvPipestage *  stage)
 {
 	volatile instr_riscv_decode *tmp;
 
+	/*								*/
+	/*	RV32C: a compressed instruction is decoded as the 32-bit	*/
+	/*	instruction it expands to, so the step functions and the	*/
+	/*	hazard checks only ever see 32-bit encodings.		*/
+	/*								*/
+	if ((instr & 0x3) != 0x3)
+	{
+		instr = riscvexpandcompressed(instr & 0xFFFF);
+		stage->length = 2;
+	}
+	else
+	{
+		stage->length = 4;
+	}
+
 	stage->instr = instr;
 
 	/*								*/
@@ -328,6 +343,88 @@ riscvdecode(Engine *  E, State *  S, uint32_t instr, RiscvPipestage *  stage)
 		}
 		case 0b0110011:
 		{
+			/*	RV32M shares the OP major opcode, with funct7 = 1	*/
+			if (tmp->funct7 == 0b0000001)
+			{
+				switch(tmp->funct3)
+				{
+					case 0b000:
+					{
+						stage->fptr = (void *) riscv_mul;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_MUL;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_MUL]);
+
+						break;
+					}
+					case 0b001:
+					{
+						stage->fptr = (void *) riscv_mulh;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_MULH;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_MULH]);
+
+						break;
+					}
+					case 0b010:
+					{
+						stage->fptr = (void *) riscv_mulhsu;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_MULHSU;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_MULHSU]);
+
+						break;
+					}
+					case 0b011:
+					{
+						stage->fptr = (void *) riscv_mulhu;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_MULHU;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_MULHU]);
+
+						break;
+					}
+					case 0b100:
+					{
+						stage->fptr = (void *) riscv_div;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_DIV;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_DIV]);
+
+						break;
+					}
+					case 0b101:
+					{
+						stage->fptr = (void *) riscv_divu;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_DIVU;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_DIVU]);
+
+						break;
+					}
+					case 0b110:
+					{
+						stage->fptr = (void *) riscv_rem;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_REM;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_REM]);
+
+						break;
+					}
+					case 0b111:
+					{
+						stage->fptr = (void *) riscv_remu;
+						stage->format = INSTR_R;
+						stage->op = RISCV_OP_REMU;
+						stage->instr_latencies = (int *)(&riscv_instr_latencies[RISCV_OP_REMU]);
+
+						break;
+					}
+				}
+
+				break;
+			}
+
 			switch(tmp->funct3)
 			{
 				case 0b000:
@@ -1325,3 +1422,287 @@ riscvdecode(Engine *  E, State *  S, uint32_t instr, RiscvPipestage *  stage)
 		mprint(E, S, nodeinfo, "fetchedpc 0x%X: Unknown stage->op: 0x%X\n", stage->fetchedpc, stage->op);
 	}
 }
+
+static uint32_t
+rvencodeR(uint32_t funct7, uint32_t rs2, uint32_t rs1, uint32_t funct3, uint32_t rd, uint32_t opcode)
+{
+	return (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+}
+
+static uint32_t
+rvencodeI(int32_t imm, uint32_t rs1, uint32_t funct3, uint32_t rd, uint32_t opcode)
+{
+	return ((imm & 0xFFF) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+}
+
+static uint32_t
+rvencodeS(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t funct3, uint32_t opcode)
+{
+	return (((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12)
+		| ((imm & 0x1F) << 7) | opcode;
+}
+
+static uint32_t
+rvencodeB(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t funct3, uint32_t opcode)
+{
+	return (((imm >> 12) & 0x1) << 31) | (((imm >> 5) & 0x3F) << 25) | (rs2 << 20)
+		| (rs1 << 15) | (funct3 << 12) | (((imm >> 1) & 0xF) << 8)
+		| (((imm >> 11) & 0x1) << 7) | opcode;
+}
+
+static uint32_t
+rvencodeU(int32_t imm, uint32_t rd, uint32_t opcode)
+{
+	return ((imm & 0xFFFFF) << 12) | (rd << 7) | opcode;
+}
+
+static uint32_t
+rvencodeJ(int32_t imm, uint32_t rd, uint32_t opcode)
+{
+	return (((imm >> 20) & 0x1) << 31) | (((imm >> 1) & 0x3FF) << 21)
+		| (((imm >> 11) & 0x1) << 20) | (((imm >> 12) & 0xFF) << 12)
+		| (rd << 7) | opcode;
+}
+
+/*	Bits hi..lo of a compressed instruction		*/
+#define	CBITS(c, hi, lo)	(((c) >> (lo)) & ((1U << ((hi) - (lo) + 1)) - 1))
+
+/*
+ *	Expand an RV32C instruction into its RV32I/F/D equivalent, following
+ *	Table 16.5-16.7 of the ISA manual v2.2. Reserved, illegal and RV64/128
+ *	only encodings expand to 0, which riscvdecode() treats like any other
+ *	invalid instruction.
+ *
+ *	The step functions execute JAL and branches with S->PC already past
+ *	the instruction, and the ops in op-riscv.c take the target relative to
+ *	S->PC - 4. For the 2-byte C.J, C.JAL, C.BEQZ and C.BNEZ we therefore
+ *	add 2 to the offset in the expansion, so that the link address
+ *	(S->PC) and the target both come out right without separate ops.
+ */
+uint32_t
+riscvexpandcompressed(uint16_t c)
+{
+	uint32_t	funct3 = CBITS(c, 15, 13);
+	uint32_t	rd = CBITS(c, 11, 7);
+	uint32_t	rs2 = CBITS(c, 6, 2);
+	uint32_t	rdp = 8 + CBITS(c, 4, 2);	/*	rd' / rs2'	*/
+	uint32_t	rs1p = 8 + CBITS(c, 9, 7);	/*	rs1' / rd'	*/
+	int32_t		imm6 = sign_extend((CBITS(c, 12, 12) << 5) | CBITS(c, 6, 2), 6);
+	int32_t		imm;
+
+	switch (c & 0x3)
+	{
+		case 0b00:
+		{
+			switch (funct3)
+			{
+				case 0b000:	/*	C.ADDI4SPN	*/
+				{
+					imm = (CBITS(c, 12, 11) << 4) | (CBITS(c, 10, 7) << 6)
+						| (CBITS(c, 6, 6) << 2) | (CBITS(c, 5, 5) << 3);
+					if (imm == 0)
+					{
+						return 0;
+					}
+
+					return rvencodeI(imm, RISCV_X2, 0b000, rdp, 0b0010011);
+				}
+				case 0b001:	/*	C.FLD		*/
+				{
+					imm = (CBITS(c, 12, 10) << 3) | (CBITS(c, 6, 5) << 6);
+
+					return rvencodeI(imm, rs1p, 0b011, rdp, 0b0000111);
+				}
+				case 0b010:	/*	C.LW		*/
+				case 0b011:	/*	C.FLW		*/
+				{
+					imm = (CBITS(c, 12, 10) << 3) | (CBITS(c, 6, 6) << 2) | (CBITS(c, 5, 5) << 6);
+
+					return rvencodeI(imm, rs1p, 0b010, rdp, funct3 == 0b010 ? 0b0000011 : 0b0000111);
+				}
+				case 0b101:	/*	C.FSD		*/
+				{
+					imm = (CBITS(c, 12, 10) << 3) | (CBITS(c, 6, 5) << 6);
+
+					return rvencodeS(imm, rdp, rs1p, 0b011, 0b0100111);
+				}
+				case 0b110:	/*	C.SW		*/
+				case 0b111:	/*	C.FSW		*/
+				{
+					imm = (CBITS(c, 12, 10) << 3) | (CBITS(c, 6, 6) << 2) | (CBITS(c, 5, 5) << 6);
+
+					return rvencodeS(imm, rdp, rs1p, 0b010, funct3 == 0b110 ? 0b0100011 : 0b0100111);
+				}
+				default:
+				{
+					return 0;
+				}
+			}
+		}
+
+		case 0b01:
+		{
+			switch (funct3)
+			{
+				case 0b000:	/*	C.ADDI, C.NOP	*/
+				{
+					return rvencodeI(imm6, rd, 0b000, rd, 0b0010011);
+				}
+				case 0b001:	/*	C.JAL		*/
+				case 0b101:	/*	C.J		*/
+				{
+					imm = sign_extend((CBITS(c, 12, 12) << 11) | (CBITS(c, 11, 11) << 4)
+						| (CBITS(c, 10, 9) << 8) | (CBITS(c, 8, 8) << 10)
+						| (CBITS(c, 7, 7) << 6) | (CBITS(c, 6, 6) << 7)
+						| (CBITS(c, 5, 3) << 1) | (CBITS(c, 2, 2) << 5), 12);
+
+					return rvencodeJ(imm + 2, funct3 == 0b001 ? RISCV_X1 : RISCV_X0, 0b1101111);
+				}
+				case 0b010:	/*	C.LI		*/
+				{
+					return rvencodeI(imm6, RISCV_X0, 0b000, rd, 0b0010011);
+				}
+				case 0b011:	/*	C.ADDI16SP, C.LUI	*/
+				{
+					if (rd == RISCV_X2)
+					{
+						imm = sign_extend((CBITS(c, 12, 12) << 9) | (CBITS(c, 6, 6) << 4)
+							| (CBITS(c, 5, 5) << 6) | (CBITS(c, 4, 3) << 7)
+							| (CBITS(c, 2, 2) << 5), 10);
+						if (imm == 0)
+						{
+							return 0;
+						}
+
+						return rvencodeI(imm, RISCV_X2, 0b000, RISCV_X2, 0b0010011);
+					}
+					if (imm6 == 0)
+					{
+						return 0;
+					}
+
+					return rvencodeU(imm6, rd, 0b0110111);
+				}
+				case 0b100:
+				{
+					switch (CBITS(c, 11, 10))
+					{
+						case 0b00:	/*	C.SRLI	*/
+						case 0b01:	/*	C.SRAI	*/
+						{
+							/*	shamt[5] must be zero on RV32	*/
+							if (CBITS(c, 12, 12))
+							{
+								return 0;
+							}
+
+							return rvencodeI(rs2 | (CBITS(c, 10, 10) << 10), rs1p, 0b101, rs1p, 0b0010011);
+						}
+						case 0b10:	/*	C.ANDI	*/
+						{
+							return rvencodeI(imm6, rs1p, 0b111, rs1p, 0b0010011);
+						}
+						default:	/*	C.SUB, C.XOR, C.OR, C.AND	*/
+						{
+							static const uint32_t	funct3s[] = {0b000, 0b100, 0b110, 0b111};
+
+							if (CBITS(c, 12, 12))
+							{
+								return 0;
+							}
+
+							return rvencodeR(CBITS(c, 6, 5) == 0 ? 0b0100000 : 0b0000000,
+								rdp, rs1p, funct3s[CBITS(c, 6, 5)], rs1p, 0b0110011);
+						}
+					}
+				}
+				case 0b110:	/*	C.BEQZ		*/
+				case 0b111:	/*	C.BNEZ		*/
+				{
+					imm = sign_extend((CBITS(c, 12, 12) << 8) | (CBITS(c, 11, 10) << 3)
+						| (CBITS(c, 6, 5) << 6) | (CBITS(c, 4, 3) << 1)
+						| (CBITS(c, 2, 2) << 5), 9);
+
+					return rvencodeB(imm + 2, RISCV_X0, rs1p, funct3 & 0x1, 0b1100011);
+				}
+			}
+		}
+
+		case 0b10:
+		{
+			switch (funct3)
+			{
+				case 0b000:	/*	C.SLLI		*/
+				{
+					if (CBITS(c, 12, 12))
+					{
+						return 0;
+					}
+
+					return rvencodeI(rs2, rd, 0b001, rd, 0b0010011);
+				}
+				case 0b001:	/*	C.FLDSP		*/
+				{
+					imm = (CBITS(c, 12, 12) << 5) | (CBITS(c, 6, 5) << 3) | (CBITS(c, 4, 2) << 6);
+
+					return rvencodeI(imm, RISCV_X2, 0b011, rd, 0b0000111);
+				}
+				case 0b010:	/*	C.LWSP		*/
+				case 0b011:	/*	C.FLWSP		*/
+				{
+					if (funct3 == 0b010 && rd == RISCV_X0)
+					{
+						return 0;
+					}
+					imm = (CBITS(c, 12, 12) << 5) | (CBITS(c, 6, 4) << 2) | (CBITS(c, 3, 2) << 6);
+
+					return rvencodeI(imm, RISCV_X2, 0b010, rd, funct3 == 0b010 ? 0b0000011 : 0b0000111);
+				}
+				case 0b100:
+				{
+					if (!CBITS(c, 12, 12))
+					{
+						if (rs2 != RISCV_X0)	/*	C.MV	*/
+						{
+							return rvencodeR(0b0000000, rs2, RISCV_X0, 0b000, rd, 0b0110011);
+						}
+						if (rd == RISCV_X0)
+						{
+							return 0;
+						}
+
+						/*	C.JR		*/
+						return rvencodeI(0, rd, 0b000, RISCV_X0, 0b1100111);
+					}
+
+					if (rs2 != RISCV_X0)		/*	C.ADD	*/
+					{
+						return rvencodeR(0b0000000, rs2, rd, 0b000, rd, 0b0110011);
+					}
+					if (rd == RISCV_X0)		/*	C.EBREAK	*/
+					{
+						return rvencodeI(1, RISCV_X0, 0b000, RISCV_X0, 0b1110011);
+					}
+
+					/*	C.JALR		*/
+					return rvencodeI(0, rd, 0b000, RISCV_X1, 0b1100111);
+				}
+				case 0b101:	/*	C.FSDSP		*/
+				{
+					imm = (CBITS(c, 12, 10) << 3) | (CBITS(c, 9, 7) << 6);
+
+					return rvencodeS(imm, rs2, RISCV_X2, 0b011, 0b0100111);
+				}
+				case 0b110:	/*	C.SWSP		*/
+				case 0b111:	/*	C.FSWSP		*/
+				{
+					imm = (CBITS(c, 12, 9) << 2) | (CBITS(c, 8, 7) << 6);
+
+					return rvencodeS(imm, rs2, RISCV_X2, 0b010, funct3 == 0b110 ? 0b0100011 : 0b0100111);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
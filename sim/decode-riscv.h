@@ -48,6 +48,14 @@ enum
 	RISCV_OP_CSRRWI,
 	RISCV_OP_CSRRSI,
 	RISCV_OP_CSRRCI,
+	RISCV_OP_MUL,
+	RISCV_OP_MULH,
+	RISCV_OP_MULHSU,
+	RISCV_OP_MULHU,
+	RISCV_OP_DIV,
+	RISCV_OP_DIVU,
+	RISCV_OP_REM,
+	RISCV_OP_REMU,
 
 	RISCV_OP_MAX,
 
@@ -277,6 +277,34 @@ ilat(Engine *E, State *S, int type, int op, int amode_d, int amode_s, ushort ins
 	}
 	else if (type == MSP430_INSTR_II)
 	{
+		/*							*/
+		/*	RETI takes 5 cycles whatever its (unused)	*/
+		/*	operand fields, and the byte forms take as	*/
+		/*	long as the word forms.				*/
+		/*							*/
+		switch (op)
+		{
+			case MSP430_OP_RETI:
+			{
+				return 5;
+			}
+			case MSP430_OP_RRCB:
+			{
+				op = MSP430_OP_RRC;
+				break;
+			}
+			case MSP430_OP_RRAB:
+			{
+				op = MSP430_OP_RRA;
+				break;
+			}
+			case MSP430_OP_PUSHB:
+			{
+				op = MSP430_OP_PUSH;
+				break;
+			}
+		}
+
 		switch (amode_d)
 		{
 			case MSP430_AMODE_REG:
@@ -487,6 +515,17 @@ smode(Engine *E, State *S, int type, ushort instr)
 		}
 	}
 
+	/*								*/
+	/*	R3, and R2 with As of 10 or 11, are constant generators	*/
+	/*	(Table 3-2 in slau049e.pdf): no memory operand and no	*/
+	/*	extension word, so they time and decode as register	*/
+	/*	mode and msp430regread() supplies the constant.		*/
+	/*								*/
+	if ((dsreg == 3) || ((dsreg == 2) && (asd >= B0010)))
+	{
+		return MSP430_AMODE_REG;
+	}
+
 	switch (asd)
 	{
 		case B0000:
@@ -593,7 +632,8 @@ msp430decode(Engine *E, State *S, ushort instr, MSP430Pipestage *p)
 			p->amode_s = p->amode_d = smode(E, S, p->format, p->instr);
 			p->ilen = ilen(E, S, p->format, p->amode_d, p->amode_s);
 
-			switch (instr & 0xFFF)
+			/*	Opcode and B/W; Ad and the register are operands	*/
+			switch (instr & 0xFC0)
 			{
 				case 0x000:
 				{
@@ -716,7 +756,8 @@ msp430decode(Engine *E, State *S, ushort instr, MSP430Pipestage *p)
 			p->format = MSP430_INSTR_III;
 			p->ilen = ilen(E, S, p->format, -1, -1);
 
-			switch ((instr & 0x0F00) >> 8)
+			/*	Condition field; the rest is the offset	*/
+			switch ((instr & 0x0C00) >> 8)
 			{
 				case 0x0:
 				{
@@ -766,7 +807,8 @@ msp430decode(Engine *E, State *S, ushort instr, MSP430Pipestage *p)
 			p->format = MSP430_INSTR_III;
 			p->ilen = ilen(E, S, p->format, -1, -1);
 
-			switch ((instr & 0x0F00) >> 8)
+			/*	Condition field; the rest is the offset	*/
+			switch ((instr & 0x0C00) >> 8)
 			{
 				case 0x0:
 				{
@@ -1072,5 +1114,32 @@ msp430decode(Engine *E, State *S, ushort instr, MSP430Pipestage *p)
 		}
 	}
 
+	/*								*/
+	/*	The raw As/Ad fields are what msp430regread() uses to	*/
+	/*	pick constant generator values for R2/R3. Jumps have	*/
+	/*	no addressing mode fields, so they must read back as	*/
+	/*	zero, or a jump on a flag would see a constant for SR.	*/
+	/*								*/
+	switch (p->format)
+	{
+		case MSP430_INSTR_I:
+		{
+			p->As = msp430_instrI_as(instr);
+			p->Ad = msp430_instrI_ad(instr);
+			break;
+		}
+		case MSP430_INSTR_II:
+		{
+			p->As = msp430_instrII_ad(instr);
+			p->Ad = 0;
+			break;
+		}
+		default:
+		{
+			p->As = 0;
+			p->Ad = 0;
+		}
+	}
+
 	return;
 }
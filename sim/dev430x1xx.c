@@ -374,7 +374,7 @@ dev430x1xxreset(State *S, int type)
 }
 
 uchar
-dev430x1xxreadbyte(Engine *E, State *S, ushort addr)
+dev430x1xxreadbyte(Engine *E, State *S, ulong addr)
 {
 	/*								*/
 	/*	If this is a byte read to peripheral module space,	*/
@@ -406,7 +406,7 @@ dev430x1xxreadbyte(Engine *E, State *S, ushort addr)
 }
 
 void
-dev430x1xxwritebyte(Engine *E, State *S, ushort addr, uchar data)
+dev430x1xxwritebyte(Engine *E, State *S, ulong addr, uchar data)
 {
 	if ((addr >= MSP430_PERIPH8_BEGIN) && (addr <= MSP430_PERIPH8_END))
 	{
@@ -437,7 +437,7 @@ dev430x1xxwritebyte(Engine *E, State *S, ushort addr, uchar data)
 }
 
 ushort
-dev430x1xxreadword(Engine *E, State *S, ushort addr)
+dev430x1xxreadword(Engine *E, State *S, ulong addr)
 {
 	/*								*/
 	/*	If this is a read from the 8 bit peripheral space,	*/
@@ -471,7 +471,7 @@ dev430x1xxreadword(Engine *E, State *S, ushort addr)
 }
 
 void
-dev430x1xxwriteword(Engine *E, State *S, ushort addr, ushort data)
+dev430x1xxwriteword(Engine *E, State *S, ulong addr, ushort data)
 {
 	/*									*/
 	/*	If this is a word write to 8-bit peripheral module region,	*/
@@ -648,13 +648,23 @@ dev430x1xxNMIinterrupt(State *S, int type)
 	return;
 }
 
-void
-dev430x1xxinterrupt(State *S, int priority)
+/*									*/
+/*	Take the highest-priority maskable interrupt pending in		*/
+/*	S->intrQ, if GIE permits. Peripherals raise an interrupt by	*/
+/*	queueing its priority (the vector offset in Table 2-1 of	*/
+/*	slau049e.pdf) as the type, via pic_intr_enqueue(). Returns 0	*/
+/*	if an interrupt was taken, -1 otherwise.			*/
+/*									*/
+int
+dev430x1xxinterrupt(Engine *E, State *S)
 {
-	int	GIE = msp430_sreg_get_GIE(S->msp430->R[MSP430_SR]);
-	if (!GIE)
+	int		GIE = msp430_sreg_get_GIE(S->msp430->R[MSP430_SR]);
+	Interrupt	*p, *intr = NULL;
+
+
+	if (!GIE || (S->intrQ->nqintrs == 0))
 	{
-		return;
+		return -1;
 	}
 
 
@@ -662,40 +672,43 @@ dev430x1xxinterrupt(State *S, int priority)
 
 
 	/*									*/
-	/*	Check the 'Rack' and complete the currently executing instr.	*/
+	/*	Look at interrupt list. Find the one with highest priority.	*/
 	/*									*/
-	//BUG: enable pipelining in the future
-
+	for (p = S->intrQ->hd->next; p != S->intrQ->tl; p = p->next)
+	{
+		if ((intr == NULL) || (p->type > intr->type))
+		{
+			intr = p;
+		}
+	}
 
 	/*									*/
-	/*	Push the PC, which is the next instr after completed one,	*/
-	/*	onto the stack.	See Figure 2-7.					*/
+	/*	Interrupts are single source as far as the queue is		*/
+	/*	concerned: the entry is consumed here, and the multi-source	*/
+	/*	IFG bits are left for SW to reset.				*/
 	/*									*/
-	S->msp430->R[MSP430_SP] += 2;
-	S->MEM[S->msp430->R[MSP430_SP]] = S->msp430->R[MSP430_PC];
-
-
-	/*	Push SR on stack.	*/
-	S->msp430->R[MSP430_SP] += 2;
-	S->MEM[S->msp430->R[MSP430_SP]] = S->msp430->R[MSP430_SR];
+	intr->prev->next = intr->next;
+	intr->next->prev = intr->prev;
+	S->intrQ->nqintrs--;
 
 
 	/*									*/
-	/*	Look at interrupt list. Find the one with highest priority.	*/
+	/*	Push the PC, which is the next instr after completed one,	*/
+	/*	onto the stack.	See Figure 2-7.					*/
 	/*									*/
-	//???
+	S->msp430->R[MSP430_SP] -= 2;
+	msp430writeword(E, S, S->msp430->R[MSP430_SP], S->msp430->R[MSP430_PC]);
 
 
-	/*									*/
-	/*	If single source, clear flags, else leave them set and let 	*/
-	/*	SW reset them.							*/
-	/*									*/
-	//???
+	/*	Push SR on stack.	*/
+	S->msp430->R[MSP430_SP] -= 2;
+	msp430writeword(E, S, S->msp430->R[MSP430_SP], S->msp430->R[MSP430_SR]);
 
 
 	/*									*/
 	/*	Clear SR except for SCG0. Since GIE is cleared, intrs are	*/
-	/*	disabled.							*/
+	/*	disabled. This also clears CPUOFF, waking the CPU from any	*/
+	/*	low-power mode; the stacked SR restores it on RETI.		*/
 	/*									*/
 	S->msp430->R[MSP430_SR] &= 1 << 6;
 
@@ -704,10 +717,11 @@ dev430x1xxinterrupt(State *S, int priority)
 	/*	Load interrupt vector into PC. Vector depends on priority.	*/
 	/*	(See Table 2-1 on page 2.13 of slau049e.pdf)			*/
 	/*									*/
-	S->msp430->R[MSP430_PC] = 0xFFE0 + (priority << 1);
+	S->msp430->R[MSP430_PC] = msp430readword(E, S, 0xFFE0 + (intr->type << 1));
+	mfree(E, intr, "Interrupt *intr in dev430x1xxinterrupt()");
 
 
-	return;
+	return 0;
 }
 
 
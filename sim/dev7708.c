@@ -808,6 +808,7 @@ dev7708writelong(Engine *E, State *S, ulong addr, ulong data)
 			/*	clear the TF bit	*/
 			data &= ~(1<<2);
 			S->superH->MMUCR = data;
+			superHutlbinvalidate(S);
 
 			break;
 		}
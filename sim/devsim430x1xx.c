@@ -40,7 +40,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 {
 	int		latency = 0;
 	int		i, j, id;
-	ulong		offset, destbase, destoffset, paddr = addr;
+	ulong		offset, destoffset, paddr = addr;
 	State		*D;
 	Numa		*X = NULL;
 
@@ -62,7 +62,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->msp430->R[MSP430_R4],
 		addr, S->Nstack, 0, S->Nstack->count);
 
 	/*								*/
@@ -124,7 +124,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 				ulong	*tmp;
 
 				X->regions[i]->nvalues *= 2;
-				tmp = (ulong *)mrealloc(X->regions[i]->values,
+				tmp = (ulong *)mrealloc(E, X->regions[i]->values,
 					X->regions[i]->nvalues*sizeof(ulong),
 					"realloc C->regions[i]->values in cache.c");
 				if (tmp == NULL)
@@ -150,7 +150,6 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 			}
 
 			D		= E->sp[id];
-			destbase	= D->MEMBASE;
 			offset		= addr - S->MEMBASE;
 			destoffset	= offset + X->regions[i]->map_offset;
 
@@ -176,7 +175,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 				S->msp430->B->mdb16 = data;
 			}
 
-			S->stallaction(S, paddr, MEM_WRITE_STALL, latency);
+			S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 			return;
 		}
@@ -195,7 +194,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 		/*	devport. If addr not found in devport, try	*/
 		/*	arch-specific dev if not, fail with sfatal.	*/
 		/*							*/
-		S->devwritebyte(S, addr, data);
+		S->devwritebyte(E, S, addr, data);
 
 		return;
 	}
@@ -213,7 +212,7 @@ msp430writebyte(Engine *E, State *S, ushort addr, uchar data)
 	}
 
 	S->MEM[paddr - S->MEMBASE] = data;
-	S->stallaction(S, paddr, MEM_WRITE_STALL, latency);
+	S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 
 	return;
@@ -225,7 +224,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 {
 	int		latency = 0;
 	int		i, id, j;
-	ulong		offset, destoffset = 0, destbase, paddr = addr;
+	ulong		offset, destoffset = 0, paddr = addr;
 	State		*D;
 	Numa		*X = NULL;
 
@@ -247,7 +246,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->msp430->R[MSP430_R4],
 		addr, S->Nstack, 0, S->Nstack->count);
 
 	/*								*/
@@ -302,7 +301,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 			/*	For value tracing, if access is bigger than the		*/
 			/*	underlying data, mask off excess.			*/
 			/*								*/
-			ulong	mask = ~0UL;
+			ulong	mask = ~(ulong)0;
 			int	size = X->regions[i]->endaddr - X->regions[i]->startaddr;
 			if (size < 4)
 			{
@@ -320,7 +319,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 				ulong	*tmp;
 
 				X->regions[i]->nvalues *= 2;
-				tmp = (ulong *)mrealloc(X->regions[i]->values,
+				tmp = (ulong *)mrealloc(E, X->regions[i]->values,
 					X->regions[i]->nvalues*sizeof(ulong),
 					"realloc C->regions[i]->values in cache.c");
 				if (tmp == NULL)
@@ -346,7 +345,6 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 			}
 
 			D		= E->sp[id];
-			destbase	= D->MEMBASE;
 			offset		= addr - S->MEMBASE;
 			destoffset	= offset + X->regions[i]->map_offset;
 
@@ -377,7 +375,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 				S->msp430->B->paddr_bus = paddr;
 			}
 
-			S->stallaction(S, paddr, MEM_WRITE_STALL, latency);
+			S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 			return;
 		}
@@ -397,7 +395,7 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 		/*	devport. If addr not found in devport, try	*/
 		/*	arch-specific dev if not, fail with sfatal.	*/
 		/*							*/
-		S->devwriteword(S, addr, data);
+		S->devwriteword(E, S, addr, data);
 
 		return;
 	}
@@ -414,9 +412,10 @@ msp430writeword(Engine *E, State *S, ushort addr, ushort data)
 		S->msp430->B->paddr_bus = paddr;
 	}
 
-	S->MEM[paddr - S->MEMBASE] = (uchar)((data>>8)&0xFF);
-	S->MEM[paddr+1 - S->MEMBASE] = (uchar)data&0xFF;
-	S->stallaction(S, paddr, MEM_WRITE_STALL, latency);
+	/*	MSP430 is little-endian	*/
+	S->MEM[paddr - S->MEMBASE] = (uchar)data&0xFF;
+	S->MEM[paddr+1 - S->MEMBASE] = (uchar)((data>>8)&0xFF);
+	S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 	return;
 }
@@ -431,7 +430,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 {
 	int		latency = 0;
 	int		i, id, j;
-	ulong		offset, destoffset = 0, destbase, paddr = addr;
+	ulong		offset, destoffset = 0, paddr = addr;
 	uchar		data = 0;
 	State		*D;
 	Numa		*X = NULL;
@@ -454,7 +453,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->msp430->R[MSP430_R4],
 		addr, S->Nstack, 0, S->Nstack->count);
 
 	/*								*/
@@ -507,7 +506,6 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 			}
 
 			D		= E->sp[id];
-			destbase	= D->MEMBASE;
 			offset		= addr - S->MEMBASE;
 			destoffset	= offset + X->regions[i]->map_offset;
 
@@ -547,7 +545,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 					ulong	*tmp;
 
 					X->regions[i]->nvalues *= 2;
-					tmp = (ulong *)mrealloc(X->regions[i]->values,
+					tmp = (ulong *)mrealloc(E, X->regions[i]->values,
 						X->regions[i]->nvalues*sizeof(ulong), 
 						"realloc C->regions[i]->values in cache.c");
 					if (tmp == NULL)
@@ -573,7 +571,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 				S->msp430->B->paddr_bus = paddr;
 			}
 
-			S->stallaction(S, paddr, MEM_READ_STALL, latency);
+			S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 			return data;
 		}
@@ -593,7 +591,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 		/*	devport. If addr not found in devport, try	*/
 		/*	arch-specific dev if not, fail with sfatal.	*/
 		/*							*/
-		return S->devreadbyte(S, addr);
+		return S->devreadbyte(E, S, addr);
 	}
 	
 	/*		Model # bits flipping due to this mem access	*/
@@ -608,7 +606,7 @@ msp430readbyte(Engine *E, State *S, ushort addr)
 		S->msp430->B->paddr_bus = paddr;
 	}
 	
-	S->stallaction(S, paddr, MEM_READ_STALL, latency);
+	S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 
 	return data;
@@ -619,7 +617,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 {
 	int		latency = 0;
 	int		i, id, j;
-	ulong		offset, destoffset = 0, destbase, paddr = addr;
+	ulong		offset, destoffset = 0, paddr = addr;
 	ushort		data = 0;
 	State		*D;
 	Numa		*X = NULL;
@@ -643,7 +641,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->msp430->R[MSP430_R4],
 		addr, S->Nstack, 0, S->Nstack->count);
 
 	/*								*/
@@ -696,7 +694,6 @@ msp430readword(Engine *E, State *S, ushort addr)
 			}
 
 			D		= E->sp[id];
-			destbase	= D->MEMBASE;
 			offset		= addr - S->MEMBASE;
 			destoffset	= offset + X->regions[i]->map_offset;
 
@@ -729,7 +726,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 				/*	For value tracing, if access is bigger than the		*/
 				/*	underlying data, mask off excess.			*/
 				/*								*/
-				ulong	mask = ~0UL;
+				ulong	mask = ~(ulong)0;
 				int	size = X->regions[i]->endaddr - X->regions[i]->startaddr;
 				if (size < 4)
 				{
@@ -747,7 +744,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 					ulong	*tmp;
 
 					X->regions[i]->nvalues *= 2;
-					tmp = (ulong *)mrealloc(X->regions[i]->values,
+					tmp = (ulong *)mrealloc(E, X->regions[i]->values,
 						X->regions[i]->nvalues*sizeof(ulong), 
 						"realloc C->regions[i]->values in cache.c");
 					if (tmp == NULL)
@@ -773,7 +770,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 				S->msp430->B->paddr_bus = paddr;
 			}
 
-			S->stallaction(S, paddr, MEM_READ_STALL, latency);
+			S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 			return data;
 		}
@@ -783,7 +780,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 1)) /* -1 for second byte */
 	{
 		latency = S->mem_r_latency;
-		data = (ushort)(S->MEM[paddr - S->MEMBASE]<<8)|S->MEM[paddr+1 - S->MEMBASE];
+		data = (ushort)(S->MEM[paddr+1 - S->MEMBASE]<<8)|S->MEM[paddr - S->MEMBASE];
 	}
 	else
 	{
@@ -793,7 +790,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 		/*	devport. If addr not found in devport, try	*/
 		/*	arch-specific dev if not, fail with sfatal.	*/
 		/*							*/
-		return S->devreadword(S, addr);
+		return S->devreadword(E, S, addr);
 	}
 
 	/*		Model # bits flipping due to this mem access	*/
@@ -808,7 +805,7 @@ msp430readword(Engine *E, State *S, ushort addr)
 		S->msp430->B->paddr_bus = paddr;
 	}
 
-	S->stallaction(S, paddr, MEM_READ_STALL, latency);
+	S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 	return data;
 }
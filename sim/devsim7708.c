@@ -42,423 +42,178 @@
 #include "sf.h"
 #include "mextern.h"
 
-ulong
-devportreadlong(Engine *E, State *S, ulong addr)
-{
-	if (addr == SUPERH_THREADID)
-	{
-		return S->NODE_ID;
-	}
-	else if ((addr >= SUPERH_NUMAREGION_RDCNT_BEGIN) &&
-		(addr < SUPERH_NUMAREGION_RDCNT_END))
-	{
-		/*							*/
-		/*	CNT register addresses are longword-aligned,	*/
-		/*	so lower 2 bits of address are irrelevant, 	*/
-		/*	(should always be zero).			*/
-		/*							*/
-		int	which = ((addr - SUPERH_NUMAREGION_RDCNT_BEGIN) >> 2) & 0x3FFF;
-
-		if (which >= S->N->count)
-		{
-			mprint(E, S, nodeinfo,
-				"Longword access to address [0x" UHLONGFMT 
-				"] (NUMAREGION_RDCNT register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "which = %d\n", which);
-
-			sfatal(E, S, "Attempt to access NUMAREGION_RDCNT register "
-				"outside number of NUMAREGIONs");
-		}
-
-		return S->N->regions[which]->nreads;
-	}
-	else if ((addr >= SUPERH_NUMAREGION_WRCNT_BEGIN) &&
-		(addr < SUPERH_NUMAREGION_WRCNT_END))
-	{
-		/*							*/
-		/*	CNT register addresses are longword-aligned,	*/
-		/*	so lower 2 bits of address are irrelevant, 	*/
-		/*	(should always be zero).			*/
-		/*							*/
-		int	which = ((addr - SUPERH_NUMAREGION_WRCNT_BEGIN) >> 2) & 0x3FFF;
-
-		if (which >= S->N->count)
-		{
-			mprint(E, S, nodeinfo,
-				"Longword access to address [0x" UHLONGFMT 
-				"] (NUMAREGION_WRCNT register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "which = %d\n", which);
-
-			sfatal(E, S, "Attempt to access NUMAREGION_WRCNT register "
-				"outside number of NUMAREGIONs");
-		}
-
-		return S->N->regions[which]->nwrites;
-	}
-	else if (addr == SUPERH_NUMAREGION_COUNT)
-	{
-		return S->N->count;
-	}
-	else if (addr == SUPERH_BATTPERCENT)
-	{
-		return (int)ceil(100*((Batt*)S->BATT)->battery_remaining / ((Batt*)S->BATT)->battery_capacity);
-	}
-	else if ((addr >= SUPERH_SENSREAD_BEGIN) && (addr < SUPERH_SENSREAD_END))
-	{
-		int	which;
-		ulong	tmp;
-
-		//TODO: we should be doing it this way for NIC regs too, why aren't we ??
-		which = ((addr - SUPERH_SENSREAD_BEGIN) >> 4) & 0xFFF;
-		if (which >= MAX_NODE_SENSORS)
-		{
-			sfatal(E, S, "Attempt to access sensor register outside number of sensors");
-			return 0;
-		}
-		//fprintf(stderr, "sensor being read has value %f which = %d\n", S->sensors[which].reading, which);
-
-
-
-//	BUG: this currently works fine for host=macos, clientcpu=superH,
-//		but will not work when there is andiannes mismatch.
-//		what we should really do, is 
-//		(1) autodetect endiannes during compile and get rid
-//		of the SF_X_endian stuff or clean it up at least
-
-//		(2) maintain a var in sim of what host endian is,
-//			in the gloabl M structure
-
-//		(3) when endian diff, marshall the data into
-//		tmp sinstead of the simple memmove, along lines of
-//
-			
-//	       	((uchar *)&tmp)[3] = ((uchar *)&S->sensors[which].reading)[3];
-//        	((uchar *)&tmp)[2] = ((uchar *)&S->sensors[which].reading)[2];
-//        	((uchar *)&tmp)[1] = ((uchar *)&S->sensors[which].reading)[1];
-//        	((uchar *)&tmp)[0] = ((uchar *)&S->sensors[which].reading)[0];
-		
-//		etc
-
-		memmove(&tmp, &S->sensors[which].reading, sizeof(ulong));
-		
-		return tmp;
-	}
-
-	return S->devreadlong(E, S, addr);
-}
 
-ushort
-devportreadword(Engine *E, State *S, ulong addr)
+static ulong	threadidreadlong(Engine *E, State *S, ulong addr);
+static ulong	numardcntreadlong(Engine *E, State *S, ulong addr);
+static void	numardcntwritelong(Engine *E, State *S, ulong addr, ulong data);
+static ulong	numawrcntreadlong(Engine *E, State *S, ulong addr);
+static void	numawrcntwritelong(Engine *E, State *S, ulong addr, ulong data);
+static ulong	numacountreadlong(Engine *E, State *S, ulong addr);
+static ulong	battpercentreadlong(Engine *E, State *S, ulong addr);
+static ulong	sensreadreadlong(Engine *E, State *S, ulong addr);
+static void	senswritewritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	usecsreadbyte(Engine *E, State *S, ulong addr);
+static uchar	nicdstreadbyte(Engine *E, State *S, ulong addr);
+static void	nicdstwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicouireadbyte(Engine *E, State *S, ulong addr);
+static void	nicouiwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicncsensereadbyte(Engine *E, State *S, ulong addr);
+static uchar	niccsensereadbyte(Engine *E, State *S, ulong addr);
+static uchar	nicncollsreadbyte(Engine *E, State *S, ulong addr);
+static uchar	nicmaxfszreadbyte(Engine *E, State *S, ulong addr);
+static void	nicmaxfszwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicrxfszreadbyte(Engine *E, State *S, ulong addr);
+static void	nicrxfszwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicbrrreadbyte(Engine *E, State *S, ulong addr);
+static void	nicbrrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicnmrreadbyte(Engine *E, State *S, ulong addr);
+static void	nicnmrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicncrreadbyte(Engine *E, State *S, ulong addr);
+static void	nicncrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nictdrreadbyte(Engine *E, State *S, ulong addr);
+static void	nictdrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicnsrreadbyte(Engine *E, State *S, ulong addr);
+static void	nicnsrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	nicrdrreadbyte(Engine *E, State *S, ulong addr);
+static void	nicrdrwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	randreadbyte(Engine *E, State *S, ulong addr);
+static void	randwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	simcmddatareadbyte(Engine *E, State *S, ulong addr);
+static void	simcmddatawritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	simcmdctlreadbyte(Engine *E, State *S, ulong addr);
+static void	simcmdctlwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static void	simcmdexec(Engine *E, State *S);
+static void	orbitwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static void	velocitywritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	xlocreadbyte(Engine *E, State *S, ulong addr);
+static void	xlocwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	ylocreadbyte(Engine *E, State *S, ulong addr);
+static void	ylocwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	zlocreadbyte(Engine *E, State *S, ulong addr);
+static void	zlocwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static uchar	devlogprintreadbyte(Engine *E, State *S, ulong addr);
+static void	devlogprintwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static void	logmarkwritebyte(Engine *E, State *S, ulong addr, ulong data);
+static void	nettracemarkwritebyte(Engine *E, State *S, ulong addr, ulong data);
+
+/*									*/
+/*	The simulator-specific devices, registered into each node's	*/
+/*	memory map by devsimregister(). Access widths with no routine	*/
+/*	go on to the machine's S->devread* / S->devwrite*. Order is	*/
+/*	irrelevant since the ranges are disjoint.			*/
+/*									*/
+static Memregion devsimregions[] =
 {
-	mprint(E, S, nodeinfo, "Word access (read) at address 0x" UHLONGFMT "\n", addr);
-	sfatal(E, S, "Address not in main mem, and not in I/O space either !");
+	/*	name			kind			base				end							readbyte		readword	readlong		writebyte		writeword	writelong	*/
+	{"THREADID",		kSunflowerMemmapDevice,	SUPERH_THREADID,		SUPERH_THREADID+1,					NULL,			NULL,		threadidreadlong,	NULL,			NULL,		NULL},
+	{"NUMAREGION_RDCNT",	kSunflowerMemmapDevice,	SUPERH_NUMAREGION_RDCNT_BEGIN,	SUPERH_NUMAREGION_RDCNT_END,				NULL,			NULL,		numardcntreadlong,	NULL,			NULL,		numardcntwritelong},
+	{"NUMAREGION_WRCNT",	kSunflowerMemmapDevice,	SUPERH_NUMAREGION_WRCNT_BEGIN,	SUPERH_NUMAREGION_WRCNT_END,				NULL,			NULL,		numawrcntreadlong,	NULL,			NULL,		numawrcntwritelong},
+	{"NUMAREGION_COUNT",	kSunflowerMemmapDevice,	SUPERH_NUMAREGION_COUNT,	SUPERH_NUMAREGION_COUNT+1,				NULL,			NULL,		numacountreadlong,	NULL,			NULL,		NULL},
+	{"BATTPERCENT",		kSunflowerMemmapDevice,	SUPERH_BATTPERCENT,		SUPERH_BATTPERCENT+1,					NULL,			NULL,		battpercentreadlong,	NULL,			NULL,		NULL},
+	{"SENSREAD",		kSunflowerMemmapDevice,	SUPERH_SENSREAD_BEGIN,		SUPERH_SENSREAD_END,					NULL,			NULL,		sensreadreadlong,	NULL,			NULL,		NULL},
+	{"SENSWRITE",		kSunflowerMemmapDevice,	SUPERH_SENSWRITE_BEGIN,		SUPERH_SENSWRITE_END,					NULL,			NULL,		NULL,			senswritewritebyte,	NULL,		NULL},
+	{"USECS",		kSunflowerMemmapDevice,	SUPERH_USECS_BEGIN,		SUPERH_USECS_END,					usecsreadbyte,		NULL,		NULL,			NULL,			NULL,		NULL},
+	{"NIC_DST",		kSunflowerMemmapDevice,	SUPERH_NIC_DST,			SUPERH_NIC_DST+SUPERH_NIC_REG_SPACING,			nicdstreadbyte,		NULL,		NULL,			nicdstwritebyte,	NULL,		NULL},
+	{"NIC_OUI",		kSunflowerMemmapDevice,	SUPERH_NIC_OUI,			SUPERH_NIC_OUI+SUPERH_NIC_REG_SPACING,			nicouireadbyte,		NULL,		NULL,			nicouiwritebyte,	NULL,		NULL},
+	{"NIC_NCSENSE",		kSunflowerMemmapDevice,	SUPERH_NIC_NCSENSE,		SUPERH_NIC_NCSENSE+SUPERH_NIC_REG_SPACING,		nicncsensereadbyte,	NULL,		NULL,			NULL,			NULL,		NULL},
+	{"NIC_CSENSE",		kSunflowerMemmapDevice,	SUPERH_NIC_CSENSE,		SUPERH_NIC_CSENSE+SUPERH_NIC_REG_SPACING,		niccsensereadbyte,	NULL,		NULL,			NULL,			NULL,		NULL},
+	{"NIC_NCOLLS",		kSunflowerMemmapDevice,	SUPERH_NIC_NCOLLS,		SUPERH_NIC_NCOLLS+SUPERH_NIC_REG_SPACING,		nicncollsreadbyte,	NULL,		NULL,			NULL,			NULL,		NULL},
+	{"NIC_MAXFSZ",		kSunflowerMemmapDevice,	SUPERH_NIC_MAXFSZ,		SUPERH_NIC_MAXFSZ+SUPERH_NIC_REG_SPACING,		nicmaxfszreadbyte,	NULL,		NULL,			nicmaxfszwritebyte,	NULL,		NULL},
+	{"NIC_RXFSZ",		kSunflowerMemmapDevice,	SUPERH_NIC_RXFSZ,		SUPERH_NIC_RXFSZ+SUPERH_NIC_REG_SPACING,		nicrxfszreadbyte,	NULL,		NULL,			nicrxfszwritebyte,	NULL,		NULL},
+	{"NIC_BRR",		kSunflowerMemmapDevice,	SUPERH_NIC_BRR,			SUPERH_NIC_BRR+SUPERH_NIC_REG_SPACING,			nicbrrreadbyte,		NULL,		NULL,			nicbrrwritebyte,	NULL,		NULL},
+	{"NIC_NMR",		kSunflowerMemmapDevice,	SUPERH_NIC_NMR,			SUPERH_NIC_NMR+SUPERH_NIC_REG_SPACING,			nicnmrreadbyte,		NULL,		NULL,			nicnmrwritebyte,	NULL,		NULL},
+	{"NIC_NCR",		kSunflowerMemmapDevice,	SUPERH_NIC_NCR,			SUPERH_NIC_NCR+SUPERH_NIC_REG_SPACING,			nicncrreadbyte,		NULL,		NULL,			nicncrwritebyte,	NULL,		NULL},
+	{"NIC_TDR",		kSunflowerMemmapDevice,	SUPERH_NIC_TDR,			SUPERH_NIC_TDR+SUPERH_NIC_REG_SPACING,			nictdrreadbyte,		NULL,		NULL,			nictdrwritebyte,	NULL,		NULL},
+	{"NIC_NSR",		kSunflowerMemmapDevice,	SUPERH_NIC_NSR,			SUPERH_NIC_NSR+SUPERH_NIC_REG_SPACING,			nicnsrreadbyte,		NULL,		NULL,			nicnsrwritebyte,	NULL,		NULL},
+	{"NIC_RDR",		kSunflowerMemmapDevice,	SUPERH_NIC_RDR,			SUPERH_NIC_RDR+SUPERH_NIC_REG_SPACING,			nicrdrreadbyte,		NULL,		NULL,			nicrdrwritebyte,	NULL,		NULL},
+	{"RAND",		kSunflowerMemmapDevice,	SUPERH_RAND_BEGIN,		SUPERH_RAND_END,					randreadbyte,		NULL,		NULL,			randwritebyte,		NULL,		NULL},
+	{"SIMCMD_DATA",		kSunflowerMemmapDevice,	SUPERH_SIMCMD_DATA,		SUPERH_SIMCMD_DATA+1,					simcmddatareadbyte,	NULL,		NULL,			simcmddatawritebyte,	NULL,		NULL},
+	{"SIMCMD_CTL",		kSunflowerMemmapDevice,	SUPERH_SIMCMD_CTL,		SUPERH_SIMCMD_CTL+1,					simcmdctlreadbyte,	NULL,		NULL,			simcmdctlwritebyte,	NULL,		NULL},
+	{"ORBIT",		kSunflowerMemmapDevice,	SUPERH_ORBIT_BEGIN,		SUPERH_ORBIT_END,					NULL,			NULL,		NULL,			orbitwritebyte,		NULL,		NULL},
+	{"VELOCITY",		kSunflowerMemmapDevice,	SUPERH_VELOCITY_BEGIN,		SUPERH_VELOCITY_END,					NULL,			NULL,		NULL,			velocitywritebyte,	NULL,		NULL},
+	{"XLOC",		kSunflowerMemmapDevice,	SUPERH_XLOC_BEGIN,		SUPERH_XLOC_END,					xlocreadbyte,		NULL,		NULL,			xlocwritebyte,		NULL,		NULL},
+	{"YLOC",		kSunflowerMemmapDevice,	SUPERH_YLOC_BEGIN,		SUPERH_YLOC_END,					ylocreadbyte,		NULL,		NULL,			ylocwritebyte,		NULL,		NULL},
+	{"ZLOC",		kSunflowerMemmapDevice,	SUPERH_ZLOC_BEGIN,		SUPERH_ZLOC_END,					zlocreadbyte,		NULL,		NULL,			zlocwritebyte,		NULL,		NULL},
+	{"DEVLOGPRINT",		kSunflowerMemmapDevice,	SUPERH_DEVLOGPRINT,		SUPERH_DEVLOGPRINT+1,					devlogprintreadbyte,	NULL,		NULL,			devlogprintwritebyte,	NULL,		NULL},
+	{"LOGMARK",		kSunflowerMemmapDevice,	SUPERH_LOGMARK_BEGIN,		SUPERH_LOGMARK_END,					NULL,			NULL,		NULL,			logmarkwritebyte,	NULL,		NULL},
+	{"NETTRACEMARK",	kSunflowerMemmapDevice,	SUPERH_NETTRACEMARK_BEGIN,	SUPERH_NETTRACEMARK_END,				NULL,			NULL,		NULL,			nettracemarkwritebyte,	NULL,		NULL},
+};
 
-	return 0;
-}
 
-uchar
-devportreadbyte(Engine *E, State *S, ulong addr)
+void
+devsimregister(Engine *E, State *S)
 {
-	uchar	data = 0;
-
-
-	if ((addr >= SUPERH_USECS_BEGIN) && (addr < SUPERH_USECS_END))
-	{
-		int	offset;
-
-		offset = addr - SUPERH_USECS_BEGIN;
-		data = (uchar)((long)(S->TIME*1E6) >> (offset*8))&0xFF;
-	}
-	else if ((addr >= SUPERH_NIC_DST) && (addr < (SUPERH_NIC_DST+SUPERH_NIC_REG_SPACING)))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_DST register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		data = S->superH->NIC_IFCS[whichifc].IFC_DST[offset];
-	}
-	else if ((addr >= SUPERH_NIC_OUI) && (addr < (SUPERH_NIC_OUI+SUPERH_NIC_REG_SPACING)))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_OUI register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+	int	i;
 
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
 
-		data = S->superH->NIC_IFCS[whichifc].IFC_OUI[offset];
-	}
-	else if ((addr >= SUPERH_NIC_NCSENSE) && (addr < SUPERH_NIC_NCSENSE+SUPERH_NIC_REG_SPACING))
+	for (i = 0; i < sizeof(devsimregions)/sizeof(devsimregions[0]); i++)
 	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_NCSENSE register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		data = (uchar)(S->superH->NIC_IFCS[whichifc].IFC_CNTR_CSENSE_ERR >> (offset*8))&0xFF;
+		mmemmapregister(E, S, &devsimregions[i]);
 	}
-	else if ((addr >= SUPERH_NIC_CSENSE) && (addr < SUPERH_NIC_CSENSE+SUPERH_NIC_REG_SPACING))
-	{
-		int		i, whichifc = (addr >> 4) & 0xFFF;
-		Netsegment	*curseg;
-
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_NCSENSE register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-		
-		curseg = &E->netsegs[S->superH->NIC_IFCS[whichifc].segno];
-		data = 0;
 
-		for (i = 0; i < curseg->cur_queue_width; i++)
-		{
-			//this is too ideal: we should return 1 only if the snr 
-			//if (curseg->segbufs[i].bits_left > 0)
-			//{
-			//	data = 1;
-			//}
-
-			if (check_snr(E, curseg, ((State *)curseg->segbufs[i].src_node), S) > curseg->minsnr)
-			{
-				data = 1;
-			}
-		}
-	}
-	else if ((addr >= SUPERH_NIC_NCOLLS) && (addr < SUPERH_NIC_NCOLLS+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
+	return;
+}
 
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_NCOLLS register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+ulong
+devportreadlong(Engine *E, State *S, ulong addr)
+{
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
+	ulong		data;
 
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
 
-		data = (uchar)(S->superH->NIC_IFCS[whichifc].IFC_CNTR_COLLS_ERR >> (offset*8))&0xFF;
-	}
-	else if ((addr >= SUPERH_NIC_MAXFSZ) && (addr < SUPERH_NIC_MAXFSZ+SUPERH_NIC_REG_SPACING))
+	if (R != NULL && R->readlong != NULL)
 	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_FSZ register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		data = (uchar)((int)S->superH->NIC_IFCS[whichifc].frame_bits/8 >> (offset*8))&0xFF;
+		data = R->readlong(E, S, addr);
 	}
-	else if ((addr >= SUPERH_NIC_RXFSZ) && (addr < SUPERH_NIC_RXFSZ+SUPERH_NIC_REG_SPACING))
+	else
 	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-		Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_FSZ register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		/*								*/
-		/*	If theres nothing in the localbuf, then the next	*/
-		/*	framesize is the one at oldestidx, since rx_localbuf	*/
-		/*	and rx_localbuf_framesize don't get set until you	*/
-		/*	start reading from them.				*/
-		/*								*/
-		if (ifcptr->rx_localbuf_h2o == 0)
-		{
-//fprintf(stderr, "+++SUPERH_NIC_RXFSZ = %d\n", ifcptr->rx_fifo_framesizes[ifcptr->rx_fifo_oldestidx]);
-			data = (uchar)(ifcptr->rx_fifo_framesizes[ifcptr->rx_fifo_oldestidx] >> (offset*8))&0xFF;
-		}
-		else
-		{
-//fprintf(stderr, "---SUPERH_NIC_RXFSZ = %d\n", ifcptr->rx_localbuf_framesize);
-			data = (uchar)(ifcptr->rx_localbuf_framesize >> (offset*8))&0xFF;
-		}
+		data = S->devreadlong(E, S, addr);
 	}
+	simprofend(E, kSimprofDevport, t0);
 
-	else if ((addr >= SUPERH_NIC_BRR) && (addr < SUPERH_NIC_BRR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_BRR register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
-
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		/*	NIC_BRR contains network speed in Kb/s		*/
-		data = (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_BRR >> (offset*8))&0xFF;
-	}
-	else if ((addr >= SUPERH_NIC_NMR) && (addr < SUPERH_NIC_NMR+SUPERH_NIC_REG_SPACING))
-	{
-		sfatal(E, S, "You should not be reading NIC_NMR !?");
-	}
-	else if ((addr >= SUPERH_NIC_NCR) && (addr < SUPERH_NIC_NCR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
+	return data;
+}
 
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_NCR register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+ushort
+devportreadword(Engine *E, State *S, ulong addr)
+{
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
+	ushort		data;
 
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
 
-		data = (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_NCR >> (offset*8))&0xFF;
-	}
-	else if ((addr >= SUPERH_NIC_TDR) && (addr < SUPERH_NIC_TDR+SUPERH_NIC_REG_SPACING))
+	if (R != NULL && R->readword != NULL)
 	{
-		sfatal(E, S, "You should not be reading NIC_TDR !?");
-	}
-	else if ((addr >= SUPERH_NIC_NSR) && (addr < SUPERH_NIC_NSR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_NSR register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+		data = R->readword(E, S, addr);
+		simprofend(E, kSimprofDevport, t0);
 
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
-
-		data = (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_NSR >> (offset*8))&0xFF;
+		return data;
 	}
-	else if ((addr >= SUPERH_NIC_RDR) && (addr < SUPERH_NIC_RDR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			mprint(E, S, nodeinfo,
-				"Byte access to address [0x" UHLONGFMT "] (NIC_RDR register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
 
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-		}
+	mprint(E, S, nodeinfo, "Word access (read) at address 0x" UHLONGFMT "\n", addr);
+	sfatal(E, S, "Address not in main mem, and not in I/O space either !");
 
-		data = nic_rx_dequeue(E, S, whichifc);
-//fprintf(stderr, "RDR returning [%d]\n", data);
-	}
-	else if ((addr >= SUPERH_RAND_BEGIN) && (addr < SUPERH_RAND_END))
-	{
-		/*							*/
-		/*	We actually craft the 32-bit rand out of 4 	*/
-		/*	successive rand bytes.				*/
-		/*							*/
-		ulong	rnd;
-		int	offset;
+	return 0;
+}
 
+uchar
+devportreadbyte(Engine *E, State *S, ulong addr)
+{
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
+	uchar		data = 0;
 
-		offset = addr - SUPERH_RAND_BEGIN;
-		rnd = (ulong)mrandom(E);
-			
-		data = (uchar)(rnd >> (offset*8))&0xFF;
-	}
-	else if (addr == SUPERH_SIMCMD_DATA)
-	{
-		sfatal(E, S, "You should not be reading SIMCMD_DATA !?");
-	}
-	else if (addr == SUPERH_SIMCMD_CTL)
-	{
-		sfatal(E, S, "You should not be reading SIMCMD_CTL !?");
-	}
-	else if ((addr >= SUPERH_XLOC_BEGIN) && (addr < SUPERH_XLOC_END))
-	{
-		int	offset;
-		uvlong	tmp;
 
-		memmove(&tmp, &S->xloc, sizeof(uvlong));
-		offset = addr - SUPERH_XLOC_BEGIN;
-		data = (uchar)(tmp >> (offset*8))&0xFF;
-//fprintf(stderr, "S->xloc = [%f], offset=[%d], XLOC returning [%d]\n", S->xloc, offset, data);
-	}
-	else if ((addr >= SUPERH_YLOC_BEGIN) && (addr < SUPERH_YLOC_END))
+	if (R == NULL || R->readbyte == NULL)
 	{
-		int	offset;
-		uvlong	tmp;
+		data = S->devreadbyte(E, S, addr);
+		simprofend(E, kSimprofDevport, t0);
 
-		memmove(&tmp, &S->yloc, sizeof(uvlong));
-		offset = addr - SUPERH_YLOC_BEGIN;
-		data = (uchar)(tmp >> (offset*8))&0xFF;
+		return data;
 	}
-	else if ((addr >= SUPERH_ZLOC_BEGIN) && (addr < SUPERH_ZLOC_END))
-	{
-		int	offset;
-		uvlong	tmp;
 
-		memmove(&tmp, &S->zloc, sizeof(uvlong));
-		offset = addr - SUPERH_ZLOC_BEGIN;
-		data = (uchar)(tmp >> (offset*8))&0xFF;
-	}
-	else if (addr == SUPERH_DEVLOGPRINT)
-	{
-		sfatal(E, S, "You should not be reading DEVLOGPRINT !?");
-	}
-	else
-	{
-		return S->devreadbyte(E, S, addr);
-	}
+	data = R->readbyte(E, S, addr);
 
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -470,6 +225,7 @@ devportreadbyte(Engine *E, State *S, ulong addr)
 		S->Cycletrans += bit_flips_32(S->superH->B->peraddr_bus, addr);
 		S->superH->B->peraddr_bus = addr;
 	}
+	simprofend(E, kSimprofDevport, t0);
 
 	return data;
 }
@@ -478,57 +234,14 @@ devportreadbyte(Engine *E, State *S, ulong addr)
 void
 devportwritelong(Engine *E, State *S, ulong addr, ulong data)
 {
-	
-	if ((addr >= SUPERH_NUMAREGION_RDCNT_BEGIN) &&
-		(addr < SUPERH_NUMAREGION_RDCNT_END))
-	{
-		/*							*/
-		/*	CNT register addresses are longword-aligned,	*/
-		/*	so lower 2 bits of address are irrelevant, 	*/
-		/*	(should always be zero).			*/
-		/*							*/
-		int	which = ((addr - SUPERH_NUMAREGION_RDCNT_BEGIN) >> 2) & 0x3FFF;
-
-		if (which >= S->N->count)
-		{
-			mprint(E, S, nodeinfo,
-				"Longword access to address [0x" UHLONGFMT 
-				"] (NUMAREGION_RDCNT register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "which = %d\n", which);
-
-			sfatal(E, S, "Attempt to access NUMAREGION_RDCNT register "
-				"outside number of NUMAREGIONs");
-		}
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
 
-		S->N->regions[which]->nreads = data;
 
-		return;
-	}
-	
-	if ((addr >= SUPERH_NUMAREGION_WRCNT_BEGIN) &&
-		(addr < SUPERH_NUMAREGION_WRCNT_END))
+	if (R != NULL && R->writelong != NULL)
 	{
-		/*							*/
-		/*	CNT register addresses are longword-aligned,	*/
-		/*	so lower 2 bits of address are irrelevant, 	*/
-		/*	(should always be zero).			*/
-		/*							*/
-		int	which = ((addr - SUPERH_NUMAREGION_WRCNT_BEGIN) >> 2) & 0x3FFF;
-
-		if (which >= S->N->count)
-		{
-			mprint(E, S, nodeinfo,
-				"Longword access to address [0x" UHLONGFMT 
-				"] (NUMAREGION_WRCNT register)\n",
-				addr);
-			mprint(E, S, nodeinfo, "which = %d\n", which);
-
-			sfatal(E, S, "Attempt to access NUMAREGION_WRCNT register "
-				"outside number of NUMAREGIONs");
-		}
-
-		S->N->regions[which]->nwrites = data;
+		R->writelong(E, S, addr, data);
+		simprofend(E, kSimprofDevport, t0);
 
 		return;
 	}
@@ -550,6 +263,7 @@ devportwritelong(Engine *E, State *S, ulong addr, ulong data)
 	}
 
 	S->devwritelong(E, S, addr, data);
+	simprofend(E, kSimprofDevport, t0);
 
 	return;
 }
@@ -557,6 +271,10 @@ devportwritelong(Engine *E, State *S, ulong addr, ulong data)
 void
 devportwriteword(Engine *E, State *S, ulong addr, ushort data)
 {
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
+
+
 	if (SF_BITFLIP_ANALYSIS)
 	{
 		/*	Peripheral Data Bus	*/
@@ -567,7 +285,17 @@ devportwriteword(Engine *E, State *S, ulong addr, ushort data)
 		S->Cycletrans += bit_flips_32(S->superH->B->peraddr_bus, addr);
 		S->superH->B->peraddr_bus = addr;
 	}
+
+	if (R != NULL && R->writeword != NULL)
+	{
+		R->writeword(E, S, addr, (ulong)data);
+		simprofend(E, kSimprofDevport, t0);
+
+		return;
+	}
+
 	S->devwriteword(E, S, addr, data);
+	simprofend(E, kSimprofDevport, t0);
 
 	return;
 }
@@ -575,6 +303,10 @@ devportwriteword(Engine *E, State *S, ulong addr, ushort data)
 void
 devportwritebyte(Engine *E, State *S, ulong addr, uchar data)
 {
+	uvlong		t0 = simprofbegin(E);
+	Memregion	*R = mmemmaplookup(S, addr);
+
+
 	if (SF_BITFLIP_ANALYSIS)
 	{
 		/*	Peripheral Data Bus	*/
@@ -586,312 +318,854 @@ devportwritebyte(Engine *E, State *S, ulong addr, uchar data)
 		S->superH->B->peraddr_bus = addr;
 	}
 
-	if ((addr >= SUPERH_NIC_OUI) && (addr < (SUPERH_NIC_OUI+SUPERH_NIC_REG_SPACING)))
+	if (R != NULL && R->writebyte != NULL)
 	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
-
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-			return;
-		}
+		R->writebyte(E, S, addr, (ulong)data);
+		simprofend(E, kSimprofDevport, t0);
 
-		S->superH->NIC_IFCS[whichifc].IFC_OUI[offset] = data;
+		return;
 	}
-	else if ((addr >= SUPERH_NIC_DST) && (addr < (SUPERH_NIC_DST+SUPERH_NIC_REG_SPACING)))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
-		int	offset = addr & 0xF;
 
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-			return;
-		}
+	S->devwritebyte(E, S, addr, data);
+	simprofend(E, kSimprofDevport, t0);
 
-		S->superH->NIC_IFCS[whichifc].IFC_DST[offset] = data;
-	}
-	else if ((addr >= SUPERH_NIC_NMR) && (addr < SUPERH_NIC_NMR+SUPERH_NIC_REG_SPACING))
+	return;
+}
+
+
+static ulong
+threadidreadlong(Engine *E, State *S, ulong addr)
+{
+	return S->NODE_ID;
+}
+
+static ulong
+numardcntreadlong(Engine *E, State *S, ulong addr)
+{
+	/*							*/
+	/*	CNT register addresses are longword-aligned,	*/
+	/*	so lower 2 bits of address are irrelevant, 	*/
+	/*	(should always be zero).			*/
+	/*							*/
+	int	which = ((addr - SUPERH_NUMAREGION_RDCNT_BEGIN) >> 2) & 0x3FFF;
+
+	if (which >= S->N->count)
 	{
-		sfatal(E, S, "Use of NIC_NMR deprecated. Update your application!!");
+		mprint(E, S, nodeinfo,
+			"Longword access to address [0x" UHLONGFMT 
+			"] (NUMAREGION_RDCNT register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "which = %d\n", which);
+
+		sfatal(E, S, "Attempt to access NUMAREGION_RDCNT register "
+			"outside number of NUMAREGIONs");
 	}
-	else if ((addr >= SUPERH_NIC_BRR) && (addr < SUPERH_NIC_BRR+SUPERH_NIC_REG_SPACING))
+
+	return S->N->regions[which]->nreads;
+}
+
+static void
+numardcntwritelong(Engine *E, State *S, ulong addr, ulong data)
+{
+	/*							*/
+	/*	CNT register addresses are longword-aligned,	*/
+	/*	so lower 2 bits of address are irrelevant, 	*/
+	/*	(should always be zero).			*/
+	/*							*/
+	int	which = ((addr - SUPERH_NUMAREGION_RDCNT_BEGIN) >> 2) & 0x3FFF;
+
+	if (which >= S->N->count)
 	{
-		sfatal(E, S, "Write to NIC_BRR ignored. What are you trying to do ?!");
+		mprint(E, S, nodeinfo,
+			"Longword access to address [0x" UHLONGFMT 
+			"] (NUMAREGION_RDCNT register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "which = %d\n", which);
+
+		sfatal(E, S, "Attempt to access NUMAREGION_RDCNT register "
+			"outside number of NUMAREGIONs");
 	}
-	else if ((addr >= SUPERH_NIC_NCR) && (addr < SUPERH_NIC_NCR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
 
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-			return;
-		}
+	S->N->regions[which]->nreads = data;
 
-/*
-		if (!(data & (1 << 0)))
-		{
-			mprint(E, S, nodeinfo,
-				"Dequeing and clearing all interrupts on IFC [%d]\n",
-				whichifc);
-			sfatal(E, S, "Are you sure thats what you wanted to do ?");
-
-			pic_intr_clear(S, NIC_RXOK_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_TXOK_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_ADDRERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_FRAMEERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_COLLSERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_CSENSEERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_RXOVRRUNERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_RXUNDRRUNERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_TXOVRRUNERR_INTR, whichifc, 1);
-			pic_intr_clear(S, NIC_TXUNDRRUNERR_INTR, whichifc, 1);
-		}
-*/
+	return;
+}
 
-		switch (data)
-		{
-			case NIC_CMD_POWERUP:
-			{
-//fprintf(stderr, "## powering UP interface for node %d\n", S->NODE_ID);
+static ulong
+numawrcntreadlong(Engine *E, State *S, ulong addr)
+{
+	/*							*/
+	/*	CNT register addresses are longword-aligned,	*/
+	/*	so lower 2 bits of address are irrelevant, 	*/
+	/*	(should always be zero).			*/
+	/*							*/
+	int	which = ((addr - SUPERH_NUMAREGION_WRCNT_BEGIN) >> 2) & 0x3FFF;
+
+	if (which >= S->N->count)
+	{
+		mprint(E, S, nodeinfo,
+			"Longword access to address [0x" UHLONGFMT 
+			"] (NUMAREGION_WRCNT register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "which = %d\n", which);
+
+		sfatal(E, S, "Attempt to access NUMAREGION_WRCNT register "
+			"outside number of NUMAREGIONs");
+	}
 
-				S->superH->NIC_IFCS[whichifc].IFC_STATE = NIC_STATE_LISTEN;
+	return S->N->regions[which]->nwrites;
+}
 
-				break;
-			}
+static void
+numawrcntwritelong(Engine *E, State *S, ulong addr, ulong data)
+{
+	/*							*/
+	/*	CNT register addresses are longword-aligned,	*/
+	/*	so lower 2 bits of address are irrelevant, 	*/
+	/*	(should always be zero).			*/
+	/*							*/
+	int	which = ((addr - SUPERH_NUMAREGION_WRCNT_BEGIN) >> 2) & 0x3FFF;
+
+	if (which >= S->N->count)
+	{
+		mprint(E, S, nodeinfo,
+			"Longword access to address [0x" UHLONGFMT 
+			"] (NUMAREGION_WRCNT register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "which = %d\n", which);
+
+		sfatal(E, S, "Attempt to access NUMAREGION_WRCNT register "
+			"outside number of NUMAREGIONs");
+	}
 
-			case NIC_CMD_POWERDN:
-			{
-//fprintf(stderr, "## powering DOWN interface for node %d\n", S->NODE_ID);
+	S->N->regions[which]->nwrites = data;
 
-				S->superH->NIC_IFCS[whichifc].IFC_STATE = NIC_STATE_IDLE;
+	return;
+}
 
-				break;
-			}
-	
-			case NIC_CMD_TRANSMIT:
-			{
-				Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
+static ulong
+numacountreadlong(Engine *E, State *S, ulong addr)
+{
+	return S->N->count;
+}
 
-//fprintf(stderr, "## triggering TRANSMIT interface for node %d\n", S->NODE_ID);
+static ulong
+battpercentreadlong(Engine *E, State *S, ulong addr)
+{
+	return (int)ceil(100*((Batt*)S->BATT)->battery_remaining / ((Batt*)S->BATT)->battery_capacity);
+}
 
-				ifcptr->tx_fifo_framesizes[ifcptr->tx_fifo_curidx] = ifcptr->tx_fifo_h2o;
-				fifo_enqueue(E, S, TX_FIFO, whichifc);
-				ifcptr->tx_fifo_h2o = 0;
+static ulong
+sensreadreadlong(Engine *E, State *S, ulong addr)
+{
+	int	which;
+	ulong	tmp;
 
-				break;
-			}
+	//TODO: we should be doing it this way for NIC regs too, why aren't we ??
+	which = ((addr - SUPERH_SENSREAD_BEGIN) >> 4) & 0xFFF;
+	if (which >= MAX_NODE_SENSORS)
+	{
+		sfatal(E, S, "Attempt to access sensor register outside number of sensors");
+		return 0;
+	}
+	//fprintf(stderr, "sensor being read has value %f which = %d\n", S->sensors[which].reading, which);
 
-			default:
-			{
-				sfatal(E, S, "Invalid command in NIC_NCR");
-			}
-		}
 
-		S->superH->NIC_IFCS[whichifc].IFC_NCR = data & 0xff;
-	}
-	else if ((addr >= SUPERH_NIC_TDR) && (addr < SUPERH_NIC_TDR+SUPERH_NIC_REG_SPACING))
-	{
-		int	whichifc = (addr >> 4) & 0xFFF;
 
-		if (whichifc >= NIC_MAX_IFCS)
-		{
-			sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
-			return;
-		}
+//	BUG: this currently works fine for host=macos, clientcpu=superH,
+//		but will not work when there is andiannes mismatch.
+//		what we should really do, is 
+//		(1) autodetect endiannes during compile and get rid
+//		of the SF_X_endian stuff or clean it up at least
 
-		nic_tx_enqueue(E, S, data, whichifc);
-	}
-	else if ((addr >= SUPERH_NIC_NSR) && (addr < SUPERH_NIC_NSR+SUPERH_NIC_REG_SPACING))
-	{
-		sfatal(E, S, "You should not write into NSR");
-	}
-	else if ((addr >= SUPERH_NIC_RDR) && (addr < SUPERH_NIC_RDR+SUPERH_NIC_REG_SPACING))
+//		(2) maintain a var in sim of what host endian is,
+//			in the gloabl M structure
+
+//		(3) when endian diff, marshall the data into
+//		tmp sinstead of the simple memmove, along lines of
+//
+		
+//	       	((uchar *)&tmp)[3] = ((uchar *)&S->sensors[which].reading)[3];
+//        	((uchar *)&tmp)[2] = ((uchar *)&S->sensors[which].reading)[2];
+//        	((uchar *)&tmp)[1] = ((uchar *)&S->sensors[which].reading)[1];
+//        	((uchar *)&tmp)[0] = ((uchar *)&S->sensors[which].reading)[0];
+	
+//		etc
+
+	memmove(&tmp, &S->sensors[which].reading, sizeof(ulong));
+	
+	return tmp;
+}
+
+static void
+senswritewritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+/*
+	int	which, offset;
+	uvlong	tmp;
+
+	which = ((addr - SUPERH_SENSWRITE_BEGIN) >> 4) & 0xFFF;
+	if (which >= MAX_NODE_SENSORS)
 	{
-		sfatal(E, S, "You should not write into RDR");
+		sfatal(E, S, "Attempt to access sensor register outside number of sensors");
 	}
-	else if ((addr >= SUPERH_NIC_MAXFSZ) && (addr < SUPERH_NIC_MAXFSZ+SUPERH_NIC_REG_SPACING))
+
+	//	TODO:
+	//((uchar *)&S->actuators[which].reading+offset) = data;
+*/
+
+	return;
+}
+
+static uchar
+usecsreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	offset;
+
+	offset = addr - SUPERH_USECS_BEGIN;
+
+	/*	Include cycles the fast step has not yet added to TIME	*/
+	return (uchar)((long)((S->TIME + S->pendingcycles*S->CYCLETIME)*1E6) >> (offset*8))&0xFF;
+}
+
+static uchar
+nicdstreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into NIC_MAXFSZ");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_DST register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_NIC_RXFSZ) && (addr < SUPERH_NIC_RXFSZ+SUPERH_NIC_REG_SPACING))
+
+	return S->superH->NIC_IFCS[whichifc].IFC_DST[offset];
+}
+
+static void
+nicdstwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into NIC_RXFSZ");
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
+		return;
 	}
-	else if ((addr >= SUPERH_LOGMARK_BEGIN) &&
-		(addr < SUPERH_LOGMARK_END))
+
+	S->superH->NIC_IFCS[whichifc].IFC_DST[offset] = data;
+}
+
+static uchar
+nicouireadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		char	logtag[MAX_NAMELEN];
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_OUI register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
+	}
 
+	return S->superH->NIC_IFCS[whichifc].IFC_OUI[offset];
+}
 
-		/*							*/
-		/*	Single byte memory access is used to trigger	*/
-		/*	logging.  If read, we identify which log tag	*/
-		/*	The logs go into the global simulation logfile	*/
-		/*							*/
-		int	which = addr - SUPERH_LOGMARK_BEGIN;
+static void
+nicouiwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
 
-		msnprint(&logtag[0], MAX_NAMELEN, "NODE%d_LOGMARK_TAG_%d", S->NODE_ID, which);
-		m_dumpnode(E, S->NODE_ID, E->logfilename, M_OWRITE, logtag, "");
+	if (whichifc >= NIC_MAX_IFCS)
+	{
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
+		return;
 	}
-	else if ((addr >= SUPERH_NETTRACEMARK_BEGIN) &&
-		(addr < SUPERH_NETTRACEMARK_END))
+
+	S->superH->NIC_IFCS[whichifc].IFC_OUI[offset] = data;
+}
+
+static uchar
+nicncsensereadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		int		i, j;
-		char		logtag[MAX_NAMELEN];
-		Ifc		*ifcptr;
-		Netsegment	*Seg;
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_NCSENSE register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
 
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
+	}
 
-		/*							*/
-		/*	Single byte memory access is used to trigger	*/
-		/*	logging.  Note that there is a whole bank of	*/
-		/*	log trigger addresses per IFC.			*/
-		/*		If read, we identify which log tag	*/
-		/*	The log is replicated into ALL current net	*/
-		/*	trace log files.				*/
-		/*							*/
-		int	which = addr - SUPERH_NETTRACEMARK_BEGIN;
+	return (uchar)(S->superH->NIC_IFCS[whichifc].IFC_CNTR_CSENSE_ERR >> (offset*8))&0xFF;
+}
 
-		msnprint(&logtag[0], MAX_NAMELEN, "NODE%d_NETTRACEMARK_TAG_%d", S->NODE_ID, which);
+static uchar
+niccsensereadbyte(Engine *E, State *S, ulong addr)
+{
+	int		i, whichifc = (addr >> 4) & 0xFFF;
+	Netsegment	*curseg;
+	uchar		data;
 
-		for (i = 0; i < S->superH->NIC_NUM_IFCS; i++)
-		{
-			ifcptr = &S->superH->NIC_IFCS[i];
-			Seg = &E->netsegs[ifcptr->segno];
 
-			for (j = 0; j < Seg->num_seg2files; j++)
-			{
-				m_dumpnode(E, S->NODE_ID, Seg->seg2filenames[j], M_OWRITE, logtag, "--");
-			}
-		}
-	}
-	else if ((addr >= SUPERH_RAND_BEGIN) && (addr < SUPERH_RAND_END))
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into RAND");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_NCSENSE register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if (addr == SUPERH_SIMCMD_DATA)
+	
+	curseg = &E->netsegs[S->superH->NIC_IFCS[whichifc].segno];
+	data = 0;
+
+	for (i = 0; i < curseg->cur_queue_width; i++)
 	{
-		/*							*/
-		/*	Commands that are too long are truncated	*/
-		/*	and immediately executed			*/
-		/*							*/
-		S->cmdbuf[S->cmdbuf_nbytes++] = data;
-		if (S->cmdbuf_nbytes == MAX_CMD_LEN - 2)
+		//this is too ideal: we should return 1 only if the snr 
+		//if (curseg->segbufs[i].bits_left > 0)
+		//{
+		//	data = 1;
+		//}
+
+		if (check_snr(E, curseg, ((State *)curseg->segbufs[i].src_node), S) > curseg->minsnr)
 		{
-			State		*tmpstate = E->cp;
-			extern	int	sf_superh_parse(void);
-			extern	int	sf_riscv_parse(void);
-
-			S->cmdbuf[S->cmdbuf_nbytes++] = '\n';
-			S->cmdbuf[S->cmdbuf_nbytes++] = '\0';
-			munchinput(E, S->cmdbuf);
-			S->cmdbuf_nbytes = 0;
-
-			/*							*/
-			/*	Everything in sf.y is relative to the		*/
-			/*	current value of E->cp, so we have to 		*/
-			/*	do a little dance, for the people, and their 	*/
-			/*	cats, i guess, but then again, who cares ? 	*/
-			/*							*/
-			E->cp = S;
-			yyengine = E;
-			if (yyengine->cp->machinetype == MACHINE_SUPERH)
-			{
-				sf_superh_parse();
-			}
-			else if (yyengine->cp->machinetype == MACHINE_RISCV)
-			{
-				sf_riscv_parse();
-			}
-			E->cp = tmpstate;
+			data = 1;
 		}
 	}
-	else if (addr == SUPERH_SIMCMD_CTL)
-	{
-		State		*tmpstate = E->cp;
-		extern	int	sf_superh_parse(void);
-		extern	int	sf_riscv_parse(void);
 
+	return data;
+}
+
+static uchar
+nicncollsreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
 
-		/*								*/
-		/*	Safe because nbytes only incr'd when SIMCMD_DATA is	*/
-		/*	written to, and we do necessary checks there.		*/
-		/*								*/
-		S->cmdbuf[S->cmdbuf_nbytes++] = '\n';
-		S->cmdbuf[S->cmdbuf_nbytes++] = '\0';
-		munchinput(E, S->cmdbuf);
-		S->cmdbuf_nbytes = 0;
+	if (whichifc >= NIC_MAX_IFCS)
+	{
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_NCOLLS register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
 
-		/*							*/
-		/*	Everything in sf.y is relative to the		*/
-		/*	current value of E->cp, so we have to 		*/
-		/*	do a little dance, for the people, and their 	*/
-		/*	cats, i guess, but then again, who cares ? 	*/
-		/*							*/
-		E->cp = S;
-		yyengine = E;
-		if (yyengine->cp->machinetype == MACHINE_SUPERH)
-			{
-				sf_superh_parse();
-			}
-			else if (yyengine->cp->machinetype == MACHINE_RISCV)
-			{
-				sf_riscv_parse();
-			}
-		E->cp = tmpstate;
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_ORBIT_BEGIN) && (addr < SUPERH_ORBIT_END))
+
+	return (uchar)(S->superH->NIC_IFCS[whichifc].IFC_CNTR_COLLS_ERR >> (offset*8))&0xFF;
+}
+
+static uchar
+nicmaxfszreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into ORBIT data register");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_FSZ register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_VELOCITY_BEGIN) && (addr < SUPERH_VELOCITY_END))
+
+	return (uchar)((int)S->superH->NIC_IFCS[whichifc].frame_bits/8 >> (offset*8))&0xFF;
+}
+
+static void
+nicmaxfszwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into NIC_MAXFSZ");
+}
+
+static uchar
+nicrxfszreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+	Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into VELOCITY data register");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_FSZ register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_XLOC_BEGIN) && (addr < SUPERH_XLOC_END))
+
+	/*								*/
+	/*	If theres nothing in the localbuf, then the next	*/
+	/*	framesize is the one at oldestidx, since rx_localbuf	*/
+	/*	and rx_localbuf_framesize don't get set until you	*/
+	/*	start reading from them.				*/
+	/*								*/
+	if (ifcptr->rx_localbuf_h2o == 0)
 	{
-		sfatal(E, S, "You should not write into XLOC data register");
+//fprintf(stderr, "+++SUPERH_NIC_RXFSZ = %d\n", ifcptr->rx_fifo_framesizes[ifcptr->rx_fifo_oldestidx]);
+		return (uchar)(ifcptr->rx_fifo_framesizes[ifcptr->rx_fifo_oldestidx] >> (offset*8))&0xFF;
 	}
-	else if ((addr >= SUPERH_YLOC_BEGIN) && (addr < SUPERH_YLOC_END))
+
+//fprintf(stderr, "---SUPERH_NIC_RXFSZ = %d\n", ifcptr->rx_localbuf_framesize);
+	return (uchar)(ifcptr->rx_localbuf_framesize >> (offset*8))&0xFF;
+}
+
+static void
+nicrxfszwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into NIC_RXFSZ");
+}
+
+static uchar
+nicbrrreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into YLOC data register");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_BRR register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_ZLOC_BEGIN) && (addr < SUPERH_ZLOC_END))
+
+	/*	NIC_BRR contains network speed in Kb/s		*/
+	return (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_BRR >> (offset*8))&0xFF;
+}
+
+static void
+nicbrrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "Write to NIC_BRR ignored. What are you trying to do ?!");
+}
+
+static uchar
+nicnmrreadbyte(Engine *E, State *S, ulong addr)
+{
+	sfatal(E, S, "You should not be reading NIC_NMR !?");
+
+	return 0;
+}
+
+static void
+nicnmrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "Use of NIC_NMR deprecated. Update your application!!");
+}
+
+static uchar
+nicncrreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		sfatal(E, S, "You should not write into ZLOC data register");
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_NCR register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else if ((addr >= SUPERH_SENSWRITE_BEGIN) && (addr < SUPERH_SENSWRITE_END))
+
+	return (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_NCR >> (offset*8))&0xFF;
+}
+
+static void
+nicncrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
+		return;
+	}
+
 /*
-		int	which, offset;
-		uvlong	tmp;
+	if (!(data & (1 << 0)))
+	{
+		mprint(E, S, nodeinfo,
+			"Dequeing and clearing all interrupts on IFC [%d]\n",
+			whichifc);
+		sfatal(E, S, "Are you sure thats what you wanted to do ?");
+
+		pic_intr_clear(S, NIC_RXOK_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_TXOK_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_ADDRERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_FRAMEERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_COLLSERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_CSENSEERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_RXOVRRUNERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_RXUNDRRUNERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_TXOVRRUNERR_INTR, whichifc, 1);
+		pic_intr_clear(S, NIC_TXUNDRRUNERR_INTR, whichifc, 1);
+	}
+*/
 
-		which = ((addr - SUPERH_SENSWRITE_BEGIN) >> 4) & 0xFFF;
-		if (which >= MAX_NODE_SENSORS)
+	switch (data)
+	{
+		case NIC_CMD_POWERUP:
 		{
-			sfatal(E, S, "Attempt to access sensor register outside number of sensors");
+//fprintf(stderr, "## powering UP interface for node %d\n", S->NODE_ID);
+
+			S->superH->NIC_IFCS[whichifc].IFC_STATE = NIC_STATE_LISTEN;
+
+			break;
+		}
+
+		case NIC_CMD_POWERDN:
+		{
+//fprintf(stderr, "## powering DOWN interface for node %d\n", S->NODE_ID);
+
+			S->superH->NIC_IFCS[whichifc].IFC_STATE = NIC_STATE_IDLE;
+
+			break;
 		}
 
-		//	TODO:
-		//((uchar *)&S->actuators[which].reading+offset) = data;
+		case NIC_CMD_TRANSMIT:
+		{
+			Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
 
+//fprintf(stderr, "## triggering TRANSMIT interface for node %d\n", S->NODE_ID);
+
+			ifcptr->tx_fifo_framesizes[ifcptr->tx_fifo_curidx] = ifcptr->tx_fifo_h2o;
+			fifo_enqueue(E, S, TX_FIFO, whichifc);
+			ifcptr->tx_fifo_h2o = 0;
+
+			break;
+		}
+
+		default:
+		{
+			sfatal(E, S, "Invalid command in NIC_NCR");
+		}
+	}
+
+	S->superH->NIC_IFCS[whichifc].IFC_NCR = data & 0xff;
+}
+
+static uchar
+nictdrreadbyte(Engine *E, State *S, ulong addr)
+{
+	sfatal(E, S, "You should not be reading NIC_TDR !?");
+
+	return 0;
+}
+
+static void
+nictdrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+
+	if (whichifc >= NIC_MAX_IFCS)
+	{
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 		return;
-*/
 	}
-	else if (addr == SUPERH_DEVLOGPRINT)
+
+	nic_tx_enqueue(E, S, data, whichifc);
+}
+
+static uchar
+nicnsrreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+	int	offset = addr & 0xF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		if (SF_SIMLOG)
-		{
-			mlog(E, S, "%c", data);
-		}
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_NSR register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
-	else
+
+	return (uchar)((int)S->superH->NIC_IFCS[whichifc].IFC_NSR >> (offset*8))&0xFF;
+}
+
+static void
+nicnsrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into NSR");
+}
+
+static uchar
+nicrdrreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	whichifc = (addr >> 4) & 0xFFF;
+
+	if (whichifc >= NIC_MAX_IFCS)
 	{
-		S->devwritebyte(E, S, addr, data);
+		mprint(E, S, nodeinfo,
+			"Byte access to address [0x" UHLONGFMT "] (NIC_RDR register)\n",
+			addr);
+		mprint(E, S, nodeinfo, "whichifc = %d\n", whichifc);
+
+		sfatal(E, S, "Attempt to access IFC register outside number of IFCs");
 	}
 
-	return;
-}
\ No newline at end of file
+//fprintf(stderr, "RDR returning [%d]\n", data);
+	return nic_rx_dequeue(E, S, whichifc);
+}
+
+static void
+nicrdrwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into RDR");
+}
+
+static uchar
+randreadbyte(Engine *E, State *S, ulong addr)
+{
+	/*							*/
+	/*	We actually craft the 32-bit rand out of 4 	*/
+	/*	successive rand bytes.				*/
+	/*							*/
+	ulong	rnd;
+	int	offset;
+
+
+	offset = addr - SUPERH_RAND_BEGIN;
+	rnd = (ulong)mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeDevice]);
+		
+	return (uchar)(rnd >> (offset*8))&0xFF;
+}
+
+static void
+randwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into RAND");
+}
+
+static uchar
+simcmddatareadbyte(Engine *E, State *S, ulong addr)
+{
+	sfatal(E, S, "You should not be reading SIMCMD_DATA !?");
+
+	return 0;
+}
+
+static void
+simcmddatawritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	/*							*/
+	/*	Commands that are too long are truncated	*/
+	/*	and immediately executed			*/
+	/*							*/
+	S->cmdbuf[S->cmdbuf_nbytes++] = data;
+	if (S->cmdbuf_nbytes == MAX_CMD_LEN - 2)
+	{
+		simcmdexec(E, S);
+	}
+}
+
+static uchar
+simcmdctlreadbyte(Engine *E, State *S, ulong addr)
+{
+	sfatal(E, S, "You should not be reading SIMCMD_CTL !?");
+
+	return 0;
+}
+
+static void
+simcmdctlwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	/*								*/
+	/*	Safe because nbytes only incr'd when SIMCMD_DATA is	*/
+	/*	written to, and we do necessary checks there.		*/
+	/*								*/
+	simcmdexec(E, S);
+}
+
+static void
+simcmdexec(Engine *E, State *S)
+{
+	State		*tmpstate = E->cp;
+	extern	int	sf_superh_parse(void);
+	extern	int	sf_riscv_parse(void);
+
+
+	S->cmdbuf[S->cmdbuf_nbytes++] = '\n';
+	S->cmdbuf[S->cmdbuf_nbytes++] = '\0';
+	munchinput(E, S->cmdbuf);
+	S->cmdbuf_nbytes = 0;
+
+	/*							*/
+	/*	Everything in sf.y is relative to the		*/
+	/*	current value of E->cp, so we have to 		*/
+	/*	do a little dance, for the people, and their 	*/
+	/*	cats, i guess, but then again, who cares ? 	*/
+	/*							*/
+	E->cp = S;
+	yyengine = E;
+	if ((yyengine->cp->machinetype == MACHINE_SUPERH) || (yyengine->cp->machinetype == MACHINE_MSP430))
+	{
+		sf_superh_parse();
+	}
+	else if (yyengine->cp->machinetype == MACHINE_RISCV)
+	{
+		sf_riscv_parse();
+	}
+	E->cp = tmpstate;
+}
+
+static void
+orbitwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into ORBIT data register");
+}
+
+static void
+velocitywritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into VELOCITY data register");
+}
+
+static uchar
+xlocreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	offset;
+	uvlong	tmp;
+
+	memmove(&tmp, &S->xloc, sizeof(uvlong));
+	offset = addr - SUPERH_XLOC_BEGIN;
+//fprintf(stderr, "S->xloc = [%f], offset=[%d], XLOC returning [%d]\n", S->xloc, offset, data);
+
+	return (uchar)(tmp >> (offset*8))&0xFF;
+}
+
+static void
+xlocwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into XLOC data register");
+}
+
+static uchar
+ylocreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	offset;
+	uvlong	tmp;
+
+	memmove(&tmp, &S->yloc, sizeof(uvlong));
+	offset = addr - SUPERH_YLOC_BEGIN;
+
+	return (uchar)(tmp >> (offset*8))&0xFF;
+}
+
+static void
+ylocwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into YLOC data register");
+}
+
+static uchar
+zlocreadbyte(Engine *E, State *S, ulong addr)
+{
+	int	offset;
+	uvlong	tmp;
+
+	memmove(&tmp, &S->zloc, sizeof(uvlong));
+	offset = addr - SUPERH_ZLOC_BEGIN;
+
+	return (uchar)(tmp >> (offset*8))&0xFF;
+}
+
+static void
+zlocwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	sfatal(E, S, "You should not write into ZLOC data register");
+}
+
+static uchar
+devlogprintreadbyte(Engine *E, State *S, ulong addr)
+{
+	sfatal(E, S, "You should not be reading DEVLOGPRINT !?");
+
+	return 0;
+}
+
+static void
+devlogprintwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	if (SF_SIMLOG)
+	{
+		mlog(E, S, "%c", (uchar)data);
+	}
+}
+
+static void
+logmarkwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	char	logtag[MAX_NAMELEN];
+
+
+	/*							*/
+	/*	Single byte memory access is used to trigger	*/
+	/*	logging.  If read, we identify which log tag	*/
+	/*	The logs go into the global simulation logfile	*/
+	/*							*/
+	int	which = addr - SUPERH_LOGMARK_BEGIN;
+
+	msnprint(&logtag[0], MAX_NAMELEN, "NODE%d_LOGMARK_TAG_%d", S->NODE_ID, which);
+	m_dumpnode(E, S->NODE_ID, E->logfilename, M_OWRITE, logtag, "");
+}
+
+static void
+nettracemarkwritebyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	int		i, j;
+	char		logtag[MAX_NAMELEN];
+	Ifc		*ifcptr;
+	Netsegment	*Seg;
+
+
+	/*							*/
+	/*	Single byte memory access is used to trigger	*/
+	/*	logging.  Note that there is a whole bank of	*/
+	/*	log trigger addresses per IFC.			*/
+	/*		If read, we identify which log tag	*/
+	/*	The log is replicated into ALL current net	*/
+	/*	trace log files.				*/
+	/*							*/
+	int	which = addr - SUPERH_NETTRACEMARK_BEGIN;
+
+	msnprint(&logtag[0], MAX_NAMELEN, "NODE%d_NETTRACEMARK_TAG_%d", S->NODE_ID, which);
+
+	for (i = 0; i < S->superH->NIC_NUM_IFCS; i++)
+	{
+		ifcptr = &S->superH->NIC_IFCS[i];
+		Seg = &E->netsegs[ifcptr->segno];
+
+		for (j = 0; j < Seg->num_seg2files; j++)
+		{
+			m_dumpnode(E, S->NODE_ID, Seg->seg2filenames[j], M_OWRITE, logtag, "--");
+		}
+	}
+}
@@ -360,8 +360,14 @@ devsfopen(Chan *c, int omode)
 		case Qstdout:
 		case Qstderr:
 		case Qnetin:
+			break;
+
 		case Qnetout:
+		{
+			/*	Segment traffic is only rendered once someone reads it	*/
+			((Engine *)c->aux)->netiotap = 1;
 			break;
+		}
 	}
 
 	c->mode = openmode(omode);
@@ -433,8 +439,8 @@ devsfread(Chan *c, void *a, long n, vlong offset)
 				return 0;
 			}
 
-			nread = min(n, MAX_SEGBUF_TEXT);
-			memmove(a, &E->netiobuf[E->netioh2o - 1][0], nread);
+			nread = min(n, E->netiolen[E->netioh2o - 1]);
+			memmove(a, E->netiobuf[E->netioh2o - 1], nread);
 			E->netioh2o--;
 			mstateunlock();
 	
@@ -575,7 +581,7 @@ devsfwrite(Chan *c, void *a, long n, vlong offset)
 				munchinput(E, "\n");
 			}
 			yyengine = E;
-			if (yyengine->cp->machinetype == MACHINE_SUPERH)
+			if ((yyengine->cp->machinetype == MACHINE_SUPERH) || (yyengine->cp->machinetype == MACHINE_MSP430))
 			{
 				sf_superh_parse();
 			}
@@ -609,7 +615,7 @@ devsfwrite(Chan *c, void *a, long n, vlong offset)
 			//streamchk();
                         //print("before yyparse...\n");
 			yyengine = E;
-			if (yyengine->cp->machinetype == MACHINE_SUPERH)
+			if ((yyengine->cp->machinetype == MACHINE_SUPERH) || (yyengine->cp->machinetype == MACHINE_MSP430))
 			{
 				sf_superh_parse();
 			}
@@ -677,7 +683,7 @@ debugnetin(Segbuf *segbuf)
 	print("Data: ");
 	for (i = 0; i < segbuf->bits_left/8; i++)
 	{
-		print("%02X ", segbuf->data[i]);
+		print("%02X ", segbuf->netbuf->data[i]);
 		if (!((i+1) % 24))
 		{
 			print("\n");
@@ -763,7 +769,7 @@ packnodeinfo(Engine *E, State *S, char buf[])
 	ptr = &buf[strlen(buf)];
 
 	sprint(ptr, "%8s = %-1.2E\t%8s = %-1.2E\n",
-		"Tcpu", S->TIME,
+		"Tcpu", S->TIME + S->pendingcycles*S->CYCLETIME,
 		"ninstrs", (double)S->dyncnt);
 	ptr = &buf[strlen(buf)];
 
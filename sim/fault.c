@@ -42,19 +42,36 @@
 #include "sf.h"
 #include "mextern.h"
 
-static uvlong	pfunexp(void *, void *ptr, char *type, uvlong modulo);
-static uvlong	pfunrnd(void *, void *ptr, char *type, uvlong modulo);
-static tuck void	induceSEE(State *S);
+static uvlong	nodepfunexp(Engine *E, State *S, FaultDraw kind, uvlong modulo);
+static uvlong	nodepfunrnd(Engine *E, State *S, FaultDraw kind, uvlong modulo);
+static uvlong	netsegpfunexp(Engine *E, Netsegment *N, FaultDraw kind, uvlong modulo);
+static uvlong	netsegpfunrnd(Engine *E, Netsegment *N, FaultDraw kind, uvlong modulo);
+static tuck uvlong	faultgap(double prob, uvlong draw);
+static tuck void	faultschedule(Engine *E);
+static tuck void	induceSEE(Engine *E, State *S);
 
 
 void
 fault_feed(Engine *E)
 {
 	int			i, j;
+	uvlong			now, elapsed;
 	State			*S = NULL;
 	Netsegment		*N;
 
 
+	/*							*/
+	/*	Nothing is due until the earliest scheduled fault	*/
+	/*	or recovery, unless a node takes SEEs every feed.	*/
+	/*							*/
+	now = ++E->faultfeeds;
+	if ((now < E->faultnextfeed) && (E->nSEEnodes == 0))
+	{
+		return;
+	}
+	elapsed = now - E->faultlastfeed;
+	E->faultlastfeed = now;
+
 	/*				*/
 	/*	All device nodes:	*/
 	/*				*/
@@ -64,7 +81,7 @@ fault_feed(Engine *E)
 
 		if (S->SEEmodeling != NULL)
 		{
-			induceSEE(S);
+			induceSEE(E, S);
 		}
 
 		/*							*/
@@ -78,7 +95,7 @@ fault_feed(Engine *E)
 
 		if (!S->runnable && S->fail_clocks_left)
 		{
-			S->fail_clocks_left--;
+			S->fail_clocks_left -= min(elapsed, S->fail_clocks_left);
 			
 			if (!S->fail_clocks_left)
 			{
@@ -92,11 +109,24 @@ fault_feed(Engine *E)
 
 				/*	Can clear this now	*/
 				S->got_correlated_failure = 0;
+
+				/*	The first trial is at this feed		*/
+				S->faultnextfeed = kFaultUndrawn;
 			}
 		}
 
-		if ((S->runnable) && (S->pfun(E, S, "state", FAULT_PROB_MODULO) 
-			< (uvlong)(S->fail_prob*FAULT_PROB_MODULO)))
+		if (!S->runnable || (S->fail_prob == 0))
+		{
+			continue;
+		}
+
+		if (S->faultnextfeed == kFaultUndrawn)
+		{
+			S->faultnextfeed = now + faultgap(S->fail_prob,
+				S->pfun(E, S, kFaultDrawOccurrence, FAULT_PROB_MODULO));
+		}
+
+		if (S->faultnextfeed <= now)
 		{
 			mprint(E, S, nodeinfo,
 				"\n\nRandom Fault at node %d (S->fail_prob [%E]).\n",
@@ -109,11 +139,12 @@ fault_feed(Engine *E)
 			/*	that make sense and also because it simplifies	*/
 			/*	the handling above.				*/
 			/*							*/	
-			S->fail_clocks_left = S->pfun(E, S, "stateduration",
+			S->fail_clocks_left = S->pfun(E, S, kFaultDrawDuration,
 				S->failure_duration_max) + 1;
 			mprint(E, S, nodeinfo, "Set S->fail_clocks_left to [" UVLONGFMT "]\n\n",
 				S->fail_clocks_left);
 			S->runnable = 0;
+			S->faultnextfeed = kFaultUndrawn;
 		}
 	}
 
@@ -131,7 +162,7 @@ fault_feed(Engine *E)
 
 		if (!N->valid && N->fail_clocks_left)
 		{
-			N->fail_clocks_left--;
+			N->fail_clocks_left -= min(elapsed, N->fail_clocks_left);
 			
 			if (!N->fail_clocks_left)
 			{
@@ -139,11 +170,22 @@ fault_feed(Engine *E)
 					"\n\nNetseg %d recovered from random fault.\n\n",
 					N->NETSEG_ID);
 				N->valid = 1;
+				N->faultnextfeed = kFaultUndrawn;
 			}
 		}
 
-		if ((N->valid) && (N->pfun(E, N, "network", FAULT_PROB_MODULO) <
-			(uvlong)(N->fail_prob*FAULT_PROB_MODULO)))
+		if (!N->valid)
+		{
+			continue;
+		}
+
+		if (N->faultnextfeed == kFaultUndrawn)
+		{
+			N->faultnextfeed = now + faultgap(N->fail_prob,
+				N->pfun(E, N, kFaultDrawOccurrence, FAULT_PROB_MODULO));
+		}
+
+		if (N->faultnextfeed <= now)
 		{
 			mprint(E, S, nodeinfo,
 				"\n\nRandom Fault at network segment %d.\n\n",
@@ -154,9 +196,10 @@ fault_feed(Engine *E)
 			/*	that make sense and also because it simplifies	*/
 			/*	the handling above.				*/
 			/*							*/
-			N->fail_clocks_left = N->pfun(E, N, "networkduration",
+			N->fail_clocks_left = N->pfun(E, N, kFaultDrawDuration,
 				N->failure_duration_max) + 1;
 			N->valid = 0;
+			N->faultnextfeed = kFaultUndrawn;
 
 			/*							*/
 			/*	Correlation with node failure. Generate a 	*/
@@ -165,7 +208,7 @@ fault_feed(Engine *E)
 			/*							*/
 			for (j = 0; j < N->num_attached; j++)
 			{
-				if (N->pfun(E, N, "network", FAULT_PROB_MODULO) <
+				if (N->pfun(E, N, kFaultDrawOccurrence, FAULT_PROB_MODULO) <
 					(uvlong)(N->correl_coeffs[N->node_ids[j]]*
 					FAULT_PROB_MODULO))
 				{
@@ -180,56 +223,192 @@ fault_feed(Engine *E)
 					/*	partly that make sense and also b'cos	*/
 					/*	it simplifies the handling above	*/
 					/*						*/
-					S->fail_clocks_left = S->pfun(E, S, "stateduration",
+					S->fail_clocks_left = S->pfun(E, S, kFaultDrawDuration,
 						S->failure_duration_max) + 1;
 					mprint(E, S, nodeinfo,
 						"Set S->fail_clocks_left to [" UVLONGFMT "]\n\n",
 						S->fail_clocks_left);
 					S->runnable = 0;
 					S->got_correlated_failure = 1;
+					S->faultnextfeed = kFaultUndrawn;
 				}
 			}
 		}
 	}
 
+	faultschedule(E);
+
 
 	return;
 }
 
+/*									*/
+/*	Number of feeds, after the current one, before the next		*/
+/*	success of a Bernoulli trial with probability prob per feed,	*/
+/*	by inversion of the geometric distribution. 'draw' is		*/
+/*	uniform on [0, FAULT_PROB_MODULO].				*/
+/*									*/
+static tuck uvlong
+faultgap(double prob, uvlong draw)
+{
+	double	u, gap;
+
+
+	if (prob >= 1)
+	{
+		return 0;
+	}
+
+	u = (draw + 1.0) / (FAULT_PROB_MODULO + 1.0);
+	gap = floor(log(u) / log1p(-prob));
+	if (!(gap < (double)kFaultMaxGap))
+	{
+		return kFaultMaxGap;
+	}
+
+	return (uvlong)gap;
+}
+
+/*									*/
+/*	Find the earliest feed at which some node or netseg fails or	*/
+/*	recovers. Called only on feeds that did any work, so its cost	*/
+/*	is paid per fault rather than per feed. A node that is not	*/
+/*	runnable for some other reason than a fault, when its fault	*/
+/*	falls due, gets a fresh draw from the following feed.		*/
+/*									*/
+static tuck void
+faultschedule(Engine *E)
+{
+	int		i;
+	uvlong		now = E->faultfeeds, next = ~(uvlong)0;
+	State		*S;
+	Netsegment	*N;
+
+
+	for (i = 0; i < E->nnodes; i++)
+	{
+		S = E->sp[i];
+
+		if (!S->runnable && S->fail_clocks_left)
+		{
+			next = min(next, now + S->fail_clocks_left);
+		}
+		else if (S->fail_prob != 0)
+		{
+			if ((S->faultnextfeed == kFaultUndrawn) || (S->faultnextfeed <= now))
+			{
+				S->faultnextfeed = now + 1 + faultgap(S->fail_prob,
+					S->pfun(E, S, kFaultDrawOccurrence, FAULT_PROB_MODULO));
+			}
+			next = min(next, S->faultnextfeed);
+		}
+	}
+
+	for (i = 0; i < E->nactivensegs; i++)
+	{
+		N = &E->netsegs[E->activensegs[i]];
+
+		if (N->fail_prob == 0)
+		{
+			continue;
+		}
+
+		if (!N->valid && N->fail_clocks_left)
+		{
+			next = min(next, now + N->fail_clocks_left);
+		}
+		else if (N->valid)
+		{
+			if ((N->faultnextfeed == kFaultUndrawn) || (N->faultnextfeed <= now))
+			{
+				N->faultnextfeed = now + 1 + faultgap(N->fail_prob,
+					N->pfun(E, N, kFaultDrawOccurrence, FAULT_PROB_MODULO));
+			}
+			next = min(next, N->faultnextfeed);
+		}
+	}
+
+	E->faultnextfeed = next;
+}
+
+/*									*/
+/*	A new probability takes effect from the next feed: the pending	*/
+/*	draw is discarded, and the next feed reschedules everything.	*/
+/*									*/
+void
+fault_setnodefailprob(Engine *E, State *S, double prob)
+{
+	S->fail_prob = prob;
+	S->faultnextfeed = kFaultUndrawn;
+	E->faultnextfeed = 0;
+}
+
+void
+fault_setnetsegfailprob(Engine *E, Netsegment *tptr, double prob)
+{
+	tptr->fail_prob = prob;
+	tptr->faultnextfeed = kFaultUndrawn;
+	E->faultnextfeed = 0;
+}
+
+/*									*/
+/*	Failure draws for a node come from that node's own stream, and	*/
+/*	those for a netseg from the netseg's stream, so that whether	*/
+/*	one node fails does not depend on how many draws other nodes	*/
+/*	made before it.							*/
+/*									*/
 static uvlong
-pfunexp(void *e, void *ptr, char *type, uvlong modulo)
+nodepfunexp(Engine *E, State *S, FaultDraw kind, uvlong modulo)
 {
 	uvlong	tmp;
-	Engine	*E = (Engine *)e;
 
 	/*
 		Deprecated:
 			replaced with sensible implementation in development version
 			of simulator
 	*/
-	tmp = mrandom(E) % (modulo + 1);	
-	if (!strcmp(type, "state") && 
-		(tmp < (ulong)((State *)ptr)->fail_prob*FAULT_PROB_MODULO))
+	tmp = mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeFault]) % (modulo + 1);
+	if ((kind == kFaultDrawOccurrence) &&
+		(tmp < (ulong)S->fail_prob*FAULT_PROB_MODULO))
 	{
-		if (((State *)ptr)->fail_prob < 1)
-			((State *)ptr)->fail_prob *= M_E/2;
+		if (S->fail_prob < 1)
+			S->fail_prob *= M_E/2;
 	}
-	else if (!strcmp(type, "network") &&
-		(tmp < (ulong)((Netsegment *)ptr)->fail_prob*FAULT_PROB_MODULO))
+
+	return tmp;
+}
+
+static uvlong
+nodepfunrnd(Engine *E, State *S, FaultDraw kind, uvlong modulo)
+{
+	return (mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeFault]) % (modulo + 1));
+}
+
+static uvlong
+netsegpfunexp(Engine *E, Netsegment *N, FaultDraw kind, uvlong modulo)
+{
+	uvlong	tmp;
+
+	/*
+		Deprecated:
+			replaced with sensible implementation in development version
+			of simulator
+	*/
+	tmp = mrandstream(E, &N->randstream) % (modulo + 1);
+	if ((kind == kFaultDrawOccurrence) &&
+		(tmp < (ulong)N->fail_prob*FAULT_PROB_MODULO))
 	{
-		if (((Netsegment *)ptr)->fail_prob < 1)
-			((Netsegment *)ptr)->fail_prob *= M_E/2;
+		if (N->fail_prob < 1)
+			N->fail_prob *= M_E/2;
 	}
 
 	return tmp;
 }
 
 static uvlong
-pfunrnd(void *e, void *ptr, char *type, uvlong modulo)
+netsegpfunrnd(Engine *E, Netsegment *N, FaultDraw kind, uvlong modulo)
 {
-	Engine	*E = (Engine *)e;
-
-	return (mrandom(E) % (modulo + 1));
+	return (mrandstream(E, &N->randstream) % (modulo + 1));
 }
 
 
@@ -238,11 +417,11 @@ fault_setnodepfun(Engine *E, State *S, char *alg)
 {
 	if (!strcmp(alg, "exp"))
 	{
-		S->pfun = pfunexp;
+		S->pfun = nodepfunexp;
 	}
 	else if (!strcmp(alg, "urnd"))
 	{
-		S->pfun = pfunrnd;
+		S->pfun = nodepfunrnd;
 	}
 	else
 	{
@@ -257,11 +436,11 @@ fault_setnetsegpfun(Engine *E, Netsegment *tptr, char *alg)
 {
 	if (!strcmp(alg, "exp"))
 	{
-		tptr->pfun = pfunexp;
+		tptr->pfun = netsegpfunexp;
 	}
 	else if (!strcmp(alg, "urnd"))
 	{
-		tptr->pfun = pfunrnd;
+		tptr->pfun = netsegpfunrnd;
 	}
 	else
 	{
@@ -272,66 +451,77 @@ fault_setnetsegpfun(Engine *E, Netsegment *tptr, char *alg)
 }
 
 static tuck void
-induceSEE(State *S)
+induceSEE(Engine *E, State *S)
 {
-	int		which;
+	int		which, lo, hi, mid;
 	SEEstruct	*p;
+	SEEstate	*M = S->SEEmodeling;
 
 
-	/*	Get a random location in machine state		*/
-	which = S->SEEmodeling->loc_pfun(S,
-				0,					/*	min	*/
-				S->SEEmodeling->logical_bits - 1,	/*	max	*/
-				S->SEEmodeling->loc_pfun_p1,		/* Dist params:	*/
-				S->SEEmodeling->loc_pfun_p2,
-				S->SEEmodeling->loc_pfun_p3,
-				S->SEEmodeling->loc_pfun_p4);
+	if ((M->nstructs == 0) || (M->logical_bits <= 0))
+	{
+		return;
+	}
 
-	p = S->SEEmodeling->hd;
-	while (p != NULL)
+	/*							*/
+	/*	Get a random location in machine state. As for	*/
+	/*	faults, the draws come from the node's own SEE	*/
+	/*	stream, so they do not depend on other nodes.	*/
+	/*							*/
+	which = mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeSEE]) % M->logical_bits;
+
+	/*							*/
+	/*	Last structure whose logical_offset is <= which.	*/
+	/*	Structures with no logical bits share the offset of	*/
+	/*	the next one, which is the one picked.			*/
+	/*							*/
+	lo = 0;
+	hi = M->nstructs - 1;
+	while (lo < hi)
 	{
-		if (	(which >= p->logical_offset) &&
-			(which < (p->logical_offset + p->logical_bits)))
+		mid = (lo + hi + 1) / 2;
+		if (M->structs[mid]->logical_offset <= which)
+		{
+			lo = mid;
+		}
+		else
 		{
-			uchar	b;
-			ulong	mask;
-			int	offset;
+			hi = mid - 1;
+		}
+	}
+	p = M->structs[lo];
 
-			/*	Get a random bit state (0/1)	*/
-			b = S->SEEmodeling->bit_pfun(S,
-				0,					/*	min	*/
-				1,					/*	max	*/
-				S->SEEmodeling->bit_pfun_p1,		/* Dist params:	*/
-				S->SEEmodeling->bit_pfun_p2,
-				S->SEEmodeling->bit_pfun_p3,
-				S->SEEmodeling->bit_pfun_p4);
+	if (	(which >= p->logical_offset) &&
+		(which < (p->logical_offset + p->logical_bits)))
+	{
+		uchar	b;
+		ulong	mask;
+		int	offset;
 
+		/*	Get a random bit state (0/1)	*/
+		b = mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeSEE]) & 1;
 
-			/*	Integer division result is OK for us here	*/
-			offset = ((which - p->logical_offset)*p->actual_bits)/p->logical_bits;
 
+		/*	Integer division result is OK for us here	*/
+		offset = ((which - p->logical_offset)*p->actual_bits)/p->logical_bits;
 
-			/*							*/
-			/*	If dealing with sub-structure, offset is 	*/
-			/*	from a non-zero offset from structure begin	*/
-			/*							*/
-			offset += p->bit_offset;
 
-			if (b == 0)
-			{
-				mask = ~(1UL << offset);
-				*(p->hw) &= mask;
-			}
-			else
-			{
-				mask = 1UL << offset;
-				*(p->hw) |= mask;
-			}
+		/*							*/
+		/*	If dealing with sub-structure, offset is 	*/
+		/*	from a non-zero offset from structure begin	*/
+		/*							*/
+		offset += p->bit_offset;
 
-			break;
+		if (b == 0)
+		{
+			mask = ~(1UL << offset);
+			*(p->hw) &= mask;
+		}
+		else
+		{
+			mask = 1UL << offset;
+			*(p->hw) |= mask;
 		}
-
-		p = p->next;
 	}
 
 	return;
@@ -348,10 +538,14 @@ induceSEE(State *S)
 /*	twice, at half the full structure size, with different offsets,		*/
 /*	and with same actual size but different logical size.			*/
 /*										*/
+/*	Each structure's logical_offset is the prefix sum of the logical	*/
+/*	sizes registered before it, so structs[] is sorted on it.		*/
+/*										*/
 void
 m_hwSEEreg(Engine *E, State *S, void *hw, int actual_bits, int logical_bits, int bit_offset)
 {
 	SEEstruct	*s;
+	SEEstate	*M = S->SEEmodeling;
 	
 
 	s = (SEEstruct *) mcalloc(E, 1, sizeof(SEEstruct), "fault.c:m_hwSEEreg/SEEstruct *s");
@@ -366,22 +560,35 @@ m_hwSEEreg(Engine *E, State *S, void *hw, int actual_bits, int logical_bits, int
 	s->logical_bits		= logical_bits;
 	s->bit_offset		= bit_offset;
 
-	if (S->SEEmodeling->hd == NULL || S->SEEmodeling->tl == NULL)
+	if (M->nstructs == M->maxstructs)
 	{
-		S->SEEmodeling->tl = S->SEEmodeling->hd = s;
-		S->SEEmodeling->logical_bits = 0;
-		S->SEEmodeling->actual_bits = 0;
+		SEEstruct	**structs;
+		int		maxstructs = (M->maxstructs == 0) ? 16 : 2*M->maxstructs;
+
+		structs = (SEEstruct **) mrealloc(E, M->structs, maxstructs*sizeof(SEEstruct *),
+				"fault.c:m_hwSEEreg/M->structs");
+		if (structs == NULL)
+		{
+			mfree(E, s, "fault.c:m_hwSEEreg/SEEstruct *s");
+			sfatal(E, NULL, "Mrealloc failed");
+			return;
+		}
+		M->structs = structs;
+		M->maxstructs = maxstructs;
 	}
-	else
+
+	if (M->nstructs == 0)
 	{
-		S->SEEmodeling->tl->next = s;
-		S->SEEmodeling->tl = s;
+		M->logical_bits = 0;
+		M->actual_bits = 0;
+		E->nSEEnodes++;
 	}
-	s->logical_offset = S->SEEmodeling->logical_bits;
+	M->structs[M->nstructs++] = s;
+	s->logical_offset = M->logical_bits;
 
 
-	S->SEEmodeling->logical_bits	+= logical_bits;
-	S->SEEmodeling->actual_bits	+= actual_bits;
+	M->logical_bits	+= logical_bits;
+	M->actual_bits	+= actual_bits;
 
 
 	return;
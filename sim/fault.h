@@ -49,3 +49,25 @@ enum
 	/*	Smallest fault probability is 1/FAULT_PROB_MODULO	*/
 	FAULT_PROB_MODULO	= 1<<30,
 };
+
+/*									*/
+/*	What a node's or netseg's pfun is being asked to draw: whether	*/
+/*	a fault occurs, or, once one has, how long it lasts.		*/
+/*									*/
+typedef enum
+{
+	kFaultDrawOccurrence,
+	kFaultDrawDuration,
+} FaultDraw;
+
+/*									*/
+/*	Random faults are Bernoulli trials, one per fault feed, with	*/
+/*	probability fail_prob. Rather than making a trial for every	*/
+/*	node and netseg at every feed, fault_feed() draws the number	*/
+/*	of feeds until the next success from the geometric		*/
+/*	distribution, and does no work at all until the earliest	*/
+/*	fault or recovery it has scheduled. kFaultMaxGap bounds the	*/
+/*	draw for probabilities too small to ever fail in practice.	*/
+/*									*/
+#define	kFaultUndrawn	((uvlong)0)
+#define	kFaultMaxGap	(((uvlong)1) << 62)
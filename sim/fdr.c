@@ -609,6 +609,9 @@ m_readstabs(Engine *E, State *S, char *filename)
 		{
 			scope = SCOPE_FUNCTION;
 			fnaddr = stab.nvalue;
+
+			/*	Name the function for the PC profile	*/
+			msymadd(E, S, stab.nvalue, cleanbuf);
 			continue;
 		}
 		else if (!strcmp(stab.ntype, "LBRAC"))
@@ -66,12 +66,16 @@ TokenTab riscv_token_table [] =
 	{"C",		T_CACHESTATS},				/*+	Synonym for CACHESTATS.:none											*/
 	{"CA",		T_MODECA},				/*+	Set simulator in cycle-accurate mode.:none									*/
 	{"FF",		T_MODEFF},				/*+	Set simulator in fast functional mode.:none									*/
+	{"SAMPLE",	T_SAMPLE},				/*+	Sampled simulation alternating fast then warming then measured detailed windows.:<fast instrs> <warm instrs> <detailed instrs>	*/
+	{"SAMPLEOFF",	T_SAMPLEOFF},				/*+	Stop sampled simulation and return to the previous mode.:none						*/
+	{"SAMPLESTATS",	T_SAMPLESTATS},				/*+	Show sampled CPI and energy and cache miss rate estimates.:none						*/
 	{"MMAP",	T_MMAP},				/*+	Map memory of one simulated node into another.:<source (integer)> <destination (integer)>			*/
 	{"DUMPREGS",	T_DUMPREGS},				/*+	Show the contents of the general purpose registers.:none							*/
 	{"DUMPHIST",	T_DUMPHIST},				/*+	Show the contents of a histogram register.:<histogram register>							*/
 	{"DUMPHISTPRETTY",	T_DUMPHISTPRETTY},				/*+	Show the contents of a histogram register, with ASCII-graph representation.:<histogram register>							*/
 	{"LDHISTRND",	T_LDHISTRND},				/*+	Fill a histogram register with random values.:<histogram register>							*/
 	{"ADDHIST",	T_ADDHIST},				/*+	Add two histograms. Write result to third histogram.:<histogram register addend 1> <histogram register addend 2> <histogram register result>							*/
+	{"SETHISTFORMAT",	T_SETHISTFORMAT},				/*+	Set the number of bins (1-256) and bin type ("uint16", "uint32" or "float") of all histogram registers, clearing them.:<number of bins> <bin type (string)>							*/
 	{"DUMPSYSREGS",	T_DUMPSYSREGS},				/*+	Show the contents of the system registers.:none									*/
 	{"DUMPMEM",	T_DUMPMEM},				/*+	Show contents of memory.:<start mem address (hexadecimal)> <end mem address (hexadecimal)>			*/
 	{"DUMPPIPE",	T_DUMPPIPE},				/*+	Show the contents of the pipeline stages.:none									*/
@@ -162,6 +166,15 @@ TokenTab riscv_token_table [] =
 	{"SETSCALEK",		T_SETSCALEK},			/*+	Set technology K parameter for use in voltage scaling.:<Sakurai K (real)>																*/
 	{"SETSCALEVT",		T_SETSCALEVT},			/*+	Set technology Vt for use in voltage scaling.:<Vt (real)>																		*/
 	{"SETQUANTUM",		T_SETQUANTUM},			/*+	Set simulation instruction group quantum.:<quantum (integer)>																		*/
+	{"SETANALYSIS",		T_SETANALYSIS},			/*+	Enable or disable an analysis (bitflip, power, valuetrace, taint, upe, histogram, numa) at run time.:<analysis (string)> <enable (Boolean)>							*/
+	{"HOSTSTATS",		T_HOSTSTATS},			/*+	Print host wall and user time, peak RSS and simulated instructions, cycles and time as one key=value line.:none								*/
+	{"SIMPROFILE",		T_SIMPROFILE},			/*+	Print the host time spent in each simulator phase and in the memory and device slow paths.:none								*/
+	{"SIMPROFILEON",	T_SIMPROFILEON},		/*+	Clear and start the host-side profile of the simulator (see SIMPROFILE).:none								*/
+	{"SIMPROFILEOFF",	T_SIMPROFILEOFF},		/*+	Stop the host-side profile of the simulator.:none								*/
+	{"PCPROFILE",		T_PCPROFILE},			/*+	Start a profile of the current node's guest code, sampling the PC every given number of cycles.:<period (cycles)>								*/
+	{"PCPROFILEOFF",	T_PCPROFILEOFF},		/*+	Stop the guest PC profile, keeping the samples taken so far.:none								*/
+	{"PCPROFILESTATS",	T_PCPROFILESTATS},		/*+	Print cycles, stall cycles, instructions and energy for the functions with the most cycles in the guest PC profile.:<number of functions>								*/
+	{"PCPROFILEDUMP",	T_PCPROFILEDUMP},		/*+	Write the guest PC profile as collapsed stacks for flame graphs, weighted by samples, cycles, stalls, instrs or energy (pJ).:<filename (string)> <metric (string)>								*/
 	{"SETBASENODEID",	T_SETBASENODEID},		/*+	Set ID of first node from which all node IDs will be offset.:<base (integer)>																*/
 	{"RENUMBERNODES",	T_RENUMBERNODES},		/*+	Renumber nodes based on base node ID.:none																				*/
 	{"FILE2NETSEG",		T_FILE2NETSEG},			/*+	Connect file to netseg.:<file (string)>	<netseg (integer)>																		*/
@@ -176,10 +189,12 @@ TokenTab riscv_token_table [] =
 	{"RESETALLCTRS",	T_RESETALLCTRS},		/*+	Reset simulation rate measurement trip counters for all nodes.:none																	*/
 
 	{"SIGSRC",		T_SIGNALSRC},			/*+	Create a physical phenomenon signal source.:<type (integer)> <description (string)> <tau (real)> <propagationspeed (real)> <A (real)> <B (real)> <C (real)> <D (real)> <E (real)> <F (real)> <G (real)> <H (real)> <I (real)> <J (real)> <K (real)> <m (real)> <n (real)> <o (real)> <p (real)> <q (real)> <r (real)> <s (real)> <t (real)> <x (real)> <y (real)> <z (real)> <trajectoryfile (string)> <trajectoryrate (real)> <looptrajectory (Boolean)> <samplesfile (string)> <samplerate (integer)> <fixedsampleval (real)> <loopsamples (Boolean)>	*/
+	{"SAVETRAJECTORY",	T_SAVETRAJECTORY},		/*+	Convert a trajectory file to the binary format which is mapped rather than parsed.:<trajectory file (string)> <binary file (string)>	*/
 	{"SIGSUBSCRIBE",	T_SIGNALSUBSCRIBE},		/*+	Subscribe sensor X on the current node to a signal source Y.:<X (integer)> <Y (integer)>														*/
 	{"SENSORSDEBUG",	T_SENSORSDEBUG},		/*+	Display various statistics on sensors and signals.:none 																		*/
 	{"SETPHYSICSPERIOD",	T_SETPHYSICSPERIOD},		/*+	Set update periodicity for physical phenomenon simulation.:<period in picoseconds (integer)>														*/
 	{"SETBATTFEEDPERIOD",	T_SETBATTFEEDPERIOD},		/*+	Set update periodicity for battery simulation.:<period in picoseconds (integer)>															*/
+	{"SETBATTFEEDADAPTIVE",	T_SETBATTFEEDADAPTIVE},		/*+	Adapt battery feed period to the rate of change of state of charge; a state of charge step of 0 disables.:<min period (real)> <max period (real)> <state of charge step per feed (real)>	*/
 	{"SETDUMPPWRPERIOD",	T_SETDUMPPWRPERIOD},		/*+	Set periodicity power logging to simlog.:<period in picoseconds (integer)>																*/
 	{"FORCEAVGPWR",		T_FORCEAVGPWR},			/*+	Bypass ILPA analysis and set avg pwr consumption.:<avg pwr in Watts (real)> <sleep pwr in Watts (real)>													*/
 	{"NETSEGPROPMODEL",	T_NETSEGPROPMODEL},		/*+	Associate a network segment with a signal propagation model.:<netseg ID (integer)> <sigsrc ID (integer)> <minimum SNR (real)>										*/
@@ -193,9 +208,16 @@ TokenTab riscv_token_table [] =
 	{"SPLIT",		T_SPLIT},			/*+	Split current CPU to execute from a new PC and stack.:<newpc (hexadecimal)> <newstackaddr (hexadecimal)> <argaddr (hexadecimal)> <newcpuidstr (integer)>						*/
 	{"SFATAL",		T_SFATAL},			/*+	Induce a node death and state dump.:<suicide note (string)>																		*/
 	{"SHAREBUS",		T_SHAREBUS},			/*+	Share bus structure with ther named node.:<Bus donor nodeid (integer)>																	*/
+	{"BUSARBITRATION",	T_BUSARBITRATION},		/*+	Select arbitration of the memory controller on the current node's bus, creating the controller if needed.:<lock, roundrobin, priority or tdma (string)>	*/
+	{"BUSBANKS",		T_BUSBANKS},			/*+	Set number of memory banks behind the current node's bus, and address interleave between banks.:<banks (integer)> <interleave bytes (integer)>	*/
+	{"BUSTIMING",		T_BUSTIMING},			/*+	Set cycles a transfer holds the current node's bus, and length of TDMA slots.:<transfer cycles (integer)> <slot cycles (integer)>	*/
+	{"BUSPRIORITY",		T_BUSPRIORITY},			/*+	Set priority of a node at the current node's bus under priority arbitration, higher first.:<nodeid (integer)> <priority (integer)>	*/
+	{"BUSSTATS",		T_BUSSTATS},			/*+	Display request, wait and bank conflict statistics of the current node's bus.:none	*/
 	{"ADDVALUETRACE",	T_ADDVALUETRACE},		/*+	Install an address monitor to track data values.:<name string (string)> <base addr (hexadecimal)> <size (integer)> <onstack (Boolean)> <pcstart (hexadecimal)> <frameoffset (integer)>			*/
 	{"DELVALUETRACE",	T_DELVALUETRACE},		/*+	Delete an installed address monitor for tracking data values.:<name string (string)> <base addr (hexadecimal)> <size (integer)> <onstack (Boolean)> <pcstart (hexadecimal)> <frameoffset (integer)>	*/
 	{"VALUESTATS",		T_VALUESTATS},			/*+	Print data value tracking statistics.:none																				*/
+	{"VALUETRACEFILE",	T_VALUETRACEFILE},		/*+	Stream value and register traces of the current node to a binary trace file instead of keeping them in memory.:<filename (string)>	*/
+	{"VALUETRACECLOSE",	T_VALUETRACECLOSE},		/*+	Flush and close the value trace file of the current node.:none	*/
 	{"REGISTERSTABS",	T_REGISTERSTABS},		/*+	Register variables in a STABS file with value tracing framework.:<STABS filename (string)>														*/
 	{"SETRANDOMSEED",	T_SETRANDOMSEED},		/*+	Reinitialize random number generation system with a specific seed useful in conjunction with GETRANDOMSEED for reproducing same pseudorandom state.:<seed value negative one to use current time (integer)>	*/
 	{"GETRANDOMSEED",	T_GETRANDOMSEED},		/*+	Query seed used to initialize random number generation system useful for reinitializing generator to same seed for reproducibility.:none								*/
@@ -234,7 +256,7 @@ TokenTab riscv_token_table [] =
 	{"SETSCHEDROUNDROBIN",	T_SETSCHEDROUNDROBIN},		/*+	Use a round-robin order for node simulation.:none																			*/
 	{"SETNETPERIOD",	T_SETNETPERIOD},		/*+	Set period for activting network scheduling.:<period in picoseconds (integer)>																*/
 	{"SETFAULTPERIOD",	T_SETFAULTPERIOD},		/*+	Set period for activating fault scheduling.:<period in picoseconds (integer)>																*/
-	{"BPT",			T_BPT},				/*+	Set breakpoint.: 'cycles' <ncycles on current node (integer)> | 'instrs' <ninstrs on current node (integer)> | 'sensorreading' <which sensor (integer)> <value (real)> | 'globaltime' <global time in picoseconds (integer)>	*/
+	{"BPT",			T_BPT},				/*+	Set breakpoint.: 'cycles' <ncycles on current node (integer)> | 'instrs' <ninstrs on current node (integer)> | 'sensorreading' <which sensor (integer)> <value (real)> | 'globaltime' <global time in picoseconds (integer)> | 'pc' <address (integer)> | 'reads' <address (integer)> <size (integer)> | 'writes' <address (integer)> <size (integer)>	*/
 	{"BPTLS",		T_BPTLS},			/*+	List breakpoints and their IDs.:none																					*/
 	{"BPTDEL",		T_BPTDEL},			/*+	Delete breakpoint.:<breakpoint ID (integer)>																				*/
 	{"RANDPRINT",		T_RANDPRINT},			/*+	Print a random value from the selected distribution with given parameters.:<distribution name (string)> <min (real)> <max (real)> <p1 (real)> <p2 (real)> <p3 (real)> <p4 (real)>			*/
@@ -250,6 +272,8 @@ TokenTab riscv_token_table [] =
 	{"INSTRS",		T_INSTRS},
 	{"SENSORREADING",	T_SENSORREADING},
 	{"GLOBALTIME",		T_GLOBALTIME},
+	{"READS",		T_READS},
+	{"WRITES",		T_WRITES},
 
 	/*	Assembler Control Instructions		*/
 	{".ALIGN",		T_DOTALIGN},
@@ -0,0 +1,164 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "sf.h"
+#include "mextern.h"
+
+
+/*									*/
+/*	Refill the buffer with the next block of the file. Returns 0	*/
+/*	once the file is exhausted.					*/
+/*									*/
+static int
+linefill(Linereader *L)
+{
+	int	n;
+
+
+	if (L->eof)
+	{
+		return 0;
+	}
+
+	n = mread(L->fd, L->buf, kSunflowerLinereaderBufsize);
+	if (n <= 0)
+	{
+		L->eof = 1;
+
+		return 0;
+	}
+	L->pos = 0;
+	L->end = n;
+
+	return 1;
+}
+
+Linereader *
+mlineopen(Engine *E, char *path)
+{
+	Linereader	*L;
+	int		fd;
+
+
+	fd = mopen(path, M_OREAD);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	L = (Linereader *)mcalloc(E, 1, sizeof(Linereader), "Linereader *L in linereader.c");
+	if (L == NULL)
+	{
+		mclose(fd);
+
+		return NULL;
+	}
+
+	L->buf = (char *)mcalloc(E, kSunflowerLinereaderBufsize, sizeof(char), "L->buf in linereader.c");
+	if (L->buf == NULL)
+	{
+		mfree(E, L, "Linereader *L in linereader.c");
+		mclose(fd);
+
+		return NULL;
+	}
+	L->fd = fd;
+
+	return L;
+}
+
+/*									*/
+/*	Same contract as mfgets(): copies up to and including the next	*/
+/*	newline, but at most len characters, and NUL-terminates, so buf	*/
+/*	must hold len+1 characters. Returns NULL at end of file.	*/
+/*									*/
+char *
+mlinegets(Linereader *L, char *buf, int len)
+{
+	int	i = 0, n;
+	char	*nl = NULL;
+
+
+	if (len <= 0)
+	{
+		return NULL;
+	}
+
+	while ((i < len) && (nl == NULL))
+	{
+		if ((L->pos == L->end) && !linefill(L))
+		{
+			break;
+		}
+
+		n = L->end - L->pos;
+		if (n > len - i)
+		{
+			n = len - i;
+		}
+
+		nl = memchr(&L->buf[L->pos], '\n', n);
+		if (nl != NULL)
+		{
+			n = nl - &L->buf[L->pos] + 1;
+		}
+
+		memcpy(&buf[i], &L->buf[L->pos], n);
+		L->pos += n;
+		i += n;
+	}
+
+	if (i == 0)
+	{
+		return NULL;
+	}
+	buf[i] = '\0';
+
+	return buf;
+}
+
+void
+mlineclose(Engine *E, Linereader *L)
+{
+	mclose(L->fd);
+	mfree(E, L->buf, "L->buf in linereader.c");
+	mfree(E, L, "Linereader *L in linereader.c");
+
+	return;
+}
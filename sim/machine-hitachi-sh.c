@@ -120,8 +120,8 @@ drain_pipeline(Engine *E, State *S)
 		(S->superH->P.MA.instr != 0x9) ||
 		(S->superH->P.WB.instr != 0x9))
 	{
-		/*	Call superHstep, with flag set to drain pipe	*/
-		superHstep(E, S, 1);
+		/*	Call cycle-level step, with flag set to drain pipe	*/
+		S->cyclestep(E, S, 1);
 	}
 
 	return;
@@ -267,6 +267,9 @@ superHfatalaction(Engine *E, State *S)
 tuck void
 superHstallaction(Engine *E, State *S, ulong addr, int type, int latency)
 {
+	Bus	*ctl;
+
+
 	/*	PAU may change VDD	*/
 	if (SF_PAU_DEFINED)
 	{
@@ -289,6 +292,23 @@ superHstallaction(Engine *E, State *S, ulong addr, int type, int latency)
 		S->superH->P.EX.cycles += latency;
 	}
 
+	/*								*/
+	/*	With a memory controller, the access is queued for	*/
+	/*	arbitration instead of locking the whole bus. Stalls	*/
+	/*	are not simulated in faststep, so nothing is queued.	*/
+	/*								*/
+	ctl = (S->superH->numactl != NULL) ? S->superH->numactl : S->superH->B->ctl;
+	S->superH->numactl = NULL;
+	if ((ctl != NULL) && (ctl->arbitration != kSunflowerBusArbLock))
+	{
+		if (S->step != S->faststep)
+		{
+			mbusrequest(E, ctl, S, addr, type, latency, &S->superH->P.bus_stall_cycles);
+		}
+
+		return;
+	}
+
 	/*								*/
 	/*	TODO: This will have to change when we implement	*/
 	/*	setjmp idea for simulating memory stalls		*/
@@ -326,7 +346,7 @@ superHtake_timer_intr(Engine *E, State *S)
 		(S->superH->SR.IMASK < TIMER_FIXED_INTRLEVEL)
 	  )
 	{
-		if (S->step == superHfaststep)
+		if (S->step == S->faststep)
 		{
 			S->superH->SPC = S->PC;
 		}
@@ -525,7 +545,7 @@ superHtake_exception(Engine *E, State *S)
 	else if (handling == COMPLETED)
 	{
 		/*	Current instruction is completed	*/
-		if (S->step == superHfaststep)
+		if (S->step == S->faststep)
 		{
 			S->superH->SPC = S->PC;
 		}
@@ -564,7 +584,7 @@ superHtake_nic_intr(Engine *E, State *S)
 	/*	to PC+2, we set it to PC, so that RTE executes the	*/
 	/*	instr after then one after we caught the interrupt.	*/
 	/*								*/
-	if (S->step == superHfaststep)
+	if (S->step == S->faststep)
 	{
 		S->superH->SPC = S->PC;
 	}
@@ -690,7 +710,7 @@ superHtake_batt_intr(Engine *E, State *S)
 		return -1;
 	}
 
-	if (S->step == superHfaststep)
+	if (S->step == S->faststep)
 	{
 		S->superH->SPC = S->PC;
 	}
@@ -749,6 +769,10 @@ superHresetcpu(Engine *E, State *S)
 	memset(&S->superH->SSR, 0, sizeof(SuperHSREG));
 	memset(S->MEM, 0, S->MEMSIZE);
 	memset(S->superH->B, 0, sizeof(SuperHBuses));
+	superHsbflush(E, S);
+
+	mmemmapinit(E, S);
+	devsimregister(E, S);
 
 	/*								*/
 	/*	The only the ratio of size:blocksize and assoc are	*/
@@ -805,6 +829,7 @@ superHresetcpu(Engine *E, State *S)
 	S->superH->TTB = 0;
 	S->superH->TEA = 0;
 	S->superH->MMUCR = 0;
+	superHutlbinvalidate(S);
 
 	S->superH->TRA = 0;
 	S->superH->EXPEVT = 0;
@@ -821,7 +846,7 @@ superHresetcpu(Engine *E, State *S)
 	S->startclk = 0;
 	S->finishclk = 0;
 	
-	S->step = superHstep;
+	S->step = S->cyclestep;
 	S->pipelined = 1;
 	S->pipeshow = 0;
 
@@ -873,6 +898,23 @@ superHresetcpu(Engine *E, State *S)
 }
 
 
+void
+superHanalysisinit(Engine *E, State *S)
+{
+	if (SF_TAINTANALYSIS && S->TAINTMEM == NULL)
+	{
+		S->TAINTMEM = (ShadowMem *)mcalloc(E, 1, S->TAINTMEMSIZE, "(ShadowMem *)S->TAINTMEM"); 
+		if (S->TAINTMEM == NULL)
+		{
+			mexit(E, "Failed to allocate memory for S->TAINTMEM.", -1);
+		}
+	}
+
+	superHbindstep(E, S);
+
+	return;
+}
+
 State *
 superHnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilename)
 {
@@ -899,72 +941,62 @@ superHnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 		mexit(E, "Failed to allocate memory for S->MEM.", -1);
 	}
 
-	if (SF_TAINTANALYSIS)
+	S->superH->B = (SuperHBuses *)mcalloc(E, 1, sizeof(SuperHBuses), "(SuperHBuses *)S->superH->B");
+	if (S->superH->B == NULL)
 	{
-		S->TAINTMEM = (ShadowMem *)mcalloc(E, 1, S->TAINTMEMSIZE, "(ShadowMem *)S->TAINTMEM"); 
-		if (S->TAINTMEM == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->TAINTMEM.", -1);
-		}
+		mexit(E, "Failed to allocate memory for S->superH->B.", -1);
 	}
 
-	if (SF_NUMA)
+	/*								*/
+	/*	The NUMA region and register trace tables are always	*/
+	/*	allocated: the commands that install regions and	*/
+	/*	tracers use them whether or not the corresponding	*/
+	/*	analysis is currently enabled (SETANALYSIS).		*/
+	/*								*/
+	S->N = (Numa *)mcalloc(E, 1, sizeof(Numa), "(Numa *)S->N");
+	if (S->N == NULL)
 	{
-		S->superH->B = (SuperHBuses *)mcalloc(E, 1, sizeof(SuperHBuses), "(SuperHBuses *)S->superH->B");
-		if (S->superH->B == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->superH->B.", -1);
-		}
-
-
-		S->N = (Numa *)mcalloc(E, 1, sizeof(Numa), "(Numa *)S->N");
-		if (S->N == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->N.", -1);
-		}
-		S->N->count = 0;
+		mexit(E, "Failed to allocate memory for S->N.", -1);
+	}
+	S->N->count = 0;
 
-		/*	Actual entries are allocated when a region is installed		*/
-		S->N->regions = (Numaregion **)mcalloc(E, MAX_NUMA_REGIONS,
-			sizeof(Numaregion*), "(Numaregion **)S->N->regions");
-		if (S->N->regions == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->N->regions.", -1);
-		}
+	/*	Actual entries are allocated when a region is installed		*/
+	S->N->regions = (Numaregion **)mcalloc(E, MAX_NUMA_REGIONS,
+		sizeof(Numaregion*), "(Numaregion **)S->N->regions");
+	if (S->N->regions == NULL)
+	{
+		mexit(E, "Failed to allocate memory for S->N->regions.", -1);
+	}
 
 
-		S->Nstack = (Numa *)mcalloc(E, 1, sizeof(Numa), "(Numa *)S->Nstack");
-		if (S->Nstack == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->Nstack.", -1);
-		}
-		S->Nstack->count = 0;
+	S->Nstack = (Numa *)mcalloc(E, 1, sizeof(Numa), "(Numa *)S->Nstack");
+	if (S->Nstack == NULL)
+	{
+		mexit(E, "Failed to allocate memory for S->Nstack.", -1);
+	}
+	S->Nstack->count = 0;
 
-		/*	Actual entries are allocated when a region is installed		*/
-		S->Nstack->regions = (Numaregion **)mcalloc(E, MAX_NUMA_REGIONS,
-			sizeof(Numaregion*), "(Numaregion **)S->Nstack->regions");
-		if (S->Nstack->regions == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->Nstack->regions.", -1);
-		}
+	/*	Actual entries are allocated when a region is installed		*/
+	S->Nstack->regions = (Numaregion **)mcalloc(E, MAX_NUMA_REGIONS,
+		sizeof(Numaregion*), "(Numaregion **)S->Nstack->regions");
+	if (S->Nstack->regions == NULL)
+	{
+		mexit(E, "Failed to allocate memory for S->Nstack->regions.", -1);
 	}
 
-	if (SF_VALUETRACE_ANALYSIS)
+	S->RT = (Regtraces *)mcalloc(E, 1, sizeof(Regtraces), "(Regtraces *)S->RT");
+	if (S->RT == NULL)
 	{
-		S->RT = (Regtraces *)mcalloc(E, 1, sizeof(Regtraces), "(Regtraces *)S->RT");
-		if (S->RT == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->RT.", -1);
-		}
-		S->RT->count = 0;
+		mexit(E, "Failed to allocate memory for S->RT.", -1);
+	}
+	S->RT->count = 0;
 
-		/*	Actual entries are allocated when a region is installed		*/
-		S->RT->regvts = (Regvt **)mcalloc(E, MAX_REG_TRACERS,
-			sizeof(Regvt*), "(Regvt **)S->RT->regvts");
-		if (S->RT->regvts == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->RT->regvts.", -1);
-		}
+	/*	Actual entries are allocated when a region is installed		*/
+	S->RT->regvts = (Regvt **)mcalloc(E, MAX_REG_TRACERS,
+		sizeof(Regvt*), "(Regvt **)S->RT->regvts");
+	if (S->RT->regvts == NULL)
+	{
+		mexit(E, "Failed to allocate memory for S->RT->regvts.", -1);
 	}
 
 	if (SF_SIMLOG)
@@ -1015,9 +1047,9 @@ superHnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 
 	S->cache_init = superHcache_init;
 	S->resetcpu = superHresetcpu;
-	S->step = superHstep;
-	S->cyclestep = superHstep;
-	S->faststep = superHfaststep;
+	S->analysisinit = superHanalysisinit;
+	S->analysisinit(E, S);
+	S->step = S->cyclestep;
 	S->dumppipe = superHdumppipe;
 	S->flushpipe = superHflushpipe;
 
@@ -1036,6 +1068,10 @@ superHnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 
 	S->writebyte = superHwritebyte;
 
+	S->bptindex.nextclk = BPT_NEVER;
+	S->bptindex.nextdyncnt = BPT_NEVER;
+	S->bptindex.lastpc = ~(ulong)0;
+
 	S->xloc = xloc;
 	S->yloc = yloc;
 	S->zloc = zloc;
@@ -1051,6 +1087,7 @@ superHnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 	}
 
 	S->NODE_ID = E->baseid + E->nnodes;
+	mrandstreaminitnode(E, S);
 
 
 	/*	Must know correct number of nodes in resetcpu()		*/
@@ -1115,6 +1152,7 @@ superHsplit(Engine *E, State *S, ulong startpc, ulong stackptr, ulong argaddr, c
 
 	N->MEM = S->MEM;
 	N->superH->B = S->superH->B;
+	superHsbshare(E, S, N);
 
 	/*								*/
 	/*	Make a copy of the entire Numaregion queue, and reset 	*/
@@ -1162,6 +1200,7 @@ superHsplit(Engine *E, State *S, ulong startpc, ulong stackptr, ulong argaddr, c
 	N->MEMBASE = S->MEMBASE;
 	N->MEMEND = S->MEMEND;
 	N->MEMSIZE = S->MEMSIZE;
+	mmemmapsetram(E, N);
 
 	N->superH->R[15] = stackptr;
 	N->superH->R[4] = argaddr;
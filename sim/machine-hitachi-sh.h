@@ -70,6 +70,9 @@ typedef struct
 	int		pbuslocker;
 	int		pbuslock_type;
 	ulong		pbuslock_addr;
+
+	/*	Memory controller, if one is configured; see bus.h	*/
+	Bus		*ctl;
 } SuperHBuses;
 
 /*		Entries in the Decode Cache		*/
@@ -78,6 +81,30 @@ typedef struct
 	SuperHPipestage	dc_p;
 } SuperHDCEntry;
 
+/*									*/
+/*	Micro-TLB: a direct-mapped cache of successful TLB translations	*/
+/*	in front of the TLB lookup in superHvmtranslate(), one entry per	*/
+/*	1KB virtual page, tagged with the ASID and privilege mode it was	*/
+/*	translated under. See mmu-hitachi-sh.c.				*/
+/*									*/
+enum
+{
+	SUPERH_UTLB_ENTRIES	= 64,
+	SUPERH_UTLB_PAGESHIFT	= 10,
+};
+
+typedef struct
+{
+	ulong		vpage;
+	ulong		pbase;
+	uchar		asid;
+	uchar		md;
+	uchar		valid;
+	uchar		cacheable;
+	uchar		readok;
+	uchar		writeok;
+} SuperHUTLBEntry;
+
 typedef struct SuperHState SuperHState;
 struct SuperHState
 {
@@ -154,6 +181,15 @@ struct SuperHState
 	SuperHPipe	P;
 	int		opncycles[SUPERH_OP_MAX];
 
+	/*							*/
+	/*	Controller of the node whose memory a NUMA	*/
+	/*	access went to, for the next stall action	*/
+	/*							*/
+	Bus		*numactl;
+
+	/*	Superblock cache for faststep, created on first use	*/
+	SuperHSBcache	*SB;
+
 	/*		Power Adaptation Unit		*/
 	PAUentry	*PAUs;
 	int		npau;
@@ -162,6 +198,7 @@ struct SuperHState
 	ulong		pauaddrmask;
 
 	Cache		*TLB;
+	SuperHUTLBEntry	utlb[SUPERH_UTLB_ENTRIES];
 
 	int		*PAUvalids;
 	int		numpauvalids;
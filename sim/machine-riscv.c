@@ -238,13 +238,74 @@ riscvfatalaction(Engine *E, State *S)
 void
 riscvdumphist(Engine *E, State *S, int histogram_id)
 {
+	Histogram	*hist = &S->riscv->histograms[histogram_id];
+
 	mprint(E, S, nodeinfo, "Printing information for register %u\n", histogram_id);
 	mprint(E, S, nodeinfo, "bin | val \n");
 	mprint(E, S, nodeinfo, "----+-----\n");
 
-	for (int i = 0; i < kUncertainAluHistogramBins; i++)
+	for (int i = 0; i < hist->nbins; i++)
+	{
+		switch (hist->bintype)
+		{
+			case kHistogramBinUint16:
+				mprint(E, S, nodeinfo, "%03u | %-3u\n", i, hist->bins.u16[i]);
+				break;
+			case kHistogramBinUint32:
+				mprint(E, S, nodeinfo, "%03u | %-3u\n", i, hist->bins.u32[i]);
+				break;
+			default:
+				mprint(E, S, nodeinfo, "%03u | %g\n", i, hist->bins.f[i]);
+				break;
+		}
+	}
+
+	if (hist->binoverflows || hist->valueoverflows)
 	{
-		mprint(E, S, nodeinfo, "%03u | %-3u\n", i, S->riscv->histograms[histogram_id].bins[i]);
+		mprint(E, S, nodeinfo, "Bin overflows: %llu, value overflows: %llu\n",
+			(unsigned long long)hist->binoverflows,
+			(unsigned long long)hist->valueoverflows);
+	}
+
+	return;
+}
+
+/*
+ *	Set the number of bins and the bin type of all histogram
+ *	registers. Register contents are cleared.
+ */
+void
+riscvsethistformat(Engine *E, State *S, int nbins, char *bintype)
+{
+	HistogramBinType	type;
+
+	if (!strcmp(bintype, "uint16"))
+	{
+		type = kHistogramBinUint16;
+	}
+	else if (!strcmp(bintype, "uint32"))
+	{
+		type = kHistogramBinUint32;
+	}
+	else if (!strcmp(bintype, "float"))
+	{
+		type = kHistogramBinFloat;
+	}
+	else
+	{
+		merror(E, "Histogram bin type must be one of \"uint16\", \"uint32\" or \"float\".");
+		return;
+	}
+
+	if (nbins < 1 || nbins > kUncertainAluHistogramMaxBins)
+	{
+		merror(E, "Histograms must have between 1 and %d bins.", kUncertainAluHistogramMaxBins);
+		return;
+	}
+
+	for (int i = 0; i < RISCV_XMAX; i++)
+	{
+		Histogram_Init(E, S, &S->riscv->histograms[i], nbins, type);
 	}
 
 	return;
@@ -509,13 +570,17 @@ riscVresetcpu(Engine *E, State *S)
 
 	memset(&S->riscv->P, 0, sizeof(SuperHPipe));
 	memset(&S->energyinfo, 0, sizeof(EnergyInfo));
+
 	// memset(&S->superH->R, 0, sizeof(ulong)*16);
 	memset(S->MEM, 0, S->MEMSIZE);
-	if (SF_NUMA)
+	if (S->riscv->B != NULL)
 	{
 		memset(S->riscv->B, 0, sizeof(SuperHBuses));
 	}
 
+	mmemmapinit(E, S);
+	devsimregister(E, S);
+
 	/*								*/
 	/*	The only the ratio of size:blocksize and assoc are	*/
 	/*	significant when Cache struct is used for modeling TLB	*/
@@ -543,6 +608,9 @@ riscVresetcpu(Engine *E, State *S)
 	S->voltscale_K = SUPERH_ORIG_VDD * SUPERH_ORIG_CYCLE;
 	S->voltscale_Vt = 0.0;
 
+	memset(S->scaledcurrents, 0, sizeof(S->scaledcurrents));
+	power_riscvcurrents(E, S);
+
 	S->Cycletrans = 0;
 	S->riscv->mem_access_type = 0;
 
@@ -567,7 +635,7 @@ riscVresetcpu(Engine *E, State *S)
 	S->startclk = 0;
 	S->finishclk = 0;
 	
-	S->step = riscvstep;
+	S->step = S->cyclestep;
 	S->pipelined = 1;
 	S->pipeshow = 0;
 
@@ -593,6 +661,37 @@ riscVresetcpu(Engine *E, State *S)
 	return;
 }
 
+void
+riscvanalysisinit(Engine *E, State *S)
+{
+	if (SF_UNCERTAIN_UPE && S->riscv->uncertain == NULL)
+	{
+		S->riscv->uncertain = uncertainnewstate(E, "S->riscv->uncertain");
+	}
+
+	if (SF_TAINTANALYSIS && S->TAINTMEM == NULL)
+	{
+		S->TAINTMEM = (ShadowMem *)mcalloc(E, 1, S->TAINTMEMSIZE, "(ShadowMem *)S->TAINTMEM"); 
+		if (S->TAINTMEM == NULL)
+		{
+			mexit(E, "Failed to allocate memory for S->TAINTMEM.", -1);
+		}
+	}
+
+	if (SF_NUMA && S->riscv->B == NULL)
+	{
+		S->riscv->B = (SuperHBuses *)mcalloc(E, 1, sizeof(SuperHBuses), "(SuperHBuses *)S->riscv->B");
+		if (S->riscv->B == NULL)
+		{
+			mexit(E, "Failed to allocate memory for S->riscv->B.", -1);
+		}
+	}
+
+	riscvbindstep(E, S);
+
+	return;
+}
+
 State *
 riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilename)
 {
@@ -610,35 +709,12 @@ riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilena
 		mexit(E, "Failed to allocate memory for S->riscv.", -1);
 	}
 
-	if (SF_UNCERTAIN_UPE)
-	{
-		S->riscv->uncertain = uncertainnewstate(E, "S->riscv->uncertain");
-	}
-
 	S->MEM = (uchar *)mcalloc(E, 1, DEFLT_MEMSIZE, "(uchar *)S->MEM");
 	if (S->MEM == NULL)
 	{
 		mexit(E, "Failed to allocate memory for S->MEM.", -1);
 	}
 
-	if (SF_TAINTANALYSIS)
-	{
-		S->TAINTMEM = (ShadowMem *)mcalloc(E, 1, S->TAINTMEMSIZE, "(ShadowMem *)S->TAINTMEM"); 
-		if (S->TAINTMEM == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->TAINTMEM.", -1);
-		}
-	}
-
-	if (SF_NUMA)
-	{
-		S->riscv->B = (SuperHBuses *)mcalloc(E, 1, sizeof(SuperHBuses), "(SuperHBuses *)S->riscv->B");
-		if (S->riscv->B == NULL)
-		{
-			mexit(E, "Failed to allocate memory for S->riscv->B.", -1);
-		}
-	}
-
 	E->cp = S;
 	E->sp[E->nnodes] = S;
 	mprint(E, NULL, siminfo, "New node created with node ID %d\n", E->nnodes);
@@ -670,9 +746,9 @@ riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilena
 
 	S->cache_init = superHcache_init;
 	S->resetcpu = riscVresetcpu;
-	S->step = riscvstep;
-	S->cyclestep = riscvstep;
-	S->faststep = riscvfaststep;
+	S->analysisinit = riscvanalysisinit;
+	S->analysisinit(E, S);
+	S->step = S->cyclestep;
 	S->dumppipe = riscvdumppipe;
 	S->flushpipe = riscvflushpipe;
 
@@ -692,6 +768,10 @@ riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilena
 
 	S->writebyte = riscVwritebyte;
 
+	S->bptindex.nextclk = BPT_NEVER;
+	S->bptindex.nextdyncnt = BPT_NEVER;
+	S->bptindex.lastpc = ~(ulong)0;
+
 	S->xloc = xloc;
 	S->yloc = yloc;
 	S->zloc = zloc;
@@ -702,6 +782,7 @@ riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilena
 	}
 
 	S->NODE_ID = E->baseid + E->nnodes;
+	mrandstreaminitnode(E, S);
 
 	/*	Must know correct number of nodes in resetcpu()		*/
 	E->nnodes++;
@@ -715,6 +796,8 @@ riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilena
 	S->dumphistpretty = riscvdumphistpretty;
 	S->ldhistrandom = riscvldhistrandom;
 	S->addhist = riscvaddhist;
+	S->sethistformat = riscvsethistformat;
+	riscvsethistformat(E, S, kUncertainAluHistogramBins, "uint16");
 
 	return S;
 }
@@ -64,14 +64,23 @@ msp430fatalaction(Engine *E, State *S)
 {
 }
 
+/*									*/
+/*	S->writebyte, used by the loaders, takes full-width arguments.	*/
+/*									*/
 void
-msp430stallaction(State *S, ulong addr, int type, int latency)
+msp430loadbyte(Engine *E, State *S, ulong addr, ulong data)
+{
+	msp430writebyte(E, S, (ushort)addr, (uchar)data);
+}
+
+void
+msp430stallaction(Engine *E, State *S, ulong addr, int type, int latency)
 {
 }
 
 
-tuck int
-msp430take_timer_intr(State *S)
+int
+msp430take_timer_intr(Engine *E, State *S)
 {
 	return 0;
 }
@@ -123,7 +132,7 @@ msp430resetcpu(Engine *E, State *S)
 	S->pipelined = 1;
 	S->pipeshow = 0;
 
-	fault_setnodepfun(S, "urnd");
+	fault_setnodepfun(E, S, "urnd");
 
 	return;
 }
@@ -148,7 +157,7 @@ msp430newstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 		mexit(E, "Failed to allocate memory for S->msp430.", -1);
 	}
 
-	S->MEM = (uchar *)mcalloc(E, 1, DEFLT_MEMSIZE, "(uchar *)S->MEM");
+	S->MEM = (uchar *)mcalloc(E, 1, MSP430_DEFLT_MEMSIZE, "(uchar *)S->MEM");
 	if (S->MEM == NULL)
 	{
 		mexit(E, "Failed to allocate memory for S->MEM.", -1);
@@ -250,8 +259,13 @@ msp430newstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 
 	S->take_timer_intr = msp430take_timer_intr;
 
+	S->machinetype = MACHINE_MSP430;
+	S->endian = Little;
+
 	S->resetcpu = msp430resetcpu;
 	S->step = msp430step;
+	S->cyclestep = msp430step;
+	S->faststep = msp430faststep;
 	S->dumppipe = msp430dumppipe;
 	S->flushpipe = msp430flushpipe;
 
@@ -263,24 +277,32 @@ msp430newstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilen
 	S->devwriteword = dev430x1xxwriteword;
 	S->devwritelong = NULL;
 	S->split = msp430split;
+	S->writebyte = msp430loadbyte;
+
+	S->bptindex.nextclk = BPT_NEVER;
+	S->bptindex.nextdyncnt = BPT_NEVER;
+	S->bptindex.lastpc = ~(ulong)0;
 
 	S->xloc = xloc;
 	S->yloc = yloc;
 	S->zloc = zloc;
 
-	S->trajfilename = (char *)mcalloc(E, 1, strlen(trajfilename)+1, "S->trajfilename in "SF_FILE_MACRO);
-	if (S->trajfilename == nil)
+	if (trajfilename != NULL)
 	{
-		mexit(E, "mcalloc failed for S->trajfilename in "SF_FILE_MACRO);
+		S->trajfilename = (char *)mcalloc(E, 1, strlen(trajfilename)+1, "S->trajfilename in "SF_FILE_MACRO);
+		if (S->trajfilename == nil)
+		{
+			mexit(E, "mcalloc failed for S->trajfilename in "SF_FILE_MACRO, -1);
+		}
+		strcpy(S->trajfilename, trajfilename);
 	}
-	strcpy(S->trajfilename, trajfilename);
 
 	S->NODE_ID = E->baseid + E->nnodes;
 
 	/*	Must know correct number of nodes in resetcpu()		*/
 	E->nnodes++;
 
-	S->resetcpu(S);
+	S->resetcpu(E, S);
 
 	S->intrQ = (InterruptQ *)mcalloc(E, 1, sizeof(InterruptQ),
 		"InterruptQ *intrQ in msp430newstate()");
@@ -37,8 +37,10 @@
 
 enum
 {
-	MSP430_DEFLT_MEMSIZE			= 256,
 	MSP430_MEMBASE				= 0x0200,
+
+	/*	RAM up through flash and the vector table at 0xFFE0	*/
+	MSP430_DEFLT_MEMSIZE			= 0x10000 - MSP430_MEMBASE,
 	MSP430_FLASHBASE			= 0xFFFF - 8192,
 	MSP430_DEFAULT_MEMREAD_LATENCY		= 1,
 	MSP430_DEFAULT_MEMWRITE_LATENCY		= 1,
@@ -87,6 +89,17 @@ struct MSP430State
 typedef struct
 {
 	MSP430Pipestage	dc_p;
+
+	/*							*/
+	/*	Operands extracted from the instruction word at	*/
+	/*	decode time, and the format-specific routine that	*/
+	/*	calls dc_p.fptr with them, so the fast step path	*/
+	/*	does no field extraction or format switch.		*/
+	/*							*/
+	void		(*dc_dispatch)();
+	ushort		dc_m;
+	ushort		dc_n;
+	short		dc_offset;
 } MSP430DCEntry;
 
 #define	MSP430_DEFAULT_VDD			(3.3)
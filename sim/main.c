@@ -38,6 +38,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #ifdef	SUNOS
 #	include <strings.h>
 #endif
@@ -53,6 +54,7 @@
 #include "help.h"
 #include "opstr-hitachi-sh.h"
 #include "opstr-riscv.h"
+#include "opstr-ti-msp430.h"
 #include "latencies-hitachi-sh.h"
 #include "latencies-riscv.h"
 
@@ -62,6 +64,7 @@ Engine*		engines[MAX_NUM_ENGINES];
 int		nengines;
 
 Engine		*yyengine;
+ulong		sfanalyses = SF_DEFAULT_ANALYSES;
 extern int	sf_superh_parse(void);
 extern int	sf_riscv_parse(void);
 
@@ -69,7 +72,9 @@ static void	spinbaton(Engine *, int);
 static void	do_numaregion(Engine *, State *, char *, ulong, ulong, long, long, long, long, int, ulong, int, int, int, ulong, int, int);
 static void	updaterandsched(Engine *);
 static void	bpts_feed(Engine *);
+static void	bptnodehit(Engine *, State *);
 static void	readnodetrajectory(Engine *, State *, char*, int, int);
+static void	valuehistory(Engine *, State *, Vtrace *, int, char *, ulong *, int);
 
 Engine *
 m_lookupengine(uvlong engineid)
@@ -93,6 +98,12 @@ m_allocengine(uvlong seed)
 	Engine	*tmp;
 
 
+	if (nengines >= MAX_NUM_ENGINES)
+	{
+		fprintf(stderr, "Engine limit (%d) reached in %s.\n", MAX_NUM_ENGINES, SF_FILE_MACRO);
+		return nil;
+	}
+
 	tmp = (Engine *) calloc(1, sizeof(Engine));
 	if (tmp == nil)
 	{
@@ -102,6 +113,7 @@ m_allocengine(uvlong seed)
 
 	tmp->throttlensec	= 0;
 	tmp->throttlewin	= 10000;
+	tmp->startwallusecs	= mwalltimeusecs();
 	tmp->quantum		= 1;
 	tmp->baseid		= 0;
 	tmp->cn			= 0;
@@ -115,6 +127,10 @@ m_allocengine(uvlong seed)
 	tmp->maxcycpsec		= 0;
 	tmp->fperiodpsec	= 100E-6; //100000;	/* 100E-6 seconds */
 	tmp->flastpsec		= 0;
+	tmp->faultfeeds		= 0;
+	tmp->faultlastfeed	= 0;
+	tmp->faultnextfeed	= 0;
+	tmp->nSEEnodes		= 0;
 	tmp->nnetsegs		= 0;
 	tmp->nactivensegs	= 0;
 	tmp->nicsimbytes	= 0;
@@ -178,12 +194,25 @@ spinbaton(Engine *E, int pos)
 }
 
 #ifndef LIBSF
+static void
+prompt(Engine *E)
+{
+	Cmdsnapshot	snap;
+
+
+	mcmdqueuesnapshot(E, &snap);
+	fprintf(stderr, "[ID=%d of %d][PC=0x" UHLONGFMT "][%.1EV, %.1EMHz] ",
+		snap.nodeid, snap.nnodes, (unsigned long)snap.pc,
+		snap.vdd, (1/snap.cycletime)/1E6);
+}
+
 int
 main(int nargs, char *args[])
 {
 	Engine		*E;
 	char 		*buf = NULL;
-	int		argn;
+	char		*statsfile = NULL, *sweepfile = NULL;
+	int		argn, batch = 0, njobs = 1;
 
 
 	nengines = 0;
@@ -207,7 +236,48 @@ main(int nargs, char *args[])
 		mexit(E, "Malloc failed in main.c for \"buf\"", -1);
 	}
 
+	/*								*/
+	/*	Options come before the script arguments. -b runs the	*/
+	/*	scripts headless, without the interactive loop; -s runs	*/
+	/*	a parameter sweep of batch runs, -j at a time.		*/
+	/*								*/
 	argn = 1;
+	while ((argn < nargs) && (args[argn][0] == '-'))
+	{
+		if (!strcmp(args[argn], "-b"))
+		{
+			batch = 1;
+		}
+		else if (!strcmp(args[argn], "-o") && (argn+1 < nargs))
+		{
+			statsfile = args[++argn];
+		}
+		else if (!strcmp(args[argn], "-s") && (argn+1 < nargs))
+		{
+			sweepfile = args[++argn];
+		}
+		else if (!strcmp(args[argn], "-j") && (argn+1 < nargs))
+		{
+			njobs = strtol(args[++argn], NULL, 0);
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-b] [-o statsfile] [-s sweepfile [-j njobs]] [script ...]\n", args[0]);
+			exit(-1);
+		}
+		argn++;
+	}
+
+	if (sweepfile != NULL)
+	{
+		m_sweep(E, statsfile, sweepfile, njobs, &args[argn], nargs - argn);
+	}
+
+	if (batch)
+	{
+		m_batch(E, statsfile, &args[argn], nargs - argn);
+	}
+
 	while (argn < nargs)
 	{
 		loadcmds(E, args[argn++]);
@@ -215,37 +285,38 @@ main(int nargs, char *args[])
 
 	/*	In the non-LIBSF version, we use fprintf to write to console	*/
 	fprintf(stderr, "\n");
-	fprintf(stderr, "[ID=%d of %d][PC=0x" UHLONGFMT "][%.1EV, %.1EMHz] ",
-		E->cp->NODE_ID, E->nnodes, (unsigned long)E->cp->PC,
-		E->cp->VDD, (1/E->cp->CYCLETIME)/1E6);
+	prompt(E);
 
 	while (1)
 	{
-		fgets(buf, MAX_BUFLEN, stdin);
-		if (strlen(buf) > 0)
+		if (fgets(buf, MAX_BUFLEN, stdin) == NULL)
 		{
-			mstatelock();
-			munchinput(E, buf);
-			yyengine = E;
-			if (yyengine->cp->machinetype == MACHINE_SUPERH)
+			/*						*/
+			/*	Out of input: let a detached run finish	*/
+			/*	rather than spinning on EOF.		*/
+			/*						*/
+			while (E->on || cmdqload(&E->cmdqueue.schedrunning))
 			{
-				sf_superh_parse();
+				mnsleep(100000000);
 			}
-			else if (yyengine->cp->machinetype == MACHINE_RISCV)
-			{
-				sf_riscv_parse();
-			}
-			fprintf(stderr, "[ID=%d of %d][PC=0x" UHLONGFMT "][%.1EV, %.1EMHz] ",
-				E->cp->NODE_ID, E->nnodes, (unsigned long)E->cp->PC,
-				E->cp->VDD, (1/E->cp->CYCLETIME)/1E6);
+			mexit(E, "End of input.", E->exitstatus);
+		}
+
+		if (strlen(buf) > 0)
+		{
+			/*						*/
+			/*	While a detached scheduler is running,	*/
+			/*	it executes the line at its next	*/
+			/*	quantum boundary; see cmdqueue.c.	*/
+			/*						*/
+			mcmdqueuesubmit(E, buf);
+			prompt(E);
 
 			/*
 			 *	Needed on some host embedded platforms, doesn't hurt in general.
 			 */
 			fflush(stderr);
 
-			mstateunlock();
-
 			buf[0] = '\0';
 		}
 	}
@@ -264,6 +335,8 @@ sched_step(Engine *E)
 	Picosec		min_secsleft;
 	double		max_cputime = 0.0;
 	ulong		throttle_tripctr = 0;
+	uvlong		t0;
+	int		quantum;
 
 
 	/*
@@ -277,7 +350,9 @@ sched_step(Engine *E)
 	{
 		if  (eventready(E->globaltimepsec, E->netlastpsec, E->netperiodpsec))
 		{
+			t0 = simprofbegin(E);
 			network_clock(E);
+			simprofend(E, kSimprofNetwork, t0);
 			E->netlastpsec = E->globaltimepsec;
 		}
 
@@ -290,7 +365,9 @@ sched_step(Engine *E)
 	{
 		if (eventready(E->globaltimepsec, E->flastpsec, E->fperiodpsec))
 		{
+			t0 = simprofbegin(E);
 			fault_feed(E);
+			simprofend(E, kSimprofFault, t0);
 			E->flastpsec = E->globaltimepsec;
 		}
 
@@ -303,7 +380,9 @@ sched_step(Engine *E)
 	{
 		if (eventready(E->globaltimepsec, E->phylastpsec, E->phyperiodpsec))
 		{
+			t0 = simprofbegin(E);
 			physics_feed(E);
+			simprofend(E, kSimprofPhysics, t0);
 			E->phylastpsec = E->globaltimepsec;
 		}
 
@@ -316,7 +395,9 @@ sched_step(Engine *E)
 	{
 		if (eventready(E->globaltimepsec, E->trajlastpsec, E->trajperiodpsec))
 		{
+			t0 = simprofbegin(E);
 			traj_feed(E);
+			simprofend(E, kSimprofTrajectory, t0);
 			E->trajlastpsec = E->globaltimepsec;
 		}
 
@@ -325,9 +406,11 @@ sched_step(Engine *E)
 		min_secsleft = min(min_secsleft, traj_secsleft);
 	}
 
-	if (SF_BPTS)
+	if (SF_BPTS && E->npolledbpts)
 	{
+		t0 = simprofbegin(E);
 		bpts_feed(E);
+		simprofend(E, kSimprofBreakpoints, t0);
 	}
 
 
@@ -347,12 +430,14 @@ sched_step(Engine *E)
 		*/
 		if (eventready(E->globaltimepsec, E->battlastpsec, E->battperiodpsec))
 		{
+			t0 = simprofbegin(E);
 			battery_feed(E, -1);
 
 			if (SF_BATTLOG)
 			{
 				battery_dumpall(E, E->sp[0]);
 			}
+			simprofend(E, kSimprofBattery, t0);
 
 			E->battlastpsec = E->globaltimepsec;
 		}
@@ -411,7 +496,6 @@ sched_step(Engine *E)
 		}
 
 		S = E->sp[E->cn];
-		S->energyinfo.current_draw = 0;
 
 		if (!S->runnable)
 		{
@@ -433,7 +517,30 @@ sched_step(Engine *E)
 		}
 
 
+		/*							*/
+		/*	A node runs no further than its next cycle or	*/
+		/*	instruction breakpoint: a node completes at	*/
+		/*	most one instruction per cycle, so either	*/
+		/*	distance bounds the quantum.			*/
+		/*							*/
+		quantum = E->quantum;
+		if (SF_BPTS && ((S->bptindex.nextclk != BPT_NEVER) || (S->bptindex.nextdyncnt != BPT_NEVER)))
+		{
+			E->quantum = (int)min((uvlong)quantum, min(S->bptindex.nextclk - S->ICLK,
+							S->bptindex.nextdyncnt - S->dyncnt));
+			E->quantum = max(E->quantum, 1);
+		}
+
+		t0 = simprofbegin(E);
 		S->step(E, S, 0);
+		simprofend(E, kSimprofNodestep, t0);
+		S->energyinfo.drawclks += S->last_stepclks;
+		E->quantum = quantum;
+
+		if (SF_BPTS && ((S->ICLK >= S->bptindex.nextclk) || (S->dyncnt >= S->bptindex.nextdyncnt)))
+		{
+			bptnodehit(E, S);
+		}
 
 
 		if (SF_DUMPPWR
@@ -441,14 +548,32 @@ sched_step(Engine *E)
 				E->dumpperiodpsec)
 			&& S->runnable)
 		{
+			EnergyInfo	*ei = &S->energyinfo;
+
+			/*							*/
+			/*	Average power since the previous dump, now	*/
+			/*	that current_draw is no longer reset per step	*/
+			/*							*/
+			power_materialize(E, S);
 			mlog(E, S, "%E %E",
-				E->globaltimepsec, S->energyinfo.current_draw * S->VDD);
+				E->globaltimepsec,
+				(ei->drawclks == ei->dumpclks) ? 0.0 :
+				(ei->current_draw - ei->dumpdraw) / (ei->drawclks - ei->dumpclks) * S->VDD);
+			ei->dumpdraw = ei->current_draw;
+			ei->dumpclks = ei->drawclks;
 			E->dumplastpsec = E->globaltimepsec;
 		}
 
 		max_cputime = max(max_cputime, S->TIME);
 	}
 
+	if (E->buses != NULL)
+	{
+		t0 = simprofbegin(E);
+		mbusclock(E);
+		simprofend(E, kSimprofBus, t0);
+	}
+
 	/*									*/
 	E->globaltimepsec = max(E->globaltimepsec, max_cputime) + E->mincycpsec;
 
@@ -463,26 +588,36 @@ sched_step(Engine *E)
 			throttle_tripctr = 0;
 		}
 	}
+
+	if (E->cmdqueue.schedrunning)
+	{
+		mcmdqueuepublish(E);
+	}
 	mstateunlock();
 }
 
 static void
 updaterandsched(Engine *E)
 {
-	int	i, idx, genscheds = 0;
+	int	i, j, tmp;
+	uvlong	draws[MAX_SIMNODES];
 
 	for (i = 0; i < E->nnodes; i++)
 	{
-		E->randsched[i] = -1;
+		E->randsched[i] = i;
 	}
 
-	while (genscheds < E->nnodes)
+	/*								*/
+	/*	Fisher-Yates shuffle, with all the draws for this	*/
+	/*	schedule taken from the scheduler's stream at once.	*/
+	/*								*/
+	mrandstreamfill(E, &E->randstreams[kSunflowerRandstreamEngineSched], draws, E->nnodes);
+	for (i = E->nnodes - 1; i > 0; i--)
 	{
-		idx = mrandom(E) % E->nnodes;
-		if (E->randsched[idx] == -1)
-		{
-			E->randsched[idx] = genscheds++;
-		}
+		j = draws[i] % (i + 1);
+		tmp = E->randsched[i];
+		E->randsched[i] = E->randsched[j];
+		E->randsched[j] = tmp;
 	}
 }
 
@@ -509,13 +644,24 @@ scheduler(Engine *E)
 	{
 		/*	Returning from longjmp()	*/
 		/*	jmpval == node that barfed.	*/
+		mcmdqueueabandon(E, kCmdqueueScheduler);
 	}
 #endif
 
+	/*								*/
+	/*	Console commands queued while we run are executed	*/
+	/*	between quanta, never in the middle of a node step.	*/
+	/*								*/
 	while (E->on)
 	{
+		mcmdqueuedrain(E, kCmdqueueScheduler);
+		if (!E->on)
+		{
+			break;
+		}
 		sched_step(E);
 	}
+	mcmdqueuestop(E);
 
 	return;
 }
@@ -731,7 +877,9 @@ load_mapfile(Engine *E, State *S, char *filename)
 {
 	FILE	*fp;
 	char	line[MAX_SREC_LINELEN], *p;
-	int		nlines = 0;
+	char	name[MAX_SREC_LINELEN], extra;
+	int	nlines = 0, nsyms = 0, found = 0;
+	unsigned long	addr;
 	//unsigned long dataSegmentEnd=0x0;
 	char 	dataSegmentStr[9];
 
@@ -747,35 +895,55 @@ load_mapfile(Engine *E, State *S, char *filename)
 		mprint(E, S, nodeinfo,
 			"Loading \"%s\" map file...\n\n", filename);
 	}
-	
-	/*														*/
-	/*		Skip all lines until the DATA_SEGMENT_END		*/
-	/*														*/
-	for (; strstr(line, "DATA_SEGMENT_END") == NULL ; nlines++)
+
+	for (; fgets(line, sizeof(line), fp) != NULL; nlines++)
 	{
-		fgets(line, sizeof(line), fp);
-	}
+		/*								*/
+		/*	Symbol definitions in the linker map are lines with	*/
+		/*	just an address and a name, e.g.,			*/
+		/*	"                0x08000130                main".	*/
+		/*	Assignments and section lines have more fields.	*/
+		/*								*/
+		if (sscanf(line, " 0x%lx %s %c", &addr, name, &extra) == 2
+			&& (isalpha((uchar)name[0]) || name[0] == '_'))
+		{
+			msymadd(E, S, (ulong)addr, name);
+			nsyms++;
 
-	p = strtok(line, " \t");
+			continue;
+		}
 
-	/*	18 is for 64bit addresses and 10 for 32bit addresses	*/
-	if (strlen(p) == 18)
-	{
-		strcpy(dataSegmentStr, &p[10]);
-	}
-	else if (strlen(p) == 10)
-	{
-		strcpy(dataSegmentStr, &p[2]);
-	}
-	else
-	{
-		mprint(E, S, nodeinfo, "Unknown memory length %zu in mmap file.\n", strlen(p));
-		return;
+		if (found || strstr(line, "DATA_SEGMENT_END") == NULL)
+		{
+			continue;
+		}
+		found = 1;
+
+		p = strtok(line, " \t");
+
+		/*	18 is for 64bit addresses and 10 for 32bit addresses	*/
+		if (strlen(p) == 18)
+		{
+			strcpy(dataSegmentStr, &p[10]);
+		}
+		else if (strlen(p) == 10)
+		{
+			strcpy(dataSegmentStr, &p[2]);
+		}
+		else
+		{
+			mprint(E, S, nodeinfo, "Unknown memory length %zu in mmap file.\n", strlen(p));
+			fclose(fp);
+
+			return;
+		}
+
+		S->MEM_DATA_SEGMENT_END = strtol(dataSegmentStr, NULL, 16);
+
+		mprint(E, S, nodeinfo, "DATA_SEGMENT_END: 0x%X\n", S->MEM_DATA_SEGMENT_END);
 	}
-	
-	S->MEM_DATA_SEGMENT_END = strtol(dataSegmentStr, NULL, 16);
 
-	mprint(E, S, nodeinfo, "DATA_SEGMENT_END: 0x%X\n", S->MEM_DATA_SEGMENT_END);
+	mprint(E, S, nodeinfo, "Read %d symbols from %d lines.\n", nsyms, nlines);
 
 	fclose(fp);
 }
@@ -797,8 +965,8 @@ m_setnode(Engine *E, int which)
 void
 loadcmds(Engine *E, char *filename)
 {
-	char	*buf;
-	int	fd;
+	char		*buf;
+	Linereader	*L;
 
 
 	buf = (char *) mcalloc(E, MAX_BUFLEN+1, sizeof(char),
@@ -809,8 +977,8 @@ loadcmds(Engine *E, char *filename)
 		mexit(E, "See above messages.", -1);
 	}
 
-	fd = mopen(filename, M_OREAD);
-	if (fd < 0)
+	L = mlineopen(E, filename);
+	if (L == NULL)
 	{
 		mprint(E, NULL, siminfo, "Cannot open \"%s\" for loading...\n\n", filename);
 		return;
@@ -821,7 +989,7 @@ loadcmds(Engine *E, char *filename)
 	/*									*/
 	mprint(E, NULL, siminfo, "Loading %s...\n", filename);
 	clearistream(E);
-	while (mfgets(buf, MAX_BUFLEN, fd) != NULL)
+	while (mlinegets(L, buf, MAX_BUFLEN) != NULL)
 	{
 		munchinput(E, buf);
 	}
@@ -833,7 +1001,7 @@ loadcmds(Engine *E, char *filename)
 	//streamchk(E);
 	scan_labels_and_globalvars(E);
 	//streamchk(E);
-	if (yyengine->cp->machinetype == MACHINE_SUPERH)
+	if ((yyengine->cp->machinetype == MACHINE_SUPERH) || (yyengine->cp->machinetype == MACHINE_MSP430))
 	{
 		sf_superh_parse();
 	}
@@ -841,7 +1009,7 @@ loadcmds(Engine *E, char *filename)
 	{
 		sf_riscv_parse();
 	}
-	mclose(fd);
+	mlineclose(E, L);
 
 
 	return;
@@ -920,6 +1088,11 @@ go(Engine *E, State *S, int gocycles)
 	while ((gocycles--) > 0)
 	{
 		S->step(E, S, 0);
+
+		if (E->buses != NULL)
+		{
+			mbusclock(E);
+		}
 	}
 
 	return;
@@ -932,6 +1105,11 @@ cont(Engine *E, State *S, ulong until_pc)
 	while (S->PC != until_pc)
 	{
 		S->step(E, S, 0);
+
+		if (E->buses != NULL)
+		{
+			mbusclock(E);
+		}
 	}
 
 	return;
@@ -1125,6 +1303,133 @@ m_version(Engine *E)
 	return;
 }
 
+static struct
+{
+	char	*name;
+	ulong	flag;
+} analyses[] =
+{
+	{"bitflip",	SF_ANALYSIS_BITFLIP},
+	{"power",	SF_ANALYSIS_POWER},
+	{"valuetrace",	SF_ANALYSIS_VALUETRACE},
+	{"taint",	SF_ANALYSIS_TAINT},
+	{"upe",		SF_ANALYSIS_UPE},
+	{"histogram",	SF_ANALYSIS_HISTOGRAM},
+	{"numa",	SF_ANALYSIS_NUMA},
+};
+
+void
+m_setanalysis(Engine *E, char *name, int enable)
+{
+	int	i, n, (*oldcycle)(Engine *, State *, int), (*oldfast)(Engine *, State *, int);
+	State	*S;
+	ulong	flag = 0;
+
+
+	n = sizeof(analyses)/sizeof(analyses[0]);
+	for (i = 0; i < n; i++)
+	{
+		if (!strcmp(name, analyses[i].name))
+		{
+			flag = analyses[i].flag;
+			break;
+		}
+	}
+
+	if (flag == 0)
+	{
+		merror(E, "Unknown analysis \"%s\".", name);
+		return;
+	}
+
+	if (enable)
+	{
+		sfanalyses |= flag;
+	}
+	else
+	{
+		sfanalyses &= ~flag;
+	}
+
+	/*								*/
+	/*	Allocate any state the analysis needs on existing nodes	*/
+	/*	and move them onto the step-loop instances for the new	*/
+	/*	set, keeping whichever of cycle/fast step was selected.	*/
+	/*								*/
+	for (i = 0; i < E->nnodes; i++)
+	{
+		S = E->sp[i];
+		if (S->analysisinit == NULL)
+		{
+			continue;
+		}
+
+		oldcycle = S->cyclestep;
+		oldfast = S->faststep;
+		S->analysisinit(E, S);
+
+		if (S->step == oldcycle)
+		{
+			S->step = S->cyclestep;
+		}
+		else if (S->step == oldfast)
+		{
+			S->step = S->faststep;
+		}
+
+		if (S->sampler != NULL && S->sampler->savedstep == oldcycle)
+		{
+			S->sampler->savedstep = S->cyclestep;
+		}
+		else if (S->sampler != NULL && S->sampler->savedstep == oldfast)
+		{
+			S->sampler->savedstep = S->faststep;
+		}
+	}
+
+	mprint(E, NULL, siminfo, "Analyses enabled:");
+	for (i = 0; i < n; i++)
+	{
+		if (sfanalyses & analyses[i].flag)
+		{
+			mprint(E, NULL, siminfo, " %s", analyses[i].name);
+		}
+	}
+	mprint(E, NULL, siminfo, "\n");
+
+	return;
+}
+
+/*									*/
+/*	One line of host resource usage and simulated progress, in a	*/
+/*	fixed key=value form so that scripts (e.g., mkbench) can take	*/
+/*	differences between two HOSTSTATS lines of a run.		*/
+/*									*/
+void
+m_hoststats(Engine *E)
+{
+	int	i;
+	uvlong	instrs = 0, cycles = 0;
+	double	simtime = 0.0;
+
+
+	for (i = 0; i < E->nnodes; i++)
+	{
+		instrs += E->sp[i]->dyncnt;
+		cycles += E->sp[i]->ICLK;
+		simtime = max(simtime, E->sp[i]->TIME);
+	}
+
+	mprint(E, NULL, siminfo,
+		"hoststats walltime=%.6f usertime=%.6f maxrsskb=" ULONGFMT
+		" nodes=%d instrs=" UVLONGFMT " cycles=" UVLONGFMT " simtime=%.9E\n",
+		(double)(mwalltimeusecs() - E->startwallusecs)/1E6,
+		(double)musercputimeusecs()/1E6, mmaxrsskbytes(),
+		E->nnodes, instrs, cycles, simtime);
+
+	return;
+}
+
 void
 m_newnode(Engine *E, char *type, double x, double y, double z, char *trajfilename, int looptrajectory, int trajectoryrate)
 {
@@ -1153,6 +1458,20 @@ m_newnode(Engine *E, char *type, double x, double y, double z, char *trajfilenam
 	{
 		S = riscvnewstate(E, x, y, z, trajfilename);
 	}
+	else if (!strncmp(type, "msp430", strlen("msp430")))
+	{
+		/*							*/
+		/*	The MSP430 decode cache fills on first use (see	*/
+		/*	msp430dclookup()), so priming it just marks every	*/
+		/*	entry as not yet decoded.			*/
+		/*							*/
+		for (int i = 0; i < (sizeof(E->msp430DC)/sizeof(MSP430DCEntry)); i++)
+		{
+			E->msp430DC[i].dc_p.valid = 0;
+		}
+
+		S = msp430newstate(E, x, y, z, trajfilename);
+	}
 	else
 	{
 		merror(E, "Machine type \"%s\" not supported.", type);
@@ -1176,10 +1495,7 @@ m_newnode(Engine *E, char *type, double x, double y, double z, char *trajfilenam
 static void
 readnodetrajectory(Engine *E, State *S, char*trajfilename, int looptrajectory, int trajectoryrate)
 {
-	enum		{MAX_LINELEN = 1024};
-	char		c, buf[MAX_LINELEN], *ep = &c;
-	double		val;
-	int		tmpfd, linesread = 0;
+	Trajectory	*T;
 
 
 	S->trajfilename = mcalloc(E, strlen(trajfilename)+1, sizeof(char), SF_FILE_MACRO);
@@ -1190,206 +1506,19 @@ readnodetrajectory(Engine *E, State *S, char*trajfilename, int looptrajectory, i
 	}
 	strcpy(S->trajfilename, trajfilename);
 
-
-	tmpfd = mopen(S->trajfilename, M_OREAD);
-	linesread = 0;
-	while ((tmpfd  >= 0) && (mfgets(buf, MAX_LINELEN, tmpfd) != NULL))
+	/*								*/
+	/*	Nodes following the same trajectory file share one copy	*/
+	/*	of it; the mobility engine only ever reads it.		*/
+	/*								*/
+	T = mtrajectoryload(E, S->trajfilename);
+	if (T != NULL)
 	{
-		if ((strlen(buf) > 0) && buf[strlen(buf)-1] == '\n')
-		{
-			buf[strlen(buf)-1] = '\0';
-		}
-
-		val = strtod(buf, &ep);
-		if ((linesread == 0) && (*ep != '\0'))
-		{
-			merror(E, "Invalid \"# of records\" field (\"%s\") in trajectory file.", buf);
-			continue;
-		}
-
-		if (linesread == 0)
-		{
-			S->path.xloc = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.xloc == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.xloc.");
-				return;
-			}
-
-			S->path.yloc = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.yloc == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.yloc.");
-				return;
-			}
-
-			S->path.zloc = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.zloc == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.zloc.");
-				return;
-			}
-
-			S->path.rho = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.rho == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.rho.");
-				return;
-			}
-
-			S->path.theta = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.theta == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.theta.");
-				return;
-			}
-
-			S->path.phi = mcalloc(E, (int)val, sizeof(double), SF_FILE_MACRO);
-			if (S->path.phi == NULL)
-			{
-				merror(E, "Could not allocate memory for S->path.phi.");
-				return;
-			}
-
-			mprint(E, NULL, siminfo,
-				"[%d] records in trajectory file\n", (int)val);
-
-		}
-		else
-		{
-			int	i = 0;
-			char	*p;
-
-
-			for ((p = strtok(buf, " \n\t")); p; (p = strtok(NULL, " \n\t")), i++)
-			{
-				switch (i)
-				{
-					case 0:
-					{
-						S->path.xloc[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid xloc in trajectory file.");
-						}
-						break;
-					}
-
-					case 1:
-					{
-						S->path.yloc[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid yloc in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 2:
-					{
-						S->path.zloc[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid zloc in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 3:
-					{
-						S->path.rho[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid rho in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 4:
-					{
-						S->path.theta[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid theta in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 5:
-					{
-						S->path.phi[S->path.nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(E, "Invalid phi in trajectory file.");
-						}
-
-						break;
-					}
-
-					default:
-					{
-						merror(E, "Extra field in trajectory file.");
-					}
-
-				}
-			}
-			S->path.nlocations++;
-
-		}
-		linesread++;
+		S->path.trajectory = T;
+		S->path.nlocations = T->nlocations;
 	}
 	S->path.trajectory_rate = trajectoryrate;
 	S->path.looptrajectory = looptrajectory;
-
-	return;
-}
-
-void
-traj_feed(Engine *E)
-{
-	int	i;
-	State	*S;
-
-
-	/*	Similar to what we do in physics_feed: we interpolate		*/
-	for (i = 0; i < E->nnodes; i++)
-	{
-		S = E->sp[i];
-		if (S->path.nlocations > 1)
-		{
-			double	idx_low, idx_high, lskew, hskew;
-			double	idx_real = E->globaltimepsec * S->path.trajectory_rate;
-
-			if (idx_real >= (double) S->path.nlocations)
-			{
-				if (S->path.looptrajectory)
-				{
-					idx_real = fmod(idx_real, (double) S->path.nlocations);
-				}
-				else
-				{
-					idx_real = (double) (S->path.nlocations - 1);
-				}
-			}
-			idx_low = floor(idx_real);
-			idx_high = ceil(idx_real);
-
-			lskew = (idx_high - idx_real) / (idx_high - idx_low);
-			hskew = (idx_real - idx_low) / (idx_high - idx_low);
-
-			S->xloc	= lskew*S->path.xloc[(int)idx_low]	+ hskew*S->path.xloc[(int)idx_high];
-			S->yloc = lskew*S->path.yloc[(int)idx_low]	+ hskew*S->path.yloc[(int)idx_high];
-			S->zloc = lskew*S->path.zloc[(int)idx_low]	+ hskew*S->path.zloc[(int)idx_high];
-
-			S->rho	= lskew*S->path.rho[(int)idx_low]	+ hskew*S->path.rho[(int)idx_high];
-			S->theta= lskew*S->path.theta[(int)idx_low]	+ hskew*S->path.theta[(int)idx_high];
-			S->phi	= lskew*S->path.phi[(int)idx_low]	+ hskew*S->path.phi[(int)idx_high];
-		}
-	}
+	mmobilityadd(E, S);
 
 	return;
 }
@@ -1403,6 +1532,7 @@ m_powertotal(Engine *E)
 
 	for (i = 0; i < E->nnodes; i++)
 	{
+		power_materialize(E, E->sp[i]);
 		total_power += E->sp[i]->energyinfo.CPUEtot;
 		total_energy += E->sp[i]->energyinfo.CPUEtot/
 			(E->sp[i]->ICLK * E->sp[i]->CYCLETIME);
@@ -1461,8 +1591,8 @@ int
 m_find_numastack(ulong curfn, ulong curframe, ulong vaddr, Numa *N, int start, int count)
 {
 	int		x, y;
-	Numaregion	*a = N->regions[start];
-	Numaregion	*b = N->regions[start+count-1];
+	Numaregion	*a;
+	Numaregion	*b;
 
 	if (start < 0 || count <= 0 || (start+count) > N->count)
 	{
@@ -1745,10 +1875,60 @@ m_numaregion(Engine *E, char *name, ulong start, ulong end, long xlrlat,
 	return;
 }
 
+/*									*/
+/*	Print a value history to the console (or to S's log if tolog),	*/
+/*	formatted in blocks rather than with one mprint() or mlog()	*/
+/*	call, and so one allocation, per value. V is the traced node's	*/
+/*	value trace sink, if it has one.				*/
+/*									*/
+static void
+valuehistory(Engine *E, State *S, Vtrace *V, int tolog, char *pre, ulong *values, int n)
+{
+	char	buf[MAX_SIM_INFO_BUFSZ/2];
+	int	i, len = 0;
+
+
+	if ((n == 0) && (V != NULL))
+	{
+		len = msnprint(buf, sizeof(buf), "%s(streamed to \"%s\") ", pre, V->filename);
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		len += msnprint(&buf[len], sizeof(buf) - len, "%s" ULONGFMT " ", pre, values[i]);
+		if (len > sizeof(buf) - 128)
+		{
+			if (tolog)
+			{
+				mlog(E, S, "%s", buf);
+			}
+			else
+			{
+				mprint(E, NULL, siminfo, "%s", buf);
+			}
+			len = 0;
+		}
+	}
+
+	if (len > 0)
+	{
+		if (tolog)
+		{
+			mlog(E, S, "%s", buf);
+		}
+		else
+		{
+			mprint(E, NULL, siminfo, "%s", buf);
+		}
+	}
+
+	return;
+}
+
 void
 m_regtracerstats(Engine *E, State *S)
 {
-	int	i, j;
+	int	i;
 
 	for (i = 0; i < MAX_REG_TRACERS; i++)
 	{
@@ -1761,11 +1941,8 @@ m_regtracerstats(Engine *E, State *S)
 		mprint(E, NULL, siminfo, "%-20s 0x" UHLONGFMT "\n", "PCstart:", S->RT->regvts[i]->pcstart);
 		mprint(E, NULL, siminfo, "%-20s 0x" UHLONGFMT "\n", "Register:", S->RT->regvts[i]->regnum);
 		mprint(E, NULL, siminfo, "Value History: ");
-
-		for (j = 0; j < S->RT->regvts[i]->validx; j++)
-		{
-			mprint(E, NULL, siminfo, ULONGFMT " ", S->RT->regvts[i]->values[j]);
-		}
+
+		valuehistory(E, S, S->vtrace, 0, "", S->RT->regvts[i]->values, S->RT->regvts[i]->validx);
 		mprint(E, NULL, siminfo, "\n");
 	}
 
@@ -1880,7 +2057,7 @@ m_addvaluetrace(Engine *E, State *S, char *tag, ulong addr, int size, int onstac
 void
 m_delvaluetrace(Engine *E, State *S, char *tag, ulong addr, int size, int onstack, ulong pcstart, int frameoffset, int ispointer)
 {
-	int	i, j;
+	int	i;
 
 	for (i = 0; i < S->Nstack->count; i++)
 	{
@@ -1907,10 +2084,7 @@ m_delvaluetrace(Engine *E, State *S, char *tag, ulong addr, int size, int onstac
 			mlog(E, S, "%-20s %d\n", "Read accesses:", S->Nstack->regions[i]->nreads);
 			mlog(E, S, "%-20s %d\n\n", "Write accesses:", S->Nstack->regions[i]->nwrites);
 			mlog(E, S, "Value History: ");
-			for (j = 0; j < S->Nstack->regions[i]->validx; j++)
-			{
-				mlog(E, S, ULONGFMT " ", S->Nstack->regions[i]->values[j]);
-			}
+			valuehistory(E, S, S->vtrace, 1, "", S->Nstack->regions[i]->values, S->Nstack->regions[i]->validx);
 			mlog(E, S, "\n");
 
 			mfree(E, S->Nstack->regions[i], "S->Nstack->regions in m_delvaluetrace");
@@ -1945,10 +2119,7 @@ m_delvaluetrace(Engine *E, State *S, char *tag, ulong addr, int size, int onstac
 			mlog(E, S, "%-20s %d\n", "Read accesses:", S->N->regions[i]->nreads);
 			mlog(E, S, "%-20s %d\n\n", "Write accesses:", S->N->regions[i]->nwrites);
 			mlog(E, S, "Value History: ");
-			for (j = 0; j < S->N->regions[i]->validx; j++)
-			{
-				mlog(E, S, ULONGFMT " ", S->N->regions[i]->values[j]);
-			}
+			valuehistory(E, S, S->vtrace, 1, "", S->N->regions[i]->values, S->N->regions[i]->validx);
 			mlog(E, S, "\n");
 
 			mfree(E, S->N->regions[i], "S->N->regions in m_delvaluetrace");
@@ -1966,7 +2137,7 @@ m_delvaluetrace(Engine *E, State *S, char *tag, ulong addr, int size, int onstac
 void
 m_valuestats(Engine *E, State *S)
 {
-	int	i, j;
+	int	i;
 
 	for (i = 0; i < S->Nstack->count; i++)
 	{
@@ -1992,10 +2163,7 @@ m_valuestats(Engine *E, State *S)
 
 		mprint(E, NULL, siminfo, "Value History: ");
 
-		for (j = 0; j < S->Nstack->regions[i]->validx; j++)
-		{
-			mprint(E, NULL, siminfo, ULONGFMT " ", S->Nstack->regions[i]->values[j]);
-		}
+		valuehistory(E, S, S->vtrace, 0, "", S->Nstack->regions[i]->values, S->Nstack->regions[i]->validx);
 		mprint(E, NULL, siminfo, "\n");
 	}
 
@@ -2022,10 +2190,7 @@ m_valuestats(Engine *E, State *S)
 
 		mprint(E, NULL, siminfo, "Value History: ");
 
-		for (j = 0; j < S->N->regions[i]->validx; j++)
-		{
-			mprint(E, NULL, siminfo, ULONGFMT " ", S->N->regions[i]->values[j]);
-		}
+		valuehistory(E, S, S->vtrace, 0, "", S->N->regions[i]->values, S->N->regions[i]->validx);
 		mprint(E, NULL, siminfo, "\n");
 	}
 
@@ -2118,6 +2283,19 @@ m_sizemem(Engine *E, State *S, int size)
 		uncertain_sizemem(E, S, size);
 	}
 
+	mmemmapsetram(E, S);
+
+	/*							*/
+	/*	MEM may have moved: drop the translations, and	*/
+	/*	stop sharing a cache with nodes that mapped the	*/
+	/*	old MEM.					*/
+	/*							*/
+	if (S->superH != NULL)
+	{
+		superHsbflush(E, S);
+		superHsbunshare(E, S);
+	}
+
 	/*
 	*	Shadow/taintmemory reallocation:
 	*/
@@ -2169,6 +2347,24 @@ m_run(Engine *E, State *S, char *args)
 	ulong	argvptroffset;
 
 
+	/*	Descriptors left open by a previous program	*/
+	mvfsresetnode(E, S);
+
+	/*							*/
+	/*	MSP430 images set up their own stack from the	*/
+	/*	reset handler, and there is no argv convention	*/
+	/*	for 16-bit pointers, so args are not passed.	*/
+	/*							*/
+	if (S->machinetype == MACHINE_MSP430)
+	{
+		mprint(E, S, nodeinfo, "args = [%s] (not passed on MSP430)\n", args);
+
+		S->runnable = 1;
+		mprint(E, S, nodeinfo, "Running...\n\n");
+
+		return;
+	}
+
 	argstrlen = strlen(args)+1;
 	if ((ARGVOFFSET + argstrlen) > S->MEMSIZE)
 	{
@@ -2299,14 +2495,16 @@ m_on(Engine *E, State *S)
 	}
 
 	E->on = 1;
-	if (E->nodetach)
+	if (E->nodetach || E->batch)
 	{
 		scheduler(E);
 	}
 	else
 	{
+		mcmdqueuestart(E);
 		if (mspawnscheduler(E) < 0)
 		{
+			mcmdqueuestop(E);
 			sfatal(E, S, "Could not create thread in ON call");
 		}
 	}
@@ -2386,7 +2584,7 @@ m_sharebus(Engine *E, State *S, int donorid)
 void
 m_dumpnode(Engine *E, int i, char *filename, int mode, char *tag, char *pre)
 {
-	int	j, k;
+	int	j;
 	State	tmp, *S;
 	int	txok = 0, rxok = 0, addrerr = 0, frmerr = 0,
 		collserr = 0, csenseerr = 0, rxovrnerr = 0,
@@ -2443,6 +2641,7 @@ m_dumpnode(Engine *E, int i, char *filename, int mode, char *tag, char *pre)
 		mlog(E, S, "%sNode%d\t\tNTRANS\t=\t" UVLONGFMT "\n",
 			pre, X->NODE_ID,
 			X->energyinfo.ntrans);
+		power_materialize(E, X);
 		mlog(E, S, "%sNode%d\t\tCPU-only ETOT\t=\t%.6E Joules\n",
 			pre, X->NODE_ID,
 			X->energyinfo.CPUEtot);
@@ -2688,10 +2887,7 @@ m_dumpnode(Engine *E, int i, char *filename, int mode, char *tag, char *pre)
 				pre, X->Nstack->regions[j]->nwrites);
 
 			mlog(E, S, "%sValue History: ", pre);
-			for (k = 0; k < X->Nstack->regions[j]->validx; k++)
-			{
-				mlog(E, S, "%s" ULONGFMT " ", pre, X->Nstack->regions[j]->values[k]);
-			}
+			valuehistory(E, S, X->vtrace, 1, pre, X->Nstack->regions[j]->values, X->Nstack->regions[j]->validx);
 			mlog(E, S, "%s\n", pre);
 		}
 
@@ -2727,10 +2923,7 @@ m_dumpnode(Engine *E, int i, char *filename, int mode, char *tag, char *pre)
 				pre, X->N->regions[j]->nwrites);
 
 			mlog(E, S, "%sValue History: ", pre);
-			for (k = 0; k < X->N->regions[j]->validx; k++)
-			{
-				mlog(E, S, "%s" ULONGFMT " ", pre, X->N->regions[j]->values[k]);
-			}
+			valuehistory(E, S, X->vtrace, 1, pre, X->N->regions[j]->values, X->N->regions[j]->validx);
 			mlog(E, S, "%s\n", pre);
 		}
 
@@ -2744,10 +2937,7 @@ m_dumpnode(Engine *E, int i, char *filename, int mode, char *tag, char *pre)
 				X->RT->regvts[j]->regnum);
 
 			mlog(E, S, "%sValue History: ", pre);
-			for (k = 0; k < X->RT->regvts[j]->validx; k++)
-			{
-				mlog(E, S, "%s" ULONGFMT " ", pre, X->RT->regvts[j]->values[k]);
-			}
+			valuehistory(E, S, X->vtrace, 1, pre, X->RT->regvts[j]->values, X->RT->regvts[j]->validx);
 			mlog(E, S, "%s\n", pre);
 		}
 	}
@@ -2807,6 +2997,12 @@ m_dumpall(Engine *E, char *filename, int mode, char *tag, char *pre)
 		mlog(E, S, "%s\tE->battperiodpsec="UVLONGFMT"\n", pre, E->battperiodpsec);
 		mlog(E, S, "%s\n", pre);
 	}
+
+	if (SF_SIMPROFILE && (E->simprof.enabled || E->simprof.totalticks != 0))
+	{
+		msimprofreport(E, S, pre);
+		mlog(E, S, "%s\n", pre);
+	}
 	mlog(E, S, "%s} Tag %s.\n", pre, tag);
 	mclose(S->logfd);
 
@@ -2866,6 +3062,108 @@ getbptidx(Engine *E)
 	return -1;
 }
 
+/*									*/
+/*	Rebuild S's breakpoint index from the breakpoint list, after	*/
+/*	a breakpoint on S is added, deleted or reached.			*/
+/*									*/
+static void
+bptreindex(Engine *E, State *S)
+{
+	Bptindex	*X = &S->bptindex;
+	Breakpoint	*b;
+	uchar		*map;
+	ulong		page;
+	int		i;
+
+
+	X->nextclk = BPT_NEVER;
+	X->nextdyncnt = BPT_NEVER;
+	X->npc = X->nreads = X->nwrites = 0;
+	if (X->pcpages != NULL)
+	{
+		memset(X->pcpages, 0, kBptBitmapBytes);
+		memset(X->readpages, 0, kBptBitmapBytes);
+		memset(X->writepages, 0, kBptBitmapBytes);
+	}
+
+	for (i = 0; i < E->nvalidbpts; i++)
+	{
+		b = &E->bpts[E->validbpts[i]];
+		switch (b->type)
+		{
+			case BPT_CYCLES:
+			{
+				if ((b->cyclesbpt.nodeid == S->NODE_ID) && (b->cyclesbpt.cycles > S->ICLK))
+				{
+					X->nextclk = min(X->nextclk, b->cyclesbpt.cycles);
+				}
+
+				break;
+			}
+
+			case BPT_INSTRS:
+			{
+				if ((b->instrsbpt.nodeid == S->NODE_ID) && (b->instrsbpt.dyncnt > S->dyncnt))
+				{
+					X->nextdyncnt = min(X->nextdyncnt, b->instrsbpt.dyncnt);
+				}
+
+				break;
+			}
+
+			case BPT_PC:
+			case BPT_READS:
+			case BPT_WRITES:
+			{
+				if (b->addrbpt.nodeid != S->NODE_ID)
+				{
+					break;
+				}
+
+				if (X->pcpages == NULL)
+				{
+					X->pcpages = (uchar *)mcalloc(E, kBptBitmapBytes, sizeof(uchar), "X->pcpages in main.c");
+					X->readpages = (uchar *)mcalloc(E, kBptBitmapBytes, sizeof(uchar), "X->readpages in main.c");
+					X->writepages = (uchar *)mcalloc(E, kBptBitmapBytes, sizeof(uchar), "X->writepages in main.c");
+					if ((X->pcpages == NULL) || (X->readpages == NULL) || (X->writepages == NULL))
+					{
+						mexit(E, "Could not allocate memory for breakpoint page bitmaps.", -1);
+					}
+				}
+
+				if (b->type == BPT_PC)
+				{
+					map = X->pcpages;
+					X->npc++;
+				}
+				else if (b->type == BPT_READS)
+				{
+					map = X->readpages;
+					X->nreads++;
+				}
+				else
+				{
+					map = X->writepages;
+					X->nwrites++;
+				}
+
+				for (page = b->addrbpt.addr >> kBptPageShift;
+					page <= (b->addrbpt.addr + b->addrbpt.size - 1) >> kBptPageShift; page++)
+				{
+					map[page >> 3] |= 1 << (page & 7);
+				}
+
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	return;
+}
+
 void
 m_setbptglobaltime(Engine *E, Picosec t)
 {
@@ -2882,6 +3180,7 @@ m_setbptglobaltime(Engine *E, Picosec t)
 	E->bpts[idx].valid	= 1;
 
 	E->validbpts[E->nvalidbpts++] = idx;
+	E->npolledbpts++;
 }
 
 void
@@ -2901,6 +3200,7 @@ m_setbptcycles(Engine *E, State *S, uvlong n)
 	E->bpts[idx].valid		= 1;
 
 	E->validbpts[E->nvalidbpts++] = idx;
+	bptreindex(E, S);
 }
 
 void
@@ -2920,6 +3220,7 @@ m_setbptinstrs(Engine *E, State *S, uvlong n)
 	E->bpts[idx].valid		= 1;
 
 	E->validbpts[E->nvalidbpts++] = idx;
+	bptreindex(E, S);
 }
 
 void
@@ -2946,6 +3247,55 @@ m_setbptsensorreading(Engine *E, State *S, int whichsensor, double val)
 	E->bpts[idx].valid			= 1;
 
 	E->validbpts[E->nvalidbpts++] = idx;
+	E->npolledbpts++;
+}
+
+void
+m_setbptpc(Engine *E, State *S, ulong pc)
+{
+	int	idx;
+
+	if ((idx = getbptidx(E)) < 0)
+	{
+		mprint(E, NULL, siminfo, "Maximum number of breakpoints reached...");
+		return;
+	}
+
+	E->bpts[idx].type		= BPT_PC;
+	E->bpts[idx].addrbpt.nodeid	= S->NODE_ID;
+	E->bpts[idx].addrbpt.addr	= pc;
+	E->bpts[idx].addrbpt.size	= 1;
+	E->bpts[idx].valid		= 1;
+
+	E->validbpts[E->nvalidbpts++] = idx;
+	bptreindex(E, S);
+}
+
+void
+m_setbptwatch(Engine *E, State *S, Breaktype type, ulong addr, ulong size)
+{
+	int	idx;
+
+	if ((idx = getbptidx(E)) < 0)
+	{
+		mprint(E, NULL, siminfo, "Maximum number of breakpoints reached...");
+		return;
+	}
+
+	if ((size == 0) || (addr + size - 1 < addr))
+	{
+		mprint(E, NULL, siminfo, "Invalid watchpoint address range...");
+		return;
+	}
+
+	E->bpts[idx].type		= type;
+	E->bpts[idx].addrbpt.nodeid	= S->NODE_ID;
+	E->bpts[idx].addrbpt.addr	= addr;
+	E->bpts[idx].addrbpt.size	= size;
+	E->bpts[idx].valid		= 1;
+
+	E->validbpts[E->nvalidbpts++] = idx;
+	bptreindex(E, S);
 }
 
 void
@@ -2986,6 +3336,26 @@ printbpt(Engine *E, Breakpoint *b)
 			break;
 		}
 
+		case BPT_PC:
+		{
+			State	*tmp = E->sp[b->addrbpt.nodeid];
+
+			mprint(E, tmp, nodeinfo, "Node %d PC breakpoint\t@\tPC=0x" UHLONGFMT "\n",
+				b->addrbpt.nodeid, b->addrbpt.addr);
+			break;
+		}
+
+		case BPT_READS:
+		case BPT_WRITES:
+		{
+			State	*tmp = E->sp[b->addrbpt.nodeid];
+
+			mprint(E, tmp, nodeinfo, "Node %d %s watchpoint\t@\t0x" UHLONGFMT " (" ULONGFMT " bytes)\n",
+				b->addrbpt.nodeid, (b->type == BPT_READS ? "read" : "write"),
+				b->addrbpt.addr, b->addrbpt.size);
+			break;
+		}
+
 		default:
 			merror(E, "Sanity check failed on a registered breakpoint...");
 	}
@@ -3010,7 +3380,8 @@ m_bptls(Engine *E)
 void
 m_bptdel(Engine *E, int which)
 {
-	int	i;
+	int		i;
+	Breakpoint	*b;
 
 	if ((which >= MAX_BREAKPOINTS) || (which < 0) || !E->bpts[which].valid)
 	{
@@ -3018,19 +3389,152 @@ m_bptdel(Engine *E, int which)
 		return;
 	}
 
-	E->bpts[which].valid = 0;
+	b = &E->bpts[which];
+	b->valid = 0;
 
 	for (i = 0; i < E->nvalidbpts; i++)
 	{
 		if (E->validbpts[i] == which)
 		{
-			E->validbpts[i] = E->validbpts[E->nvalidbpts];
+			E->validbpts[i] = E->validbpts[E->nvalidbpts - 1];
 			E->nvalidbpts--;
 
 			break;
 		}
 	}
 
+	switch (b->type)
+	{
+		case BPT_GLOBALTIME:
+		case BPT_SENSORREADING:
+		{
+			E->npolledbpts--;
+			break;
+		}
+
+		case BPT_CYCLES:
+		{
+			bptreindex(E, E->sp[b->cyclesbpt.nodeid]);
+			break;
+		}
+
+		case BPT_INSTRS:
+		{
+			bptreindex(E, E->sp[b->instrsbpt.nodeid]);
+			break;
+		}
+
+		default:
+		{
+			bptreindex(E, E->sp[b->addrbpt.nodeid]);
+			break;
+		}
+	}
+
+	return;
+}
+
+/*									*/
+/*	Called from sched_step() once S reaches the nearest cycle or	*/
+/*	instruction breakpoint in its index.				*/
+/*									*/
+static void
+bptnodehit(Engine *E, State *S)
+{
+	Breakpoint	*b;
+	int		i, hit;
+
+
+	for (i = 0; i < E->nvalidbpts; i++)
+	{
+		b = &E->bpts[E->validbpts[i]];
+		if (b->type == BPT_CYCLES)
+		{
+			hit = (b->cyclesbpt.nodeid == S->NODE_ID)
+				&& (b->cyclesbpt.cycles >= S->bptindex.nextclk)
+				&& (b->cyclesbpt.cycles <= S->ICLK);
+		}
+		else if (b->type == BPT_INSTRS)
+		{
+			hit = (b->instrsbpt.nodeid == S->NODE_ID)
+				&& (b->instrsbpt.dyncnt >= S->bptindex.nextdyncnt)
+				&& (b->instrsbpt.dyncnt <= S->dyncnt);
+		}
+		else
+		{
+			continue;
+		}
+
+		if (hit)
+		{
+			mprint(E, S, nodeinfo, "\n\nNode %d breakpoint hit:\n\t%d\t", S->NODE_ID, E->validbpts[i]);
+			printbpt(E, b);
+			E->on = 0;
+		}
+	}
+	bptreindex(E, S);
+
+	return;
+}
+
+/*									*/
+/*	S has arrived at pc, on a page holding a PC breakpoint.		*/
+/*	Returns 1, having stopped the simulation, if there is a	*/
+/*	breakpoint at pc; the step loop then stops before executing	*/
+/*	the instruction there.						*/
+/*									*/
+int
+mbptpc(Engine *E, State *S, ulong pc)
+{
+	Breakpoint	*b;
+	int		i;
+
+
+	for (i = 0; i < E->nvalidbpts; i++)
+	{
+		b = &E->bpts[E->validbpts[i]];
+		if ((b->type == BPT_PC) && (b->addrbpt.nodeid == S->NODE_ID) && (b->addrbpt.addr == pc))
+		{
+			mprint(E, S, nodeinfo, "\n\nNode %d breakpoint hit:\n\t%d\t", S->NODE_ID, E->validbpts[i]);
+			printbpt(E, b);
+			E->on = 0;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*									*/
+/*	S accesses size bytes at addr, on a watched page. The access	*/
+/*	completes, and the step loop stops after the instruction.	*/
+/*	Read watchpoints also see instruction fetches.			*/
+/*									*/
+void
+mbptwatch(Engine *E, State *S, ulong addr, int size, Breaktype type)
+{
+	Breakpoint	*b;
+	int		i;
+
+
+	for (i = 0; i < E->nvalidbpts; i++)
+	{
+		b = &E->bpts[E->validbpts[i]];
+		if ((b->type == type) && (b->addrbpt.nodeid == S->NODE_ID)
+			&& (addr <= b->addrbpt.addr + b->addrbpt.size - 1)
+			&& (b->addrbpt.addr <= addr + size - 1))
+		{
+			mprint(E, S, nodeinfo, "\n\nNode %d watchpoint hit (%s of %d bytes at 0x" UHLONGFMT "):\n\t%d\t",
+				S->NODE_ID, (type == BPT_READS ? "read" : "write"), size,
+				addr, E->validbpts[i]);
+			printbpt(E, b);
+			E->on = 0;
+
+			return;
+		}
+	}
+
 	return;
 }
 
@@ -3040,6 +3544,7 @@ m_setloc(Engine *E, State *S, double x, double y, double z)
 	S->xloc = x;
 	S->yloc = y;
 	S->zloc = z;
+	S->locversion++;
 
 	m_locstats(E, S);
 
@@ -3052,6 +3557,9 @@ m_locstats(Engine *E, State *S)
 	mprint(E, NULL, siminfo, "Location  = [%E][%E][%E]\n", S->xloc, S->yloc, S->zloc);
 }
 
+/*									*/
+/*	Poll the breakpoints that cannot be indexed per node.		*/
+/*									*/
 tuck void
 bpts_feed(Engine *E)
 {
@@ -3077,34 +3585,6 @@ bpts_feed(Engine *E)
 				break;
 			}
 
-			case BPT_CYCLES:
-			{
-				tmp = E->sp[b->cyclesbpt.nodeid];
-
-				if (tmp->runnable && tmp->ICLK >= b->cyclesbpt.cycles)
-				{
-					mprint(E, tmp, nodeinfo, "\n\nNode %d breakpoint hit:\n\t%d\t", b->cyclesbpt.nodeid, E->validbpts[i]);
-					printbpt(E, &E->bpts[E->validbpts[i]]);
-					E->on = 0;
-				}
-
-				break;
-			}
-
-			case BPT_INSTRS:
-			{
-				tmp = E->sp[b->instrsbpt.nodeid];
-
-				if (tmp->runnable && tmp->dyncnt >= b->instrsbpt.dyncnt)
-				{
-					mprint(E, tmp, nodeinfo, "\n\nNode %d breakpoint hit:\n\t%d\t", b->instrsbpt.nodeid, E->validbpts[i]);
-					printbpt(E, &E->bpts[E->validbpts[i]]);
-					E->on = 0;
-				}
-
-				break;
-			}
-
 			case BPT_SENSORREADING:
 			{
 				tmp = E->sp[b->instrsbpt.nodeid];
@@ -3119,8 +3599,9 @@ bpts_feed(Engine *E)
 				break;
 			}
 
+			/*	Cycle, instruction, PC and watch breakpoints are indexed per node	*/
 			default:
-				merror(E, "Sanity check failed on a registered breakpoint...");
+				break;
 		}
 	}
-};
+}
@@ -211,8 +211,67 @@ typedef enum
 	BPT_GLOBALTIME,
 	BPT_INSTRS,
 	BPT_SENSORREADING,
+	BPT_PC,
+	BPT_READS,
+	BPT_WRITES,
 } Breaktype;
 
+/*									*/
+/*	Per-node index of the breakpoints on that node. Cycle and	*/
+/*	instruction breakpoints become the nearest counts not yet	*/
+/*	reached, which cap the node's quantum in sched_step(), so	*/
+/*	they are neither polled nor overshot. PC breakpoints and	*/
+/*	watchpoints mark their pages in bitmaps, allocated on first	*/
+/*	use; the step loops and memory accessors test the bitmap	*/
+/*	only while the node has such breakpoints, and search the	*/
+/*	breakpoint list only on a marked page.				*/
+/*									*/
+enum
+{
+	kBptPageShift	= 12,
+	kBptBitmapBytes	= (1UL << (32 - kBptPageShift)) / 8,
+};
+
+#define	BPT_NEVER	(~(uvlong)0)
+
+typedef struct
+{
+	uvlong		nextclk;
+	uvlong		nextdyncnt;
+
+	int		npc;
+	int		nreads;
+	int		nwrites;
+	uchar		*pcpages;
+	uchar		*readpages;
+	uchar		*writepages;
+
+	/*	A PC breakpoint hits on arriving at its address, so	*/
+	/*	resuming from it does not hit again straight away	*/
+	ulong		lastpc;
+} Bptindex;
+
+#define	bptpage(map, addr)	(((map)[((ulong)(addr)) >> (kBptPageShift + 3)] >> ((((ulong)(addr)) >> kBptPageShift) & 7)) & 1)
+
+#define	bptpchook(E, S, pc)\
+	((S)->bptindex.npc && ((pc) != (S)->bptindex.lastpc)\
+		&& ((S)->bptindex.lastpc = (pc), bptpage((S)->bptindex.pcpages, (pc)))\
+		&& mbptpc((E), (S), (pc)))
+
+#define	bptreadhook(E, S, addr, size)\
+	if ((S)->bptindex.nreads && (bptpage((S)->bptindex.readpages, (addr))\
+		|| bptpage((S)->bptindex.readpages, (addr) + (size) - 1)))\
+	{\
+		mbptwatch((E), (S), (addr), (size), BPT_READS);\
+	}
+
+#define	bptwritehook(E, S, addr, size)\
+	if ((S)->bptindex.nwrites && (bptpage((S)->bptindex.writepages, (addr))\
+		|| bptpage((S)->bptindex.writepages, (addr) + (size) - 1)))\
+	{\
+		mbptwatch((E), (S), (addr), (size), BPT_WRITES);\
+	}
+
 typedef enum
 {
 	kSunflowerTaintModeLiberal,
@@ -307,6 +366,10 @@ typedef struct
 	/*		Resized at runtime		*/
 	int		nvalues;
 
+	/*	Record id and last value in a value trace file	*/
+	int		vtraceid;
+	ulong		vtracelast;
+
 
 	/*	Access Statistics			*/
 	ulong		nreads;
@@ -336,6 +399,10 @@ typedef struct
 	int		nvalues;
 	int		ndevns;
 
+	/*	Record id and last value in a value trace file	*/
+	int		vtraceid;
+	ulong		vtracelast;
+
 	ulong		pcstart;
 } Regvt;
 
@@ -451,15 +518,19 @@ struct SEEstruct
 	/*	differently.			*/
 	/*					*/
 	int		bit_offset;
-
-
-	SEEstruct	*next;
 };
 
 typedef struct
 {
-	SEEstruct	*hd;
-	SEEstruct	*tl;
+	/*					*/
+	/*	Registered structures, in	*/
+	/*	order of logical_offset, for	*/
+	/*	a binary search on a logical	*/
+	/*	bit.				*/
+	/*					*/
+	SEEstruct	**structs;
+	int		nstructs;
+	int		maxstructs;
 
 	int		logical_bits;
 	int		actual_bits;
@@ -488,13 +559,7 @@ typedef struct
 
 typedef struct
 {
-	double		*xloc;
-	double		*yloc;
-	double		*zloc;
-
-	double		*rho;
-	double		*theta;
-	double		*phi;
+	Trajectory	*trajectory;
 
 	int		nlocations;
 	int		trajectory_rate;
@@ -559,7 +624,7 @@ struct State
 
 	/*	Instruction-level power analysis	*/
 	EnergyInfo	energyinfo;
-	double		scaledcurrents[SUPERH_OP_MAX];/*	Currently, power data is only for superH	*/
+	double		scaledcurrents[ENERGY_NOPCODES];/*	Currently, power data is only for superH	*/
 
 	/*		The operating voltage.		*/
 	double		VDD;
@@ -605,6 +670,13 @@ struct State
 	uvlong		last_stepclks;
 	double		TIME;
 	double		CYCLETIME;
+
+	/*							*/
+	/*	Cycles run by the fast step loops in the current	*/
+	/*	step but not yet added to TIME. Anything reading	*/
+	/*	the node's time mid-step adds them in.		*/
+	/*							*/
+	int		pendingcycles;
 	uvlong		dyncnt;
 	uvlong		nfetched;
 
@@ -629,12 +701,32 @@ struct State
 	Pdist		failure_duration_dist;
 	uvlong		failure_duration_max;
 	uvlong		fail_clocks_left;
+	uvlong		faultnextfeed;
 	int		got_correlated_failure;
 	uvlong		nfaults;
 	uvlong		faultthreshold;
 	int		ENABLE_TOO_MANY_FAULTS;
 	SEEstate*	SEEmodeling;
 
+	/*	Per-node random streams, indexed by SunflowerRandstreamKind	*/
+	Randstream	randstreams[kSunflowerRandstreamMax];
+
+	/*	Sampled simulation controller, NULL until first SAMPLE	*/
+	Sampler		*sampler;
+
+	/*	Guest PC profile and function symbols, see pcprofile.h	*/
+	Pcprofile	*pcprof;
+	Pcsymtab	*symtab;
+
+	/*		Physical memory map, see memmap.h		*/
+	Memmap		*memmap;
+
+	/*	Streaming value trace sink; NULL to keep traces in memory	*/
+	Vtrace		*vtrace;
+
+	/*	Guest file descriptors, indexed by fd; see vfs.h	*/
+	Vfsfd		vfsfds[kSunflowerVfsMaxfds];
+
 	/*			Division off SIM_GLOBAL_CLOCK		*/
 	int		clock_modulus;
 
@@ -674,6 +766,11 @@ struct State
 	double		phi;
 	Path		path;
 
+	/*	Bumped on every change of position; see mobility.h	*/
+	uvlong		locversion;
+
+	Bptindex	bptindex;
+
 	/*			Trajectory/headings input		*/
 	char		*trajfilename;
 
@@ -702,8 +799,12 @@ struct State
 	int		(*cyclestep)(Engine *, State *, int);
 	int		(*faststep)(Engine *, State *, int);
 
+	/*	Allocates state for, and binds the step loops to, the	*/
+	/*	analyses enabled in sfanalyses. Safe to call again.	*/
+	void		(*analysisinit)(Engine *, State *);
+
 	/*	Pointer to function for failure prob dist		*/
-	uvlong		(*pfun)(void *, void *, char *, uvlong);
+	uvlong		(*pfun)(Engine *, State *, FaultDraw, uvlong);
 
 	/*	The routines to handle the different interrupts		*/
 	int		(*take_timer_intr)(Engine *, State *S);
@@ -728,6 +829,7 @@ struct State
 	void		(*dumphistpretty)(Engine *, State *S, int histogram_id);
 	void		(*ldhistrandom)(Engine *, State *S, int histogram_id);
 	void		(*addhist)(Engine *, State *S, int histogram_id0, int histogram_id1, int histogram_id2);
+	void		(*sethistformat)(Engine *, State *S, int nbins, char *bintype);
 
 	/*	Memory mapped device register read/write functions	*/
 	uchar		(*devreadbyte)(Engine *, State *S, ulong addr);
@@ -782,6 +884,13 @@ typedef struct
 			double	value;
 		} sensorreadingbpt;
 
+		struct
+		{
+			int	nodeid;
+			ulong	addr;
+			ulong	size;
+		} addrbpt;
+
 		Picosec	globaltime;
 	};
 } Breakpoint;
@@ -804,15 +913,32 @@ struct Engine
 	/*		Do not spawn new thread on 'ON' command		*/
 	int		nodetach;
 
+	/*	Console input for, and snapshot from, the scheduler	*/
+	Cmdqueue	cmdqueue;
+
+	/*	Headless run: 'ON' always runs on the calling thread,	*/
+	/*	and the process exits with the guest's exit status.	*/
+	int		batch;
+	int		exitstatus;
+
 
 	/*	Throttling simulation speed in distributed sim.		*/
 	ulong		throttlensec;
 	ulong		throttlewin;
 
+	/*	Host wall-clock time at engine creation, for HOSTSTATS	*/
+	uvlong		startwallusecs;
+
+	/*	Host-side profile of the simulator, for SIMPROFILE	*/
+	Simprofile	simprof;
+
 	/*		Random number generator per-node state		*/
 	uvlong		*randgen_mt;
 	int		randgen_mti;
 
+	/*	Engine-wide counter-based streams (scheduling, rvars)	*/
+	Randstream	randstreams[kSunflowerRandstreamMax];
+
 	/*		Table-based rnum generation			*/
 	RandTable	randtabs[MAX_RANDTABLEENTRIES];
 	int		nrandtabs;
@@ -829,6 +955,18 @@ struct Engine
 	State		*cp;			/*	pointer to current	*/
 	int		cn;			/*	current node id		*/
 
+	/*	Trajectory files loaded so far, shared between nodes	*/
+	Trajectory	*trajectories;
+
+	/*	Nodes moving along their trajectories			*/
+	Mobility	mobility;
+
+	/*	Files opened by guests, shared between nodes		*/
+	Vfsfile		*vfsfiles;
+
+	/*	Memory controllers of shared buses			*/
+	Bus		*buses;
+
 	/*		Miscellaneous whole-simulation state		*/
 	int		quantum;		/*	sim quantum		*/
 	int		scanning;
@@ -851,14 +989,31 @@ struct Engine
 	Picosec		fperiodpsec;
 	Picosec		flastpsec;
 
+	/*	Fault feeds so far, the last one that did any work,	*/
+	/*	and the next one with a fault or recovery scheduled	*/
+	uvlong		faultfeeds;
+	uvlong		faultlastfeed;
+	uvlong		faultnextfeed;
+	int		nSEEnodes;
+
 	/*				Network				*/
 	Netsegment	netsegs[MAX_NETSEGMENTS];
 	int		nnetsegs;
 	int		activensegs[MAX_NETSEGMENTS];
 	int		nactivensegs;
 	uvlong		nicsimbytes;
-	char		netiobuf[MAX_NETIO_NBUFS][MAX_SEGBUF_TEXT];
+	Netbufpool	netbufpool;
+
+	/*								*/
+	/*	Text renderings of recent segment traffic for netout.	*/
+	/*	Only kept once netout has been opened (netiotap), and	*/
+	/*	each buffer is grown to the frames actually seen.	*/
+	/*								*/
+	char		*netiobuf[MAX_NETIO_NBUFS];
+	int		netiobufsz[MAX_NETIO_NBUFS];
+	int		netiolen[MAX_NETIO_NBUFS];
 	int		netioh2o;
+	int		netiotap;
 
 	/*								*/
 	/*	At 8 Mb/s, each byte is transferred in 1 us, thus	*/
@@ -891,6 +1046,12 @@ struct Engine
 	int		verbose;
 	Picosec		battlastpsec;
 	Picosec		battperiodpsec;
+	BattBank	battbank;
+
+	/*	Adaptive feed period: 0 battdsoc disables	*/
+	double		battdsoc;
+	Picosec		battperiodmin;
+	Picosec		battperiodmax;
 	Picosec		dumplastpsec;
 	Picosec		dumpperiodpsec;
 
@@ -913,6 +1074,9 @@ struct Engine
 	int		validbpts[MAX_BREAKPOINTS];
 	int		nvalidbpts;
 
+	/*	Global time and sensor breakpoints, which are polled	*/
+	int		npolledbpts;
+
 	char		*logfilename;
 };
 
@@ -0,0 +1,335 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static Memmappage*	mmemmappage(Engine *E, Memmap *M, uvlong addr);
+static int		mmemmapoverlaps(Memmap *M, uvlong base, uvlong end);
+static void		mmemmapclear(Engine *E, Memmap *M);
+
+
+/*									*/
+/*	Empty the node's memory map and map its RAM. Devices are	*/
+/*	added by the caller afterwards, e.g., devsimregister().		*/
+/*									*/
+void
+mmemmapinit(Engine *E, State *S)
+{
+	if (S->memmap == NULL)
+	{
+		S->memmap = (Memmap *)mcalloc(E, 1, sizeof(Memmap), "S->memmap");
+		if (S->memmap == NULL)
+		{
+			mexit(E, "Could not allocate memory for S->memmap", -1);
+		}
+	}
+	else
+	{
+		mmemmapclear(E, S->memmap);
+	}
+
+	mmemmapsetram(E, S);
+
+	return;
+}
+
+/*									*/
+/*	(Re)map the RAM region after S->MEMBASE or S->MEMSIZE change.	*/
+/*									*/
+void
+mmemmapsetram(Engine *E, State *S)
+{
+	Memregion	R;
+
+
+	if (S->memmap == NULL)
+	{
+		return;
+	}
+
+	if (S->memmap->ram != NULL)
+	{
+		mmemmapunregister(E, S, S->memmap->ram);
+		S->memmap->ram = NULL;
+	}
+
+	memset(&R, 0, sizeof(Memregion));
+	R.name = "RAM";
+	R.kind = kSunflowerMemmapRam;
+	R.base = S->MEMBASE;
+	R.end = (uvlong)S->MEMBASE + S->MEMSIZE;
+	S->memmap->ram = mmemmapregister(E, S, &R);
+
+	return;
+}
+
+/*									*/
+/*	Add a copy of *T to the map. Regions may not overlap; on	*/
+/*	overlap the map is unchanged and we return NULL.		*/
+/*									*/
+Memregion *
+mmemmapregister(Engine *E, State *S, Memregion *T)
+{
+	Memmap		*M = S->memmap;
+	Memregion	*R, **tmp;
+	Memmappage	*P;
+	uvlong		page, pagebase, pageend;
+
+
+	if (T->end <= T->base)
+	{
+		return NULL;
+	}
+
+	if (mmemmapoverlaps(M, T->base, T->end))
+	{
+		merror(E, "Memory map region \"%s\" [0x" UHLONGFMT ", 0x" UHLONGFMT ") overlaps an existing region.",
+			T->name, (ulong)T->base, (ulong)T->end);
+		return NULL;
+	}
+
+	R = (Memregion *)mcalloc(E, 1, sizeof(Memregion), "Memregion in mmemmapregister()");
+	if (R == NULL)
+	{
+		mexit(E, "Could not allocate memory for Memregion", -1);
+	}
+	memcpy(R, T, sizeof(Memregion));
+	R->next = M->regions;
+	M->regions = R;
+
+	for (page = R->base >> kSunflowerMemmapPageshift;
+		page <= (R->end - 1) >> kSunflowerMemmapPageshift; page++)
+	{
+		P = mmemmappage(E, M, page << kSunflowerMemmapPageshift);
+		pagebase = page << kSunflowerMemmapPageshift;
+		pageend = pagebase + (1 << kSunflowerMemmapPageshift);
+
+		if (R->base <= pagebase && R->end >= pageend)
+		{
+			P->region = R;
+			continue;
+		}
+
+		if (P->regions == NULL)
+		{
+			tmp = (Memregion **)mcalloc(E, 1, sizeof(Memregion *),
+				"Memmappage regions in mmemmapregister()");
+		}
+		else
+		{
+			tmp = (Memregion **)mrealloc(E, P->regions, (P->nregions + 1)*sizeof(Memregion *),
+				"Memmappage regions in mmemmapregister()");
+		}
+		if (tmp == NULL)
+		{
+			mexit(E, "Could not allocate memory for Memmappage regions", -1);
+		}
+		P->regions = tmp;
+		P->regions[P->nregions++] = R;
+	}
+
+	return R;
+}
+
+void
+mmemmapunregister(Engine *E, State *S, Memregion *R)
+{
+	Memmap		*M = S->memmap;
+	Memregion	**pp;
+	Memmappage	*P;
+	uvlong		page;
+	int		i;
+
+
+	for (page = R->base >> kSunflowerMemmapPageshift;
+		page <= (R->end - 1) >> kSunflowerMemmapPageshift; page++)
+	{
+		P = mmemmappage(E, M, page << kSunflowerMemmapPageshift);
+		if (P->region == R)
+		{
+			P->region = NULL;
+			continue;
+		}
+
+		for (i = 0; i < P->nregions; i++)
+		{
+			if (P->regions[i] == R)
+			{
+				P->regions[i] = P->regions[--P->nregions];
+				break;
+			}
+		}
+	}
+
+	for (pp = &M->regions; *pp != NULL; pp = &(*pp)->next)
+	{
+		if (*pp == R)
+		{
+			*pp = R->next;
+			break;
+		}
+	}
+	mfree(E, R, "Memregion in mmemmapunregister()");
+
+	return;
+}
+
+Memregion *
+mmemmaplookup(State *S, ulong addr)
+{
+	Memmappage	*P;
+	Memregion	*R;
+	int		i;
+
+
+	if (S->memmap == NULL)
+	{
+		return NULL;
+	}
+
+	P = S->memmap->dir[(addr >> kSunflowerMemmapDirshift) & (kSunflowerMemmapNdir - 1)];
+	if (P == NULL)
+	{
+		return NULL;
+	}
+
+	P = &P[(addr >> kSunflowerMemmapPageshift) & (kSunflowerMemmapNpages - 1)];
+	if (P->region != NULL)
+	{
+		return P->region;
+	}
+
+	for (i = 0; i < P->nregions; i++)
+	{
+		R = P->regions[i];
+		if (addr >= R->base && addr < R->end)
+		{
+			return R;
+		}
+	}
+
+	return NULL;
+}
+
+/*									*/
+/*	Whether the nbytes at addr all lie in RAM. This replaces the	*/
+/*	MEMBASE/MEMEND test in the memory hierarchy.			*/
+/*									*/
+int
+mmemmapinram(State *S, ulong addr, int nbytes)
+{
+	Memregion	*R = mmemmaplookup(S, addr);
+
+	return (R != NULL) && (R->kind == kSunflowerMemmapRam) &&
+		((uvlong)addr + nbytes <= R->end);
+}
+
+static Memmappage *
+mmemmappage(Engine *E, Memmap *M, uvlong addr)
+{
+	Memmappage	**D = &M->dir[(addr >> kSunflowerMemmapDirshift) & (kSunflowerMemmapNdir - 1)];
+
+
+	if (*D == NULL)
+	{
+		*D = (Memmappage *)mcalloc(E, kSunflowerMemmapNpages, sizeof(Memmappage),
+			"Memmappage table in mmemmappage()");
+		if (*D == NULL)
+		{
+			mexit(E, "Could not allocate memory for Memmappage table", -1);
+		}
+	}
+
+	return &(*D)[(addr >> kSunflowerMemmapPageshift) & (kSunflowerMemmapNpages - 1)];
+}
+
+static int
+mmemmapoverlaps(Memmap *M, uvlong base, uvlong end)
+{
+	Memregion	*R;
+
+
+	for (R = M->regions; R != NULL; R = R->next)
+	{
+		if (base < R->end && R->base < end)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+mmemmapclear(Engine *E, Memmap *M)
+{
+	Memregion	*R, *next;
+	int		i, j;
+
+
+	for (i = 0; i < kSunflowerMemmapNdir; i++)
+	{
+		if (M->dir[i] == NULL)
+		{
+			continue;
+		}
+
+		for (j = 0; j < kSunflowerMemmapNpages; j++)
+		{
+			if (M->dir[i][j].regions != NULL)
+			{
+				mfree(E, M->dir[i][j].regions, "Memmappage regions in mmemmapclear()");
+			}
+		}
+		mfree(E, M->dir[i], "Memmappage table in mmemmapclear()");
+		M->dir[i] = NULL;
+	}
+
+	for (R = M->regions; R != NULL; R = next)
+	{
+		next = R->next;
+		mfree(E, R, "Memregion in mmemmapclear()");
+	}
+	M->regions = NULL;
+	M->ram = NULL;
+
+	return;
+}
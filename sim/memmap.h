@@ -0,0 +1,104 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Per-node physical memory map. The 32-bit physical address	*/
+/*	space is split into pages, held in a two-level table that is	*/
+/*	only filled in where something is mapped. Each page points	*/
+/*	either to the one region covering it entirely (the common	*/
+/*	case: RAM, or the 64KB NIC register banks) or to the short	*/
+/*	list of regions that share it. Devices register an address	*/
+/*	range with the access routines they implement; a NULL routine	*/
+/*	leaves that access width to the machine's devread/devwrite.	*/
+/*	See memmap.c.							*/
+/*									*/
+enum
+{
+	kSunflowerMemmapPageshift	= 12,
+	kSunflowerMemmapDirshift	= 22,
+	kSunflowerMemmapNpages		= 1 << (kSunflowerMemmapDirshift - kSunflowerMemmapPageshift),
+	kSunflowerMemmapNdir		= 1 << (32 - kSunflowerMemmapDirshift),
+};
+
+typedef enum
+{
+	kSunflowerMemmapRam,
+	kSunflowerMemmapDevice,
+} SunflowerMemmapKind;
+
+typedef struct Memregion Memregion;
+struct Memregion
+{
+	char			*name;
+	SunflowerMemmapKind	kind;
+
+	/*	Covers [base, end)				*/
+	uvlong			base;
+	uvlong			end;
+
+	/*							*/
+	/*	(Engine *, State *, ulong addr) for reads, and	*/
+	/*	(Engine *, State *, ulong addr, ulong data) for	*/
+	/*	writes. Unused for RAM, which is S->MEM.	*/
+	/*							*/
+	uchar			(*readbyte)();
+	ushort			(*readword)();
+	ulong			(*readlong)();
+	void			(*writebyte)();
+	void			(*writeword)();
+	void			(*writelong)();
+
+	/*	All regions of the map				*/
+	Memregion		*next;
+};
+
+typedef struct
+{
+	/*	Region covering the whole page, if there is one	*/
+	Memregion		*region;
+
+	/*	Otherwise, the regions that overlap the page	*/
+	Memregion		**regions;
+	int			nregions;
+} Memmappage;
+
+typedef struct
+{
+	Memmappage		*dir[kSunflowerMemmapNdir];
+	Memregion		*regions;
+	Memregion		*ram;
+} Memmap;
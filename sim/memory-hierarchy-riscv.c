@@ -95,7 +95,9 @@ riscVwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 	TransAddr	trans;
 	ulong		paddr;
 	uchar		data = xdata & 0xFF;
-	
+
+	bptwritehook(E, S, vaddr, 1);
+
 	/*								*/
 	/*	Translate address. If error occured, we do nothing:	*/
 	/*	faulting instruction will get re-executed after the	*/
@@ -112,7 +114,7 @@ riscVwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 	paddr	= trans.paddr;
 	inram	= 0;
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND))
+	if (mmemmapinram(S, paddr, 1))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -152,6 +154,8 @@ riscVwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 	ulong		paddr;
 	ushort		data = xdata & 0xFFFF;
 
+	bptwritehook(E, S, vaddr, 2);
+
 	/*                                                              */
         /*      Translate address. If error occured, we do nothing:     */
         /*      faulting instruction will get re-executed after the     */
@@ -178,7 +182,7 @@ riscVwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND-1)) /* -1 for 2nd byte */
+	if (mmemmapinram(S, paddr, 2))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -222,6 +226,8 @@ riscVwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 	TransAddr	trans;
 	ulong		paddr;
 
+	bptwritehook(E, S, vaddr, 4);
+
 	/*                                                              */
         /*      Translate address. If error occured, we do nothing:     */
         /*      faulting instruction will get re-executed after the     */
@@ -248,7 +254,7 @@ riscVwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 3)) /* -3 for 4th byte */
+	if (mmemmapinram(S, paddr, 4))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -294,6 +300,8 @@ riscVreadbyte(Engine *E, State *S, ulong vaddr)
 	ulong		paddr;
 	uchar		data = 0;
 
+	bptreadhook(E, S, vaddr, 1);
+
 	/*                                                              */
         /*      Translate address. If error occured, we do nothing:     */
         /*      faulting instruction will get re-executed after the     */
@@ -310,7 +318,7 @@ riscVreadbyte(Engine *E, State *S, ulong vaddr)
         paddr   = trans.paddr;
 	inram	= 0;
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND))
+	if (mmemmapinram(S, paddr, 1))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -344,6 +352,8 @@ riscVreadword(Engine *E, State *S, ulong vaddr)
 	ulong		paddr;
 	ushort		data = 0;
 
+	bptreadhook(E, S, vaddr, 2);
+
 	/*                                                              */
         /*      Translate address. If error occured, we do nothing:     */
         /*      faulting instruction will get re-executed after the     */
@@ -370,7 +380,7 @@ riscVreadword(Engine *E, State *S, ulong vaddr)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 1)) /* -1 for second byte */
+	if (mmemmapinram(S, paddr, 2))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -405,6 +415,8 @@ riscVreadlong(Engine *E, State *S, ulong vaddr)
 	ulong		paddr;
 	ulong		data = 0;
 
+	bptreadhook(E, S, vaddr, 4);
+
 	/*                                                              */
         /*      Translate address. If error occured, we do nothing:     */
         /*      faulting instruction will get re-executed after the     */
@@ -431,7 +443,7 @@ riscVreadlong(Engine *E, State *S, ulong vaddr)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 3)) /* -3 for 4th byte */
+	if (mmemmapinram(S, paddr, 4))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -239,8 +239,11 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 	uchar		data = xdata & 0xFF;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
 
 
+	bptwritehook(E, S, vaddr, 1);
+
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -259,34 +262,40 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
+		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
 		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -309,28 +318,7 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 		/*										*/
 		if (X->regions[i]->valuetrace && (X->regions[i]->ispointer || (data < S->MEMBASE) || (data > S->MEMEND)))
 		{
-			X->regions[i]->values[X->regions[i]->validx] = data;
-			if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-			{
-				X->regions[i]->validx++;
-			}
-
-			if (X->regions[i]->validx == X->regions[i]->nvalues)
-			{
-				ulong	*tmp;
-
-				X->regions[i]->nvalues *= 2;
-				tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-					X->regions[i]->nvalues*sizeof(ulong), "realloc C->regions[i]->values in cache.c");
-				if (tmp == NULL)
-				{
-					mprint(E, NULL, siminfo,
-						"Resizing X->regions[i]->values to %d entries failed\n",
-						X->regions[i]->nvalues);
-					sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-				}
-				X->regions[i]->values = tmp;
-			}
+			mvtracenuma(E, S, X->regions[i], data);
 		}
 
 		if (!X->regions[i]->private || (id == S->NODE_ID))
@@ -364,6 +352,11 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 			D->MEM[destoffset] = data;
 			paddr = D->MEMBASE + destoffset;
 
+			if (D->superH != NULL && D->superH->SB != NULL)
+			{
+				superHsbwrite(E, D, paddr, 1);
+			}
+
 			if (SF_BITFLIP_ANALYSIS)
 			{
 				/*	        Data Bus	*/
@@ -375,6 +368,11 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 			return;
@@ -397,7 +395,7 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 	paddr	= trans.paddr;
 	inram	= 0;
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND))
+	if (mmemmapinram(S, paddr, 1))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -416,6 +414,12 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 		return;
 	}
 
+	/*	Stores into translated code invalidate its superblocks	*/
+	if (S->superH->SB != NULL)
+	{
+		superHsbwrite(E, S, paddr, 1);
+	}
+
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -466,6 +470,7 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 		}
 		
 		S->superH->C->writemiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -496,6 +501,7 @@ superHwritebyte(Engine *E, State *S, ulong vaddr, ulong xdata)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (inram)
@@ -523,8 +529,11 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 	ushort		data = xdata & 0xFFFF;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
 
 
+	bptwritehook(E, S, vaddr, 2);
+
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -543,34 +552,40 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
+		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
 		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -604,28 +619,7 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 				mask = (1 << (size << 3)) - 1;
 			}
 
-			X->regions[i]->values[X->regions[i]->validx] = data & mask;
-			if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-			{
-				X->regions[i]->validx++;
-			}
-
-			if (X->regions[i]->validx == X->regions[i]->nvalues)
-			{
-				ulong	*tmp;
-
-				X->regions[i]->nvalues *= 2;
-				tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-					X->regions[i]->nvalues*sizeof(ulong), "realloc C->regions[i]->values in cache.c");
-				if (tmp == NULL)
-				{
-					mprint(E, NULL, siminfo,
-						"Resizing X->regions[i]->values to %d entries failed\n",
-						X->regions[i]->nvalues);
-					sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-				}
-				X->regions[i]->values = tmp;
-			}
+			mvtracenuma(E, S, X->regions[i], data & mask);
 		}
 
 		if (!X->regions[i]->private || (id == S->NODE_ID))
@@ -659,6 +653,11 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 			D->MEM[destoffset+1] = (uchar)data&0xFF;
 			paddr = D->MEMBASE + destoffset;
 
+			if (D->superH != NULL && D->superH->SB != NULL)
+			{
+				superHsbwrite(E, D, paddr, 2);
+			}
+
 			if (SF_BITFLIP_ANALYSIS)
 			{
 				/*	        Data Bus	*/
@@ -670,6 +669,11 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 			return;
@@ -702,7 +706,7 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND-1)) /* -1 for 2nd byte */
+	if (mmemmapinram(S, paddr, 2))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -721,6 +725,12 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 		return;
 	}
 
+	/*	Stores into translated code invalidate its superblocks	*/
+	if (S->superH->SB != NULL)
+	{
+		superHsbwrite(E, S, paddr, 2);
+	}
+
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -771,6 +781,7 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 		}
 		
 		S->superH->C->writemiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -802,6 +813,7 @@ superHwriteword(Engine *E, State *S, ulong vaddr, ulong xdata)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (inram)
@@ -830,7 +842,10 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 	ulong		paddr;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
+
 
+	bptwritehook(E, S, vaddr, 4);
 
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
@@ -850,34 +865,40 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
+		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
 		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -911,28 +932,7 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 				mask = (1 << (size << 3)) - 1;
 			}
 
-			X->regions[i]->values[X->regions[i]->validx] = data & mask;
-			if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-			{
-				X->regions[i]->validx++;
-			}
-
-			if (X->regions[i]->validx == X->regions[i]->nvalues)
-			{
-				ulong	*tmp;
-
-				X->regions[i]->nvalues *= 2;
-				tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-					X->regions[i]->nvalues*sizeof(ulong), "realloc C->regions[i]->values in cache.c");
-				if (tmp == NULL)
-				{
-					mprint(E, NULL, siminfo,
-						"Resizing X->regions[i]->values to %d entries failed\n",
-						X->regions[i]->nvalues);
-					sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-				}
-				X->regions[i]->values = tmp;
-			}
+			mvtracenuma(E, S, X->regions[i], data & mask);
 		}
 
 		if (!X->regions[i]->private || (id == S->NODE_ID))
@@ -968,6 +968,11 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 			D->MEM[destoffset+3] =(uchar)data&0xFF;
 			paddr = D->MEMBASE + destoffset;
 
+			if (D->superH != NULL && D->superH->SB != NULL)
+			{
+				superHsbwrite(E, D, paddr, 4);
+			}
+
 			if (SF_BITFLIP_ANALYSIS)
 			{
 				/*	        Data Bus	*/
@@ -979,6 +984,11 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_WRITE_STALL, latency);
 
 			return;
@@ -1011,7 +1021,7 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 3)) /* -3 for 4th byte */
+	if (mmemmapinram(S, paddr, 4))
 	{
 		inram = 1;
 		latency = S->mem_w_latency;
@@ -1030,6 +1040,12 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 		return;
 	}
 
+	/*	Stores into translated code invalidate its superblocks	*/
+	if (S->superH->SB != NULL)
+	{
+		superHsbwrite(E, S, paddr, 4);
+	}
+
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
 	{
@@ -1082,6 +1098,7 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 		}
 
 		S->superH->C->writemiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -1112,6 +1129,7 @@ superHwritelong(Engine *E, State *S, ulong vaddr, ulong data)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (inram)
@@ -1148,7 +1166,10 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 	uchar		data = 0;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
+
 
+	bptreadhook(E, S, vaddr, 1);
 
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
@@ -1168,34 +1189,40 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
 		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
+		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -1248,29 +1275,7 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 			/*										*/
 			if (X->regions[i]->valuetrace && (X->regions[i]->ispointer || (data < S->MEMBASE) || (data > S->MEMEND)))
 			{
-				X->regions[i]->values[X->regions[i]->validx] = data;
-				if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-				{
-					X->regions[i]->validx++;
-				}
-
-				if (X->regions[i]->validx == X->regions[i]->nvalues)
-				{
-					ulong	*tmp;
-
-					X->regions[i]->nvalues *= 2;
-					tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-						X->regions[i]->nvalues*sizeof(ulong), 
-						"realloc C->regions[i]->values in cache.c");
-					if (tmp == NULL)
-					{
-						mprint(E, NULL, siminfo,
-							"Resizing X->regions[i]->values to %d entries failed\n",
-							X->regions[i]->nvalues);
-						sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-					}
-					X->regions[i]->values = tmp;
-				}
+				mvtracenuma(E, S, X->regions[i], data);
 			}
 
 			if (SF_BITFLIP_ANALYSIS)
@@ -1284,6 +1289,11 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 			return data;
@@ -1312,7 +1322,7 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 	paddr	= trans.paddr;
 	inram	= 0;
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND))
+	if (mmemmapinram(S, paddr, 1))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -1374,6 +1384,7 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 		}
 
 		S->superH->C->readmiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -1397,6 +1408,7 @@ superHreadbyte(Engine *E, State *S, ulong vaddr)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (!S->superH->cache_activated || !trans.cacheable)
@@ -1418,7 +1430,10 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 	ushort		data = 0;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
+
 
+	bptreadhook(E, S, vaddr, 2);
 
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
@@ -1438,34 +1453,40 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
 		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
+		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -1529,29 +1550,7 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 					mask = (1 << (size << 3)) - 1;
 				}
 
-				X->regions[i]->values[X->regions[i]->validx] = data & mask;
-				if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-				{
-					X->regions[i]->validx++;
-				}
-
-				if (X->regions[i]->validx == X->regions[i]->nvalues)
-				{
-					ulong	*tmp;
-
-					X->regions[i]->nvalues *= 2;
-					tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-						X->regions[i]->nvalues*sizeof(ulong), 
-						"realloc C->regions[i]->values in cache.c");
-					if (tmp == NULL)
-					{
-						mprint(E, NULL, siminfo,
-							"Resizing X->regions[i]->values to %d entries failed\n",
-							X->regions[i]->nvalues);
-						sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-					}
-					X->regions[i]->values = tmp;
-				}
+				mvtracenuma(E, S, X->regions[i], data & mask);
 			}
 
 			if (SF_BITFLIP_ANALYSIS)
@@ -1565,6 +1564,11 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 			return data;
@@ -1603,7 +1607,7 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 1)) /* -1 for second byte */
+	if (mmemmapinram(S, paddr, 2))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -1666,6 +1670,7 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 		}
 
 		S->superH->C->readmiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -1689,6 +1694,7 @@ superHreadword(Engine *E, State *S, ulong vaddr)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (!S->superH->cache_activated || !trans.cacheable)
@@ -1710,7 +1716,10 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 	ulong		data = 0;
 	State		*D;
 	Numa		*X = NULL;
+	uvlong		t0;
+
 
+	bptreadhook(E, S, vaddr, 4);
 
 	/*		Model # bits flipping due to this mem access	*/
 	if (SF_BITFLIP_ANALYSIS)
@@ -1730,34 +1739,40 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 	/*	executing prologue, we don't want the tracking to be 	*/
 	/*	triggered...						*/
 	/*								*/
-	i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
-		vaddr, S->Nstack, 0, S->Nstack->count);
-
-	/*								*/
-	/*	If address doesn't match a registered address using	*/
-	/*	the current frame pointer, it might be that we are	*/
-	/*	accessing an address on one of our parent's stacks.	*/
-	/*	Unwind the stack (side-effect-free) and try to match.	*/
-	/*								*/
-	j = S->fpstackheight - 1;
-	while (i < 0 && j >= 0)
-	{
-		i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
-				vaddr, S->Nstack, 0, S->Nstack->count);
-		j--;
-	}
+	i = -1;
+	if (SF_NUMA)
+	{
+		t0 = simprofbegin(E);
+		i = m_find_numastack(S->PCSTACK[S->pcstackheight], S->superH->R[14],
+			vaddr, S->Nstack, 0, S->Nstack->count);
+
+		/*								*/
+		/*	If address doesn't match a registered address using	*/
+		/*	the current frame pointer, it might be that we are	*/
+		/*	accessing an address on one of our parent's stacks.	*/
+		/*	Unwind the stack (side-effect-free) and try to match.	*/
+		/*								*/
+		j = S->fpstackheight - 1;
+		while (i < 0 && j >= 0)
+		{
+			i = m_find_numastack(S->PCSTACK[j], S->FPSTACK[j],
+					vaddr, S->Nstack, 0, S->Nstack->count);
+			j--;
+		}
 
-	if (i >= 0)
-	{
-		X = S->Nstack;
-	}
-	else
-	{
-		i = m_find_numa(vaddr, S->N, 0, S->N->count);
 		if (i >= 0)
 		{
-			X = S->N;
+			X = S->Nstack;
 		}
+		else
+		{
+			i = m_find_numa(vaddr, S->N, 0, S->N->count);
+			if (i >= 0)
+			{
+				X = S->N;
+			}
+		}
+		simprofend(E, kSimprofNuma, t0);
 	}
 
 	if (i != -1)
@@ -1824,29 +1839,7 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 					mask = (1 << (size << 3)) - 1;
 				}
 
-				X->regions[i]->values[X->regions[i]->validx] = data & mask;
-				if (X->regions[i]->validx < MAX_NUMAREGION_VALUETRACE)
-				{
-					X->regions[i]->validx++;
-				}
-
-				if (X->regions[i]->validx == X->regions[i]->nvalues)
-				{
-					ulong	*tmp;
-
-					X->regions[i]->nvalues *= 2;
-					tmp = (ulong *)mrealloc(E, X->regions[i]->values,
-						X->regions[i]->nvalues*sizeof(ulong),
-						"realloc C->regions[i]->values in cache.c");
-					if (tmp == NULL)
-					{
-						mprint(E, NULL, siminfo,
-							"Resizing X->regions[i]->values to %d entries failed\n",
-							X->regions[i]->nvalues);
-						sfatal(E, S, "realloc failed for X->regions[i]->values in cache.c");
-					}
-					X->regions[i]->values = tmp;
-				}
+				mvtracenuma(E, S, X->regions[i], data & mask);
 			}
 
 			if (SF_BITFLIP_ANALYSIS)
@@ -1860,6 +1853,11 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 				S->superH->B->paddr_bus = paddr;
 			}
 
+			if (D->superH != NULL)
+			{
+				S->superH->numactl = D->superH->B->ctl;
+			}
+
 			S->stallaction(E, S, paddr, MEM_READ_STALL, latency);
 
 			return data;
@@ -1898,7 +1896,7 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 		/*	raise address error	*/
 	}
 
-	if ((paddr >= S->MEMBASE) && (paddr < S->MEMEND - 3)) /* -3 for 4th byte */
+	if (mmemmapinram(S, paddr, 4))
 	{
 		inram = 1;
 		latency = S->mem_r_latency;
@@ -1964,6 +1962,7 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 		}
 
 		S->superH->C->readmiss++;
+		t0 = simprofbegin(E);
 
 		/*	LRU Replacement. Emulates the SH3's 6-bit LRU	*/ 
 		/*	field indirectly.				*/
@@ -1987,6 +1986,7 @@ superHreadlong(Engine *E, State *S, ulong vaddr)
 		S->superH->C->blocks[oldest].tag = tag;
 		S->superH->C->blocks[oldest].valid = 1;
 		S->superH->C->blocks[oldest].timestamp = 0;
+		simprofend(E, kSimprofCachemiss, t0);
 	}
 	
 	if (!S->superH->cache_activated || !trans.cacheable)
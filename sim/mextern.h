@@ -41,6 +41,7 @@ extern char*		riscv_opstrs[];
 extern char*		msp430_opstrs[];
 extern char const	MVERSION[];
 extern Engine*		yyengine;
+extern ulong		sfanalyses;
 
 /*	This is used when indexing stage->instr_latencies	*/
 enum
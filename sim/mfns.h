@@ -80,6 +80,10 @@ void	nic_tx_enqueue(Engine *, State *S, uchar, int whichifc);
 double	check_snr(Engine *, Netsegment *curseg, State *src_node, State *dst_node);
 void	remote_seg_enqueue(Engine *, Segbuf *segbuf);
 int	parsenetsegdump(Engine *, char *buf, Segbuf *segbuf);
+Netbuf*	netbuf_alloc(Engine *, int nbytes);
+Netbuf*	netbuf_ref(Netbuf *b);
+void	netbuf_release(Engine *, Netbuf *b);
+int	netbuf_size(Netbuf *b);
 
 
 
@@ -92,9 +96,13 @@ int	mchdir(char *);
 int	mclose(int);
 int	mcreate(char *path, int mode);
 char*	mfgets(char *buf, int len, int fd);
+int	mfexists(char *path);
+void*	mmapfile(int fd, long size);
 int	mfsize(int fd);
 int	mopen(char *path, int mode);
 int	mread(int fd, char* buf, int len);
+int	mfork(void);
+int	mwaitchild(int *status);
 int	mwrite(int fd, char* buf, int len);
 char*	mgetpwd(void);
 ulong	sim_syscall(Engine *, State *, ulong, ulong, ulong, ulong);
@@ -114,13 +122,75 @@ int	mkillscheduler(Engine *);
 int	mspawnscheduler(Engine *);
 uvlong	mrandom(Engine *);
 uvlong	mrandominit(Engine *, uvlong);
+void	mrandstreaminit(Randstream *, SunflowerRandstreamKind, int);
+void	mrandstreaminitnode(Engine *, State *);
+uvlong	mrandstream(Engine *, Randstream *);
+double	mrandstreamuniform(Engine *, Randstream *, double, double);
+void	mrandstreamfill(Engine *, Randstream *, uvlong *, int);
+void	mrandstreamfilluniform(Engine *, Randstream *, double *, int, double, double);
+void	msampleinit(Engine *, State *, uvlong, uvlong, uvlong);
+void	msampleoff(Engine *, State *);
+int	msamplestep(Engine *, State *, int);
+void	msamplestats(Engine *, State *);
+void	mcmdqueuesubmit(Engine *, char *);
+void	mcmdqueuedrain(Engine *, CmdqueueOwner);
+void	mcmdqueuestart(Engine *);
+void	mcmdqueuestop(Engine *);
+void	mcmdqueueabandon(Engine *, CmdqueueOwner);
+void	mcmdqueuepublish(Engine *);
+void	mcmdqueuesnapshot(Engine *, Cmdsnapshot *);
+void	msimprofon(Engine *);
+void	msimprofoff(Engine *);
+void	msimprofreport(Engine *, State *, char *);
+void	mpcprofinit(Engine *, State *, ulong);
+void	mpcprofoff(Engine *, State *);
+void	mpcprofsample(Engine *, State *, ulong);
+void	mpcprofstats(Engine *, State *, int);
+void	mpcprofdump(Engine *, State *, char *, char *);
+void	msymadd(Engine *, State *, ulong, char *);
+void	mmemmapinit(Engine *, State *);
+void	mmemmapsetram(Engine *, State *);
+Memregion*	mmemmapregister(Engine *, State *, Memregion *);
+void	mmemmapunregister(Engine *, State *, Memregion *);
+Memregion*	mmemmaplookup(State *, ulong);
+int	mmemmapinram(State *, ulong, int);
+Linereader*	mlineopen(Engine *, char *);
+char*	mlinegets(Linereader *, char *, int);
+void	mlineclose(Engine *, Linereader *);
+Trajectory*	mtrajectoryload(Engine *, char *);
+void	mtrajectorysave(Engine *, char *, char *);
+void	mvtraceopen(Engine *, State *, char *);
+void	mvtraceclose(Engine *, State *);
+void	mvtracecloseall(Engine *);
+void	mvtracenuma(Engine *, State *, Numaregion *, ulong);
+void	mvtracereg(Engine *, State *, Regvt *, ulong);
+int	mvfsopen(Engine *, State *, char *, int);
+int	mvfsclose(Engine *, State *, int);
+long	mvfsread(Engine *, State *, int, ulong, long);
+long	mvfswrite(Engine *, State *, int, ulong, long);
+long	mvfslseek(Engine *, State *, int, long, int);
+int	mvfsfsize(Engine *, State *, int, ulong *);
+int	mvfssize(Engine *, char *, ulong *);
+void	mvfsresetnode(Engine *, State *);
+void	mvfsflush(Engine *);
+void	mbusarbitration(Engine *, State *, char *);
+void	mbusbanks(Engine *, State *, int, ulong);
+void	mbustiming(Engine *, State *, int, int);
+void	mbuspriority(Engine *, State *, int, int);
+void	mbusrequest(Engine *, Bus *, State *, ulong, int, int, int *);
+void	mbusclock(Engine *);
+void	mbusstats(Engine *, State *);
 ulong	mcputimeusecs(void);
 ulong	musercputimeusecs(void);
 void	mnsleep(ulong);
 ulong	mwallclockusecs(void);
+uvlong	mwalltimeusecs(void);
+ulong	mmaxrsskbytes(void);
 void	m_dumpall(Engine *, char *filename, int mode, char *tag, char *pre);
 void	m_dumpnode(Engine *, int i, char *filename, int mode, char *tag, char *pre);
 void	m_version(Engine *E);
+void	m_setanalysis(Engine *E, char *name, int enable);
+void	m_hoststats(Engine *E);
 void	m_newnode(Engine *E, char *type, double x, double y, double z, char *trajfilename, int looptrajectory, int trajectoryrate);
 void	m_powertotal(Engine *);
 void	m_renumbernodes(Engine *);
@@ -185,8 +255,11 @@ ulong	checksum(uchar *data, int datalen);
 void	m_setloc(Engine *, State *, double, double, double);
 void	m_locstats(Engine *E, State *S);
 Engine*	m_allocengine(uvlong);
+void	m_batch(Engine *, char *, char **, int) __attribute__((noreturn));
+void	m_sweep(Engine *, char *, char *, int, char **, int) __attribute__((noreturn));
 Engine* m_lookupengine(uvlong);
 void	traj_feed(Engine *E);
+void	mmobilityadd(Engine *E, State *S);
 
 
 
@@ -240,6 +313,8 @@ void	pau_init(Engine *, State *S, int nentries);
 /*				Power estimation nd batteries				*/
 /*											*/
 void	power_printstats(Engine *, State *S);
+void	power_materialize(Engine *, State *S);
+void	power_riscvcurrents(Engine *, State *S);
 void	power_scaledelay(Engine *, State *S, double Vdd);
 void	power_scalevdd(Engine *, State *S, double freq);
 int	bit_flips_32(ulong w1, ulong w2);
@@ -248,6 +323,7 @@ void	newbatt(int type, double capacity);
 void	batt_newbatt(Engine *, int ID, double capacity_mAh);
 void	batt_nodeattach(Engine *, State *S, int which);
 void	batt_printstats(Engine *, State *S, int which);
+void	batt_setfeedadaptive(Engine *, double minperiod, double maxperiod, double dsoc);
 void	battery_dumpall(Engine *, State *);
 void	battery_feed(Engine *, double);
 
@@ -257,8 +333,12 @@ void	m_setbptglobaltime(Engine *, Picosec);
 void	m_setbptcycles(Engine *, State *, uvlong);
 void	m_setbptinstrs(Engine *, State *, uvlong);
 void	m_setbptsensorreading(Engine *, State *, int, double);
+void	m_setbptpc(Engine *, State *, ulong);
+void	m_setbptwatch(Engine *, State *, Breaktype, ulong, ulong);
 void	m_bptls(Engine *);
 void	m_bptdel(Engine *, int);
+int	mbptpc(Engine *, State *, ulong);
+void	mbptwatch(Engine *, State *, ulong, int, Breaktype);
 
 
 
@@ -276,8 +356,8 @@ void	tag_showtags(Engine *E, State *S);
 /*											*/
 void	fault_setnodepfun(Engine *E, State *S, char *alg);
 void	fault_setnetsegpfun(Engine *E, Netsegment *tptr, char *alg);
-//uvlong	pfunexp(void *ptr, char *type, uvlong modulo);
-//uvlong	pfunrnd(void *ptr, char *type, uvlong modulo);
+void	fault_setnodefailprob(Engine *E, State *S, double prob);
+void	fault_setnetsegfailprob(Engine *E, Netsegment *tptr, double prob);
 void	fault_feed(Engine *E);
 uvlong	exponential(void *, char *, uvlong);
 uvlong	uniform_random(void *, char *, uvlong);
@@ -397,9 +477,16 @@ void	write_4(State * S, ulong source, uchar * target);
 /*											*/
 void	superHdecode(Engine *, ushort, SuperHPipestage *);
 void	superHdumppipe(Engine *, State *S);
+ulong	superHpipepc(State *S);
 void	superHdumpregs(Engine *E, State *S);
 void	superHdumpsysregs(Engine *E, State *S);
-int	superHfaststep(Engine *, State *S, int drain_pipeline);
+void	superHbindstep(Engine *, State *S);
+void	superHanalysisinit(Engine *, State *S);
+int	superHsbexec(Engine *, State *S, int maxinstrs);
+void	superHsbwrite(Engine *, State *S, ulong paddr, ulong nbytes);
+void	superHsbflush(Engine *, State *S);
+void	superHsbshare(Engine *, State *S, State *N);
+void	superHsbunshare(Engine *, State *S);
 void	superHfatalaction(Engine *, State *S);
 void	superHIFIDflush(State *S);
 State*	superHnewstate(Engine *E, double, double, double, char *);
@@ -408,7 +495,6 @@ void	superHresetcpu(Engine *, State *S);
 void	superHsetfreq(State *, int);
 void	superHsetvdd(State *, double);
 void	superHstallaction(Engine *, State *S, ulong addr, int type, int latency);
-int	superHstep(Engine *, State *S, int drain_pipeline);
 int	superHtake_batt_intr(Engine *, State *S);
 int	superHtake_nic_intr(Engine *, State *S);
 int	superHtake_timer_intr(Engine *, State *S);
@@ -436,6 +522,7 @@ uchar	devportreadbyte(Engine *E, State *S, ulong addr);
 void	devportwritelong(Engine *E, State *S, ulong addr, ulong data);
 void	devportwriteword(Engine *E, State *S, ulong addr, ushort data);
 void	devportwritebyte(Engine *E, State *S, ulong addr, uchar data);
+void	devsimregister(Engine *E, State *S);
 
 ulong	dev7708readlong(Engine *E, State *S, ulong addr);
 ushort	dev7708readword(Engine *E, State *S, ulong addr);
@@ -456,6 +543,7 @@ ulong	superHtlb_dataarray_read(State *S, ulong addr);
 void	superHtlb_dataarray_write(State *S, ulong addr, ulong data);
 void	superHdumptlb(Engine *, State *S);
 void	superHtlbflush(Engine *, State *S);
+void	superHutlbinvalidate(State *S);
 int	superHcheck_batt_intr(Engine *, State *S);
 int	superHcheck_nic_intr(Engine *, State *S);
 
@@ -634,8 +722,9 @@ void	msp430decode(Engine *, State *S, ushort instr, MSP430Pipestage *p);
 void	msp430dumpregs(Engine *, State *S);
 void	msp430dumpsysregs(Engine *, State *S);
 void	msp430fatalaction(Engine *, State *S);
-void	msp430stallaction(Engine *, State *S);
-void	msp430take_timer_intr(Engine *, State *S);
+void	msp430loadbyte(Engine *, State *S, ulong addr, ulong data);
+void	msp430stallaction(Engine *, State *S, ulong addr, int type, int latency);
+int	msp430take_timer_intr(Engine *, State *S);
 void	msp430resetcpu(Engine *, State *S);
 State*	msp430newstate(Engine *E, double xloc, double yloc, double zloc, char *trajfilename);
 ushort	msp430regread(Engine *E, State *S, int n, MSP430Pipestage *p);
@@ -655,16 +744,16 @@ void	msp430dumppipe(Engine *, State *S);
 void	msp430split(Engine *E, State *S, ulong startpc, ulong stackptr, ulong argaddr, char *idstr);
 
 void	dev430x1xxreset(State *S, int type);
-uchar	dev430x1xxreadbyte(Engine *, State *S, ushort addr);
-void	dev430x1xxwritebyte(Engine *, State *S, ushort addr, uchar data);
-ushort	dev430x1xxreadword(Engine *, State *S, ushort addr);
-void	dev430x1xxwriteword(Engine *, State *S, ushort addr, ushort data);
+uchar	dev430x1xxreadbyte(Engine *, State *S, ulong addr);
+void	dev430x1xxwritebyte(Engine *, State *S, ulong addr, uchar data);
+ushort	dev430x1xxreadword(Engine *, State *S, ulong addr);
+void	dev430x1xxwriteword(Engine *, State *S, ulong addr, ushort data);
 void	dev430x1xxsetpin(State *S, int pin, double voltage);
 double	dev430x1xxgetpin(State *S, int pin);
 void	dev430x1xxPORreset(State *S);
 void	dev430x1xxPUCreset(State *S);
 void	dev430x1xxNMIinterrupt(State *S, int type);
-void	dev430x1xxinterrupt(State *S, int priority);
+int	dev430x1xxinterrupt(Engine *, State *S);
 void	dev430x1xxflashaccessviolation(State *S);
 void	dev430x1xxflashreadbyte(State *S);
 void	dev430x1xxflashwritebyte(State *S);
@@ -723,15 +812,20 @@ State*	riscvnewstate(Engine *E, double xloc, double yloc, double zloc, char *tra
 void	riscvstallaction(Engine *, State *S, ulong addr, int type, int latency);
 void    riscvdumpregs(Engine *E, State *S);
 void	riscvdumppipe(Engine *E, State *S);
+ulong	riscvpipepc(State *S);
 void	riscvflushpipe(State *S);
 void	riscvIFflush(State *S);
 void	riscvIFIDflush(State *S);
-int	riscvstep(Engine *E, State *S, int drain_pipe);
-int	riscvfaststep(Engine *E, State *S, int drain_pipe);
+void	riscvbindstep(Engine *E, State *S);
+void	riscvanalysisinit(Engine *E, State *S);
+uint32_t	riscvfetch(Engine *E, State *S, uint32_t pc);
 void	riscvdumphist(Engine *E, State *S, int histogram_id);
 void	riscvdumphistpretty(Engine *E, State *S, int histogram_id);
+void	riscvsethistformat(Engine *E, State *S, int nbins, char *bintype);
 void	riscvdumpdistribution(Engine *E, State *S);
 void	riscvdecode(Engine *E, State *S, uint32_t instr, RiscvPipestage *stage);
+uint32_t	riscvexpandcompressed(uint16_t cinstr);
+uint32_t	sign_extend(uint32_t data, uint8_t n);
 uint32_t reg_read_riscv(Engine *E, State *S, uint8_t n);
 void	reg_set_riscv(Engine *E, State *S, uint8_t n, uint32_t data);
 
@@ -759,6 +853,14 @@ void 	riscv_xor(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
 void 	riscv_sll(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
 void	riscv_srl(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
 void 	riscv_sra(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_mul(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_mulh(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_mulhsu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_mulhu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_div(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_divu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_rem(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
+void	riscv_remu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd);
 void 	riscv_addi(Engine *E, State *S, uint8_t rs1, uint8_t rd, uint32_t imm0);
 void 	riscv_slti(Engine *E, State *S, uint8_t rs1, uint8_t rd, uint32_t imm0);
 void 	riscv_sltiu(Engine *E, State *S, uint8_t rs1, uint8_t rd, uint32_t imm0);
@@ -874,8 +976,10 @@ void rv32un_un_part1(Engine *E, State *S, uint8_t rs1, uint8_t rd, uint16_t imm0
 /*
  *		Histogram arithmetic.
  */
+int		Histogram_Init(Engine *E, State *S, Histogram *hist, int nbins, HistogramBinType bintype);
+void		Histogram_Free(Engine *E, State *S, Histogram *hist);
 void		Histogram_AddDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest);
-void		Histogram_ScalarMultiply(Engine *E, State *S, Histogram *hist, HistogramBinDatatype scalar);
+void		Histogram_ScalarMultiply(Engine *E, State *S, Histogram *hist, double scalar);
 void		Histogram_SubDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest);
 void		Histogram_CombDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest);
 int		Histogram_LowerBound(Engine *E, State *S, Histogram *hist);
@@ -885,7 +989,7 @@ void		Histogram_DistRShift(Engine *E, State *S, Histogram *hist1, uint8_t Rs2, H
 uint8_t		Histogram_ExpectedValue(Engine *E, State *S, Histogram *hist);
 uint32_t	Histogram_DistLess(Engine *E, State *S, Histogram *hist, uint32_t Rs2);
 uint32_t	Histogram_DistGrt(Engine *E, State *S, Histogram *hist, uint32_t Rs2);
-void		Histogram_LDDist(Engine *E, State *S, Histogram *histogram, HistogramBinDatatype bins[kUncertainAluHistogramBins]);
+void		Histogram_LDDist(Engine *E, State *S, Histogram *histogram, double *bins);
 void 		Histogram_LDRandom(Engine *E, State *S, Histogram *histogram);
 double		Histogram_Mean(Engine *E, State *S, Histogram *histogram);
 void		Histogram_PrettyPrint(Engine *E, State *S, Histogram *histogram);
@@ -43,6 +43,7 @@
 static void	superHtlbexception(Engine *, State *S, int code, ulong vaddr);
 static void	prcheckpriv(Engine *, State *S, int wflag, ulong data, ulong vaddr, TransAddr *tr);
 static void	prcheckuser(Engine *, State *S, int wflag, ulong data, ulong vaddr, TransAddr *tr);
+static void	utlbfill(State *S, ulong vaddr, ulong asid, ulong data, TransAddr *tr);
 
 
 int
@@ -87,6 +88,7 @@ superHtlb_init(Engine *E, State *S, int size, int blocksize, int assoc)
 	S->superH->TLB->indexbits = (int)ceil(log10(S->superH->TLB->nsets)/log10(2));
 	S->superH->TLB->tagbits = SUPERH_MEMADDRBITS -
 				(S->superH->TLB->offsetbits+S->superH->TLB->indexbits);
+	superHutlbinvalidate(S);
 
 /*
 	mprint(E, S, nodeinfo, "TLB Parameters:\n");
@@ -108,6 +110,7 @@ superHvmtranslate(Engine *E, State *S, int op, TransAddr *tr)
 	int		area = MMU_AREA_INVALID, i, start, end, hflag;
 	ulong		vaddr = tr->vaddr, index;
 	ulong		vaddr31_17, vaddr11_10, pteh_asid, mmucr_sv;
+	SuperHUTLBEntry	*u;
 
 
 
@@ -216,7 +219,29 @@ sfatal(E, S, "stopping on tlb exception...\n");
 
 
 	/*									*/
-	/*	Address is not in P1 or P2, so it must be translated.		*/
+	/*	Address is not in P1 or P2, so it must be translated. Try	*/
+	/*	the micro-TLB first. An entry only records translations that	*/
+	/*	succeeded, so a miss, or an access its permissions do not	*/
+	/*	allow, goes through the full lookup below, which raises any	*/
+	/*	exception.							*/
+	/*									*/
+	pteh_asid = pteh_field_asid(S->superH->PTEH);
+	u = &S->superH->utlb[(vaddr >> SUPERH_UTLB_PAGESHIFT) & (SUPERH_UTLB_ENTRIES - 1)];
+	if (u->valid && (u->vpage == (vaddr >> SUPERH_UTLB_PAGESHIFT))
+		&& (u->asid == pteh_asid) && (u->md == S->superH->SR.MD))
+	{
+		if ((op==MEM_WRITE_BYTE)||(op==MEM_WRITE_WORD)||(op==MEM_WRITE_LONG) ?
+			u->writeok : u->readok)
+		{
+			tr->error = 0;
+			tr->paddr = u->pbase | (vaddr & ((1 << SUPERH_UTLB_PAGESHIFT) - 1));
+			tr->cacheable = u->cacheable;
+
+			return;
+		}
+	}
+
+	/*									*/
 	/*	Do a TLB lookup.						*/
 	/*									*/
 
@@ -235,7 +260,6 @@ sfatal(E, S, "stopping on tlb exception...\n");
 
 	vaddr31_17 = vaddr_field_vpn31_17(vaddr);
 	vaddr11_10 = vaddr_field_vpn11_10(vaddr);
-	pteh_asid = pteh_field_asid(S->superH->PTEH);
 	mmucr_sv = mmucr_field_sv(S->superH->MMUCR);
 
 
@@ -347,6 +371,13 @@ sfatal(E, S, "stopping on tlb exception...\n");
 		{
 			prcheckuser(E, S, wflag, data, vaddr, tr);
 		}
+
+		if (!tr->error)
+		{
+			utlbfill(S, vaddr, pteh_asid, data, tr);
+		}
+
+		return;
 	}
 	else
 	{
@@ -491,6 +522,60 @@ mprint(E, NULL, siminfo, "TLB init page write exception...\n");
 	return;
 }
 
+/*									*/
+/*	Record a translation that passed prcheckuser()/prcheckpriv(),	*/
+/*	along with whether the page may be read and written in the	*/
+/*	current mode, as those routines would decide.			*/
+/*									*/
+void
+utlbfill(State *S, ulong vaddr, ulong asid, ulong data, TransAddr *tr)
+{
+	SuperHUTLBEntry	*u;
+	int		tlb_pr = tlbdataarray_datafield_pr(data);
+	ulong		tlb_d = tlbdataarray_datafield_d(data);
+
+
+	u = &S->superH->utlb[(vaddr >> SUPERH_UTLB_PAGESHIFT) & (SUPERH_UTLB_ENTRIES - 1)];
+	u->vpage = vaddr >> SUPERH_UTLB_PAGESHIFT;
+	u->pbase = tr->paddr & ~((1 << SUPERH_UTLB_PAGESHIFT) - 1);
+	u->asid = asid;
+	u->md = S->superH->SR.MD;
+	u->cacheable = tr->cacheable;
+
+	if (S->superH->SR.MD)
+	{
+		u->readok = 1;
+		u->writeok = ((tlb_pr == B0001) || (tlb_pr == B0011)) && tlb_d;
+	}
+	else
+	{
+		u->readok = (tlb_pr == B0010) || (tlb_pr == B0011);
+		u->writeok = (tlb_pr == B0011) && tlb_d;
+	}
+	u->valid = 1;
+
+	return;
+}
+
+/*									*/
+/*	Called whenever the TLB contents or MMUCR change. A change of	*/
+/*	ASID in PTEH needs no invalidation, since entries are tagged	*/
+/*	with the ASID they were translated under.			*/
+/*									*/
+void
+superHutlbinvalidate(State *S)
+{
+	int	i;
+
+
+	for (i = 0; i < SUPERH_UTLB_ENTRIES; i++)
+	{
+		S->superH->utlb[i].valid = 0;
+	}
+
+	return;
+}
+
 void
 superHtlbexception(Engine *E, State *S, int type, ulong vaddr)
 {
@@ -579,6 +664,7 @@ superHtlb_addrarray_write(State *S, ulong addr, ulong data)
 
 	way = tlbaddrarray_addrfield_way(addr);
 	S->superH->TLB->blocks[index*S->superH->TLB->assoc + way].tag = data;
+	superHutlbinvalidate(S);
 
 	return;
 }
@@ -616,6 +702,7 @@ superHtlb_dataarray_write(State *S, ulong addr, ulong data)
 
 	way = tlbdataarray_addrfield_way(addr);
 	S->superH->TLB->blocks[index*S->superH->TLB->assoc + way].tag = data;
+	superHutlbinvalidate(S);
 
 	return;
 }
@@ -669,6 +756,7 @@ superHtlbflush(Engine *E, State *S)
 	*/
 
 	mprint(E, NULL, siminfo, "\nSunflower debug: in superHtlbflush\n\n");
+	superHutlbinvalidate(S);
 
 	return;
 }
@@ -0,0 +1,300 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static void	mobilitygrow(Engine *E);
+static void	mobilityremove(Engine *E, int k);
+static int	mobilityseek(Engine *E, int k, double *idx);
+static void	mobilitystop(Engine *E, int k);
+static tuck void	mobilitywrite(State *S, Trajectory *T, int segment, double frac);
+
+
+/*									*/
+/*	Start S following the trajectory in S->path. Nodes whose	*/
+/*	trajectory never moves are placed once and not tracked.	*/
+/*									*/
+void
+mmobilityadd(Engine *E, State *S)
+{
+	Mobility	*M = &E->mobility;
+	Trajectory	*T = S->path.trajectory;
+	double		idx;
+	int		k;
+
+
+	for (k = 0; k < M->nmoving; k++)
+	{
+		if (M->nodes[k] == S)
+		{
+			mobilityremove(E, k);
+			break;
+		}
+	}
+
+	if (T == NULL)
+	{
+		return;
+	}
+
+	if (T->stationary || (T->nlocations == 1))
+	{
+		mobilitywrite(S, T, 0, 0.0);
+
+		return;
+	}
+
+	if (M->nmoving == M->maxmoving)
+	{
+		mobilitygrow(E);
+	}
+
+	k = M->nmoving++;
+	M->nodes[k] = S;
+	M->trajectories[k] = T;
+	M->rate[k] = S->path.trajectory_rate;
+	M->loop[k] = (S->path.looptrajectory != 0);
+	M->written[k] = -1;
+
+	if (!mobilityseek(E, k, &idx))
+	{
+		mobilitystop(E, k);
+		return;
+	}
+	if (T->moving[M->segment[k]])
+	{
+		mobilitywrite(S, T, M->segment[k], idx - M->segment[k]);
+	}
+	else
+	{
+		M->written[k] = M->segment[k];
+		mobilitywrite(S, T, M->segment[k], 0.0);
+	}
+
+	return;
+}
+
+/*									*/
+/*	Move all tracked nodes to their position at the current	*/
+/*	simulated time. A node usually stays within its segment	*/
+/*	between updates, or steps into the next one; longer jumps	*/
+/*	(and time running backwards) seek afresh.			*/
+/*									*/
+void
+traj_feed(Engine *E)
+{
+	Mobility	*M = &E->mobility;
+	Trajectory	*T;
+	double		idx;
+	int		k, segment, ended;
+
+
+	M->nchanged = 0;
+	for (k = 0; k < M->nmoving; )
+	{
+		T = M->trajectories[k];
+		segment = M->segment[k];
+		idx = E->globaltimepsec * M->rate[k] - M->lapbase[k];
+
+		if ((idx < segment) || (idx >= segment + kMobilityMaxSteps))
+		{
+			ended = !mobilityseek(E, k, &idx);
+			segment = M->segment[k];
+		}
+		else
+		{
+			ended = 0;
+			while (idx >= segment + 1)
+			{
+				segment++;
+				if ((segment == T->nlocations - 1) && !M->loop[k])
+				{
+					ended = 1;
+					break;
+				}
+
+				if (segment == T->nlocations)
+				{
+					segment = 0;
+					M->lapbase[k] += T->nlocations;
+					idx -= T->nlocations;
+				}
+			}
+			M->segment[k] = segment;
+		}
+
+		if (ended)
+		{
+			/*	mobilitystop() moves the last node into slot k	*/
+			M->changed[M->nchanged++] = M->nodes[k]->NODE_ID;
+			mobilitystop(E, k);
+			continue;
+		}
+
+		if (!T->moving[segment])
+		{
+			if (M->written[k] == segment)
+			{
+				k++;
+				continue;
+			}
+			M->written[k] = segment;
+			idx = segment;
+		}
+		else
+		{
+			M->written[k] = -1;
+		}
+
+		mobilitywrite(M->nodes[k], T, segment, idx - segment);
+		M->changed[M->nchanged++] = M->nodes[k]->NODE_ID;
+		k++;
+	}
+
+	return;
+}
+
+/*									*/
+/*	Set the segment and lap of node k from the absolute time,	*/
+/*	leaving the index within the lap in *idx. Returns 0 if the	*/
+/*	node is on a non-looping trajectory that has run out.		*/
+/*									*/
+static int
+mobilityseek(Engine *E, int k, double *idx)
+{
+	Mobility	*M = &E->mobility;
+	double		a = E->globaltimepsec * M->rate[k];
+	int		n = M->trajectories[k]->nlocations;
+
+
+	M->written[k] = -1;
+	if (!M->loop[k] && (a >= n - 1))
+	{
+		return 0;
+	}
+
+	M->lapbase[k] = M->loop[k] ? floor(a / n) * n : 0.0;
+	*idx = a - M->lapbase[k];
+	M->segment[k] = min((int)*idx, n - 1);
+
+	return 1;
+}
+
+/*									*/
+/*	Leave node k on the last record of its trajectory and stop	*/
+/*	tracking it.							*/
+/*									*/
+static void
+mobilitystop(Engine *E, int k)
+{
+	Mobility	*M = &E->mobility;
+	Trajectory	*T = M->trajectories[k];
+
+
+	mobilitywrite(M->nodes[k], T, T->nlocations - 1, 0.0);
+	mobilityremove(E, k);
+
+	return;
+}
+
+/*									*/
+/*	Position S at fraction frac of the way along segment.		*/
+/*									*/
+static tuck void
+mobilitywrite(State *S, Trajectory *T, int segment, double frac)
+{
+	S->xloc = T->planes[kSunflowerTrajectoryX][segment] + frac*T->deltas[kSunflowerTrajectoryX][segment];
+	S->yloc = T->planes[kSunflowerTrajectoryY][segment] + frac*T->deltas[kSunflowerTrajectoryY][segment];
+	S->zloc = T->planes[kSunflowerTrajectoryZ][segment] + frac*T->deltas[kSunflowerTrajectoryZ][segment];
+
+	S->rho = T->planes[kSunflowerTrajectoryRho][segment] + frac*T->deltas[kSunflowerTrajectoryRho][segment];
+	S->theta = T->planes[kSunflowerTrajectoryTheta][segment] + frac*T->deltas[kSunflowerTrajectoryTheta][segment];
+	S->phi = T->planes[kSunflowerTrajectoryPhi][segment] + frac*T->deltas[kSunflowerTrajectoryPhi][segment];
+
+	S->locversion++;
+
+	return;
+}
+
+static void
+mobilityremove(Engine *E, int k)
+{
+	Mobility	*M = &E->mobility;
+	int		last = --M->nmoving;
+
+
+	M->nodes[k] = M->nodes[last];
+	M->trajectories[k] = M->trajectories[last];
+	M->segment[k] = M->segment[last];
+	M->lapbase[k] = M->lapbase[last];
+	M->rate[k] = M->rate[last];
+	M->loop[k] = M->loop[last];
+	M->written[k] = M->written[last];
+
+	return;
+}
+
+static void
+mobilitygrow(Engine *E)
+{
+	Mobility	*M = &E->mobility;
+	int		n = (M->maxmoving == 0) ? 8 : 2*M->maxmoving;
+
+
+	M->nodes = (State **)mrealloc(E, M->nodes, n*sizeof(State *), "M->nodes in mobility.c");
+	M->trajectories = (Trajectory **)mrealloc(E, M->trajectories, n*sizeof(Trajectory *), "M->trajectories in mobility.c");
+	M->segment = (int *)mrealloc(E, M->segment, n*sizeof(int), "M->segment in mobility.c");
+	M->lapbase = (double *)mrealloc(E, M->lapbase, n*sizeof(double), "M->lapbase in mobility.c");
+	M->rate = (double *)mrealloc(E, M->rate, n*sizeof(double), "M->rate in mobility.c");
+	M->loop = (uchar *)mrealloc(E, M->loop, n*sizeof(uchar), "M->loop in mobility.c");
+	M->written = (int *)mrealloc(E, M->written, n*sizeof(int), "M->written in mobility.c");
+	M->changed = (int *)mrealloc(E, M->changed, n*sizeof(int), "M->changed in mobility.c");
+
+	if ((M->nodes == NULL) || (M->trajectories == NULL) || (M->segment == NULL) ||
+		(M->lapbase == NULL) || (M->rate == NULL) || (M->loop == NULL) ||
+		(M->written == NULL) || (M->changed == NULL))
+	{
+		mexit(E, "Could not allocate memory for the mobility engine.", -1);
+	}
+	M->maxmoving = n;
+
+	return;
+}
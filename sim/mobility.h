@@ -0,0 +1,74 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Mobility engine: moves the nodes that follow a trajectory.	*/
+/*	Only nodes whose trajectory has more than one distinct		*/
+/*	record are kept here, as parallel arrays indexed alike, each	*/
+/*	with a cursor on its current trajectory segment so that an	*/
+/*	update is one multiply-add per coordinate against the		*/
+/*	segment's precomputed per-record delta. A node on a		*/
+/*	stationary segment is written once when it enters it; a	*/
+/*	non-looping node is dropped when it reaches its last record.	*/
+/*									*/
+/*	Every position change bumps the node's locversion, and the	*/
+/*	NODE_IDs moved by the most recent update are listed in		*/
+/*	changed[], for caches of quantities that depend on node		*/
+/*	positions. See mobility.c.					*/
+/*									*/
+enum
+{
+	/*	Beyond this many records, seek rather than step	*/
+	kMobilityMaxSteps	= 16,
+};
+
+typedef struct
+{
+	int		nmoving;
+	int		maxmoving;
+
+	struct State	**nodes;
+	Trajectory	**trajectories;
+	int		*segment;	/*	Current segment: from record segment to the next	*/
+	double		*lapbase;	/*	Trajectory index at which the current lap began		*/
+	double		*rate;		/*	Records per second					*/
+	uchar		*loop;
+	int		*written;	/*	Stationary segment already written, or -1		*/
+
+	int		nchanged;
+	int		*changed;
+} Mobility;
@@ -57,9 +57,96 @@ enum
 
 static int		lookup_id(Engine *, uchar*);
 static int		seg_enqueue(Engine *E, State *S, int whichifc);
-static uchar *		fifo_dequeue(Engine *, State *S, Fifo fifo_name, int whichifc);
+static Netbuf *		fifo_dequeue(Engine *, State *S, Fifo fifo_name, int whichifc);
 static void		netsegcircbuf(Engine *, Segbuf *segbuf);
-static void		seg_dequeue(Netsegment *curseg, int whichbuf);
+static void		seg_dequeue(Engine *, Netsegment *curseg, int whichbuf);
+static void		rx_deliverbyte(Engine *, Netsegment *curseg, Segbuf *segbuf,
+				State *sptr, State *dptr, int whichifc, int offset);
+static void		rx_materialize(Engine *, Ifc *ifcptr, int nbytes);
+
+
+/*									*/
+/*	Frame buffers come from a per-engine pool of power-of-two	*/
+/*	size classes, so FIFO entries and segment buffers cost what	*/
+/*	the segment's frame size needs rather than MAX_FRAMEBYTES.	*/
+/*	Released buffers go back on their class's free list.		*/
+/*									*/
+Netbuf *
+netbuf_alloc(Engine *E, int nbytes)
+{
+	Netbuf	*b;
+	int	class = 0;
+
+
+	while ((class < NETBUF_NCLASSES) && ((NETBUF_MINBYTES << class) < nbytes))
+	{
+		class++;
+	}
+
+	if (class == NETBUF_NCLASSES)
+	{
+		mexit(E, "Frame is larger than the largest frame buffer class.", -1);
+	}
+
+	b = E->netbufpool.freelist[class];
+	if (b != NULL)
+	{
+		E->netbufpool.freelist[class] = b->next;
+	}
+	else
+	{
+		b = (Netbuf *)mcalloc(E, 1, sizeof(Netbuf), "(Netbuf *)b in network-hitachi-sh.c");
+		if (b == NULL)
+		{
+			mexit(E, "mcalloc failed for (Netbuf *)b in network-hitachi-sh.c", -1);
+		}
+
+		b->data = (uchar *)mcalloc(E, NETBUF_MINBYTES << class, sizeof(uchar),
+				"(uchar *)b->data in network-hitachi-sh.c");
+		if (b->data == NULL)
+		{
+			mexit(E, "mcalloc failed for (uchar *)b->data in network-hitachi-sh.c", -1);
+		}
+		b->sizeclass = class;
+	}
+
+	b->next = NULL;
+	b->refs = 1;
+
+
+	return b;
+}
+
+Netbuf *
+netbuf_ref(Netbuf *b)
+{
+	if (b != NULL)
+	{
+		b->refs++;
+	}
+
+	return b;
+}
+
+void
+netbuf_release(Engine *E, Netbuf *b)
+{
+	if (b == NULL || --b->refs > 0)
+	{
+		return;
+	}
+
+	b->next = E->netbufpool.freelist[b->sizeclass];
+	E->netbufpool.freelist[b->sizeclass] = b;
+
+	return;
+}
+
+int
+netbuf_size(Netbuf *b)
+{
+	return NETBUF_MINBYTES << b->sizeclass;
+}
 
 
 /*									*/
@@ -153,12 +240,13 @@ fifo_enqueue(Engine *E, State *S, Fifo which_fifo, int whichifc)
 
 /*									*/
 /*	The fifo_enqueue() and fifo_dequeue() functions just update	*/
-/*	the FIFO indeces.						*/
+/*	the FIFO indeces. fifo_dequeue() hands the caller a reference	*/
+/*	to the entry's frame buffer, which the caller must release.	*/
 /*									*/
-tuck uchar *
+tuck Netbuf *
 fifo_dequeue(Engine *E, State *S, Fifo which_fifo, int whichifc)
 {
-	uchar	*ret_ptr;
+	Netbuf	*ret_ptr;
 	Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
 
 
@@ -188,8 +276,8 @@ fifo_dequeue(Engine *E, State *S, Fifo which_fifo, int whichifc)
 			ifcptr->IFC_TXFIFO_LEVEL--;
 		}
 
-		/*	   Caller of fifo_dequeue will copy data immediately	*/
 		ret_ptr = ifcptr->tx_fifo[ifcptr->tx_fifo_oldestidx];
+		ifcptr->tx_fifo[ifcptr->tx_fifo_oldestidx] = NULL;
 		ifcptr->tx_fifo_oldestidx++;
 		ifcptr->tx_fifo_oldestidx %= ifcptr->tx_fifo_size;
 	}
@@ -219,8 +307,16 @@ fifo_dequeue(Engine *E, State *S, Fifo which_fifo, int whichifc)
 			ifcptr->IFC_RXFIFO_LEVEL--;
 		}
 
-		/*	   Caller of fifo_dequeue will copy data immediately	*/
-		ret_ptr = ifcptr->rx_fifo[ifcptr->rx_fifo_oldestidx];
+		/*							*/
+		/*	On an overrun, the entry may be getting filled	*/
+		/*	right now. The caller gets its own reference,	*/
+		/*	so later writes copy rather than clobber it.	*/
+		/*							*/
+		if ((ifcptr->rx_fifo_oldestidx == ifcptr->rx_fifo_curidx) && (ifcptr->rx_fill != NULL))
+		{
+			rx_materialize(E, ifcptr, max(ifcptr->rx_filln, ifcptr->frame_bits/8));
+		}
+		ret_ptr = netbuf_ref(ifcptr->rx_fifo[ifcptr->rx_fifo_oldestidx]);
 		ifcptr->rx_fifo_oldestidx++;
 		ifcptr->rx_fifo_oldestidx %= ifcptr->rx_fifo_size;
 	}
@@ -235,7 +331,7 @@ seg_enqueue(Engine *E, State *S, int whichifc)
 	int			actual_framesize, i, si, di;
 	Ifc			*ifcptr = &S->superH->NIC_IFCS[whichifc];
 	Netsegment		*Seg = &E->netsegs[ifcptr->segno];
-	uchar			*tptr;
+	Netbuf			*tptr;
 	int			curwidth = Seg->cur_queue_width;
 	char			srcstr[16], dststr[16];
 
@@ -378,7 +474,8 @@ seg_enqueue(Engine *E, State *S, int whichifc)
 		return Etxunderrun;
 	}
 
-	memmove(Seg->segbufs[curwidth].data, tptr, ifcptr->frame_bits/8);
+	/*	The segbuf takes over the TX FIFO entry's buffer	*/
+	Seg->segbufs[curwidth].netbuf = tptr;
 
 	Seg->segbufs[curwidth].timestamp = E->globaltimepsec;
 	Seg->segbufs[curwidth].bits_left = actual_framesize * 8;
@@ -431,11 +528,14 @@ seg_enqueue(Engine *E, State *S, int whichifc)
 }
 
 void
-seg_dequeue(Netsegment *curseg, int whichbuf)
+seg_dequeue(Engine *E, Netsegment *curseg, int whichbuf)
 {
+	netbuf_release(E, curseg->segbufs[whichbuf].netbuf);
+
 	memmove(&curseg->segbufs[whichbuf],
 		&curseg->segbufs[curseg->cur_queue_width - 1],
 		sizeof(Segbuf));
+	curseg->segbufs[curseg->cur_queue_width - 1].netbuf = NULL;
 
 	curseg->cur_queue_width--;
 	if (curseg->cur_queue_width < curseg->queue_max_width)
@@ -453,6 +553,8 @@ remote_seg_enqueue(Engine *E, Segbuf *segbuf)
 	State	*S = (State *)segbuf->src_node;
 	int	whichifc = segbuf->src_ifc;
 	Ifc	*ifcptr = &S->superH->NIC_IFCS[whichifc];
+	Netbuf	**slot = &ifcptr->tx_fifo[ifcptr->tx_fifo_curidx];
+	int	nbytes = segbuf->bits_left/8;
 
 
 	S->from_remote = 1;
@@ -468,7 +570,13 @@ remote_seg_enqueue(Engine *E, Segbuf *segbuf)
 		msnprint((char *)ifcptr->IFC_DST, NIC_ADDR_LEN, "::1");
 	}
 
-	memmove(ifcptr->tx_fifo[ifcptr->tx_fifo_curidx], segbuf->data, segbuf->bits_left/8);
+	/*	The entry may be partially filled locally, so keep it frame-sized	*/
+	if ((*slot == NULL) || (netbuf_size(*slot) < max(nbytes, ifcptr->frame_bits/8)))
+	{
+		netbuf_release(E, *slot);
+		*slot = netbuf_alloc(E, max(nbytes, ifcptr->frame_bits/8));
+	}
+	memmove((*slot)->data, segbuf->netbuf->data, nbytes);
 	ifcptr->tx_fifo_framesizes[ifcptr->tx_fifo_curidx] = segbuf->actual_nbytes;
 	fifo_enqueue(E, S, TX_FIFO, whichifc);
 
@@ -497,7 +605,11 @@ nic_tx_enqueue(Engine *E, State *S, uchar data, int whichifc)
 	}
 
 
-	ifcptr->tx_fifo[ifcptr->tx_fifo_curidx][ifcptr->tx_fifo_h2o++] = data;
+	if (ifcptr->tx_fifo[ifcptr->tx_fifo_curidx] == NULL)
+	{
+		ifcptr->tx_fifo[ifcptr->tx_fifo_curidx] = netbuf_alloc(E, ifcptr->frame_bits/8);
+	}
+	ifcptr->tx_fifo[ifcptr->tx_fifo_curidx]->data[ifcptr->tx_fifo_h2o++] = data;
 
 
 	/*	Set bit in NSR to indicate data in TDR	*/
@@ -548,7 +660,7 @@ nic_rx_dequeue(Engine *E, State *S, int whichifc)
 	/*									*/
 	if (ifcptr->rx_localbuf_h2o == 0)
 	{
-		uchar *tptr;
+		Netbuf *tptr;
 	
 		/*								*/
 		/*	fifo_dequeue will be taking the item at oldestidx	*/
@@ -563,11 +675,12 @@ nic_rx_dequeue(Engine *E, State *S, int whichifc)
 			return (uchar) 0;
 		}
 
-		memmove(ifcptr->rx_localbuf, tptr, framesize);
+		netbuf_release(E, ifcptr->rx_localbuf);
+		ifcptr->rx_localbuf = tptr;
 		ifcptr->rx_localbuf_h2o = framesize;
 	}
 
-	retchar = ifcptr->rx_localbuf[framesize - ifcptr->rx_localbuf_h2o];
+	retchar = ifcptr->rx_localbuf->data[framesize - ifcptr->rx_localbuf_h2o];
 	ifcptr->rx_localbuf_h2o--;
 
 
@@ -608,7 +721,7 @@ tx_retryalg_binexp(void *e, void *x, int whichifc)
 		timeslot = (double)ifcptr->frame_bits/
 					(double)E->netsegs[ifcptr->segno].bitrate;
 		range = timeslot * (pow(2, min(ifcptr->tx_alg_retries, 10)) + 1);
-		delay = fmod((double)mrandom(E), range);
+		delay = fmod((double)mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeNetwork]), range);
 
 		mprint(E, S, nodeinfo,
 			"Binary exponential backoff for %E seconds, node %d ifc %d\n",
@@ -671,7 +784,7 @@ tx_retryalg_random(void *e, void *x, int whichifc)
 		timeslot = (double)ifcptr->frame_bits/
 					(double)E->netsegs[ifcptr->segno].bitrate;
 		range = timeslot*(MAXRANDOMSLOTS + 1);
-		delay = fmod((double)mrandom(E), range);
+		delay = fmod((double)mrandstream(E, &S->randstreams[kSunflowerRandstreamNodeNetwork]), range);
 
 		mprint(E, S, nodeinfo,
 			"Random backoff for %E seconds (range=%E, max=%d slots), node %d ifc %d\n",
@@ -816,7 +929,7 @@ tx_retryalg_none(void *e, void *x, int whichifc)
 		/*	for retryalg_none, we just junk the FIFO	*/
 		/*	entry, no retries for sending it onto medium	*/
 		/*							*/
-		fifo_dequeue(E, S, TX_FIFO, whichifc);
+		netbuf_release(E, fifo_dequeue(E, S, TX_FIFO, whichifc));
 	}
 
 	ifcptr->tx_alg_retries = 0;
@@ -825,6 +938,116 @@ tx_retryalg_none(void *e, void *x, int whichifc)
 	return;
 }
 
+/*									*/
+/*	Give the RX FIFO entry being filled a buffer of its own, then	*/
+/*	write back the bytes of the frame whose delivery was tracked	*/
+/*	without copying (see rx_deliverbyte()).				*/
+/*									*/
+static void
+rx_materialize(Engine *E, Ifc *ifcptr, int nbytes)
+{
+	Netbuf	**slot = &ifcptr->rx_fifo[ifcptr->rx_fifo_curidx];
+	Netbuf	*private;
+
+
+	if ((*slot == NULL) || ((*slot)->refs > 1) || (netbuf_size(*slot) < nbytes))
+	{
+		private = netbuf_alloc(E, nbytes);
+		if (*slot != NULL)
+		{
+			memmove(private->data, (*slot)->data, min(netbuf_size(*slot), nbytes));
+		}
+		else
+		{
+			memset(private->data, 0, netbuf_size(private));
+		}
+
+		netbuf_release(E, *slot);
+		*slot = private;
+	}
+
+	if (ifcptr->rx_fill != NULL)
+	{
+		memmove((*slot)->data, ifcptr->rx_fill->data, ifcptr->rx_filln);
+		netbuf_release(E, ifcptr->rx_fill);
+		ifcptr->rx_fill = NULL;
+		ifcptr->rx_filln = 0;
+	}
+
+	return;
+}
+
+/*									*/
+/*	Deliver byte 'offset' of the frame in segbuf into the RX FIFO	*/
+/*	entry being filled on dptr's IFC whichifc. As long as a frame	*/
+/*	arrives intact and nothing else writes into the entry, we only	*/
+/*	count its bytes, and once it is complete the entry becomes a	*/
+/*	reference to the segbuf's buffer. A broadcast thus shares one	*/
+/*	payload across all receivers. Corrupted or lost bytes (SNR at	*/
+/*	or below minsnr), or frames interleaving on a wide segment,	*/
+/*	fall back to writing bytes into a private copy of the entry.	*/
+/*									*/
+static void
+rx_deliverbyte(Engine *E, Netsegment *curseg, Segbuf *segbuf, State *sptr, State *dptr,
+	int whichifc, int offset)
+{
+	Ifc	*ifcptr = &dptr->superH->NIC_IFCS[whichifc];
+	Netbuf	**slot = &ifcptr->rx_fifo[ifcptr->rx_fifo_curidx];
+	Netbuf	*shared = segbuf->netbuf;
+	int	intact = 1, lost = 0;
+	uchar	data = shared->data[offset];
+
+
+	/*	If we are assoc. w/a sigsrc, measure SNR and corrupt data if SNR is too low	*/
+	if (curseg->sigsrc != NULL)
+	{
+		double snr = check_snr(E, curseg, sptr, dptr);
+
+		if (snr == curseg->minsnr)
+		{
+			/*	SNR at brink. Destination gets noise	*/
+			data &= mrandstream(E, &dptr->randstreams[kSunflowerRandstreamNodeNetwork]);
+			intact = 0;
+		}
+		else if (!(snr > curseg->minsnr))
+		{
+			/*	when snr is too low, dst gets nothing	*/
+			intact = 0;
+			lost = 1;
+		}
+	}
+
+	if (intact && (ifcptr->rx_fill == shared) && (ifcptr->rx_filln == offset))
+	{
+		ifcptr->rx_filln++;
+	}
+	else if (intact && (offset == 0) && (ifcptr->rx_fill == NULL))
+	{
+		ifcptr->rx_fill = netbuf_ref(shared);
+		ifcptr->rx_filln = 1;
+	}
+	else
+	{
+		rx_materialize(E, ifcptr, max(segbuf->actual_nbytes, ifcptr->frame_bits/8));
+		if (!lost)
+		{
+			(*slot)->data[offset] = data;
+		}
+	}
+
+	/*	Whole frame arrived intact: hand the entry our reference	*/
+	if ((ifcptr->rx_fill == shared) && (ifcptr->rx_filln == segbuf->actual_nbytes))
+	{
+		netbuf_release(E, *slot);
+		*slot = ifcptr->rx_fill;
+		ifcptr->rx_fill = NULL;
+		ifcptr->rx_filln = 0;
+	}
+
+
+	return;
+}
+
 void
 network_clock(Engine *E)
 {
@@ -884,33 +1107,7 @@ network_clock(Engine *E)
 						/*	Gets reset for all recipients when we dequeue segbuf	*/
 						dptr->superH->NIC_IFCS[k].IFC_STATE |= NIC_STATE_RX;
 
-
-						/*	If we have an associate physical model		*/
-						if (curseg->sigsrc != NULL)
-						{
-							double snr = check_snr(E, curseg, sptr, dptr);
-
-							if (snr > curseg->minsnr)
-							{
-								dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] =
-									tptr->data[offset];
-							}
-							else if (snr == curseg->minsnr)
-							{
-								/*	SNR too low. Dest. gets noise	*/
-								dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] =
-									tptr->data[offset] & mrandom(E);
-							}
-							else
-							{
-								/*	when snr too low, dst gets nothing	*/
-							}
-						}
-						else
-						{
-							dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] =
-								tptr->data[offset];
-						}
+						rx_deliverbyte(E, curseg, tptr, sptr, dptr, k, offset);
 
 						/*					*/
 						/*	Destination power consumption 	*/
@@ -1006,7 +1203,7 @@ network_clock(Engine *E)
 						}
 					}
 
-					seg_dequeue(curseg, whichbuf);
+					seg_dequeue(E, curseg, whichbuf);
 				}
 
 				/*	Source power consumption	*/
@@ -1042,37 +1239,9 @@ network_clock(Engine *E)
 					/*							*/
 					/*	Subscription to segment enforces framesize	*/
 					/*	is integral multiple of bytes, and receive	*/
-					/*	buf is resized for framesize.			*/
+					/*	buf is sized for framesize.			*/
 					/*							*/
-
-					/*							*/
-					/*	If we are assoc. w/a sigsrc, measure SNR	*/
-					/*	and corrupt data if SNR is too low.		*/
-					/*							*/
-					if (curseg->sigsrc != NULL)
-					{
-						double snr = check_snr(E, curseg, sptr, dptr);
-
-						if (snr > curseg->minsnr)
-						{
-							dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] =
-								tptr->data[offset];
-						}
-						else if (snr == curseg->minsnr)
-						{
-							/*	SNR at brink. Destination gets noise	*/
-							dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] =
-								tptr->data[offset] & mrandom(E);
-						}
-						else
-						{
-							/*	when snr is too low, dst gets nothing	*/
-						}
-					}
-					else
-					{
-						dptr->superH->NIC_IFCS[k].rx_fifo[idx][offset] = tptr->data[offset];
-					}
+					rx_deliverbyte(E, curseg, tptr, sptr, dptr, k, offset);
 
 					/*							*/
 					/*	Destination power consumption (source handled	*/
@@ -1145,7 +1314,7 @@ network_clock(Engine *E)
 				/*							*/
 				dptr->superH->NIC_IFCS[k].IFC_STATE &= ~NIC_STATE_RX;
 
-				seg_dequeue(curseg, whichbuf);
+				seg_dequeue(E, curseg, whichbuf);
 			}
 
 			/*	Source power consumption	*/
@@ -1305,15 +1474,38 @@ netsegcircbuf(Engine *E, Segbuf *segbuf)
 	int	bufsz, i, n = 0;
 
 
-	buf = &E->netiobuf[E->netioh2o][0];
-	bufsz = sizeof(E->netiobuf[0]);
+	/*	Nobody reads the text until netout has been opened	*/
+	if (!E->netiotap)
+	{
+		return;
+	}
+
+	/*	3 chars per byte, a newline every 24, and the header lines	*/
+	bufsz = 4*(segbuf->bits_left/8) + 1024;
+	if (E->netiobufsz[E->netioh2o] < bufsz)
+	{
+		if (E->netiobuf[E->netioh2o] != NULL)
+		{
+			mfree(E, E->netiobuf[E->netioh2o], "(char *)E->netiobuf[] in network-hitachi-sh.c");
+		}
+
+		E->netiobuf[E->netioh2o] = (char *)mcalloc(E, bufsz, sizeof(char),
+						"(char *)E->netiobuf[] in network-hitachi-sh.c");
+		if (E->netiobuf[E->netioh2o] == NULL)
+		{
+			mexit(E, "mcalloc failed for (char *)E->netiobuf[] in network-hitachi-sh.c", -1);
+		}
+		E->netiobufsz[E->netioh2o] = bufsz;
+	}
+	buf = E->netiobuf[E->netioh2o];
+	bufsz = E->netiobufsz[E->netioh2o];
 
 	n += msnprint(&buf[n], bufsz, "Timestamp: %E\n", segbuf->timestamp);
 
 	n += msnprint(&buf[n], bufsz, "Data: ");
 	for (i = 0; i < segbuf->bits_left/8; i++)
 	{
-		n += msnprint(&buf[n], bufsz, "%02X ", segbuf->data[i]);
+		n += msnprint(&buf[n], bufsz, "%02X ", segbuf->netbuf->data[i]);
 		if (!((i+1) % 24))
 		{
 			n += msnprint(&buf[n], bufsz, "\n");
@@ -1340,12 +1532,24 @@ netsegcircbuf(Engine *E, Segbuf *segbuf)
 	n += msnprint(&buf[n], bufsz, "from_remote flag: 0x%08X\n", segbuf->from_remote);
 	n += msnprint(&buf[n], bufsz, "\n\n\n\n");
 
+	E->netiolen[E->netioh2o] = n;
  	E->netioh2o++;
 
+	/*	Drop the oldest text; its buffer is reused for the next	*/
 	if (E->netioh2o == MAX_NETIO_NBUFS)
 	{
-		memmove(E->netiobuf[0], E->netiobuf[1],
-			(MAX_NETIO_NBUFS-1)*MAX_SEGBUF_TEXT);
+		buf = E->netiobuf[0];
+		bufsz = E->netiobufsz[0];
+
+		memmove(&E->netiobuf[0], &E->netiobuf[1],
+			(MAX_NETIO_NBUFS-1)*sizeof(E->netiobuf[0]));
+		memmove(&E->netiobufsz[0], &E->netiobufsz[1],
+			(MAX_NETIO_NBUFS-1)*sizeof(E->netiobufsz[0]));
+		memmove(&E->netiolen[0], &E->netiolen[1],
+			(MAX_NETIO_NBUFS-1)*sizeof(E->netiolen[0]));
+
+		E->netiobuf[MAX_NETIO_NBUFS-1] = buf;
+		E->netiobufsz[MAX_NETIO_NBUFS-1] = bufsz;
 		E->netioh2o--;
 	}
 
@@ -1360,7 +1564,7 @@ netsegdump(Engine *E, char *dumpname, Segbuf *segbuf)
 	char	*buf;
 
 
-	bufsz = MAX_SEGBUF_TEXT;
+	bufsz = MAX_SEGDUMP_LINE;
 	buf = (char *) mmalloc(E, bufsz,
 			"(char *)buf segbuf text in network-hitachi-sh.c");
 	if (buf == NULL)
@@ -1388,7 +1592,7 @@ netsegdump(Engine *E, char *dumpname, Segbuf *segbuf)
 	mprintfd(fd, buf);
 	for (i = 0; i < segbuf->bits_left/8; i++)
 	{
-		msnprint(buf, bufsz, "%02X ", segbuf->data[i]);
+		msnprint(buf, bufsz, "%02X ", segbuf->netbuf->data[i]);
 		mprintfd(fd, buf);
 		if (!((i+1) % 24))
 		{
@@ -1436,7 +1640,7 @@ netsegdump(Engine *E, char *dumpname, Segbuf *segbuf)
 int
 parsenetsegdump(Engine *E, char *buf, Segbuf *segbuf)
 {
-	int	i = 0, off = 0, tmp;
+	int	i = 0, off = 0, tmp, nbytes = 0;
 
 
 	sscanf(buf+off, "Timestamp: %le\n", &segbuf->timestamp);
@@ -1444,11 +1648,28 @@ parsenetsegdump(Engine *E, char *buf, Segbuf *segbuf)
 	sscanf(buf+off, "Data: ");
 	off += strlen("Data: ");
 
+	/*	Count the payload first so the buffer fits the frame	*/
+	for (tmp = off; buf[tmp] != '.' && nbytes < MAX_FRAMEBYTES + 4; nbytes++)
+	{
+		tmp += strlen("XX ");
+		if (!((nbytes+1) % 24))
+		{
+			tmp++;
+		}
+	}
+
+	if ((segbuf->netbuf == NULL) || (segbuf->netbuf->refs > 1) ||
+		(netbuf_size(segbuf->netbuf) < max(nbytes, 1)))
+	{
+		netbuf_release(E, segbuf->netbuf);
+		segbuf->netbuf = netbuf_alloc(E, max(nbytes, 1));
+	}
+
 	/*	MAXFRAMEBYTES for payload, + 4 for cksum	*/
 	for ( ; buf[off] != '.' && i < MAX_FRAMEBYTES + 4; i++)
 	{
 		sscanf(buf+off, "%2X ", &tmp);
-		segbuf->data[i] = (uchar)tmp;
+		segbuf->netbuf->data[i] = (uchar)tmp;
 		off += strlen("XX ");
 
 		if (!((i+1) % 24))
@@ -1607,6 +1828,7 @@ network_netnewseg(Engine *E, int which, int framebits, int pgnspeed, int bitrate
 	}
 
 	tptr->NETSEG_ID = which; 
+	mrandstreaminit(&tptr->randstream, kSunflowerRandstreamNetsegFault, which);
 
 	tptr->segbufs = (Segbuf *)mcalloc(E, tptr->queue_max_width, sizeof(Segbuf),
 				"(Segbuf *)tptr->segbufs in shasm.y");
@@ -1641,9 +1863,6 @@ network_netnewseg(Engine *E, int which, int framebits, int pgnspeed, int bitrate
 void
 network_netsegnicattach(Engine *E, State *S, int whichifc, int whichseg)
 {
-	int i;
-
-
 	if (whichifc >= NIC_MAX_IFCS)
 	{
 		merror(E, "IFC # > max. number of IFCs.");
@@ -1672,9 +1891,14 @@ network_netsegnicattach(Engine *E, State *S, int whichifc, int whichseg)
 	S->superH->NIC_IFCS[whichifc].IFC_BRR = E->netsegs[whichseg].bitrate/1024;
 
 
+	/*							*/
+	/*	FIFO entries start out empty; frame buffers	*/
+	/*	sized for frame_bits are taken from the pool	*/
+	/*	as frames are transmitted and received.		*/
+	/*							*/
 	S->superH->NIC_IFCS[whichifc].rx_fifo =
-		(uchar **)mcalloc(E, S->superH->NIC_IFCS[whichifc].rx_fifo_size,
-		sizeof(uchar *), "shasm.y, (uchar **) for T_NETSEGNICATTACH");
+		(Netbuf **)mcalloc(E, S->superH->NIC_IFCS[whichifc].rx_fifo_size,
+		sizeof(Netbuf *), "shasm.y, (Netbuf **) for T_NETSEGNICATTACH");
 
 	if (S->superH->NIC_IFCS[whichifc].rx_fifo == NULL)
 	{
@@ -1682,23 +1906,9 @@ network_netsegnicattach(Engine *E, State *S, int whichifc, int whichseg)
 		return;
 	}
 
-	for (i = 0; i < S->superH->NIC_IFCS[whichifc].rx_fifo_size; i++)
-	{
-		S->superH->NIC_IFCS[whichifc].rx_fifo[i] =
-			(uchar *)mcalloc(E, E->netsegs[whichseg].frame_bits/8,
-			sizeof(uchar), "shasm.y, (uchar *) for T_NETSEGNICATTACH");
-
-		if (S->superH->NIC_IFCS[whichifc].rx_fifo[i] == NULL)
-		{
-			merror(E, "Could not allocate memory for rx_fifo entry.");
-			return;
-		}
-	}
-
-
 	S->superH->NIC_IFCS[whichifc].tx_fifo =
-		(uchar **)mcalloc(E, S->superH->NIC_IFCS[whichifc].tx_fifo_size, sizeof(uchar *),
-		"shasm.y, (uchar **) for T_NETSEGNICATTACH");
+		(Netbuf **)mcalloc(E, S->superH->NIC_IFCS[whichifc].tx_fifo_size, sizeof(Netbuf *),
+		"shasm.y, (Netbuf **) for T_NETSEGNICATTACH");
 				
 	if (S->superH->NIC_IFCS[whichifc].tx_fifo == NULL)
 	{
@@ -1706,19 +1916,6 @@ network_netsegnicattach(Engine *E, State *S, int whichifc, int whichseg)
 		return;
 	}
 
-	for (i = 0; i < S->superH->NIC_IFCS[whichifc].tx_fifo_size; i++)
-	{
-		S->superH->NIC_IFCS[whichifc].tx_fifo[i] =\
-			(uchar *)mcalloc(E, E->netsegs[whichseg].frame_bits/8, sizeof(uchar),
-			"shasm.y, (uchar *) for T_NETSEGNICATTACH");
-
-		if (S->superH->NIC_IFCS[whichifc].tx_fifo[i] == NULL)
-		{
-			merror(E, "Could not allocate memory for tx_fifo entry.");
-			return;
-		}
-	}
-
 	S->superH->NIC_IFCS[whichifc].tx_fifo_framesizes =
 		(int *)mcalloc(E, S->superH->NIC_IFCS[whichifc].tx_fifo_size,
 		sizeof(int), "network-hitachi-sh.c, (int *) for tx_fifo_framesizes");
@@ -1737,16 +1934,8 @@ network_netsegnicattach(Engine *E, State *S, int whichifc, int whichseg)
 		return;
 	}
 
-	/*	Local buffer for RX only	*/
-	S->superH->NIC_IFCS[whichifc].rx_localbuf =
-		(uchar *)mcalloc(E, S->superH->NIC_IFCS[whichifc].frame_bits/8, sizeof(uchar),
-		"shasm.y, (uchar *) for S->superH->NIC_IFCS[whichifc].rx_localbuf");
-			
-	if (S->superH->NIC_IFCS[whichifc].rx_localbuf == NULL)
-	{
-		merror(E, "Could not allocate memory for rx_localbuf[].");
-		return;
-	}
+	/*	Local buffer for RX only: holds the frame dequeued from rx_fifo	*/
+	S->superH->NIC_IFCS[whichifc].rx_localbuf = NULL;
 
 	S->superH->NIC_IFCS[whichifc].valid = 1;
 		
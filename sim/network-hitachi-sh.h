@@ -43,6 +43,15 @@ enum
 	MAX_FRAMEBYTES		= 200000,
 	MAX_SEGBUF_TEXT		= 3*MAX_FRAMEBYTES + 1024,
 	MAX_NETIO_NBUFS		= 32,
+	MAX_SEGDUMP_LINE	= 128,
+
+	/*							*/
+	/*	Frame buffers come in power-of-two size classes	*/
+	/*	from NETBUF_MINBYTES up; the largest class must	*/
+	/*	hold MAX_FRAMEBYTES plus the 4 byte checksum.	*/
+	/*							*/
+	NETBUF_MINBYTES		= 64,
+	NETBUF_NCLASSES		= 13,
 };
 
 enum
@@ -78,6 +87,26 @@ typedef enum
 	RX_FIFO,
 } Fifo;
 
+/*								*/
+/*	A frame buffer. It is handed from TX FIFO to segment to	*/
+/*	RX FIFO without copying; a broadcast holds one reference	*/
+/*	per receiver that got the frame intact.			*/
+/*								*/
+typedef struct Netbuf Netbuf;
+struct Netbuf
+{
+	int	refs;
+	int	sizeclass;
+	Netbuf	*next;
+	uchar	*data;
+};
+
+typedef struct
+{
+	/*	Released buffers, one free list per size class	*/
+	Netbuf	*freelist[NETBUF_NCLASSES];
+} Netbufpool;
+
 typedef struct
 {
 	int	valid;
@@ -112,21 +141,29 @@ typedef struct
 	int		segno;
 
 
-	/*	Each TX/RX FIFO entry is an array of bytes	*/
-	uchar		**rx_fifo;
-	uchar		**tx_fifo;
+	/*	Each TX/RX FIFO entry is a frame buffer, or NULL	*/
+	Netbuf		**rx_fifo;
+	Netbuf		**tx_fifo;
 
 	/*							*/
-	/*	The FIFO entries are each sized for maximum	*/
-	/*	frame size.  We maintain the actual frame	*/
-	/*	sizes separately.				*/
+	/*	The FIFO entries are each sized for the		*/
+	/*	segment frame size.  We maintain the actual	*/
+	/*	frame sizes separately.				*/
 	/*							*/
 	int		*rx_fifo_framesizes;
 	int		*tx_fifo_framesizes;
 
 	
+	/*							*/
+	/*	Frame being received into rx_fifo[rx_fifo_curidx]	*/
+	/*	without copying, and how many of its leading	*/
+	/*	bytes have arrived intact so far.		*/
+	/*							*/
+	Netbuf		*rx_fill;
+	int		rx_filln;
+
 	/*	For receive only, a further level of buffering	*/
-	uchar		*rx_localbuf;
+	Netbuf		*rx_localbuf;
 	int		rx_localbuf_h2o;
 	int		rx_localbuf_framesize;
 
@@ -204,11 +241,11 @@ struct Segbuf
 	double	timestamp;
 
 	/*						*/
-	/*	Pointer to data from NIC_TX_BUF	plus	*/
-	/*	the checksum. Others depend on size	*/
-	/*	of MAXFRAMEBYTES to not inlcude cksum.	*/
+	/*	Data from NIC_TX_BUF plus the checksum,	*/
+	/*	owned by the segbuf while it is on the	*/
+	/*	segment.				*/
 	/*						*/
-	uchar	data[MAX_FRAMEBYTES + 4];
+	Netbuf	*netbuf;
 	int	actual_nbytes;
 
 	/*	How many bits remain to be emptied	*/
@@ -237,7 +274,10 @@ struct Segbuf
 };
 
 
-typedef struct
+/*	Defined in main.h, which is included after us	*/
+struct Engine;
+
+typedef struct Netsegment
 {
 	int		valid;
 	int		NETSEG_ID;
@@ -281,6 +321,7 @@ typedef struct
 	Pdist		failure_duration_dist;
 	uvlong		failure_duration_max;
 	uvlong		fail_clocks_left;
+	uvlong		faultnextfeed;
 
 	double		correl_coeffs[MAX_SEGNODES];
 
@@ -302,7 +343,10 @@ typedef struct
 
 
 	/*	Pointer to function for failure prob dist	*/
-	uvlong		(*pfun)(void *, void *, char *, uvlong);
+	uvlong		(*pfun)(struct Engine *, struct Netsegment *, FaultDraw, uvlong);
+
+	/*	Counter-based random stream for failure draws	*/
+	Randstream	randstream;
 } Netsegment;
 
 
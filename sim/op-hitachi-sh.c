@@ -2044,6 +2044,7 @@ superH_ldtlb(Engine *E, State *S)
 
 	S->superH->TLB->blocks[i].data = tlbentry_data_pack(ppn, pr, sz, c, d, sh);
 	S->superH->TLB->blocks[i].tag = tlbentry_addr_pack(vpn31_17, vpn11_10, asid, v);
+	superHutlbinvalidate(S);
 
 //	fprintf(stderr, "\n\nsunflower: ldtlb instr\n\n");
 	return;
@@ -298,6 +298,176 @@ riscv_sra(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
 	return;
 }
 
+/*
+ *	RV32M: multiplication and division. Division by zero and signed
+ *	overflow do not trap; they give the results fixed by the ISA manual.
+ */
+void
+riscv_mul(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	reg_set_riscv(E, S, rd, reg_read_riscv(E, S, rs1) * reg_read_riscv(E, S, rs2));
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_mulh(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	int64_t		product = (int64_t)(int32_t)reg_read_riscv(E, S, rs1) * (int64_t)(int32_t)reg_read_riscv(E, S, rs2);
+
+	reg_set_riscv(E, S, rd, (uint32_t)((uint64_t)product >> 32));
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_mulhsu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	int64_t		product = (int64_t)(int32_t)reg_read_riscv(E, S, rs1) * (int64_t)reg_read_riscv(E, S, rs2);
+
+	reg_set_riscv(E, S, rd, (uint32_t)((uint64_t)product >> 32));
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_mulhu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	uint64_t	product = (uint64_t)reg_read_riscv(E, S, rs1) * (uint64_t)reg_read_riscv(E, S, rs2);
+
+	reg_set_riscv(E, S, rd, (uint32_t)(product >> 32));
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_div(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	int32_t		dividend = (int32_t)reg_read_riscv(E, S, rs1);
+	int32_t		divisor = (int32_t)reg_read_riscv(E, S, rs2);
+
+	if (divisor == 0)
+	{
+		reg_set_riscv(E, S, rd, 0xFFFFFFFF);
+	}
+	else if (dividend == INT32_MIN && divisor == -1)
+	{
+		reg_set_riscv(E, S, rd, (uint32_t)dividend);
+	}
+	else
+	{
+		reg_set_riscv(E, S, rd, (uint32_t)(dividend / divisor));
+	}
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_divu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	uint32_t	dividend = reg_read_riscv(E, S, rs1);
+	uint32_t	divisor = reg_read_riscv(E, S, rs2);
+
+	if (divisor == 0)
+	{
+		reg_set_riscv(E, S, rd, 0xFFFFFFFF);
+	}
+	else
+	{
+		reg_set_riscv(E, S, rd, dividend / divisor);
+	}
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_rem(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	int32_t		dividend = (int32_t)reg_read_riscv(E, S, rs1);
+	int32_t		divisor = (int32_t)reg_read_riscv(E, S, rs2);
+
+	if (divisor == 0)
+	{
+		reg_set_riscv(E, S, rd, (uint32_t)dividend);
+	}
+	else if (dividend == INT32_MIN && divisor == -1)
+	{
+		reg_set_riscv(E, S, rd, 0);
+	}
+	else
+	{
+		reg_set_riscv(E, S, rd, (uint32_t)(dividend % divisor));
+	}
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
+void
+riscv_remu(Engine *E, State *S, uint8_t rs1, uint8_t rs2, uint8_t rd)
+{
+	uint32_t	dividend = reg_read_riscv(E, S, rs1);
+	uint32_t	divisor = reg_read_riscv(E, S, rs2);
+
+	if (divisor == 0)
+	{
+		reg_set_riscv(E, S, rd, dividend);
+	}
+	else
+	{
+		reg_set_riscv(E, S, rd, dividend % divisor);
+	}
+
+	if (SF_TAINTANALYSIS)
+	{
+		taintprop(E, S,	taintretreg(E,S,rs1),	taintretreg(E,S,rs2),
+				(uint64_t)rd,		kSunflowerTaintMemTypeRegister);
+	}
+
+	return;
+}
+
 void
 riscv_addi(Engine *E, State *S, uint8_t rs1, uint8_t rd, uint32_t	imm0)
 {
@@ -41,7 +41,7 @@
 #include "mextern.h"
 
 #include "regaccess-ti-msp430.c"
-#include "mem-ti-msp430.c"
+#include "devsim430x1xx.c"
 
 
 enum
@@ -69,6 +69,77 @@ enum
 */
 
 
+/*									*/
+/*	An operand's extension word follows the instruction word, and	*/
+/*	the destination operand's also follows the source operand's	*/
+/*	when both have one. For symbolic mode, this is also the PC	*/
+/*	value the offset is relative to.				*/
+/*									*/
+static tuck ushort
+extaddr(Engine *E, State *S, int whichop, MSP430Pipestage *p)
+{
+	ushort	addr = msp430regread(E, S, MSP430_PC, p) + 2;
+
+	if ((whichop == SECOND_OP) && (p->format == MSP430_INSTR_I) &&
+		(	(p->amode_s == MSP430_AMODE_IDX) ||
+			(p->amode_s == MSP430_AMODE_SYM) ||
+			(p->amode_s == MSP430_AMODE_ABS) ||
+			(p->amode_s == MSP430_AMODE_IMM)))
+	{
+		addr += 2;
+	}
+
+	return addr;
+}
+
+/*									*/
+/*	msp430regread() returns the constant generator values for R2	*/
+/*	and R3 based on As, which only applies to the source operand.	*/
+/*									*/
+static tuck ushort
+opregread(Engine *E, State *S, int regnum, int whichop, MSP430Pipestage *p)
+{
+	int	As = p->As;
+	ushort	data;
+
+
+	if (whichop == FIRST_OP)
+	{
+		return msp430regread(E, S, regnum, p);
+	}
+
+	p->As = 0;
+	data = msp430regread(E, S, regnum, p);
+	p->As = As;
+
+	return data;
+}
+
+static tuck ushort
+opaddr(Engine *E, State *S, int mode, int regnum, int whichop, MSP430Pipestage *p)
+{
+	ushort	X = msp430readword(E, S, extaddr(E, S, whichop, p));
+
+
+	switch (mode)
+	{
+		case MSP430_AMODE_SYM:
+		{
+			return extaddr(E, S, whichop, p) + X;
+		}
+
+		case MSP430_AMODE_ABS:
+		{
+			return X;
+		}
+
+		default:
+		{
+			return opregread(E, S, regnum, whichop, p) + X;
+		}
+	}
+}
+
 static tuck ushort
 getval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr, MSP430Pipestage *p)
 {
@@ -76,34 +147,20 @@ getval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr,
 	{
 		case MSP430_AMODE_REG:
 		{
-			return msp430regread(S, regnum, p);
+			return opregread(E, S, regnum, whichop, p);
 		}
 
 		case MSP430_AMODE_IDX:
 		case MSP430_AMODE_SYM:
 		case MSP430_AMODE_ABS:
 		{
-			int	X = msp430readword(S,
-					msp430regread(S, MSP430_PC, p) + (1 << whichop));
-
-		/*
-			BUG ?: If you look at example in slau049e.pdf, 3.3.3, it looks like 
-			the value should be X + PC + (1 << whichop) in the case of IDX mode
-			i.e., we don't use the PC as the base address for the register indirect,
-			but rather add the address at which the offset resides (the memory 
-			address of X) to X (at least in the case of IDX mode). I think the 
-			manual is wrong, since it contradicts itself right there in in 3.3.3 
-			saying the addresses are X + PC and Y+PC, and not of X+&X, Y+&Y... ???  
-			(similar thing is done in 3.3.7)...
-		*/
-
 			if (iswordinstr)
 			{
-				return msp430readword(S, msp430regread(S, regnum, p) + X);
+				return msp430readword(E, S, opaddr(E, S, mode, regnum, whichop, p));
 			}
 			else
 			{
-				return msp430readbyte(S, msp430regread(S, regnum, p) + X);
+				return msp430readbyte(E, S, opaddr(E, S, mode, regnum, whichop, p));
 			}
 		}
 
@@ -111,27 +168,32 @@ getval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr,
 		{
 			if (iswordinstr)
 			{
-				return msp430readword(S, msp430regread(S, regnum, p));
+				return msp430readword(E, S, msp430regread(E, S, regnum, p));
 			}
 			else
 			{
-				return msp430readbyte(S, msp430regread(S, regnum, p));
+				return msp430readbyte(E, S, msp430regread(E, S, regnum, p));
 			}
 		}
 
 		case MSP430_AMODE_INC:
 		{
-			ushort	addr = msp430regread(S, regnum, p);
+			ushort	addr = msp430regread(E, S, regnum, p);
 
-			msp430regset(S, regnum, msp430regread(S, regnum, p) + (1 << iswordinstr));
+			/*						*/
+			/*	The stack pointer always moves by a	*/
+			/*	word, so that it stays aligned.		*/
+			/*						*/
+			msp430regset(E, S, regnum, addr +
+				((iswordinstr || regnum == MSP430_SP) ? 2 : 1));
 
 			if (iswordinstr)
 			{
-				return msp430readword(S, addr);
+				return msp430readword(E, S, addr);
 			}
 			else
 			{
-				return msp430readbyte(S, addr);
+				return msp430readbyte(E, S, addr);
 			}
 		}
 
@@ -139,13 +201,11 @@ getval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr,
 		{
 			if (iswordinstr)
 			{
-				return msp430readword(S,
-					msp430regread(S, MSP430_PC, p)+ (1 << whichop));
+				return msp430readword(E, S, extaddr(E, S, whichop, p));
 			}
 			else
 			{
-				return msp430readbyte(S,
-					msp430regread(S, MSP430_PC, p)+ (1 << whichop));
+				return msp430readbyte(E, S, extaddr(E, S, whichop, p));
 			}
 		}
 
@@ -167,22 +227,64 @@ setval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr,
 	{
 		case MSP430_AMODE_REG:
 		{
-			msp430regset(S, regnum, data);
+			/*							*/
+			/*	Every op advances PC by ilen once it is done,	*/
+			/*	so a result written to PC (e.g., a RET, which	*/
+			/*	is MOV @SP+, PC) is biased to land on data.	*/
+			/*	Byte ops clear the high byte of a register.	*/
+			/*							*/
+			if (!iswordinstr)
+			{
+				data &= 0xFF;
+			}
+			if (regnum == MSP430_PC)
+			{
+				data -= p->ilen;
+			}
+			msp430regset(E, S, regnum, data);
+
+			break;
 		}
 
 		case MSP430_AMODE_IDX:
 		case MSP430_AMODE_SYM:
 		case MSP430_AMODE_ABS:
 		{
-			int X = msp430readword(S, msp430regread(S, MSP430_PC, p) + (1 << whichop));
 			if (iswordinstr)
 			{
-				msp430writeword(S, msp430regread(S, regnum, p) + X, data);
+				msp430writeword(E, S, opaddr(E, S, mode, regnum, whichop, p), data);
 			}
 			else
 			{
-				msp430writebyte(S, msp430regread(S, regnum, p) + X, data);
+				msp430writebyte(E, S, opaddr(E, S, mode, regnum, whichop, p), data);
 			}
+
+			break;
+		}
+
+		/*							*/
+		/*	Format II ops write back through their single	*/
+		/*	source/destination operand.			*/
+		/*							*/
+		case MSP430_AMODE_IND:
+		case MSP430_AMODE_INC:
+		{
+			ushort	addr = msp430regread(E, S, regnum, p);
+
+			if (mode == MSP430_AMODE_INC)
+			{
+				addr -= (iswordinstr || regnum == MSP430_SP) ? 2 : 1;
+			}
+			if (iswordinstr)
+			{
+				msp430writeword(E, S, addr, data);
+			}
+			else
+			{
+				msp430writebyte(E, S, addr, data);
+			}
+
+			break;
 		}
 
 		default:
@@ -239,44 +341,44 @@ setval(Engine *E, State *S, int mode, int regnum, int whichop, int iswordinstr,
 /*												*/
 
 tuck void
-msp430_mov(State *S, ushort m, ushort n, MSP430Pipestage *p)
+msp430_mov(Engine *E, State *S, ushort m, ushort n, MSP430Pipestage *p)
 {
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR,
-		getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p), p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR,
+		getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p), p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_movb(State *S, ushort m, ushort n, MSP430Pipestage *p)
+msp430_movb(Engine *E, State *S, ushort m, ushort n, MSP430Pipestage *p)
 {
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR,
-		getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF, p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR,
+		getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF, p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_add(State *S, ushort m, ushort n, MSP430Pipestage *p)
+msp430_add(Engine *E, State *S, ushort m, ushort n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_src, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
 	result = orig_src + orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -285,7 +387,7 @@ msp430_add(State *S, ushort m, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((short)orig_dst > (short)result)
+	if ((ulong)orig_src + orig_dst > 0xFFFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -295,32 +397,32 @@ msp430_add(State *S, ushort m, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_addb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_addb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	tmpSR, orig_dst, orig_src, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
 	result = orig_src + orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -329,7 +431,7 @@ msp430_addb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((char)orig_dst > (char)result)
+	if ((ulong)orig_src + orig_dst > 0xFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -339,33 +441,33 @@ msp430_addb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_addc(State *S, int m, int n, MSP430Pipestage *p)
+msp430_addc(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_src, result, C;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
 	result = orig_src + orig_dst + C;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -374,7 +476,7 @@ msp430_addc(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((short)orig_dst > (short)result)
+	if ((ulong)orig_src + orig_dst + C > 0xFFFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -384,34 +486,34 @@ msp430_addc(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_addcb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_addcb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR;
 	uchar	orig_dst, orig_src, result, C;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
 	result = orig_src + orig_dst + C;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -420,7 +522,7 @@ msp430_addcb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((char)orig_dst > (char)result)
+	if ((ulong)orig_src + orig_dst + C > 0xFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -430,32 +532,32 @@ msp430_addcb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_sub(State *S, int m, int n, MSP430Pipestage *p)
+msp430_sub(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_src, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	result = orig_dst + !orig_src + 1;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	result = orig_dst + ~orig_src + 1;
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -464,7 +566,7 @@ msp430_sub(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((short)orig_dst < (short)result)
+	if (orig_dst >= orig_src)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -474,33 +576,33 @@ msp430_sub(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_subb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_subb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR;
 	uchar	orig_dst, orig_src, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
-	result = orig_dst + !orig_src + 1;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	result = orig_dst + ~orig_src + 1;
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -509,43 +611,43 @@ msp430_subb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((char)orig_dst < (char)result)
+	if (orig_dst >= orig_src)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	if ((!(orig_src >> 7) && (orig_dst >> 7) && (result >> 7)) ||
-		((orig_src >> 7) && !(orig_dst >> 7) && !(result >> 7))
+	if ((!(orig_dst >> 7) && (orig_src >> 7) && (result >> 7)) ||
+		((orig_dst >> 7) && !(orig_src >> 7) && !(result >> 7))
 	)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_subc(State *S, int m, int n, MSP430Pipestage *p)
+msp430_subc(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_src, result, C;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	result = orig_dst + !orig_src + 1 + C;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	result = orig_dst + ~orig_src + C;
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -554,7 +656,7 @@ msp430_subc(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((short)orig_dst < (short)result)
+	if ((ulong)orig_dst + (ushort)~orig_src + C > 0xFFFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -564,34 +666,34 @@ msp430_subc(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_subcb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_subcb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR;
 	uchar	orig_dst, orig_src, result, C;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
-	result = orig_dst + !orig_src + 1;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	result = orig_dst + ~orig_src + C;
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -600,43 +702,42 @@ msp430_subcb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((char)orig_dst < (char)result)
+	if ((ulong)orig_dst + (uchar)~orig_src + C > 0xFF)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	if ((!(orig_src >> 7) && (orig_dst >> 7) && (result >> 7)) ||
-		((orig_src >> 7) && !(orig_dst >> 7) && !(result >> 7))
+	if ((!(orig_dst >> 7) && (orig_src >> 7) && (result >> 7)) ||
+		((orig_dst >> 7) && !(orig_src >> 7) && !(result >> 7))
 	)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_cmp(State *S, int m, int n, MSP430Pipestage *p)
+msp430_cmp(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_src, result;
 	int	dsign = 1, ssign = 1, asign = 1;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	result = !orig_src + 1 + orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	result = ~orig_src + 1 + orig_dst;
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -645,7 +746,7 @@ msp430_cmp(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((short)orig_dst > (short)result)
+	if (orig_dst >= orig_src)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -661,38 +762,37 @@ msp430_cmp(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		asign = 0;
 	}
-	if ((ssign == dsign) && (asign != ssign))
+	if ((ssign != dsign) && (asign != dsign))
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_cmpb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_cmpb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	orig_dst, orig_src, result;
 	int	dsign = 1, ssign = 1, asign = 1;
 	ushort	tmpSR;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
-	result = !orig_src + 1 + orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	result = ~orig_src + 1 + orig_dst;
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -701,7 +801,7 @@ msp430_cmpb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	if ((char)orig_dst > (char)result)
+	if (orig_dst >= orig_src)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
@@ -717,33 +817,33 @@ msp430_cmpb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		asign = 0;
 	}
-	if ((ssign == dsign) && (asign != ssign))
+	if ((ssign != dsign) && (asign != dsign))
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_dadd(State *S, int m, int n, MSP430Pipestage *p)
+msp430_dadd(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, result, orig_dst, orig_src, C;
 	int	src_dec, dst_dec, result_dec, d1, d2, d3, d4;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
 
 	/*	 B -> BCD	*/
 	src_dec = (orig_src & 0xF) +
@@ -762,9 +862,9 @@ msp430_dadd(State *S, int m, int n, MSP430Pipestage *p)
 	d2 = (result_dec/10);	if (d2 > 0) result_dec -= d2*10;
 	d1 = result_dec;
 	result = (d4 << 12) | (d3 << 8) | (d2 << 4) | d1;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -777,30 +877,30 @@ msp430_dadd(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_daddb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_daddb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	result, orig_dst, orig_src;
 	int	src_dec, dst_dec, result_dec, d1, d2;
 	ushort	C, tmpSR;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	C = msp430_sreg_get_C(tmpSR);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
 
 	/*	 B -> BCD	*/
 	src_dec = (orig_src & 0xF) +
@@ -813,10 +913,10 @@ msp430_daddb(State *S, int m, int n, MSP430Pipestage *p)
 	d2 = (result_dec/10);	if (d2 > 0) result_dec -= d2*10;
 	d1 = result_dec;
 	result = (d2 << 4) | d1;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
-	if ((result >> 15) & B0001)
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
+	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
 	}
@@ -828,30 +928,30 @@ msp430_daddb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_bit(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bit(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	result = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
-		getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	result = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
+		getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -864,31 +964,31 @@ msp430_bit(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_bitb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bitb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	result;
 	ushort	tmpSR;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	result = (getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
-		(getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
+	result = (getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
+		(getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -901,86 +1001,86 @@ msp430_bitb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_bic(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bic(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	result;
 
-	result = !getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
-			getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	result = ~getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
+			getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_bicb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bicb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	result;
 
-	result = !(getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
-		(getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	result = ~(getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
+		(getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_bis(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bis(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	result;
 
-	result = !getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p) | 
-		getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	result = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p) |
+		getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_bisb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_bisb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	result;
 
-	result = !(getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) |
-		(getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	result = (getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) |
+		(getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_xor(State *S, int m, int n, MSP430Pipestage *p)
+msp430_xor(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_src, orig_dst, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
 	result = orig_src ^ orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((short)orig_src < 0 && (short)orig_dst < 0)
 	{
 		msp430_sreg_set_V(tmpSR);
@@ -997,8 +1097,8 @@ msp430_xor(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
@@ -1006,24 +1106,24 @@ msp430_xor(State *S, int m, int n, MSP430Pipestage *p)
 
 
 tuck void
-msp430_xorb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_xorb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	tmpSR, orig_src, orig_dst, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	orig_src = getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	orig_dst = getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
+	orig_src = getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_dst = getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF;
 	result = orig_src ^ orig_dst;
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((char)orig_src < 0 && (char)orig_dst < 0)
 	{
 		msp430_sreg_set_V(tmpSR);
@@ -1040,31 +1140,31 @@ msp430_xorb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_and(State *S, int m, int n, MSP430Pipestage *p)
+msp430_and(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	result = getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
-			getval(S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
-	setval(S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
+	result = getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p) &
+			getval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, p);
+	setval(E, S, p->amode_d, n, SECOND_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -1077,32 +1177,32 @@ msp430_and(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_andb(State *S, int m, int n, MSP430Pipestage *p)
+msp430_andb(Engine *E, State *S, int m, int n, MSP430Pipestage *p)
 {
 	uchar	result;
 	ushort	tmpSR;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	msp430_sreg_clr_C(tmpSR);
 	msp430_sreg_clr_Z(tmpSR);
 	msp430_sreg_clr_N(tmpSR);
 	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_SR, tmpSR);
 
-	result = (getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
-			(getval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
-	setval(S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
+	result = (getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF) &
+			(getval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, p) & 0xFF);
+	setval(E, S, p->amode_d, n, SECOND_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -1115,8 +1215,8 @@ msp430_andb(State *S, int m, int n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
@@ -1153,28 +1253,28 @@ msp430_andb(State *S, int m, int n, MSP430Pipestage *p)
 /*												*/
 
 tuck void
-msp430_rrc(State *S, ushort n, MSP430Pipestage *p)
+msp430_rrc(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, orig_C, tmp, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
 
-	orig_dst = getval(S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
 	orig_C = msp430_sreg_get_C(tmpSR);
 	tmp = orig_C << 15;
-	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
 	result = (orig_dst >> 1) | tmp;
-	setval(S, p->amode_s, n, FIRST_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, result, p);
 
-	if (((short)orig_dst > 0) && orig_C)
+	msp430_sreg_clr_C(tmpSR);
+	msp430_sreg_clr_Z(tmpSR);
+	msp430_sreg_clr_N(tmpSR);
+	msp430_sreg_clr_V(tmpSR);
+	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
+	if (((short)orig_dst >= 0) && orig_C)
 	{
 		msp430_sreg_set_V(tmpSR);
 	}
-	else
-	{
-		msp430_sreg_clr_V(tmpSR);
-	}
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -1183,35 +1283,34 @@ msp430_rrc(State *S, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_rrcb(State *S, ushort n, MSP430Pipestage *p)
+msp430_rrcb(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
-	uchar	orig_dst, tmp, result;
+	uchar	orig_dst, orig_C, result;
 	ushort	tmpSR;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
-	orig_dst = getval(S, p->amode_s, n, FIRST_OP, BYTEINSTR, p) & 0xFF;
-	tmp = msp430_sreg_get_C(tmpSR) << 7;
-	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
-	result = (orig_dst >> 1) | tmp;
-	setval(S, p->amode_d, n, FIRST_OP, BYTEINSTR, result, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
+	orig_dst = getval(E, S, p->amode_s, n, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	orig_C = msp430_sreg_get_C(tmpSR);
+	result = (orig_dst >> 1) | (orig_C << 7);
+	setval(E, S, p->amode_d, n, FIRST_OP, BYTEINSTR, result, p);
 
-	if (((char)orig_dst > 0) && msp430_sreg_get_C(tmpSR))
+	msp430_sreg_clr_C(tmpSR);
+	msp430_sreg_clr_Z(tmpSR);
+	msp430_sreg_clr_N(tmpSR);
+	msp430_sreg_clr_V(tmpSR);
+	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
+	if (((char)orig_dst >= 0) && orig_C)
 	{
 		msp430_sreg_set_V(tmpSR);
-
-	}
-	else
-	{
-		msp430_sreg_clr_V(tmpSR);
 	}
 	if ((result >> 7) & B0001)
 	{
@@ -1221,26 +1320,30 @@ msp430_rrcb(State *S, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_rra(State *S, ushort n, MSP430Pipestage *p)
+msp430_rra(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, orig_dst, tmp, result;
 
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
-	orig_dst = getval(S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
-	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
+	orig_dst = getval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
 	tmp = orig_dst & (1 << 15);
 	result = (orig_dst >> 1) | tmp;
-	setval(S, p->amode_d, n, FIRST_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, FIRST_OP, WORDINSTR, result, p);
 
+	msp430_sreg_clr_C(tmpSR);
+	msp430_sreg_clr_Z(tmpSR);
+	msp430_sreg_clr_N(tmpSR);
+	msp430_sreg_clr_V(tmpSR);
+	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -1249,29 +1352,31 @@ msp430_rra(State *S, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_rrab(State *S, ushort n, MSP430Pipestage *p)
+msp430_rrab(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	uchar	tmp, result, orig_dst;
 	ushort	tmpSR;
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
-	orig_dst = getval(S, p->amode_s, n, FIRST_OP, BYTEINSTR, p) & 0xFF;
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
+	orig_dst = getval(E, S, p->amode_s, n, FIRST_OP, BYTEINSTR, p) & 0xFF;
 	tmp = orig_dst & (1 << 7);
-	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
 	result = (orig_dst >> 1) | tmp;
-	setval(S, p->amode_d, n, FIRST_OP, BYTEINSTR, result, p);
+	setval(E, S, p->amode_d, n, FIRST_OP, BYTEINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
-	if ((result >> 15) & B0001)
+	msp430_sreg_clr_C(tmpSR);
+	msp430_sreg_clr_Z(tmpSR);
+	msp430_sreg_clr_N(tmpSR);
+	msp430_sreg_clr_V(tmpSR);
+	msp430_sreg_setval_C(tmpSR, (orig_dst & 0x1));
+	if ((result >> 7) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
 	}
@@ -1279,80 +1384,85 @@ msp430_rrab(State *S, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_Z(tmpSR);
 	}
-	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
 }
 
 tuck void
-msp430_push(State *S, ushort m, MSP430Pipestage *p)
+msp430_push(Engine *E, State *S, ushort m, MSP430Pipestage *p)
 {
-	msp430regset(S, MSP430_SP, msp430regread(S, MSP430_SP, p) - 2);
-	msp430writeword(S, msp430regread(S, MSP430_SP, p),
-		getval(S, p->amode_s, m, FIRST_OP, WORDINSTR, p));
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SP, msp430regread(E, S, MSP430_SP, p) - 2);
+	msp430writeword(E, S, msp430regread(E, S, MSP430_SP, p),
+		getval(E, S, p->amode_s, m, FIRST_OP, WORDINSTR, p));
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_pushb(State *S, ushort m, MSP430Pipestage *p)
+msp430_pushb(Engine *E, State *S, ushort m, MSP430Pipestage *p)
 {
-	msp430regset(S, MSP430_SP, msp430regread(S, MSP430_SP, p) - 2);
-	msp430writebyte(S, msp430regread(S, MSP430_SP, p),
-		(getval(S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF));
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SP, msp430regread(E, S, MSP430_SP, p) - 2);
+	msp430writebyte(E, S, msp430regread(E, S, MSP430_SP, p),
+		(getval(E, S, p->amode_s, m, FIRST_OP, BYTEINSTR, p) & 0xFF));
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_swpb(State *S, ushort n, MSP430Pipestage *p)
+msp430_swpb(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	ushort	tmp;
 
-	tmp = getval(S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
-	setval(S, p->amode_d, n, FIRST_OP, BYTEINSTR, (tmp >> 8) | ((tmp & 0xFF) << 8), p);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	tmp = getval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
+	setval(E, S, p->amode_d, n, FIRST_OP, WORDINSTR, (tmp >> 8) | ((tmp & 0xFF) << 8), p);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 	return;
 }
 
 tuck void
-msp430_call(State *S, ushort n, MSP430Pipestage *p)
+msp430_call(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	ushort tmp;
 
-	tmp = getval(S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
-	msp430regset(S, MSP430_SP, msp430regread(S, MSP430_SP, p) - 2);
-	msp430writeword(S, msp430regread(S, MSP430_SP, p), msp430regread(S, MSP430_PC, p));
-	msp430regset(S, MSP430_PC, tmp);
+	/*							*/
+	/*	The return address pushed is that of the	*/
+	/*	instruction after the CALL and its extension	*/
+	/*	word, if any.					*/
+	/*							*/
+	tmp = getval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
+	msp430regset(E, S, MSP430_SP, msp430regread(E, S, MSP430_SP, p) - 2);
+	msp430writeword(E, S, msp430regread(E, S, MSP430_SP, p),
+		msp430regread(E, S, MSP430_PC, p) + p->ilen);
+	msp430regset(E, S, MSP430_PC, tmp);
 
 	return;
 }
 
 tuck void
-msp430_reti(State *S, MSP430Pipestage *p)
+msp430_reti(Engine *E, State *S, MSP430Pipestage *p)
 {
-	msp430regset(S, MSP430_SR,
-		msp430readword(S, msp430regread(S, MSP430_SP, p)));
-	msp430regset(S, MSP430_SP, msp430regread(S, MSP430_SP, p) + 2);
-	msp430regset(S, MSP430_PC,
-		msp430readword(S, msp430regread(S, MSP430_SP, p)));
-	msp430regset(S, MSP430_SP, msp430regread(S, MSP430_SP, p) + 2);
+	msp430regset(E, S, MSP430_SR,
+		msp430readword(E, S, msp430regread(E, S, MSP430_SP, p)));
+	msp430regset(E, S, MSP430_SP, msp430regread(E, S, MSP430_SP, p) + 2);
+	msp430regset(E, S, MSP430_PC,
+		msp430readword(E, S, msp430regread(E, S, MSP430_SP, p)));
+	msp430regset(E, S, MSP430_SP, msp430regread(E, S, MSP430_SP, p) + 2);
 
 	return;
 }
 
 tuck void
-msp430_sxt(State *S, ushort n, MSP430Pipestage *p)
+msp430_sxt(Engine *E, State *S, ushort n, MSP430Pipestage *p)
 {
 	ushort	tmpSR, result, orig_dst;
 
-	orig_dst = getval(S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
+	orig_dst = getval(E, S, p->amode_s, n, FIRST_OP, WORDINSTR, p);
 	if (orig_dst & (1 << 7))
 	{
 		result = orig_dst | 0xFF00;
@@ -1361,9 +1471,13 @@ msp430_sxt(State *S, ushort n, MSP430Pipestage *p)
 	{
 		result = orig_dst & 0x00FF;
 	}
-	setval(S, p->amode_d, n, FIRST_OP, WORDINSTR, result, p);
+	setval(E, S, p->amode_d, n, FIRST_OP, WORDINSTR, result, p);
 
-	tmpSR = msp430regread(S, MSP430_SR, p);
+	tmpSR = msp430regread(E, S, MSP430_SR, p);
+	msp430_sreg_clr_C(tmpSR);
+	msp430_sreg_clr_Z(tmpSR);
+	msp430_sreg_clr_N(tmpSR);
+	msp430_sreg_clr_V(tmpSR);
 	if ((result >> 15) & B0001)
 	{
 		msp430_sreg_set_N(tmpSR);
@@ -1376,9 +1490,8 @@ msp430_sxt(State *S, ushort n, MSP430Pipestage *p)
 	{
 		msp430_sreg_set_C(tmpSR);
 	}
-	msp430_sreg_clr_V(tmpSR);
-	msp430regset(S, MSP430_SR, tmpSR);
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+	msp430regset(E, S, MSP430_SR, tmpSR);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 
 
 	return;
@@ -1408,17 +1521,19 @@ msp430_sxt(State *S, ushort n, MSP430Pipestage *p)
 /*	JL		Label		Jump to label if (N .XOR. V) = 1			*/
 /*	JMP		Label		Jump to label unconditionally				*/
 /*												*/
+/*	The offset is in words, from the PC of the word following the jump.			*/
+/*												*/
 
 tuck void
-msp430_jeqjz(State *S, short offset, MSP430Pipestage *p)
+msp430_jeqjz(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	if (msp430_sreg_get_Z(msp430regread(S, MSP430_SR, p)))
+	if (msp430_sreg_get_Z(msp430regread(E, S, MSP430_SR, p)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1426,30 +1541,30 @@ msp430_jeqjz(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jnejnz(State *S, short offset, MSP430Pipestage *p)
+msp430_jnejnz(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	if (!msp430_sreg_get_Z(msp430regread(S, MSP430_SR, p)))
+	if (!msp430_sreg_get_Z(msp430regread(E, S, MSP430_SR, p)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
 }
 
 tuck void
-msp430_jc(State *S, short offset, MSP430Pipestage *p)
+msp430_jc(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	if (msp430_sreg_get_C(msp430regread(S, MSP430_SR, p)))
+	if (msp430_sreg_get_C(msp430regread(E, S, MSP430_SR, p)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1457,15 +1572,15 @@ msp430_jc(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jnc(State *S, short offset, MSP430Pipestage *p)
+msp430_jnc(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	if (!msp430_sreg_get_C(msp430regread(S, MSP430_SR, p)))
+	if (!msp430_sreg_get_C(msp430regread(E, S, MSP430_SR, p)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1473,15 +1588,15 @@ msp430_jnc(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jn(State *S, short offset, MSP430Pipestage *p)
+msp430_jn(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	if (msp430_sreg_get_N(msp430regread(S, MSP430_SR, p)))
+	if (msp430_sreg_get_N(msp430regread(E, S, MSP430_SR, p)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1489,16 +1604,16 @@ msp430_jn(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jge(State *S, short offset, MSP430Pipestage *p)
+msp430_jge(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	ushort	tmpSR = msp430regread(S, MSP430_SR, p);
+	ushort	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if (!(msp430_sreg_get_N(tmpSR) ^ msp430_sreg_get_V(tmpSR)))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1506,16 +1621,16 @@ msp430_jge(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jl(State *S, short offset, MSP430Pipestage *p)
+msp430_jl(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	ushort	tmpSR = msp430regread(S, MSP430_SR, p);
+	ushort	tmpSR = msp430regread(E, S, MSP430_SR, p);
 	if (msp430_sreg_get_N(tmpSR) ^ msp430_sreg_get_V(tmpSR))
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 	}
 	else
 	{
-		msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p)+p->ilen);
+		msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p)+p->ilen);
 	}
 
 	return;
@@ -1523,9 +1638,9 @@ msp430_jl(State *S, short offset, MSP430Pipestage *p)
 
 
 tuck void
-msp430_jmp(State *S, short offset, MSP430Pipestage *p)
+msp430_jmp(Engine *E, State *S, short offset, MSP430Pipestage *p)
 {
-	msp430regset(S, MSP430_PC, msp430regread(S, MSP430_PC, p) + 2*offset);
+	msp430regset(E, S, MSP430_PC, msp430regread(E, S, MSP430_PC, p) + 2 + 2*offset);
 
 	return;
 }
@@ -167,6 +167,7 @@ pau_clk(Engine *E, State *S)
 
 					S->superH->influenced = 0;
 					S->superH->controlling_pau = -1;
+					power_materialize(E, S);
 					S->VDD = S->SVDD;
 					power_scaledelay(E, S, S->VDD);
 				}
@@ -234,6 +235,7 @@ pau_lvdd(Engine *E, State *S, int pauentry)
 	mprint(E, S, nodeinfo, "mf=[%.4f], cf=[%.4f], delta=[%.4f], calc_vdd=[%.4f]\n",
 		mf, cf, delta, calc_vdd);
 
+	power_materialize(E, S);
 	S->SVDD = S->VDD;
 	S->VDD = calc_vdd;
 	power_scaledelay(E, S, S->VDD);
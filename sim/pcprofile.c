@@ -0,0 +1,710 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+typedef struct
+{
+	int		sym;
+	Pcprofentry	total;
+} Pcproffunc;
+
+static Pcprofentry	*pcprofentry(Engine *E, Pcprofile *p, ulong pc);
+static Pcprofentry	*pcprofstackentry(Engine *E, State *S, Pcprofile *p, ulong pc);
+static void	pcprofdumpstacks(FILE *fp, State *S, Pcprofile *p, char *metric);
+static void	pcprofdumppcs(FILE *fp, State *S, Pcprofile *p, char *metric);
+static void	pcprofleaf(FILE *fp, State *S, ulong pc, int withfunc, double w);
+static double	pcprofweight(Pcprofentry *e, char *metric);
+static void	pcproffree(Engine *E, Pcprofile *p);
+static int	pcsymlookup(State *S, ulong pc);
+static int	pcsymcmp(const void *a, const void *b);
+static int	pcproffunccmp(const void *a, const void *b);
+
+
+void
+mpcprofinit(Engine *E, State *S, ulong period)
+{
+	Pcprofile	*p;
+
+
+	if (period == 0)
+	{
+		merror(E, "PC profile needs a non-zero sampling period.");
+		return;
+	}
+
+	if (S->pcprof == NULL)
+	{
+		S->pcprof = (Pcprofile *)mcalloc(E, 1, sizeof(Pcprofile), "S->pcprof");
+		if (S->pcprof == NULL)
+		{
+			mexit(E, "Could not allocate memory for S->pcprof", -1);
+		}
+	}
+	p = S->pcprof;
+
+	pcproffree(E, p);
+	memset(p, 0, sizeof(Pcprofile));
+	p->period = period;
+	p->countdown = period;
+	p->lastclk = S->ICLK;
+	p->lastdyncnt = S->dyncnt;
+	if (SF_POWER_ANALYSIS)
+	{
+		power_materialize(E, S);
+		p->lastenergy = S->energyinfo.CPUEtot;
+	}
+	p->active = 1;
+
+	mprint(E, S, nodeinfo,
+		"PC profile: sampling every " ULONGFMT " cycles%s\n", period,
+		SF_POWER_ANALYSIS ? "" : " (enable the power analysis to attribute energy)");
+
+	return;
+}
+
+void
+mpcprofoff(Engine *E, State *S)
+{
+	if (S->pcprof != NULL)
+	{
+		S->pcprof->active = 0;
+	}
+
+	return;
+}
+
+/*									*/
+/*	Called from pcprofhook() in the step loops once the countdown	*/
+/*	expires. Everything since the previous sample is charged to pc,	*/
+/*	and on superH also to the call chain pc was reached through.	*/
+/*									*/
+void
+mpcprofsample(Engine *E, State *S, ulong pc)
+{
+	Pcprofile	*p = S->pcprof;
+	Pcprofentry	*e, *c;
+	uvlong		cycles, instrs, stalls;
+	double		energy = 0.0;
+
+
+	p->countdown = p->period;
+	p->nsamples++;
+
+	cycles = S->ICLK - p->lastclk;
+	instrs = S->dyncnt - p->lastdyncnt;
+	stalls = (cycles > instrs) ? cycles - instrs : 0;
+
+	if (SF_POWER_ANALYSIS)
+	{
+		power_materialize(E, S);
+		energy = S->energyinfo.CPUEtot - p->lastenergy;
+		p->lastenergy = S->energyinfo.CPUEtot;
+	}
+
+	e = pcprofentry(E, p, pc);
+	e->samples++;
+	e->cycles += cycles;
+	e->instrs += instrs;
+	e->stalls += stalls;
+	e->energy += energy;
+
+	/*								*/
+	/*	Only the superH call and return instructions maintain	*/
+	/*	S->PCSTACK; the other machines get one-frame stacks	*/
+	/*	from the per-PC counters in mpcprofdump().		*/
+	/*								*/
+	if (S->machinetype == MACHINE_SUPERH)
+	{
+		c = pcprofstackentry(E, S, p, pc);
+		c->samples++;
+		c->cycles += cycles;
+		c->instrs += instrs;
+		c->stalls += stalls;
+		c->energy += energy;
+	}
+
+	p->lastclk = S->ICLK;
+	p->lastdyncnt = S->dyncnt;
+
+	return;
+}
+
+/*									*/
+/*	Flat profile by function, largest cycle count first.		*/
+/*									*/
+void
+mpcprofstats(Engine *E, State *S, int nfuncs)
+{
+	Pcprofile	*p = S->pcprof;
+	Pcproffunc	*funcs;
+	Pcprofentry	total;
+	int		i, j, k, nsyms, sym;
+
+
+	if (p == NULL || p->nsamples == 0)
+	{
+		mprint(E, S, nodeinfo, "No PC profile samples (use PCPROFILE)\n");
+		return;
+	}
+
+	/*	Slot nsyms collects PCs that match no symbol	*/
+	nsyms = (S->symtab == NULL) ? 0 : S->symtab->nsyms;
+	funcs = (Pcproffunc *)mcalloc(E, nsyms + 1, sizeof(Pcproffunc), "funcs in mpcprofstats()");
+	if (funcs == NULL)
+	{
+		mexit(E, "Could not allocate memory for funcs in mpcprofstats()", -1);
+	}
+	for (i = 0; i <= nsyms; i++)
+	{
+		funcs[i].sym = i;
+	}
+
+	memset(&total, 0, sizeof(total));
+	for (i = 0; i < PCPROF_DIRENTRIES; i++)
+	{
+		if (p->dir[i] == NULL)
+		{
+			continue;
+		}
+
+		for (j = 0; j < PCPROF_DIRENTRIES; j++)
+		{
+			if (p->dir[i][j] == NULL)
+			{
+				continue;
+			}
+
+			for (k = 0; k < PCPROF_PAGESLOTS; k++)
+			{
+				Pcprofentry	*e = &p->dir[i][j]->slots[k];
+				Pcprofentry	*f;
+
+				if (e->samples == 0)
+				{
+					continue;
+				}
+
+				sym = pcsymlookup(S, ((ulong)i << (PCPROF_DIRSHIFT + PCPROF_PAGESHIFT))
+						| ((ulong)j << PCPROF_PAGESHIFT) | ((ulong)k << PCPROF_SLOTSHIFT));
+				f = &funcs[sym < 0 ? nsyms : sym].total;
+				f->samples += e->samples;
+				f->instrs += e->instrs;
+				f->cycles += e->cycles;
+				f->stalls += e->stalls;
+				f->energy += e->energy;
+
+				total.samples += e->samples;
+				total.instrs += e->instrs;
+				total.cycles += e->cycles;
+				total.stalls += e->stalls;
+				total.energy += e->energy;
+			}
+		}
+	}
+
+	qsort(funcs, nsyms + 1, sizeof(Pcproffunc), pcproffunccmp);
+
+	mprint(E, S, nodeinfo, "\nPC profile: " UVLONGFMT " samples, " UVLONGFMT " cycles, "
+		UVLONGFMT " stall cycles, %E J, " ULONGFMT " cycles/sample, %d pages\n",
+		total.samples, total.cycles, total.stalls, total.energy, p->period, p->npages);
+	mprint(E, S, nodeinfo, "%%cycles\tcycles\t\tstalls\t\tinstrs\t\tenergy (J)\tfunction\n");
+	for (i = 0; i <= nsyms && i < nfuncs; i++)
+	{
+		Pcprofentry	*f = &funcs[i].total;
+
+		if (f->samples == 0)
+		{
+			break;
+		}
+
+		mprint(E, S, nodeinfo, "%6.2f\t" UVLONGFMT "\t" UVLONGFMT "\t" UVLONGFMT "\t%E\t%s\n",
+			total.cycles == 0 ? 0.0 : 100.0 * (double)f->cycles / (double)total.cycles,
+			f->cycles, f->stalls, f->instrs, f->energy,
+			funcs[i].sym == nsyms ? "[unknown]" : S->symtab->syms[funcs[i].sym].name);
+	}
+	mprint(E, S, nodeinfo, "\n");
+
+	mfree(E, funcs, "funcs in mpcprofstats()");
+
+	return;
+}
+
+/*									*/
+/*	Write the profile in the collapsed-stack format read by		*/
+/*	flamegraph.pl and speedscope, weighted by the named metric.	*/
+/*	On superH there is one "node;caller;...;callee;callee+off	*/
+/*	weight" line per sampled call chain and PC. Elsewhere there is	*/
+/*	no call chain and each sampled PC gets a "node;function;	*/
+/*	function+off weight" line.					*/
+/*									*/
+void
+mpcprofdump(Engine *E, State *S, char *filename, char *metric)
+{
+	Pcprofile	*p = S->pcprof;
+	FILE		*fp;
+
+
+	if (p == NULL || p->nsamples == 0)
+	{
+		mprint(E, S, nodeinfo, "No PC profile samples (use PCPROFILE)\n");
+		return;
+	}
+
+	if (strcmp(metric, "samples") && strcmp(metric, "cycles") && strcmp(metric, "stalls")
+		&& strcmp(metric, "instrs") && strcmp(metric, "energy"))
+	{
+		merror(E, "Unknown PC profile metric \"%s\" (samples, cycles, stalls, instrs or energy).", metric);
+		return;
+	}
+
+	fp = fopen(filename, "w");
+	if (fp == NULL)
+	{
+		merror(E, "Could not open \"%s\" for writing.", filename);
+		return;
+	}
+
+	if (p->nstacks > 0)
+	{
+		pcprofdumpstacks(fp, S, p, metric);
+	}
+	else
+	{
+		pcprofdumppcs(fp, S, p, metric);
+	}
+	fclose(fp);
+
+	mprint(E, S, nodeinfo, "Wrote PC profile (%s) to \"%s\"\n", metric, filename);
+
+	return;
+}
+
+/*									*/
+/*	Add a function symbol. The name is taken up to the first ':'	*/
+/*	so STABS strings such as "main:F(0,1)" can be passed as is.	*/
+/*									*/
+void
+msymadd(Engine *E, State *S, ulong addr, char *name)
+{
+	Pcsymtab	*t;
+	int		len;
+
+
+	len = strcspn(name, ": \t\n");
+	if (len == 0)
+	{
+		return;
+	}
+
+	if (S->symtab == NULL)
+	{
+		S->symtab = (Pcsymtab *)mcalloc(E, 1, sizeof(Pcsymtab), "S->symtab");
+		if (S->symtab == NULL)
+		{
+			mexit(E, "Could not allocate memory for S->symtab", -1);
+		}
+	}
+	t = S->symtab;
+
+	if (t->nsyms == t->maxsyms)
+	{
+		Pcsymbol	*syms;
+
+		syms = (Pcsymbol *)mcalloc(E, max(2*t->maxsyms, 64), sizeof(Pcsymbol), "S->symtab->syms");
+		if (syms == NULL)
+		{
+			mexit(E, "Could not allocate memory for S->symtab->syms", -1);
+		}
+
+		if (t->syms != NULL)
+		{
+			memmove(syms, t->syms, t->nsyms*sizeof(Pcsymbol));
+			mfree(E, t->syms, "S->symtab->syms");
+		}
+		t->syms = syms;
+		t->maxsyms = max(2*t->maxsyms, 64);
+	}
+
+	t->syms[t->nsyms].addr = addr;
+	t->syms[t->nsyms].name = (char *)mcalloc(E, len + 1, sizeof(char), "S->symtab->syms[].name");
+	if (t->syms[t->nsyms].name == NULL)
+	{
+		mexit(E, "Could not allocate memory for S->symtab->syms[].name", -1);
+	}
+	memmove(t->syms[t->nsyms].name, name, len);
+	t->nsyms++;
+	t->sorted = 0;
+
+	return;
+}
+
+static Pcprofentry *
+pcprofentry(Engine *E, Pcprofile *p, ulong pc)
+{
+	Pcprofpage	**d;
+	Pcprofpage	*page;
+	ulong		i, j;
+
+
+	pc &= 0xFFFFFFFF;
+	i = pc >> (PCPROF_DIRSHIFT + PCPROF_PAGESHIFT);
+	j = (pc >> PCPROF_PAGESHIFT) & (PCPROF_DIRENTRIES - 1);
+
+	d = p->dir[i];
+	if (d == NULL)
+	{
+		d = (Pcprofpage **)mcalloc(E, PCPROF_DIRENTRIES, sizeof(Pcprofpage *), "p->dir[]");
+		if (d == NULL)
+		{
+			mexit(E, "Could not allocate memory for PC profile directory", -1);
+		}
+		p->dir[i] = d;
+	}
+
+	page = d[j];
+	if (page == NULL)
+	{
+		page = (Pcprofpage *)mcalloc(E, 1, sizeof(Pcprofpage), "PC profile page");
+		if (page == NULL)
+		{
+			mexit(E, "Could not allocate memory for PC profile page", -1);
+		}
+		d[j] = page;
+		p->npages++;
+	}
+
+	return &page->slots[(pc & ((1 << PCPROF_PAGESHIFT) - 1)) >> PCPROF_SLOTSHIFT];
+}
+
+static Pcprofentry *
+pcprofstackentry(Engine *E, State *S, Pcprofile *p, ulong pc)
+{
+	Pcprofstack	*c;
+	ulong		*frames, h;
+	int		i, nframes, height, truncated;
+
+
+	height = max(0, min(S->pcstackheight, MAX_PCSTACK_HEIGHT - 1));
+	nframes = min(height, PCPROF_MAXFRAMES);
+	truncated = (height > nframes);
+	frames = &S->PCSTACK[height - nframes + 1];
+
+	h = pc;
+	for (i = 0; i < nframes; i++)
+	{
+		h = h*31 + frames[i];
+	}
+	h = (h ^ (h >> 13)) % PCPROF_STACKBUCKETS;
+
+	for (c = p->stacks[h]; c != NULL; c = c->next)
+	{
+		if (c->pc == pc && c->nframes == nframes && c->truncated == truncated
+			&& !memcmp(c->frames, frames, nframes*sizeof(ulong)))
+		{
+			return &c->e;
+		}
+	}
+
+	c = (Pcprofstack *)mcalloc(E, 1, sizeof(Pcprofstack), "PC profile stack");
+	if (c == NULL)
+	{
+		mexit(E, "Could not allocate memory for PC profile stack", -1);
+	}
+	if (nframes > 0)
+	{
+		c->frames = (ulong *)mcalloc(E, nframes, sizeof(ulong), "PC profile stack frames");
+		if (c->frames == NULL)
+		{
+			mexit(E, "Could not allocate memory for PC profile stack frames", -1);
+		}
+		memmove(c->frames, frames, nframes*sizeof(ulong));
+	}
+	c->pc = pc;
+	c->nframes = nframes;
+	c->truncated = truncated;
+	c->next = p->stacks[h];
+	p->stacks[h] = c;
+	p->nstacks++;
+
+	return &c->e;
+}
+
+static void
+pcprofdumpstacks(FILE *fp, State *S, Pcprofile *p, char *metric)
+{
+	Pcprofstack	*c;
+	int		i, j, sym;
+	double		w;
+
+
+	for (i = 0; i < PCPROF_STACKBUCKETS; i++)
+	{
+		for (c = p->stacks[i]; c != NULL; c = c->next)
+		{
+			w = pcprofweight(&c->e, metric);
+			if (w < 0.5)
+			{
+				continue;
+			}
+
+			fprintf(fp, "node%d", S->NODE_ID);
+			if (c->truncated)
+			{
+				fprintf(fp, ";[truncated]");
+			}
+
+			/*	Frames are function start PCs	*/
+			for (j = 0; j < c->nframes; j++)
+			{
+				sym = pcsymlookup(S, c->frames[j]);
+				if (sym < 0)
+				{
+					fprintf(fp, ";0x%lx", (unsigned long)c->frames[j]);
+				}
+				else
+				{
+					fprintf(fp, ";%s", S->symtab->syms[sym].name);
+				}
+			}
+
+			/*							*/
+			/*	The innermost frame is normally the function	*/
+			/*	holding pc; it differs before the first call	*/
+			/*	and in code entered by a jump or an exception.	*/
+			/*							*/
+			sym = pcsymlookup(S, c->pc);
+			pcprofleaf(fp, S, c->pc, c->nframes == 0
+				|| pcsymlookup(S, c->frames[c->nframes - 1]) != sym, w);
+		}
+	}
+
+	return;
+}
+
+static void
+pcprofdumppcs(FILE *fp, State *S, Pcprofile *p, char *metric)
+{
+	int		i, j, k;
+	ulong		pc;
+	double		w;
+
+
+	for (i = 0; i < PCPROF_DIRENTRIES; i++)
+	{
+		if (p->dir[i] == NULL)
+		{
+			continue;
+		}
+
+		for (j = 0; j < PCPROF_DIRENTRIES; j++)
+		{
+			if (p->dir[i][j] == NULL)
+			{
+				continue;
+			}
+
+			for (k = 0; k < PCPROF_PAGESLOTS; k++)
+			{
+				Pcprofentry	*e = &p->dir[i][j]->slots[k];
+
+				if (e->samples == 0)
+				{
+					continue;
+				}
+
+				w = pcprofweight(e, metric);
+				if (w < 0.5)
+				{
+					continue;
+				}
+
+				pc = ((ulong)i << (PCPROF_DIRSHIFT + PCPROF_PAGESHIFT))
+					| ((ulong)j << PCPROF_PAGESHIFT) | ((ulong)k << PCPROF_SLOTSHIFT);
+				fprintf(fp, "node%d", S->NODE_ID);
+				pcprofleaf(fp, S, pc, 1, w);
+			}
+		}
+	}
+
+	return;
+}
+
+/*									*/
+/*	Finish a collapsed-stack line with ";function+off weight",	*/
+/*	preceded by a ";function" frame if withfunc is set.		*/
+/*									*/
+static void
+pcprofleaf(FILE *fp, State *S, ulong pc, int withfunc, double w)
+{
+	int	sym = pcsymlookup(S, pc);
+
+
+	if (sym < 0)
+	{
+		fprintf(fp, "%s;0x%lx %.0f\n", withfunc ? ";[unknown]" : "", (unsigned long)pc, w);
+	}
+	else
+	{
+		if (withfunc)
+		{
+			fprintf(fp, ";%s", S->symtab->syms[sym].name);
+		}
+		fprintf(fp, ";%s+0x%lx %.0f\n", S->symtab->syms[sym].name,
+			(unsigned long)(pc - S->symtab->syms[sym].addr), w);
+	}
+
+	return;
+}
+
+static double
+pcprofweight(Pcprofentry *e, char *metric)
+{
+	/*	Energy is written in picojoules	*/
+	switch (metric[0])
+	{
+		case 'c':	return e->cycles;
+		case 'i':	return e->instrs;
+		case 'e':	return e->energy * 1E12;
+		default:	return (metric[1] == 'a') ? e->samples : e->stalls;
+	}
+}
+
+static void
+pcproffree(Engine *E, Pcprofile *p)
+{
+	Pcprofstack	*c, *next;
+	int		i, j;
+
+
+	for (i = 0; i < PCPROF_STACKBUCKETS; i++)
+	{
+		for (c = p->stacks[i]; c != NULL; c = next)
+		{
+			next = c->next;
+			if (c->frames != NULL)
+			{
+				mfree(E, c->frames, "PC profile stack frames");
+			}
+			mfree(E, c, "PC profile stack");
+		}
+		p->stacks[i] = NULL;
+	}
+	p->nstacks = 0;
+
+	for (i = 0; i < PCPROF_DIRENTRIES; i++)
+	{
+		if (p->dir[i] == NULL)
+		{
+			continue;
+		}
+
+		for (j = 0; j < PCPROF_DIRENTRIES; j++)
+		{
+			if (p->dir[i][j] != NULL)
+			{
+				mfree(E, p->dir[i][j], "PC profile page");
+			}
+		}
+		mfree(E, p->dir[i], "p->dir[]");
+		p->dir[i] = NULL;
+	}
+	p->npages = 0;
+
+	return;
+}
+
+static int
+pcsymlookup(State *S, ulong pc)
+{
+	Pcsymtab	*t = S->symtab;
+	int		lo, hi, mid;
+
+
+	if (t == NULL || t->nsyms == 0)
+	{
+		return -1;
+	}
+
+	if (!t->sorted)
+	{
+		qsort(t->syms, t->nsyms, sizeof(Pcsymbol), pcsymcmp);
+		t->sorted = 1;
+	}
+
+	/*	Last symbol with addr <= pc	*/
+	lo = 0;
+	hi = t->nsyms - 1;
+	if (pc < t->syms[0].addr)
+	{
+		return -1;
+	}
+	while (lo < hi)
+	{
+		mid = (lo + hi + 1) / 2;
+		if (t->syms[mid].addr <= pc)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+
+	return lo;
+}
+
+static int
+pcsymcmp(const void *a, const void *b)
+{
+	ulong	x = ((Pcsymbol *)a)->addr, y = ((Pcsymbol *)b)->addr;
+
+	return (x > y) - (x < y);
+}
+
+static int
+pcproffunccmp(const void *a, const void *b)
+{
+	uvlong	x = ((Pcproffunc *)a)->total.cycles, y = ((Pcproffunc *)b)->total.cycles;
+
+	return (x < y) - (x > y);
+}
@@ -0,0 +1,138 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Guest PC profile. Every period cycles (instructions, in the	*/
+/*	fast step) the step loop samples the PC of the instruction	*/
+/*	holding up the pipeline, and the cycles, instructions and	*/
+/*	energy since the previous sample are charged to that PC.	*/
+/*	Cycles beyond one per instruction are counted as stalls.	*/
+/*	Counters live in 4KB pages of the guest address space, two	*/
+/*	bytes per slot, reached through a two-level directory, so	*/
+/*	only pages that hold executed code are ever allocated.		*/
+/*	On superH, each sample is also charged to the call chain in	*/
+/*	S->PCSTACK at that moment, held in a hash table keyed by the	*/
+/*	chain and the PC, from which PCPROFILEDUMP writes full stacks.	*/
+/*	See pcprofile.c.						*/
+/*									*/
+enum
+{
+	PCPROF_PAGESHIFT	= 12,
+	PCPROF_DIRSHIFT		= 10,
+	PCPROF_SLOTSHIFT	= 1,
+	PCPROF_PAGESLOTS	= (1 << PCPROF_PAGESHIFT) >> PCPROF_SLOTSHIFT,
+	PCPROF_DIRENTRIES	= 1 << PCPROF_DIRSHIFT,
+	PCPROF_STACKBUCKETS	= 4096,
+	PCPROF_MAXFRAMES	= 64,
+};
+
+typedef struct
+{
+	uvlong		samples;
+	uvlong		instrs;
+	uvlong		cycles;
+	uvlong		stalls;
+	double		energy;
+} Pcprofentry;
+
+typedef struct
+{
+	Pcprofentry	slots[PCPROF_PAGESLOTS];
+} Pcprofpage;
+
+/*									*/
+/*	One sampled call chain: the start PCs of the active functions,	*/
+/*	outermost first, and the sampled PC. Chains deeper than		*/
+/*	PCPROF_MAXFRAMES keep their innermost frames.			*/
+/*									*/
+typedef struct Pcprofstack Pcprofstack;
+struct Pcprofstack
+{
+	ulong		pc;
+	int		nframes;
+	int		truncated;
+	ulong		*frames;
+	Pcprofentry	e;
+	Pcprofstack	*next;
+};
+
+typedef struct
+{
+	int		active;
+	ulong		period;
+	ulong		countdown;
+
+	/*	Counter values at the previous sample			*/
+	uvlong		lastclk;
+	uvlong		lastdyncnt;
+	double		lastenergy;
+
+	uvlong		nsamples;
+	int		npages;
+	Pcprofpage	**dir[PCPROF_DIRENTRIES];
+
+	int		nstacks;
+	Pcprofstack	*stacks[PCPROF_STACKBUCKETS];
+} Pcprofile;
+
+/*									*/
+/*	Function symbols, from REGISTERSTABS or LOADMAPFILE, used to	*/
+/*	name the PCs in the profile. A PC belongs to the symbol with	*/
+/*	the highest address at or below it.				*/
+/*									*/
+typedef struct
+{
+	ulong		addr;
+	char		*name;
+} Pcsymbol;
+
+typedef struct
+{
+	Pcsymbol	*syms;
+	int		nsyms;
+	int		maxsyms;
+	int		sorted;
+} Pcsymtab;
+
+#define	pcprofhook(E, S, pc)\
+	do\
+	{\
+		if ((S)->pcprof != NULL && (S)->pcprof->active && --(S)->pcprof->countdown == 0)\
+		{\
+			mpcprofsample((E), (S), (pc));\
+		}\
+	} while (0)
@@ -187,7 +187,8 @@ physics_newsigsrc(Engine *EE, int type, char* descr, double tau, double propspee
 	char		c, buf[MAX_LINELEN], *ep = &c;
 	Signalsrc	*s;
 	double		val;
-	int		tmpfd, linesread = 0;
+	int		linesread = 0;
+	Linereader	*L;
 
 
 	if (EE->nsigsrcs >= MAX_SIGNAL_SRCS)
@@ -249,111 +250,20 @@ physics_newsigsrc(Engine *EE, int type, char* descr, double tau, double propspee
 		strcpy(s->trajectory_file, trajectoryfile);
 	}
 
-	tmpfd = mopen(s->trajectory_file, M_OREAD);
-	linesread = 0;
-	while ((tmpfd  >= 0) && (mfgets(buf, MAX_LINELEN, tmpfd) != NULL))
+	/*	Shared with any node or source using the same file	*/
+	if (s->trajectory_file != NULL)
 	{
-		if ((strlen(buf) > 0) && buf[strlen(buf)-1] == '\n')
-		{
-			buf[strlen(buf)-1] = '\0';
-		}
+		Trajectory	*T = mtrajectoryload(EE, s->trajectory_file);
 
-		val = strtod(buf, &ep);
-		if ((linesread == 0) && (*ep != '\0'))
+		if (T != NULL)
 		{
-			merror(EE, "Invalid \"# of records\" field (\"%s\") in trajectory file.", buf);
-			continue;
+			s->xlocs = T->planes[kSunflowerTrajectoryX];
+			s->ylocs = T->planes[kSunflowerTrajectoryY];
+			s->zlocs = T->planes[kSunflowerTrajectoryZ];
+			s->nlocations = T->nlocations;
 		}
-
-		if (linesread == 0)
-		{
-			s->xlocs = mcalloc(EE, (int)val, sizeof(double),
-				"s->xlocs in shasm.y");
-			if (s->xlocs == NULL)
-			{
-				merror(EE, "Could not allocate memory for s->xlocs.");
-				return;
-			}
-
-			s->ylocs = mcalloc(EE, (int)val, sizeof(double),
-					"s->ylocs in shasm.y");
-			if (s->ylocs == NULL)
-			{
-				merror(EE, "Could not allocate memory for s->ylocs.");
-				return;
-			}
-
-			s->zlocs = mcalloc(EE, (int)val, sizeof(double),
-					"s->zlocs in shasm.y");
-			if (s->zlocs == NULL)
-			{
-				merror(EE, "Could not allocate memory for s->zlocs.");
-				return;
-			}
-
-			mprint(EE, NULL, siminfo,
-				"[%d] records in trajectory file\n", (int)val);
-		}
-		else
-		{
-			int	i = 0;
-			char 	*p;
-						
-
-			for ((p = strtok(buf, " \n\t")); p; (p = strtok(NULL, " \n\t")), i++)
-			{
-				switch (i)
-				{
-					case 0:
-					{
-						s->xlocs[s->nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(EE, "Invalid xloc in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 1:
-					{
-						s->ylocs[s->nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(EE, "Invalid yloc in trajectory file.");
-						}
-
-						break;
-					}
-
-					case 2:
-					{
-						s->zlocs[s->nlocations] = strtod(p, &ep);
-						if (*ep != '\0')
-						{
-							merror(EE, "Invalid zloc in trajectory file.");
-						}
-
-						break;
-					}
-
-					default:
-					{
-						merror(EE, "Extra field in trajectory file.");
-					}
-
-				}
-           		}
-			s->nlocations++;
-		}
-		linesread++;
 	}
-	
-	if (tmpfd >= 0)
-	{
-		mclose(tmpfd);
-	}
-			
+
 	s->trajectory_rate = trajectoryrate;
 	s->xloc = fixedx;
 	s->yloc = fixedy;
@@ -375,7 +285,7 @@ physics_newsigsrc(Engine *EE, int type, char* descr, double tau, double propspee
 
 	s->sample_rate = samplerate;
 	linesread = 0;
-	if ((tmpfd = mopen(s->samples_file, M_OREAD)) < 0)
+	if ((L = mlineopen(EE, s->samples_file)) == NULL)
 	{
 		s->nsamples = 1;
 		s->samples = mcalloc(EE, 1, sizeof(double), "s->samples in shasm.y");
@@ -386,7 +296,7 @@ physics_newsigsrc(Engine *EE, int type, char* descr, double tau, double propspee
 		}
 		s->samples[0] = fixedsampleval;
 	}
-	else while (mfgets(buf, MAX_LINELEN, tmpfd) != NULL)
+	else while (mlinegets(L, buf, MAX_LINELEN-1) != NULL)
 	{
 		if ((strlen(buf) > 0) && buf[strlen(buf)-1] == '\n')
 		{
@@ -418,9 +328,9 @@ physics_newsigsrc(Engine *EE, int type, char* descr, double tau, double propspee
 		linesread++;
 	}				
 	
-	if (tmpfd >= 0)
+	if (L != NULL)
 	{
-		mclose(tmpfd);
+		mlineclose(EE, L);
 	}
 
 	s->loopsamples = loopsamples;
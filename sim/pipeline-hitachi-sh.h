@@ -55,4 +55,7 @@ typedef struct
 	SuperHPipestage	MA;
 	SuperHPipestage	WB;
 	int		fetch_stall_cycles;
+
+	/*	Cycles still to wait for the bus or a memory bank	*/
+	int		bus_stall_cycles;
 } SuperHPipe;
@@ -204,6 +204,14 @@ riscvreadsreg(int op)
 		case RISCV_OP_SRA:
 		case RISCV_OP_OR:
 		case RISCV_OP_AND:
+		case RISCV_OP_MUL:
+		case RISCV_OP_MULH:
+		case RISCV_OP_MULHSU:
+		case RISCV_OP_MULHU:
+		case RISCV_OP_DIV:
+		case RISCV_OP_DIVU:
+		case RISCV_OP_REM:
+		case RISCV_OP_REMU:
 		{
 			return 2;
 		}
@@ -238,6 +246,14 @@ riscvsetsreg(int op)
 		case RISCV_OP_SRA:
 		case RISCV_OP_OR:
 		case RISCV_OP_AND:
+		case RISCV_OP_MUL:
+		case RISCV_OP_MULH:
+		case RISCV_OP_MULHSU:
+		case RISCV_OP_MULHU:
+		case RISCV_OP_DIV:
+		case RISCV_OP_DIVU:
+		case RISCV_OP_REM:
+		case RISCV_OP_REMU:
 		{
 			return 1;
 		}
@@ -290,614 +306,59 @@ riscvnumstalls(RiscvPipestage IDstage, RiscvPipestage IFstage)
 	return 0;
 }
 
-int
-riscvfaststep(Engine *E, State *S, int drain_pipeline)
+/*
+ *	With RV32C, instructions are 2 or 4 bytes long and only 2-byte
+ *	aligned. At a 4-byte aligned PC we read a longword as before, so
+ *	RV32I code sees one memory access per fetch; riscvdecode() ignores
+ *	the upper half if the instruction turns out to be compressed. At a
+ *	2-byte aligned PC we read a halfword, and a second one only if it
+ *	starts a 32-bit instruction.
+ */
+uint32_t
+riscvfetch(Engine *E, State *S, uint32_t pc)
 {
-	int		i;
-	uint32_t	tmpinstr;
-	uint32_t	tmpPC;
-	Picosec		saved_globaltime;
-
-
-	USED(drain_pipeline);
+	uint32_t	instr;
 
-	saved_globaltime = E->globaltimepsec;
-	for (i = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	if (!(pc & 0x2))
 	{
-		if (!eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
-		{
-			E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
-			continue;
-		}
-		/*	need to check for exceptions/interrupts here	*/
-
-		tmpPC = S->PC;
-		tmpinstr = riscVreadlong(E, S, S->PC);
-
-		riscvdecode(E, S, tmpinstr, &(S->riscv->P.EX));
-
-		S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-		S->riscv->P.EX.fetchedpc = S->PC;
-		S->PC += 4;
-		S->CLK++;
-		S->ICLK++;
-		S->dyncnt++;
-		S->TIME += S->CYCLETIME;
-
-		switch (S->riscv->P.EX.format)
-		{
-			case INSTR_R:
-			{
-				instr_r *tmp;
-
-				tmp = (instr_r *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rs1, tmp->rs2, tmp->rd);
-				break;
-			}
-
-			case INSTR_I:
-			{
-				instr_i *tmp;
-
-				tmp = (instr_i *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rs1, tmp->rd, tmp->imm0);
-				break;
-			}
-
-			case INSTR_S:
-			{
-				instr_s *tmp;
-
-				tmp = (instr_s *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rs1, tmp->rs2, tmp->imm0, tmp->imm5);
-				break;
-			}
-
-			case INSTR_B:
-			{
-				instr_b *tmp;
-
-				tmp = (instr_b *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rs1, tmp->rs2, tmp->imm1, tmp->imm5, tmp->imm11, tmp->imm12);
-				break;
-			}
-
-			case INSTR_U:
-			{
-				instr_u *tmp;
-
-				tmp = (instr_u *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rd, tmp->imm0);
-				break;
-			}
-
-			case INSTR_J:
-			{
-				instr_j *tmp;
-
-				tmp = (instr_j *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rd, tmp->imm1, tmp->imm11, tmp->imm12, tmp->imm20);
-				break;
-			}
-			
-			case INSTR_R4:
-			{
-				instr_r4 *tmp;
-
-				tmp = (instr_r4 *)&S->riscv->P.EX.instr;
-				(*(S->riscv->P.EX.fptr))(E, S, tmp->rs1, tmp->rs2, tmp->rs3, tmp->rm, tmp->rd);
-				break;
-			}
-
-			case INSTR_N:
-			{
-				(*(S->riscv->P.EX.fptr))(E, S);
-				break;
-			}
-
-			default:
-			{
-				sfatal(E, S, "Unknown Instruction Type !!");
-				break;
-			}
-		}
-
-		if (SF_BITFLIP_ANALYSIS)
-		{
-			S->Cycletrans += bit_flips_32(tmpPC, S->PC);	
-			S->Cycletrans = 0;
-		}
+		return riscVreadlong(E, S, pc);
+	}
 
-		E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+	instr = riscVreadword(E, S, pc);
+	if ((instr & 0x3) == 0x3)
+	{
+		instr |= (uint32_t)riscVreadword(E, S, pc + 2) << 16;
 	}
-	E->globaltimepsec = saved_globaltime;
-	S->last_stepclks = i;
 
-	return i;
+	return instr;
 }
 
-int
-riscvstep(Engine *E, State *S, int drain_pipeline)
+/*								*/
+/*	PC charged by the PC profile for the current cycle: the	*/
+/*	oldest instruction still in the pipeline, which is the one	*/
+/*	holding up the others when the pipeline stalls.		*/
+/*								*/
+ulong
+riscvpipepc(State *S)
 {
-	int		i, exec_energy_updated = 0, stall_energy_updated = 0;
-	ulong		tmpPC;
-	Picosec		saved_globaltime;
-	//S->superH->SR.MD = 1;
-
-	saved_globaltime = E->globaltimepsec;
-	for (i = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	if (S->riscv->P.MA.valid)
 	{
-		/*	superH multiprocessor equivalent has bus locking managment inserted here.	*/
-
-		if (!drain_pipeline)
-		{
-			if (!eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
-			{
-				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
-				continue;
-			}
-
-			/*	need to check for exceptions/interrupts here	*/
-
-		}
-
-		tmpPC = S->PC;
-
-		/*								*/
-		/* 	 		Clear WB stage				*/
-		/*								*/
-		S->riscv->P.WB.valid = 0;
-
-
-		/*								*/
-		/*   MA cycles--. If 0, move instr in MA to WB if WB is empty	*/
-		/*								*/
-		if ((S->riscv->P.MA.valid) && (S->riscv->P.MA.cycles > 0))
-		{
-			S->riscv->P.MA.cycles--;
-			if (S->riscv->P.MA.cycles != 0)
-			{
-				S->num_cycles_waiting++;
-			}
-
-			/*							*/
-			/*	For mem stall, energy cost assigned is NOP	*/
-			/*							*/
-
-			if (SF_POWER_ANALYSIS)
-			{
-				update_energy(SUPERH_OP_NOP, 0, 0);/*	Power data is only available for superH	*/
-				stall_energy_updated = 1;
-			}
-
-		}
-
-		if ((S->riscv->P.MA.valid) && (S->riscv->P.MA.cycles == 0)
-			&& (!S->riscv->P.WB.valid))
-		{
-
-			/*		Count # bits flipping in WB		*/
-			if (SF_BITFLIP_ANALYSIS)
-			{
-				S->Cycletrans += bit_flips_32(S->riscv->P.MA.instr,
-							S->riscv->P.WB.instr);
-			}
-
-			memmove(&S->riscv->P.WB, &S->riscv->P.MA, sizeof(RiscvPipestage));
-			S->riscv->P.WB.cycles = S->riscv->P.WB.instr_latencies[WB];
-
-			S->riscv->P.MA.valid = 0;
-			S->riscv->P.WB.valid = 1;
-		}
-
-
-		/*										*/
-		/* 	 EX cycles--. If 0, exec, mark EX stage empty and move it to MA		*/
-		/*										*/
-		if ((S->riscv->P.EX.valid) && (S->riscv->P.EX.cycles > 0))
-		{
-			S->riscv->P.EX.cycles--;
-			if (S->riscv->P.EX.cycles != 0)
-			{
-				S->num_cycles_waiting++;
-			}
-
-			if (SF_POWER_ANALYSIS)
-			{
-				update_energy(S->riscv->P.EX.op, 0, 0);
-				exec_energy_updated = 1;
-			}
-
-		}
-
-		if (S->riscv->P.EX.valid && (S->riscv->P.EX.fptr == NULL))
-		{
-			mprint(E, S, nodeinfo, "PC=0x" UHLONGFMT "\n",
-				S->riscv->P.EX.fetchedpc);
-			mprint(E, S, nodeinfo, "S->riscv->P.EX.instr = [0x%x]",
-				S->riscv->P.EX.instr);
-			sfatal(E, S, "Illegal instruction.");
-		}
-
-		if (	(S->riscv->P.EX.valid)
-			&& (S->riscv->P.EX.cycles == 0)
-			&& !(S->riscv->P.MA.valid)
-		)
-		{
-			/*	Rewind PC so that instrs that use PC have	*/
-			/*	the correct PC. Will bring PC back after.	*/
-			S->PC = S->riscv->P.EX.fetchedpc + 4;
-
-			/*	Flushes next 2 instructions if jumping as they must be wrong	*/
-			if (S->riscv->P.EX.op == RISCV_OP_JALR)
-			{
-				riscvIFIDflush(S);
-			}
-
-			switch (S->riscv->P.EX.format)
-			{
-				case INSTR_R:
-				{
-					uint32_t tmp = (uint32_t) S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits15to19) >> 15,
-								(tmp&maskExtractBits20to24) >> 20,
-								(tmp&maskExtractBits7to11) >> 7);
-					S->dyncnt++;
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					break;
-				}
-
-				case INSTR_I:
-				{
-					uint32_t tmp = (uint32_t) S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits15to19) >> 15,
-								(tmp&maskExtractBits7to11) >> 7,
-								(tmp&maskExtractBits20to31) >> 20);
-					S->dyncnt++;
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					break;
-				}
-
-				case INSTR_S:
-				{
-					uint32_t tmp = (uint32_t) S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits15to19) >> 15,
-								(tmp&maskExtractBits20to24) >> 20,
-								(tmp&maskExtractBits7to11) >> 7,
-								(tmp&maskExtractBits25to31) >> 25);
-					S->dyncnt++;
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					break;
-				}
-
-				case INSTR_B:
-				{
-					/*	BRANCH executes in the ID stage. So do
-						nothing, because it's already done in ID stage
-					uint32_t tmp = (uint32_t) S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits15to19) >> 15,
-								(tmp&maskExtractBits20to24) >> 20,
-								(tmp&maskExtractBits8to11) >> 8,
-								(tmp&maskExtractBits25to30) >> 25,
-								(tmp&maskExtractBit7) >> 7,
-								(tmp&maskExtractBit31) >> 31);
-					S->dyncnt++;				
-
-					The implementation of the pipeline also affects the taint
-					propagation statistics gathered in op-riscv (to find all
-					instances hereof, use the find function to search for
-					"instruction_taintDistribution"), be aware of this if
-					changing the pipeline implementation.
-
-					If branch instructions were included in the EX stage of the
-					pipeline then the instruction below should be included:
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					*/
-					break;
-				}
-
-				case INSTR_U:
-				{
-					uint32_t tmp = (uint32_t) S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits7to11) >> 7,
-								(tmp&maskExtractBits12to31) >> 12);
-					S->dyncnt++;
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					break;
-				}
-
-				case INSTR_J:
-				{
-					/*	There is only one instruction of J-type, which is JAL,
-						which does early PC calculation	in the ID stage.
-						So do nothing, because it's already done in ID stage
-					uint32_t tmp = S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits7to11) >> 7,
-								(tmp&maskExtractBits21to30) >> 21,
-								(tmp&maskExtractBit20) >> 20,
-								(tmp&maskExtractBits12to19) >> 12,
-								(tmp&maskExtractBit31) >> 31);
-					S->dyncnt++;
-					
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-					*/
-
-					break;
-				}
-
-				case INSTR_R4:
-				{
-					uint32_t tmp = S->riscv->P.EX.instr;
-					(*(S->riscv->P.EX.fptr))(E, S,
-								(tmp&maskExtractBits15to19) >> 15,
-								(tmp&maskExtractBits20to24) >> 20,
-								(tmp&maskExtractBits27to31) >> 27,
-								(tmp&maskExtractBits12to14) >> 12,
-								(tmp&maskExtractBits7to11) >> 7);
-					break;
-				}
-
-				case INSTR_N:
-				{
-					(*(S->riscv->P.EX.fptr))(E, S);	/*	riscv_nop??	*/
-					S->dyncnt++;
-
-					S->riscv->instruction_distribution[S->riscv->P.EX.op]++;
-
-					break;
-				}
-
-				default:
-				{
-					sfatal(E, S, "Unknown Instruction Type !!");
-					break;
-				}
-			}
-
-			/*	Set PC back to current, unless it has been changed	*/
-			if (!riscvchangespc(S->riscv->P.EX.op))
-			{
-				S->PC = tmpPC;
-			}
-
-			/*		Count # bits flipping in MA		*/
-			if (SF_BITFLIP_ANALYSIS)
-			{
-				S->Cycletrans += bit_flips_32(S->riscv->P.EX.instr,
-							S->riscv->P.MA.instr);
-			}
-
-			memmove(&S->riscv->P.MA, &S->riscv->P.EX, sizeof(RiscvPipestage));
-			S->riscv->P.MA.cycles = S->riscv->P.MA.instr_latencies[MA];
-
-			S->riscv->P.EX.valid = 0;
-			S->riscv->P.MA.valid = 1;
-		}
-
-
-		/*										*/
-		/* 	 ID cycles--. If 0, mark ID stage empty and move it to EX		*/
-		/*										*/
-		if ((S->riscv->P.ID.valid) && (S->riscv->P.ID.cycles > 0))
-		{
-			S->riscv->P.ID.cycles--;
-			if (S->riscv->P.ID.cycles != 0)
-			{
-				S->num_cycles_waiting++;
-			}
-
-			if (SF_POWER_ANALYSIS)
-			{
-				update_energy(S->riscv->P.ID.op, 0, 0);
-				exec_energy_updated = 1;
-			}
-
-		}
-
-		/*	First : If fetch unit is stalled, dec its counter			*/
-		if (S->riscv->P.fetch_stall_cycles > 0)
-		{
-			/*								*/
-			/*	Fetch Unit is stalled. Decrement time for it to wait.	*/
-			/*	If we have not accounted for energy cost of stall 	*/
-			/*	above (i.e. no stalled instr in MA), then cost of this	*/
-			/*	cycle is calculated as cost of a NOP.			*/
-			/*								*/
-			S->riscv->P.fetch_stall_cycles--;
-
-			if (SF_POWER_ANALYSIS)
-			{
-				if (!stall_energy_updated && !exec_energy_updated)
-				{
-					update_energy(SUPERH_OP_NOP, 0, 0);
-				}
-			}
-		}
-		/*									*/
-		/* 	move instr in ID stage to EX stage if EX stage is empty.	*/
-		/*									*/
-		if (	(S->riscv->P.ID.valid)
-			&& (S->riscv->P.fetch_stall_cycles == 0)
-			&& (S->riscv->P.ID.cycles == 0)
-			&& (!S->riscv->P.EX.valid)
-		)
-		{
-			/*	check if hazards need to stall next instuction (currently in IF)	*/
-			S->riscv->P.IF.cycles += riscvnumstalls(S->riscv->P.ID, S->riscv->P.IF);
-
-			/*	Executes early JUMP/BRANCH. Assumes next instr is always wrong.	*/
-			if (S->riscv->P.ID.op == RISCV_OP_JAL || riscvbranches(S->riscv->P.ID.op))
-			{
-				S->PC = S->riscv->P.ID.fetchedpc + 4;/*	set PC back to when it was at JAL/BRANCH instr	*/
-
-				if (S->riscv->P.ID.op == RISCV_OP_JAL)
-				{
-				uint32_t tmp = S->riscv->P.ID.instr;
-				(*(S->riscv->P.ID.fptr))(E, S,
-							(tmp&maskExtractBits7to11) >> 7,
-							(tmp&maskExtractBits21to30) >> 21,
-							(tmp&maskExtractBit20) >> 20,
-							(tmp&maskExtractBits12to19) >> 12,
-							(tmp&maskExtractBit31) >> 31);
-				}
-				else
-				{
-				uint32_t tmp = (uint32_t) S->riscv->P.ID.instr;
-				(*(S->riscv->P.ID.fptr))(E, S,
-							(tmp&maskExtractBits15to19) >> 15,
-							(tmp&maskExtractBits20to24) >> 20,
-							(tmp&maskExtractBits8to11) >> 8,
-							(tmp&maskExtractBits25to30) >> 25,
-							(tmp&maskExtractBit7) >> 7,
-							(tmp&maskExtractBit31) >> 31);
-				}
-				S->riscv->instruction_distribution[S->riscv->P.ID.op]++;
-				S->dyncnt++;
-				riscvIFflush(S);
-			}
-
-			/*		Count # bits flipping in EX		*/
-			if (SF_BITFLIP_ANALYSIS)
-			{
-				S->Cycletrans += bit_flips_32(S->riscv->P.ID.instr,
-							S->riscv->P.EX.instr);
-			}
-
-			memmove(&S->riscv->P.EX, &S->riscv->P.ID, sizeof(RiscvPipestage));
-			S->riscv->P.EX.cycles = S->riscv->P.EX.instr_latencies[EX];
-
-			S->riscv->P.ID.valid = 0;
-			S->riscv->P.EX.valid = 1;
-		}
-
-
-		/*										*/
-		/* 	 IF cycles--. If 0, exec, mark IF stage empty and move it to ID		*/
-		/*										*/
-		if ((S->riscv->P.IF.valid) && (S->riscv->P.IF.cycles > 0))
-		{
-			S->riscv->P.IF.cycles--;
-			if (S->riscv->P.IF.cycles != 0)
-			{
-				S->num_cycles_waiting++;
-			}
-
-			if (SF_POWER_ANALYSIS)
-			{
-				update_energy(S->riscv->P.IF.op, 0, 0);
-				exec_energy_updated = 1;
-			}
-		}
-
-		/*									*/
-		/* 	    Move instr in IF stage to ID stage if ID stage is empty	*/
-		/*									*/
-		if (	!(S->riscv->P.ID.valid)
-			&& (S->riscv->P.IF.valid)
-			&& (S->riscv->P.IF.cycles == 0)
-			&& (S->riscv->P.fetch_stall_cycles == 0))
-		{
-			/*		Count # bits flipping in ID		*/
-			if (SF_BITFLIP_ANALYSIS)
-			{
-				S->Cycletrans += bit_flips_32(S->riscv->P.ID.instr,
-						S->riscv->P.IF.instr);
-			}
-
-			memmove(&S->riscv->P.ID, &S->riscv->P.IF, sizeof(RiscvPipestage));
-			S->riscv->P.ID.cycles = S->riscv->P.ID.instr_latencies[ID];
-
-			S->riscv->P.IF.valid = 0;
-			S->riscv->P.ID.valid = 1;
-		}
-
-		/*									*/
-		/* 	  Put instr in IF stage if it is empty, and increment PC	*/
-		/*									*/
-		if (	!(S->riscv->P.IF.valid)
-		)
-		{
-			uint32_t	instrlong;
-
-			/*						*/
-			/*	Get inst from mem hierarchy or fetch	*/
-			/*	NOPs (used for draining pipeline).	*/
-			/*						*/
-			if (drain_pipeline)
-			{
-				instrlong = 51;/*	should be 0000000 00000 00000 000 00000 0010011 for ADD x0,x0,x0	*/
-			}
-			else
-			{
-				S->riscv->mem_access_type = MEM_ACCESS_IFETCH;
-				instrlong = riscVreadlong(E, S, S->PC);
-				S->nfetched++;
-				S->riscv->mem_access_type = MEM_ACCESS_NIL;
-			}
-
-			/*	Count # bits flipping in IF		*/
-			if (SF_BITFLIP_ANALYSIS)
-			{
-				S->Cycletrans += bit_flips_32(S->riscv->P.IF.instr, instrlong);
-			}
-
-			S->riscv->P.IF.instr = instrlong;
-			S->riscv->P.IF.valid = 1;
-
-			riscvdecode(E, S, S->riscv->P.IF.instr, &S->riscv->P.IF);
-			S->riscv->P.IF.cycles = S->riscv->P.IF.instr_latencies[IF];
-
-			if (!drain_pipeline)
-			{
-				S->riscv->P.IF.fetchedpc = S->PC;
-				S->PC += 4;
-			}
-		}
-
-		S->CLK++;
-		S->ICLK++;
-		S->TIME += S->CYCLETIME;
-
-		if (S->pipeshow)
-		{
-			riscvdumppipe(E, S);
-		}
-
-/*	Power Adaptation Unit not implemented...
-		if (SF_PAU_DEFINED && S->riscv->PAUs != NULL)
-		{
-			pau_clk(E, S);
-		}
-*/
-		if (SF_BITFLIP_ANALYSIS)
-		{
-			S->Cycletrans += bit_flips_32(tmpPC, S->PC);
-			S->energyinfo.ntrans = S->energyinfo.ntrans + S->Cycletrans;
-			S->Cycletrans = 0;
-		}
-
-		E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+		return S->riscv->P.MA.fetchedpc;
+	}
+	if (S->riscv->P.EX.valid)
+	{
+		return S->riscv->P.EX.fetchedpc;
+	}
+	if (S->riscv->P.ID.valid)
+	{
+		return S->riscv->P.ID.fetchedpc;
+	}
+	if (S->riscv->P.IF.valid)
+	{
+		return S->riscv->P.IF.fetchedpc;
 	}
-	E->globaltimepsec = saved_globaltime;
 
-	return i;
+	return S->PC;
 }
 
 void
@@ -1051,3 +512,67 @@ riscvIFIDflush(State *S)
 	return;
 }
 
+
+/*									*/
+/*	Instantiate the step loops once per combination of the		*/
+/*	analyses they test, so that an analysis which is turned off	*/
+/*	costs nothing inside the loops. riscvbindstep() points the	*/
+/*	node at the instances matching the current sfanalyses.		*/
+/*									*/
+#undef	SF_ANALYSES
+
+#define	SF_ANALYSES		0
+#define	SF_STEPFN(name)		name##_plain
+#include "step-riscv.c"
+#undef	SF_ANALYSES
+#undef	SF_STEPFN
+
+#define	SF_ANALYSES		SF_ANALYSIS_POWER
+#define	SF_STEPFN(name)		name##_power
+#include "step-riscv.c"
+#undef	SF_ANALYSES
+#undef	SF_STEPFN
+
+#define	SF_ANALYSES		SF_ANALYSIS_BITFLIP
+#define	SF_STEPFN(name)		name##_bitflip
+#include "step-riscv.c"
+#undef	SF_ANALYSES
+#undef	SF_STEPFN
+
+#define	SF_ANALYSES		(SF_ANALYSIS_BITFLIP | SF_ANALYSIS_POWER)
+#define	SF_STEPFN(name)		name##_bitflippower
+#include "step-riscv.c"
+#undef	SF_ANALYSES
+#undef	SF_STEPFN
+
+#define	SF_ANALYSES		sfanalyses
+
+/*	Indexed by SF_STEPVARIANT()	*/
+static int	(*riscvstepvariants[SF_NSTEPVARIANTS])(Engine *, State *, int) =
+{
+	riscvstep_plain,
+	riscvstep_power,
+	riscvstep_bitflip,
+	riscvstep_bitflippower,
+};
+
+static int	(*riscvfaststepvariants[SF_NSTEPVARIANTS])(Engine *, State *, int) =
+{
+	riscvfaststep_plain,
+	riscvfaststep_power,
+	riscvfaststep_bitflip,
+	riscvfaststep_bitflippower,
+};
+
+void
+riscvbindstep(Engine *E, State *S)
+{
+	int	v = SF_STEPVARIANT(sfanalyses);
+
+	USED(E);
+
+	S->cyclestep = riscvstepvariants[v];
+	S->faststep = riscvfaststepvariants[v];
+
+	return;
+}
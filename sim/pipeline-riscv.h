@@ -42,6 +42,7 @@ typedef struct
 	void 		(*fptr)();
 	uint8_t		op;
 	uint8_t		format;
+	uint8_t		length;		/*	In bytes: 2 for RV32C, 4 otherwise	*/
 	int		valid;
 
 /*	Every instr should have its own time/cycle count for how long
@@ -35,26 +35,304 @@
 	POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <string.h>
+#include "instr-ti-msp430.h"
 #include "sf.h"
 #include "mextern.h"
 
 
+static tuck void		msp430dispatchI(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p);
+static tuck void		msp430dispatchII(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p);
+static tuck void		msp430dispatchIII(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p);
+static tuck void		msp430dispatchreti(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p);
+static tuck MSP430DCEntry*	msp430dclookup(Engine *E, State *S, ushort instr);
+static tuck int			msp430takeintr(Engine *E, State *S);
+
+
+/*									*/
+/*	The decode cache is indexed by the 16-bit instruction word and	*/
+/*	shared by all MSP430 nodes in an engine. Unlike the superH DC,	*/
+/*	it is not primed at startup since msp430decode() treats the	*/
+/*	unassigned encodings as fatal; entries are instead filled the	*/
+/*	first time a given instruction word is executed.			*/
+/*									*/
+static tuck MSP430DCEntry *
+msp430dclookup(Engine *E, State *S, ushort instr)
+{
+	MSP430DCEntry	*dc = &E->msp430DC[instr];
+
+
+	if (dc->dc_p.valid)
+	{
+		return dc;
+	}
+
+	msp430decode(E, S, instr, &dc->dc_p);
+	switch (dc->dc_p.format)
+	{
+		case MSP430_INSTR_I:
+		{
+			dc->dc_m = msp430_instrI_sreg(instr);
+			dc->dc_n = msp430_instrI_dreg(instr);
+			dc->dc_dispatch = msp430dispatchI;
+
+			break;
+		}
+
+		case MSP430_INSTR_II:
+		{
+			dc->dc_n = msp430_instrII_dsreg(instr);
+			dc->dc_dispatch = (dc->dc_p.op == MSP430_OP_RETI) ?
+						msp430dispatchreti : msp430dispatchII;
+
+			break;
+		}
+
+		case MSP430_INSTR_III:
+		{
+			/*	10-bit signed word offset	*/
+			dc->dc_offset = ((short)(instr << 6)) >> 6;
+			dc->dc_dispatch = msp430dispatchIII;
+
+			break;
+		}
+
+		default:
+		{
+			sfatal(E, S, "Unknown Instruction Type !!");
+		}
+	}
+	dc->dc_p.valid = 1;
+
+	return dc;
+}
+
+static tuck void
+msp430dispatchI(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p)
+{
+	(*(dc->dc_p.fptr))(E, S, dc->dc_m, dc->dc_n, p);
+}
+
+static tuck void
+msp430dispatchII(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p)
+{
+	(*(dc->dc_p.fptr))(E, S, dc->dc_n, p);
+}
+
+static tuck void
+msp430dispatchIII(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p)
+{
+	(*(dc->dc_p.fptr))(E, S, dc->dc_offset, p);
+}
+
+static tuck void
+msp430dispatchreti(Engine *E, State *S, MSP430DCEntry *dc, MSP430Pipestage *p)
+{
+	USED(dc);
+
+	(*(dc->dc_p.fptr))(E, S, p);
+}
+
+/*									*/
+/*	Called at an instruction boundary, as superHfaststep() checks	*/
+/*	its interrupt queues. If dev430x1xxinterrupt() accepts a	*/
+/*	pending interrupt (which also clears CPUOFF), charge the	*/
+/*	interrupt-accept latency and return 1, else return 0.		*/
+/*									*/
+static tuck int
+msp430takeintr(Engine *E, State *S)
+{
+	if (S->intrQ->nqintrs == 0)
+	{
+		return 0;
+	}
+
+	S->msp430->R[MSP430_PC] = S->PC;
+	if (dev430x1xxinterrupt(E, S) != 0)
+	{
+		return 0;
+	}
+	S->PC = S->msp430->R[MSP430_PC];
+	S->sleep = 0;
+
+	S->CLK += MSP430_INTACCEPT_LATENCY;
+	S->ICLK += MSP430_INTACCEPT_LATENCY;
+	S->TIME += MSP430_INTACCEPT_LATENCY*S->CYCLETIME;
+	E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+
+	return 1;
+}
+
 int
 msp430step(Engine *E, State *S, int drain_pipe)
 {
+	int		i;
+	ulong		tmpPC;
+	MSP430DCEntry	*dc;
+	Picosec		saved_globaltime;
+	uvlong		startclks = S->ICLK;
+
+
 	/*								*/
 	/*	If ~RST/NMI pin is configured for reset, CPU stays	*/
 	/*	in reset state as long as pin stays low. When pin	*/
 	/*	goes high, PC goes to 0xFFFE				*/
 	/*								*/	
 
-	return -1;
+	/*								*/
+	/*	The MSP430 CPU is not pipelined: an instruction holds	*/
+	/*	EX for the number of cycles given by ilat(), and only	*/
+	/*	then executes and frees the stage for the next fetch.	*/
+	/*	Each iteration below is one CPU clock.			*/
+	/*								*/
+	saved_globaltime = E->globaltimepsec;
+	for (i = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	{
+		if (!drain_pipe)
+		{
+			if (!eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
+			{
+				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+				continue;
+			}
+
+			if (!S->msp430->P.EX.valid && msp430takeintr(E, S))
+			{
+				continue;
+			}
+
+			/*							*/
+			/*	CPUOFF (LPM0 and deeper) stops MCLK, so only	*/
+			/*	time advances until something clears the bit.	*/
+			/*							*/
+			if (S->sleep || msp430_sreg_get_CPU_OFF(S->msp430->R[MSP430_SR]))
+			{
+				S->ICLK++;
+				S->TIME += S->CYCLETIME;
+				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+
+				continue;
+			}
+		}
+		else if (!S->msp430->P.EX.valid)
+		{
+			break;
+		}
+
+		tmpPC = S->PC;
+
+		if (!S->msp430->P.EX.valid)
+		{
+			S->msp430->P.IF.instr = msp430readword(E, S, S->PC);
+			S->msp430->P.IF.valid = 1;
+
+			dc = msp430dclookup(E, S, S->msp430->P.IF.instr);
+			memmove(&S->msp430->P.EX, &dc->dc_p, sizeof(MSP430Pipestage));
+			S->msp430->P.IF.valid = 0;
+		}
+
+		S->msp430->P.EX.cycles -= 1;
+		if (S->msp430->P.EX.cycles <= 0)
+		{
+			dc = &E->msp430DC[S->msp430->P.EX.instr];
+
+			S->msp430->R[MSP430_PC] = S->PC;
+			(*(dc->dc_dispatch))(E, S, dc, &S->msp430->P.EX);
+			S->PC = S->msp430->R[MSP430_PC];
+
+			S->msp430->P.EX.valid = 0;
+			S->dyncnt++;
+		}
+
+		S->CLK++;
+		S->ICLK++;
+		S->TIME += S->CYCLETIME;
+
+		if (SF_BITFLIP_ANALYSIS)
+		{
+			S->Cycletrans += bit_flips_32(tmpPC, S->PC);	
+			S->energyinfo.ntrans = S->energyinfo.ntrans + S->Cycletrans;
+			S->Cycletrans = 0;
+		}
+
+		E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+	}
+	E->globaltimepsec = saved_globaltime;
+	S->last_stepclks = S->ICLK - startclks;
+
+	return i;
 }
 
+/*									*/
+/*	Fast path: no pipeline stage bookkeeping. Each iteration runs a	*/
+/*	whole instruction straight out of the decode cache through its	*/
+/*	pre-selected dispatch routine, and charges its ilat() cycles to	*/
+/*	CLK and TIME in one step, so the count of CPU clocks at the end	*/
+/*	matches msp430step() exactly.					*/
+/*									*/
 int
 msp430faststep(Engine *E, State *S, int drain_pipe)
 {
-	return -1;
+	int		i;
+	MSP430DCEntry	*dc;
+	Picosec		saved_globaltime;
+	uvlong		startclks = S->ICLK;
+
+
+	USED(drain_pipe);
+
+	saved_globaltime = E->globaltimepsec;
+	for (i = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	{
+		if (!eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
+		{
+			E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+			continue;
+		}
+
+		if (msp430takeintr(E, S))
+		{
+			continue;
+		}
+
+		if (S->sleep || msp430_sreg_get_CPU_OFF(S->msp430->R[MSP430_SR]))
+		{
+			S->ICLK++;
+			S->TIME += S->CYCLETIME;
+			E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+
+			continue;
+		}
+
+		/*							*/
+		/*	The dispatch routines write through their pipe	*/
+		/*	stage argument, so run on a per-node copy and	*/
+		/*	never on the DC entry shared by all nodes.	*/
+		/*							*/
+		dc = msp430dclookup(E, S, msp430readword(E, S, S->PC));
+		memmove(&S->msp430->P.EX, &dc->dc_p, sizeof(MSP430Pipestage));
+
+		S->msp430->R[MSP430_PC] = S->PC;
+		(*(dc->dc_dispatch))(E, S, dc, &S->msp430->P.EX);
+		S->PC = S->msp430->R[MSP430_PC];
+		S->msp430->P.EX.valid = 0;
+
+		S->CLK += dc->dc_p.cycles;
+		S->ICLK += dc->dc_p.cycles;
+		S->dyncnt++;
+		S->TIME += dc->dc_p.cycles*S->CYCLETIME;
+
+		E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+	}
+	E->globaltimepsec = saved_globaltime;
+
+	/*								*/
+	/*	Clocks, not iterations: interrupt entry (and, in the	*/
+	/*	fast path, every instruction) spans several clocks.	*/
+	/*								*/
+	S->last_stepclks = S->ICLK - startclks;
+
+	return i;
 }
 
 void
@@ -74,9 +352,9 @@ msp430flushpipe(State *S)
 
 	if (SF_BITFLIP_ANALYSIS)
 	{
-		S->Cycletrans += bit_flips_32(S->superH->P.IF.instr, 0);
-		S->Cycletrans += bit_flips_32(S->superH->P.ID.instr, 0);
-		S->Cycletrans += bit_flips_32(S->superH->P.EX.instr, 0);
+		S->Cycletrans += bit_flips_32(S->msp430->P.IF.instr, 0);
+		S->Cycletrans += bit_flips_32(S->msp430->P.ID.instr, 0);
+		S->Cycletrans += bit_flips_32(S->msp430->P.EX.instr, 0);
 	}
 
 	return;
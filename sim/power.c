@@ -84,15 +84,86 @@ Sqrt(double x)
 	return pow(x, 0.5);
 }
 
+/*									*/
+/*	Fold the per-op cycle counts gathered by update_energy() into	*/
+/*	CPUEtot and current_draw. Per cycle, this adds the same as the	*/
+/*	old per-cycle update did: the forced sleep power when asleep,	*/
+/*	else the forced average power, else the op's scaled current.	*/
+/*	Sleep cycles are charged as SUPERH_OP_SLEEP, which is what the	*/
+/*	superH sleep path passes; RISC-V keeps its (nominal) sleep	*/
+/*	current in the sleep slot, see power_riscvcurrents().		*/
+/*									*/
+void
+power_materialize(Engine *E, State *S)
+{
+	EnergyInfo	*ei = &S->energyinfo;
+	double		draw = 0.0, sleepcurrent = 0.0;
+	uvlong		nsleep, nawake = 0;
+	int		i;
+
+
+	nsleep = ei->opcycles[ENERGY_SLEEPSLOT];
+	ei->opcycles[ENERGY_SLEEPSLOT] = 0;
+
+	if (S->force_avgpwr != 0.0)
+	{
+		for (i = 0; i < ENERGY_SLEEPSLOT; i++)
+		{
+			nawake += ei->opcycles[i];
+			ei->opcycles[i] = 0;
+		}
+		draw = nawake * (S->force_avgpwr/S->VDD);
+	}
+	else
+	{
+		for (i = 0; i < ENERGY_SLEEPSLOT; i++)
+		{
+			if (ei->opcycles[i] != 0)
+			{
+				draw += ei->opcycles[i] * S->scaledcurrents[i];
+				ei->opcycles[i] = 0;
+			}
+		}
+	}
+
+	if (nsleep != 0)
+	{
+		if (S->force_sleeppwr != 0.0)
+		{
+			sleepcurrent = S->force_sleeppwr/S->VDD;
+		}
+		else if (S->force_avgpwr != 0.0)
+		{
+			sleepcurrent = S->force_avgpwr/S->VDD;
+		}
+		else if (S->machinetype == MACHINE_SUPERH)
+		{
+			sleepcurrent = S->scaledcurrents[SUPERH_OP_SLEEP];
+		}
+		else if (S->machinetype == MACHINE_RISCV)
+		{
+			sleepcurrent = S->scaledcurrents[ENERGY_SLEEPSLOT];
+		}
+		draw += nsleep * sleepcurrent;
+	}
+
+	ei->CPUEtot += draw*S->VDD*S->CYCLETIME;
+	ei->current_draw += draw;
+
+	return;
+}
+
 void
 power_printstats(Engine *E, State *S)
 {
-	if (S->machinetype != MACHINE_SUPERH)
+	if (S->machinetype != MACHINE_SUPERH && S->machinetype != MACHINE_RISCV)
 	{
 		merror(E, "This machine does not know how to \"powerstats\"");
 		return;
 	}
 
+	power_materialize(E, S);
+
 	//fprintf(stderr, "Bus lock=%d, locker=%d\n", S->B->pbuslock, S->B->pbuslocker);
 
 	mprint(E, NULL, siminfo, "\nVdd\t= %E\n", S->VDD);
@@ -118,6 +189,26 @@ power_printstats(Engine *E, State *S)
 	return;			
 }
 
+void
+power_riscvcurrents(Engine *E, State *S)
+{
+	int	i;
+
+
+	/*							*/
+	/*	Scaled current, I2 = (I1*V2*t1)/(V1*t2);	*/
+	/*							*/
+	for (i = 0; i < RISCV_OP_MAX; i++)
+	{
+		S->scaledcurrents[i] =
+			((RISCV_NOMINAL_CURRENT*S->VDD*RISCV_ORIG_CYCLE)/(RISCV_READINGS_VDD*S->CYCLETIME))*1E-3;
+	}
+	S->scaledcurrents[ENERGY_SLEEPSLOT] =
+		((RISCV_NOMINAL_SLEEPCURRENT*S->VDD*RISCV_ORIG_CYCLE)/(RISCV_READINGS_VDD*S->CYCLETIME))*1E-3;
+
+	return;
+}
+
 void
 power_scaledelay(Engine *E, State *S, double Vdd)
 {
@@ -136,6 +227,9 @@ power_scaledelay(Engine *E, State *S, double Vdd)
 
 		return;
 	}
+
+	/*	Counts so far are charged at the old operating point	*/
+	power_materialize(E, S);
 	
 	/*
 	TODO: 
@@ -157,7 +251,11 @@ power_scaledelay(Engine *E, State *S, double Vdd)
 	if (S->force_avgpwr == 0.0)
 	{
 		S->CYCLETIME = K*Vdd/pow(Vdd - Vt, alpha);
+	}
 
+	/*	The R0000 readings and SUPERH_OP_* indices are superH only	*/
+	if ((S->force_avgpwr == 0.0) && (S->machinetype == MACHINE_SUPERH))
+	{
 		for (i = SUPERH_OP_ADD; i <= SUPERH_OP_XTRCT; i++)
 		{
 			double reading = (R0000[i].reading1 + R0000[i].reading2)/2;
@@ -169,6 +267,10 @@ power_scaledelay(Engine *E, State *S, double Vdd)
 				((reading*S->VDD*SUPERH_ORIG_CYCLE)/(SUPERH_READINGS_VDD*S->CYCLETIME))*1E-3;
 		}
 	}
+	else if ((S->force_avgpwr == 0.0) && (S->machinetype == MACHINE_RISCV))
+	{
+		power_riscvcurrents(E, S);
+	}
 	S->mem_r_latency *= (int) ceil(oldcycle/S->CYCLETIME);
 	S->mem_w_latency *= (int) ceil(oldcycle/S->CYCLETIME);
 
@@ -275,13 +377,19 @@ power_scalevdd(Engine *E, State *S, double freq)
 		return;
 	}
 
+	/*	Counts so far are charged at the old operating point	*/
+	power_materialize(E, S);
+
 	S->mem_r_latency *= (int) ceil(S->CYCLETIME/delta);
 	S->mem_w_latency *= (int) ceil(S->CYCLETIME/delta);
  	S->CYCLETIME = delta;
 	if (S->force_avgpwr == 0.0)
 	{
 		S->VDD = newvdd;
+	}
 
+	if ((S->force_avgpwr == 0.0) && (S->machinetype == MACHINE_SUPERH))
+	{
 		for (i = SUPERH_OP_ADD; i <= SUPERH_OP_XTRCT; i++)
 		{
 			double reading = (R0000[i].reading1 + R0000[i].reading2)/2;
@@ -293,6 +401,10 @@ power_scalevdd(Engine *E, State *S, double freq)
 				((reading*S->VDD*SUPERH_ORIG_CYCLE)/(SUPERH_READINGS_VDD*S->CYCLETIME))*1E-3;
 		}
 	}
+	else if ((S->force_avgpwr == 0.0) && (S->machinetype == MACHINE_RISCV))
+	{
+		power_riscvcurrents(E, S);
+	}
 
 	E->mincycpsec = PICOSEC_MAX;
 	E->maxcycpsec = 0;
@@ -45,12 +45,31 @@ enum
 {
 	MAXINSTRNAME = 64,
 	NREADINGS = 256,
+
+	/*							*/
+	/*	Per-op counters and currents are indexed by	*/
+	/*	the node's own op codes (SUPERH_OP_* or		*/
+	/*	RISCV_OP_*), plus one slot for sleep cycles.	*/
+	/*							*/
+	ENERGY_NOPCODES = ((int)SUPERH_OP_MAX > (int)RISCV_OP_MAX ? (int)SUPERH_OP_MAX : (int)RISCV_OP_MAX) + 1,
+	ENERGY_SLEEPSLOT = ENERGY_NOPCODES - 1,
 };
 
 #define	SUPERH_READINGS_VDD	(3.3)
 #define	SUPERH_ORIG_VDD		(3.3)
 #define	SUPERH_ORIG_CYCLE	(1/60E6)
 
+/*									*/
+/*	No per-instruction measurements exist for RISC-V yet, so every	*/
+/*	RISCV_OP_* is charged one nominal current (mA), taken at the	*/
+/*	same operating point as the superH readings, until real	*/
+/*	readings are available.						*/
+/*									*/
+#define	RISCV_READINGS_VDD	(3.3)
+#define	RISCV_ORIG_CYCLE	(1/60E6)
+#define	RISCV_NOMINAL_CURRENT	(250.0)
+#define	RISCV_NOMINAL_SLEEPCURRENT	(20.0)
+
 typedef struct
 {
 	double		reading1;
@@ -77,30 +96,34 @@ typedef struct
 	/*	    Per-nic Energy		*/
 	double		Enetwork;
 
-	/*	Current drawn in last cycle	*/
+	/*							*/
+	/*	Sum over cycles of the current drawn in each	*/
+	/*	cycle, over drawclks cycles. Never reset: the	*/
+	/*	battery and power dump keep their own marks.	*/
+	/*							*/
 	double	 	current_draw;
+	uvlong		drawclks;
+	double		battdraw;
+	uvlong		battclks;
+	double		dumpdraw;
+	uvlong		dumpclks;
+
+	/*							*/
+	/*	Cycles spent in each op since CPUEtot and	*/
+	/*	current_draw were last brought up to date by	*/
+	/*	power_materialize().				*/
+	/*							*/
+	uvlong		opcycles[ENERGY_NOPCODES];
 } EnergyInfo;
 
 
 /*									*/
-/*	TX/RX Power consumption is updated by updating E.current_draw	*/
-/*	in network.c E.current_draw is reset to zero at the start of 	*/
-/*	each simulation cycle and sums up the op and NIC power (and 	*/
-/*	any other future) currents.					*/
+/*	The pipelines only count cycles per op here. The counts are	*/
+/*	turned into energy and current by power_materialize(), using	*/
+/*	the current VDD, CYCLETIME, scaledcurrents and forced power	*/
+/*	settings, so it must run before any of those change and before	*/
+/*	CPUEtot or current_draw are read. TX/RX currents are added	*/
+/*	to current_draw directly in network-hitachi-sh.c.		*/
 /*									*/
 #define	update_energy(op, Rm, Rn)\
-	if ((S->force_sleeppwr != 0.0) && S->sleep)\
-	{\
-		S->energyinfo.CPUEtot += S->force_sleeppwr*S->CYCLETIME;\
-		S->energyinfo.current_draw += S->force_sleeppwr/S->VDD;\
-	}\
-	else if (S->force_avgpwr != 0.0)\
-	{\
-		S->energyinfo.CPUEtot += S->force_avgpwr*S->CYCLETIME;\
-		S->energyinfo.current_draw += S->force_avgpwr/S->VDD;\
-	}\
-	else\
-	{\
-		S->energyinfo.CPUEtot += S->scaledcurrents[op]*S->VDD*S->CYCLETIME;\
-		S->energyinfo.current_draw += S->scaledcurrents[op];\
-	}
+	S->energyinfo.opcycles[S->sleep ? ENERGY_SLEEPSLOT : (op)]++
@@ -38,6 +38,7 @@
 #include <math.h>
 #include <string.h>
 #include "sf.h"
+#include "mextern.h"
 
 
 /*										*/
@@ -424,6 +425,7 @@ uvlong
 mrandominit(Engine *E, uvlong seed)
 {
 	uvlong	ux, lx;
+	int	i, k;
 
 	if (seed == -1)
 	{
@@ -445,6 +447,23 @@ mrandominit(Engine *E, uvlong seed)
 		E->randgen_mt[E->randgen_mti] = ux | lx;
 	}
 
+	/*								*/
+	/*	Rewind all counter-based streams, so that re-seeding	*/
+	/*	with the same value reproduces the same draws.		*/
+	/*								*/
+	for (k = 0; k < kSunflowerRandstreamMax; k++)
+	{
+		mrandstreaminit(&E->randstreams[k], k, 0);
+	}
+	for (i = 0; i < E->nnodes; i++)
+	{
+		mrandstreaminitnode(E, E->sp[i]);
+	}
+	for (i = 0; i < E->nnetsegs; i++)
+	{
+		mrandstreaminit(&E->netsegs[i].randstream, kSunflowerRandstreamNetsegFault, E->netsegs[i].NETSEG_ID);
+	}
+
 	return seed;
 }
 
@@ -821,6 +840,132 @@ mrandom(Engine *E)
 	return x;
 }
 
+/*										*/
+/*	Counter-based streams. Unlike the Mersenne Twister above, which	*/
+/*	is a single sequence shared by the whole engine, each Randstream	*/
+/*	draw is computed directly from a 128-bit counter made up of the	*/
+/*	stream id and the stream's own draw count, keyed by the engine	*/
+/*	seed. The generator is Philox-4x32-10 from:				*/
+/*										*/
+/*		@inproceedings{2063405,						*/
+/*			author = {Salmon, John K. and Moraes, Mark A. and	*/
+/*				Dror, Ron O. and Shaw, David E.},		*/
+/*			title = {Parallel Random Numbers: As Easy As 1, 2, 3},	*/
+/*			booktitle = {Proc. SC '11},				*/
+/*			year = {2011},						*/
+/*			doi = {http://doi.acm.org/10.1145/2063384.2063405},	*/
+/*			}							*/
+/*										*/
+/*	Since draws only depend on (seed, stream id, counter), nodes can	*/
+/*	be stepped in any order (or concurrently) without perturbing each	*/
+/*	other's random sequences.						*/
+/*										*/
+static tuck uvlong
+philox4x32(uvlong key, uvlong id, uvlong counter)
+{
+	int		r;
+	uint32_t	c0, c1, c2, c3, k0, k1;
+	uint64_t	p0, p1;
+
+
+	c0 = (uint32_t)counter;
+	c1 = (uint32_t)(counter >> 32);
+	c2 = (uint32_t)id;
+	c3 = (uint32_t)(id >> 32);
+	k0 = (uint32_t)key;
+	k1 = (uint32_t)(key >> 32);
+
+	for (r = 0; r < RANDGEN_PHILOX_ROUNDS; r++)
+	{
+		p0 = (uint64_t)RANDGEN_PHILOX_M0 * c0;
+		p1 = (uint64_t)RANDGEN_PHILOX_M1 * c2;
+
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)p1;
+		c3 = (uint32_t)p0;
+
+		k0 += RANDGEN_PHILOX_W0;
+		k1 += RANDGEN_PHILOX_W1;
+	}
+
+	return ((uvlong)c1 << 32) | c0;
+}
+
+void
+mrandstreaminit(Randstream *R, SunflowerRandstreamKind kind, int ownerid)
+{
+	R->id		= ((uvlong)kind << 32) | (uint32_t)ownerid;
+	R->counter	= 0;
+
+	return;
+}
+
+void
+mrandstreaminitnode(Engine *E, State *S)
+{
+	int	k;
+
+	for (k = 0; k < kSunflowerRandstreamMax; k++)
+	{
+		mrandstreaminit(&S->randstreams[k], k, S->NODE_ID);
+	}
+
+	return;
+}
+
+uvlong
+mrandstream(Engine *E, Randstream *R)
+{
+	return philox4x32(E->randseed, R->id, R->counter++);
+}
+
+double
+mrandstreamuniform(Engine *E, Randstream *R, double min, double max)
+{
+	/*	Same mapping from [0, ~0ULL] onto [min, max] as u()	*/
+	return min + ((double)mrandstream(E, R)) * ((max - min)/((double)~0ULL));
+}
+
+/*										*/
+/*	Bulk fill: out[i] is exactly what the (i+1)'th subsequent call to	*/
+/*	mrandstream() would have returned. The iterations are independent	*/
+/*	of each other, so the loop is a candidate for auto-vectorization	*/
+/*	when filling large tables.						*/
+/*										*/
+void
+mrandstreamfill(Engine *E, Randstream *R, uvlong *out, int n)
+{
+	int	i;
+	uvlong	key = E->randseed, id = R->id, base = R->counter;
+
+
+	for (i = 0; i < n; i++)
+	{
+		out[i] = philox4x32(key, id, base + i);
+	}
+	R->counter += n;
+
+	return;
+}
+
+void
+mrandstreamfilluniform(Engine *E, Randstream *R, double *out, int n, double min, double max)
+{
+	int	i;
+	double	scale = (max - min)/((double)~0ULL);
+	uvlong	key = E->randseed, id = R->id, base = R->counter;
+
+
+	for (i = 0; i < n; i++)
+	{
+		out[i] = min + ((double)philox4x32(key, id, base + i)) * scale;
+	}
+	R->counter += n;
+
+	return;
+}
+
 /*										*/
 /*	For the m_pfun_*() functions, we include the 'min' and 'max' params	*/
 /*	as a convenience, since we will often want to restrict the range of	*/
@@ -2956,6 +3101,18 @@ m_updatervars(Engine *E)
 		return;
 	}
 
+	/*								*/
+	/*	Rvars may rewrite VDD, frequency or forced power; charge	*/
+	/*	the cycles accumulated so far at the old settings first.	*/
+	/*								*/
+	if (SF_POWER_ANALYSIS)
+	{
+		for (i = 0; i < E->nnodes; i++)
+		{
+			power_materialize(E, E->sp[i]);
+		}
+	}
+
 	E->rvarsnextpsec = PICOSEC_MAX;
 	for (i = 0; i < E->nvalidrvars; i++)
 	{
@@ -2978,7 +3135,7 @@ m_updatervars(Engine *E)
 			}
 			else if (p->valdisttabid >= 0)
 			{
-				val = E->randtabs[p->valdisttabid].table[mrandom(E) % E->randtabs[p->valdisttabid].size];
+				val = E->randtabs[p->valdisttabid].table[mrandstream(E, &E->randstreams[kSunflowerRandstreamEngineRvar]) % E->randtabs[p->valdisttabid].size];
 			}
 			else
 			{
@@ -2999,7 +3156,7 @@ m_updatervars(Engine *E)
 			else if (p->durdisttabid >= 0)
 			{
 				dur = E->randtabs[p->durdisttabid].table[
-						mrandom(E) % E->randtabs[p->durdisttabid].size];
+						mrandstream(E, &E->randstreams[kSunflowerRandstreamEngineRvar]) % E->randtabs[p->durdisttabid].size];
 			}
 			else
 			{
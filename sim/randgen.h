@@ -58,6 +58,13 @@
 #define RANDGEN_TT		33
 #define RANDGEN_LL		39
 
+/*	Philox-4x32-10 multipliers and Weyl key increments		*/
+#define RANDGEN_PHILOX_M0	0xD2511F53U
+#define RANDGEN_PHILOX_M1	0xCD9E8D57U
+#define RANDGEN_PHILOX_W0	0x9E3779B9U
+#define RANDGEN_PHILOX_W1	0xBB67AE85U
+#define RANDGEN_PHILOX_ROUNDS	10
+
 /*										*/
 /*	NOTE: these are defined in main.h due to dependencies. They are		*/
 /*	mirrored here for informational purposes.				*/
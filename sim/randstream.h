@@ -0,0 +1,63 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Counter-based random number streams. A stream is named by its	*/
+/*	kind and the id of its owner (node, netseg, or the engine), and	*/
+/*	its n'th draw is a pure function of (seed, kind, owner id, n).	*/
+/*	Draws on one stream are therefore unaffected by how many draws	*/
+/*	were made on any other stream, or in which order nodes were	*/
+/*	stepped. See mrandstream() in randgen.c.			*/
+/*									*/
+typedef enum
+{
+	kSunflowerRandstreamNodeFault,
+	kSunflowerRandstreamNodeSEE,
+	kSunflowerRandstreamNodeNetwork,
+	kSunflowerRandstreamNodeDevice,
+	kSunflowerRandstreamNetsegFault,
+	kSunflowerRandstreamEngineSched,
+	kSunflowerRandstreamEngineRvar,
+
+	kSunflowerRandstreamMax,
+} SunflowerRandstreamKind;
+
+typedef struct
+{
+	uvlong	id;
+	uvlong	counter;
+} Randstream;
@@ -152,42 +152,20 @@ do_valuetrace(Engine *E, State *S, ulong *data, int n)
 		/*	For value tracing, if access is bigger than the		*/
 		/*	underlying data, mask off excess.			*/
 		/*								*/
-		ulong	mask = ~0U;
+		ulong	mask = ~0U, value;
 		if ((*match)->size < 4)
 		{
 			mask = (1 << ((*match)->size << 3)) - 1;
 		}
 
-		(*match)->values[(*match)->validx] = *data & mask;
+		value = *data & mask;
 
 		if (SF_FT_TANDEM)
 		{
 			do_tandem(E, S, data, n, match);
 		}
 
-		if ((*match)->validx < MAX_REGTRACER_VALUETRACE)
-		{
-			(*match)->validx++;
-		}
-
-		if ((*match)->validx == (*match)->nvalues)
-		{
-			ulong	*tmp;
-
-			(*match)->nvalues *= 2;
-			tmp = (ulong *)mrealloc(E, (*match)->values,
-				(*match)->nvalues*sizeof(ulong),
-				"realloc (*match)->values in regaccess.c");
-
-			if (tmp == NULL)
-			{
-				mprint(E, NULL, siminfo,
-					"Resizing (*match)->values to %d entries failed\n",
-					(*match)->nvalues);
-				sfatal(E, S, "realloc failed for (*match)->values in regaccess.c");
-			}
-			(*match)->values = tmp;
-		}
+		mvtracereg(E, S, *match, value);
 	}
 	
 	return;
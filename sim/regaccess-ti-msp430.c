@@ -66,7 +66,7 @@ msp430regread(Engine *E, State *S, int n, MSP430Pipestage *p)
 				break;
 			}
 			default:
-				sfatal(S, "Internal Error: Invalid As supplied to ref_read");
+				sfatal(E, S, "Internal Error: Invalid As supplied to ref_read");
 		}
 	}
 	else if (n == 3)
@@ -94,7 +94,7 @@ msp430regread(Engine *E, State *S, int n, MSP430Pipestage *p)
 				break;
 			}
 			default:
-				sfatal(S, "Internal Error: Invalid As supplied to ref_read");
+				sfatal(E, S, "Internal Error: Invalid As supplied to ref_read");
 		}
 	}
 	else
@@ -137,7 +137,7 @@ msp430regread(Engine *E, State *S, int n, MSP430Pipestage *p)
 			/*	For value tracing, if access is bigger than the		*/
 			/*	underlying data, mask off excess.			*/
 			/*								*/
-			ulong	mask = ~0UL;
+			ulong	mask = ~(ulong)0;
 			if ((*match)->size < 4)
 			{
 				mask = (1 << ((*match)->size << 3)) - 1;
@@ -155,7 +155,7 @@ msp430regread(Engine *E, State *S, int n, MSP430Pipestage *p)
 				ulong	*tmp;
 
 				(*match)->nvalues *= 2;
-				tmp = (ulong *)mrealloc((*match)->values,
+				tmp = (ulong *)mrealloc(E, (*match)->values,
 					(*match)->nvalues*sizeof(ulong),
 					"realloc (*match)->values in regaccess.c");
 				if (tmp == NULL)
@@ -202,7 +202,7 @@ msp430regset(Engine *E, State *S, int n, ushort data)
 			/*	For value tracing, if access is bigger than the		*/
 			/*	underlying data, mask off excess.			*/
 			/*								*/
-			ulong	mask = ~0UL;
+			ulong	mask = ~(ulong)0;
 			if ((*match)->size < 4)
 			{
 				mask = (1 << ((*match)->size << 3)) - 1;
@@ -220,7 +220,7 @@ msp430regset(Engine *E, State *S, int n, ushort data)
 				ulong	*tmp;
 
 				(*match)->nvalues *= 2;
-				tmp = (ulong *)mrealloc((*match)->values,
+				tmp = (ulong *)mrealloc(E, (*match)->values,
 					(*match)->nvalues*sizeof(ulong),
 					"realloc (*match)->values in regaccess.c");
 				if (tmp == NULL)
@@ -0,0 +1,417 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sf.h"
+#include "mextern.h"
+
+enum
+{
+	/*	RISC-V NOP (ADDI x0, x0, 0) fetched by riscvstep() when draining	*/
+	RISCV_DRAIN_NOP = 51,
+};
+
+/*	Two-sided 95% point of the standard normal	*/
+#define	SAMPLE_Z95	(1.96)
+
+static void	sampledrain(Engine *E, State *S);
+static void	sampleenter(Engine *E, State *S, SunflowerSamplePhase phase);
+static tuck void	sampleaccesses(State *S, uvlong *accesses, uvlong *misses);
+static tuck void	sampleaccum(Samplestat *stat, double x);
+static void	sampleprint(Engine *E, State *S, char *name, char *unit, Samplestat *stat, uvlong n, uvlong ninstrs);
+
+
+void
+msampleinit(Engine *E, State *S, uvlong nfast, uvlong nwarm, uvlong ndetail)
+{
+	Sampler	*s;
+
+
+	if (ndetail == 0)
+	{
+		merror(E, "Sampling needs a non-zero detailed window.");
+		return;
+	}
+
+	if (S->sampler == NULL)
+	{
+		S->sampler = (Sampler *)mcalloc(E, 1, sizeof(Sampler), "S->sampler");
+		if (S->sampler == NULL)
+		{
+			mexit(E, "Could not allocate memory for S->sampler", -1);
+		}
+	}
+	s = S->sampler;
+
+	/*								*/
+	/*	If we are already sampling, go back to the step the	*/
+	/*	user had selected before re-initializing, so a second	*/
+	/*	SAMPLE does not lose the original mode.		*/
+	/*								*/
+	if (s->active)
+	{
+		msampleoff(E, S);
+	}
+
+	memset(s, 0, sizeof(Sampler));
+	s->nfast = nfast;
+	s->nwarm = nwarm;
+	s->ndetail = ndetail;
+	s->savedstep = S->step;
+	s->startdyncnt = S->dyncnt;
+	s->startclk = S->CLK;
+	s->active = 1;
+
+	/*								*/
+	/*	The pipeline may hold instructions from a previous	*/
+	/*	cycle-accurate run; retire them before going fast.	*/
+	/*								*/
+	if (S->step == S->cyclestep)
+	{
+		sampledrain(E, S);
+	}
+
+	if (nfast > 0)
+	{
+		sampleenter(E, S, kSunflowerSamplePhaseFast);
+	}
+	else
+	{
+		sampleenter(E, S, nwarm > 0 ? kSunflowerSamplePhaseWarm : kSunflowerSamplePhaseDetail);
+	}
+	S->step = msamplestep;
+
+	mprint(E, S, nodeinfo,
+		"Sampling: " UVLONGFMT " fast, " UVLONGFMT " warm, " UVLONGFMT " detailed instructions per period\n",
+		nfast, nwarm, ndetail);
+
+	return;
+}
+
+void
+msampleoff(Engine *E, State *S)
+{
+	Sampler	*s = S->sampler;
+
+
+	if (s == NULL || !s->active)
+	{
+		return;
+	}
+
+	if (s->phase != kSunflowerSamplePhaseFast && s->savedstep != S->cyclestep)
+	{
+		sampledrain(E, S);
+	}
+	else if (s->phase == kSunflowerSamplePhaseFast && s->savedstep == S->cyclestep)
+	{
+		S->flushpipe(S);
+	}
+
+	S->step = s->savedstep;
+	s->active = 0;
+
+	return;
+}
+
+int
+msamplestep(Engine *E, State *S, int drain_pipeline)
+{
+	Sampler	*s = S->sampler;
+	int	ret;
+
+
+	if (s->phase == kSunflowerSamplePhaseFast)
+	{
+		ret = S->faststep(E, S, drain_pipeline);
+	}
+	else
+	{
+		ret = S->cyclestep(E, S, drain_pipeline);
+	}
+
+	/*								*/
+	/*	Phases end at a step() boundary, so a phase may run	*/
+	/*	up to a quantum of instructions past its nominal end.	*/
+	/*	The measured window uses the actual counts, so this	*/
+	/*	only affects how long the phase is, not its accuracy.	*/
+	/*								*/
+	if (!E->on || !S->runnable || S->dyncnt < s->phaseend)
+	{
+		return ret;
+	}
+
+	switch (s->phase)
+	{
+		case kSunflowerSamplePhaseFast:
+		{
+			sampleenter(E, S, s->nwarm > 0 ? kSunflowerSamplePhaseWarm : kSunflowerSamplePhaseDetail);
+			break;
+		}
+
+		case kSunflowerSamplePhaseWarm:
+		{
+			sampleenter(E, S, kSunflowerSamplePhaseDetail);
+			break;
+		}
+
+		case kSunflowerSamplePhaseDetail:
+		{
+			uvlong	ninstrs, accesses, misses;
+
+
+			power_materialize(E, S);
+			ninstrs = S->dyncnt - s->windyncnt;
+			if (ninstrs > 0)
+			{
+				s->nsamples++;
+				sampleaccum(&s->cpi, (double)(S->CLK - s->winclk) / ninstrs);
+				sampleaccum(&s->epi, (S->energyinfo.CPUEtot - s->winenergy) / ninstrs);
+
+				sampleaccesses(S, &accesses, &misses);
+				if (accesses > s->winaccesses)
+				{
+					s->nmisssamples++;
+					sampleaccum(&s->missrate,
+						(double)(misses - s->winmisses) / (accesses - s->winaccesses));
+				}
+			}
+
+			if (s->nfast > 0)
+			{
+				sampledrain(E, S);
+				sampleenter(E, S, kSunflowerSamplePhaseFast);
+			}
+			else
+			{
+				sampleenter(E, S, s->nwarm > 0 ? kSunflowerSamplePhaseWarm : kSunflowerSamplePhaseDetail);
+			}
+			break;
+		}
+	}
+
+	return ret;
+}
+
+void
+msamplestats(Engine *E, State *S)
+{
+	Sampler	*s = S->sampler;
+	uvlong	ninstrs;
+
+
+	if (s == NULL || s->nsamples == 0)
+	{
+		mprint(E, S, nodeinfo, "No sampled windows have completed\n");
+		return;
+	}
+
+	ninstrs = S->dyncnt - s->startdyncnt;
+
+	mprint(E, S, nodeinfo, "\nSampling %s: " UVLONGFMT " fast, " UVLONGFMT " warm, " UVLONGFMT " detailed\n",
+		(s->active ? "active" : "off"), s->nfast, s->nwarm, s->ndetail);
+	mprint(E, S, nodeinfo, "Instructions since SAMPLE\t: " UVLONGFMT "\n", ninstrs);
+	mprint(E, S, nodeinfo, "Detailed windows\t\t: " UVLONGFMT "\n", s->nsamples);
+	mprint(E, S, nodeinfo, "Simulated cycles since SAMPLE\t: " UVLONGFMT "\n", S->CLK - s->startclk);
+
+	sampleprint(E, S, "CPI", "cycles", &s->cpi, s->nsamples, ninstrs);
+	mprint(E, S, nodeinfo, "Estimated time\t\t\t: %E s\n",
+		(s->cpi.sum / s->nsamples) * ninstrs * S->CYCLETIME);
+
+	if (SF_POWER_ANALYSIS)
+	{
+		sampleprint(E, S, "Energy/instr", "J", &s->epi, s->nsamples, ninstrs);
+	}
+
+	if (s->nmisssamples > 0)
+	{
+		sampleprint(E, S, "Cache miss rate", NULL, &s->missrate, s->nmisssamples, 0);
+	}
+	mprint(E, S, nodeinfo, "\n");
+
+	return;
+}
+
+static void
+sampleprint(Engine *E, State *S, char *name, char *unit, Samplestat *stat, uvlong n, uvlong ninstrs)
+{
+	double	mean, var, ci;
+
+
+	mean = stat->sum / n;
+	var = (n > 1) ? (stat->sumsq - n*mean*mean) / (n - 1) : 0.0;
+	ci = SAMPLE_Z95 * sqrt(max(var, 0.0) / n);
+
+	mprint(E, S, nodeinfo, "%s\t\t\t: %E +/- %E (95%% CI)\n", name, mean, ci);
+	if (unit != NULL)
+	{
+		mprint(E, S, nodeinfo, "Estimated total %s\t: %E +/- %E\n",
+			unit, mean*ninstrs, ci*ninstrs);
+	}
+
+	return;
+}
+
+static void
+sampleenter(Engine *E, State *S, SunflowerSamplePhase phase)
+{
+	Sampler	*s = S->sampler;
+
+
+	switch (phase)
+	{
+		case kSunflowerSamplePhaseFast:
+		{
+			s->phaseend = S->dyncnt + s->nfast;
+			break;
+		}
+
+		case kSunflowerSamplePhaseWarm:
+		{
+			/*							*/
+			/*	Leaving the fast step: the pipeline holds	*/
+			/*	whatever it held when we last left the cycle	*/
+			/*	step, so start it empty at the current PC.	*/
+			/*							*/
+			if (s->phase == kSunflowerSamplePhaseFast)
+			{
+				S->flushpipe(S);
+			}
+			s->phaseend = S->dyncnt + s->nwarm;
+			break;
+		}
+
+		case kSunflowerSamplePhaseDetail:
+		{
+			if (s->phase == kSunflowerSamplePhaseFast)
+			{
+				S->flushpipe(S);
+			}
+			s->winclk = S->CLK;
+			s->windyncnt = S->dyncnt;
+			power_materialize(E, S);
+			s->winenergy = S->energyinfo.CPUEtot;
+			sampleaccesses(S, &s->winaccesses, &s->winmisses);
+			s->phaseend = S->dyncnt + s->ndetail;
+			break;
+		}
+	}
+	s->phase = phase;
+
+	return;
+}
+
+static tuck void
+sampleaccesses(State *S, uvlong *accesses, uvlong *misses)
+{
+	Cache	*C;
+
+
+	if (S->machinetype != MACHINE_SUPERH || !S->superH->cache_activated)
+	{
+		*accesses = *misses = 0;
+		return;
+	}
+
+	C = S->superH->C;
+	*misses = C->readmiss + C->writemiss;
+	*accesses = *misses + C->readhit + C->writehit;
+
+	return;
+}
+
+static tuck void
+sampleaccum(Samplestat *stat, double x)
+{
+	stat->sum += x;
+	stat->sumsq += x*x;
+
+	return;
+}
+
+/*									*/
+/*	Retire the instructions in flight in the cycle-accurate		*/
+/*	pipeline, so the fast step (which only looks at S->PC) does	*/
+/*	not skip them. As drain_pipeline() in machine-hitachi-sh.c,	*/
+/*	but stops if the node halts or sleeps, since the step would	*/
+/*	then no longer advance the pipeline.				*/
+/*									*/
+static void
+sampledrain(Engine *E, State *S)
+{
+	switch (S->machinetype)
+	{
+		case MACHINE_SUPERH:
+		{
+			SuperHPipe	*P = &S->superH->P;
+
+			while (E->on && S->runnable && !S->sleep &&
+				((P->IF.instr != 0x9) || (P->ID.instr != 0x9) ||
+				(P->EX.instr != 0x9) || (P->MA.instr != 0x9) ||
+				(P->WB.instr != 0x9)))
+			{
+				S->cyclestep(E, S, 1);
+			}
+			break;
+		}
+
+		case MACHINE_RISCV:
+		{
+			RiscvPipe	*P = &S->riscv->P;
+
+			while (E->on && S->runnable && !S->sleep &&
+				((P->IF.valid && P->IF.instr != RISCV_DRAIN_NOP) ||
+				(P->ID.valid && P->ID.instr != RISCV_DRAIN_NOP) ||
+				(P->EX.valid && P->EX.instr != RISCV_DRAIN_NOP) ||
+				(P->MA.valid && P->MA.instr != RISCV_DRAIN_NOP)))
+			{
+				S->cyclestep(E, S, 1);
+			}
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,91 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Sampled simulation. The sampler alternates between running	*/
+/*	the fast functional step for a fixed number of instructions,	*/
+/*	running the cycle-accurate step without measuring to warm the	*/
+/*	pipeline and caches, and running the cycle-accurate step for a	*/
+/*	measured window. The per-window CPI, energy per instruction	*/
+/*	and cache miss rate are used to estimate the totals for the	*/
+/*	whole sampled run, with a confidence interval. See sampling.c.	*/
+/*									*/
+typedef enum
+{
+	kSunflowerSamplePhaseFast,
+	kSunflowerSamplePhaseWarm,
+	kSunflowerSamplePhaseDetail,
+} SunflowerSamplePhase;
+
+typedef struct
+{
+	double	sum;
+	double	sumsq;
+} Samplestat;
+
+typedef struct
+{
+	int			active;
+	SunflowerSamplePhase	phase;
+
+	/*	Phase lengths, in dynamic instructions			*/
+	uvlong			nfast;
+	uvlong			nwarm;
+	uvlong			ndetail;
+
+	/*	S->dyncnt at which the current phase ends		*/
+	uvlong			phaseend;
+
+	/*	Step routine in effect before sampling was enabled	*/
+	int			(*savedstep)();
+
+	/*	Counter values at the start of the measured window	*/
+	uvlong			winclk;
+	uvlong			windyncnt;
+	double			winenergy;
+	uvlong			winaccesses;
+	uvlong			winmisses;
+
+	/*	Totals over the sampled run				*/
+	uvlong			startdyncnt;
+	uvlong			startclk;
+	uvlong			nsamples;
+	uvlong			nmisssamples;
+	Samplestat		cpi;
+	Samplestat		epi;
+	Samplestat		missrate;
+} Sampler;
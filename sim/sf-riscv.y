@@ -95,6 +95,10 @@
 %token	T_BATTVBATTLUTNENTRIES
 %token	T_BATTVLOSTLUT
 %token	T_BATTVLOSTLUTNENTRIES
+%token	T_PCPROFILE
+%token	T_PCPROFILEDUMP
+%token	T_PCPROFILEOFF
+%token	T_PCPROFILESTATS
 %token	T_PCBT
 %token	T_CACHEINIT
 %token	T_CACHEOFF
@@ -114,6 +118,7 @@
 %token	T_DUMPHISTPRETTY
 %token	T_LDHISTRND
 %token	T_ADDHIST
+%token	T_SETHISTFORMAT
 %token	T_DUMPSYSREGS
 %token	T_DUMPTIME
 %token	T_DUMPTLB
@@ -125,6 +130,7 @@
 %token	T_FLTTHRESH
 %token	T_FORCEAVGPWR
 %token	T_HELP
+%token	T_HOSTSTATS
 %token	T_IGNORENODEDEATHS
 %token	T_INITSEESTATE
 %token	T_HWSEEREG
@@ -139,6 +145,12 @@
 %token	T_MMAP
 %token	T_MODECA
 %token	T_MODEFF
+%token	T_SAMPLE
+%token	T_SAMPLEOFF
+%token	T_SAMPLESTATS
+%token	T_SAVETRAJECTORY
+%token	T_VALUETRACEFILE
+%token	T_VALUETRACECLOSE
 %token	T_NETCORREL
 %token	T_NETDEBUG
 %token	T_NETNEWSEG
@@ -190,11 +202,13 @@
 %token	T_SETBASENODEID
 %token	T_SETBATT
 %token	T_SETBATTFEEDPERIOD
+%token	T_SETBATTFEEDADAPTIVE
 %token	T_SETDUMPPWRPERIOD
 %token	T_SETNETPERIOD
 %token	T_SETFAULTPERIOD
 %token	T_SETFREQ
 %token	T_SETIFCOUI
+%token	T_SETANALYSIS
 %token	T_SETMEMBASE
 %token	T_SETNODE
 %token	T_SETPC
@@ -215,12 +229,20 @@
 %token	T_SETNODEMASS
 %token	T_SETPROPULSIONCOEFFS
 %token	T_SHAREBUS
+%token	T_BUSARBITRATION
+%token	T_BUSBANKS
+%token	T_BUSPRIORITY
+%token	T_BUSSTATS
+%token	T_BUSTIMING
 %token	T_SHOWCLK
 %token	T_SHOWMEMBASE
 %token	T_SHOWPIPE
 %token	T_SHOWTAGS
 %token	T_SIGNALSRC
 %token	T_SIGNALSUBSCRIBE
+%token	T_SIMPROFILE
+%token	T_SIMPROFILEOFF
+%token	T_SIMPROFILEON
 %token	T_SIZEMEM
 %token	T_SIZEPAU
 %token	T_SPLIT
@@ -249,6 +271,8 @@
 %token	T_CYCLES
 %token	T_INSTRS
 %token	T_SENSORREADING
+%token	T_READS
+%token	T_WRITES
 
 /*	Assembler control instructions 		*/
 %token	T_DOTALIGN
@@ -658,6 +682,7 @@ sf_cmd		: T_QUIT '\n'
 						"Setting yyengine->batts[%d].Cf to %f\n",
 						yyengine->curbatt, $2);
 				yyengine->batts[yyengine->curbatt].Cf = $2;
+				yyengine->battbank.dirty = 1;
 			}
 		}
 		| T_BATTINOMINAL dimm '\n'
@@ -668,6 +693,7 @@ sf_cmd		: T_QUIT '\n'
 					"Setting yyengine->batts[%d].Inominal to %f\n",
 					yyengine->curbatt, $2);
 				yyengine->batts[yyengine->curbatt].Inominal = $2;
+				yyengine->battbank.dirty = 1;
 			}
 		}
 		| T_BATTRF dimm '\n'
@@ -678,6 +704,7 @@ sf_cmd		: T_QUIT '\n'
 						"Setting yyengine->batts[%d].Rf to %f\n",
 						yyengine->curbatt, $2);
 				yyengine->batts[yyengine->curbatt].Rf = $2;
+				yyengine->battbank.dirty = 1;
 			}
 		}
 		| T_BATTETALUT uimm dimm '\n'
@@ -687,6 +714,7 @@ sf_cmd		: T_QUIT '\n'
 				if ($2 < yyengine->batts[yyengine->curbatt].etaLUTnentries)
 				{
 					yyengine->batts[yyengine->curbatt].etaLUT[$2] = $3;
+					yyengine->battbank.dirty = 1;
 				}
 				else
 				{
@@ -709,6 +737,7 @@ sf_cmd		: T_QUIT '\n'
 				{
 					yyengine->batts[yyengine->curbatt].etaLUT = tmp;
 					yyengine->batts[yyengine->curbatt].etaLUTnentries = $2;
+					yyengine->battbank.dirty = 1;
 				}
 			}
 		}
@@ -719,6 +748,7 @@ sf_cmd		: T_QUIT '\n'
 				if ($2 < yyengine->batts[yyengine->curbatt].VbattLUTnentries)
 				{
 					yyengine->batts[yyengine->curbatt].VbattLUT[$2] = $3;
+					yyengine->battbank.dirty = 1;
 				}
 				else
 				{
@@ -741,6 +771,7 @@ sf_cmd		: T_QUIT '\n'
 				{
 					yyengine->batts[yyengine->curbatt].VbattLUT = tmp;
 					yyengine->batts[yyengine->curbatt].VbattLUTnentries = $2;
+					yyengine->battbank.dirty = 1;
 				}
 			}
 		}
@@ -751,6 +782,7 @@ sf_cmd		: T_QUIT '\n'
 				if ($2 < yyengine->batts[yyengine->curbatt].VlostLUTnentries)
 				{
 					yyengine->batts[yyengine->curbatt].VlostLUT[$2] = $3;
+					yyengine->battbank.dirty = 1;
 				}
 				else
 				{
@@ -773,9 +805,17 @@ sf_cmd		: T_QUIT '\n'
 				{
 					yyengine->batts[yyengine->curbatt].VlostLUT = tmp;
 					yyengine->batts[yyengine->curbatt].VlostLUTnentries = $2;
+					yyengine->battbank.dirty = 1;
 				}
 			}
 		}
+		| T_SETBATTFEEDADAPTIVE dimm dimm dimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				batt_setfeedadaptive(yyengine, $2, $3, $4);
+			}
+		}
 		| T_SETBATT uimm '\n'
 		{
 			if (!yyengine->scanning)
@@ -825,6 +865,27 @@ sf_cmd		: T_QUIT '\n'
 				m_setbptsensorreading(yyengine, yyengine->cp, $3, $4);
 			}
 		}
+		| T_BPT T_PC uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				m_setbptpc(yyengine, yyengine->cp, $3);
+			}
+		}
+		| T_BPT T_READS uimm uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				m_setbptwatch(yyengine, yyengine->cp, BPT_READS, $3, $4);
+			}
+		}
+		| T_BPT T_WRITES uimm uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				m_setbptwatch(yyengine, yyengine->cp, BPT_WRITES, $3, $4);
+			}
+		}
 		| T_BPTLS '\n'
 		{
 			if (!yyengine->scanning)
@@ -968,6 +1029,84 @@ sf_cmd		: T_QUIT '\n'
 				yyengine->quantum = $2;
 			}
 		}
+		| T_SETANALYSIS T_STRING uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				m_setanalysis(yyengine, $2, $3);
+			}
+		}
+		| T_HOSTSTATS '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				m_hoststats(yyengine);
+			}
+		}
+		| T_SIMPROFILE '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msimprofreport(yyengine, NULL, "");
+			}
+		}
+		| T_SIMPROFILEON '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msimprofon(yyengine);
+			}
+		}
+		| T_SIMPROFILEOFF '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msimprofoff(yyengine);
+			}
+		}
+		| T_PCPROFILE uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mpcprofinit(yyengine, yyengine->cp, $2);
+			}
+		}
+		| T_PCPROFILEOFF '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mpcprofoff(yyengine, yyengine->cp);
+			}
+		}
+		| T_PCPROFILESTATS uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mpcprofstats(yyengine, yyengine->cp, $2);
+			}
+		}
+		| T_PCPROFILEDUMP T_STRING T_STRING '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mpcprofdump(yyengine, yyengine->cp, $2, $3);
+			}
+		}
+		| T_PCPROFILEDUMP T_STRING T_CYCLES '\n'
+		{
+			/*	"cycles" and "instrs" lex as the BPT keywords	*/
+			if (!yyengine->scanning)
+			{
+				mpcprofdump(yyengine, yyengine->cp, $2, "cycles");
+			}
+		}
+		| T_PCPROFILEDUMP T_STRING T_INSTRS '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mpcprofdump(yyengine, yyengine->cp, $2, "instrs");
+			}
+		}
 		| T_SETBASENODEID uimm '\n'
 		{
 			if (!yyengine->scanning)
@@ -1069,6 +1208,7 @@ sf_cmd		: T_QUIT '\n'
 		{
 			if (!yyengine->scanning)
 			{
+				power_materialize(yyengine, yyengine->cp);
 				yyengine->cp->force_avgpwr = $2;
 				yyengine->cp->force_sleeppwr = $3;
 			}
@@ -1145,6 +1285,27 @@ sf_cmd		: T_QUIT '\n'
 				m_dumpall(yyengine, $2, M_OWRITE, $3, $4);
 			}
 		}
+		| T_SAVETRAJECTORY T_STRING T_STRING '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mtrajectorysave(yyengine, $2, $3);
+			}
+		}
+		| T_VALUETRACEFILE T_STRING '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mvtraceopen(yyengine, yyengine->cp, $2);
+			}
+		}
+		| T_VALUETRACECLOSE '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mvtraceclose(yyengine, yyengine->cp);
+			}
+		}
 		| T_SETNODE uimm '\n'
 		{
 			if (!yyengine->scanning)
@@ -1189,6 +1350,27 @@ sf_cmd		: T_QUIT '\n'
 				yyengine->cp->step = yyengine->cp->faststep;
 			}
 		}
+		| T_SAMPLE uimm uimm uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msampleinit(yyengine, yyengine->cp, $2, $3, $4);
+			}
+		}
+		| T_SAMPLEOFF '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msampleoff(yyengine, yyengine->cp);
+			}
+		}
+		| T_SAMPLESTATS '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				msamplestats(yyengine, yyengine->cp);
+			}
+		}
 		| T_CACHEINIT uimm uimm uimm '\n'
 		{
 			if (!yyengine->scanning)
@@ -1245,6 +1427,13 @@ sf_cmd		: T_QUIT '\n'
 				yyengine->cp->addhist(yyengine, yyengine->cp, $2, $3, $4);
 			}
 		}
+		| T_SETHISTFORMAT uimm T_STRING '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				yyengine->cp->sethistformat(yyengine, yyengine->cp, $2, $3);
+			}
+		}
 		| T_DUMPSYSREGS '\n'
 		{
 			if (!yyengine->scanning)
@@ -1403,7 +1592,7 @@ sf_cmd		: T_QUIT '\n'
 		{
 			if (!yyengine->scanning)
 			{
-				yyengine->cp->fail_prob = $2;
+				fault_setnodefailprob(yyengine, yyengine->cp, $2);
 			}
 		}
 		| T_NODEFAILDURMAX uimm '\n'
@@ -1446,7 +1635,7 @@ sf_cmd		: T_QUIT '\n'
 				}
 				else
 				{
-					yyengine->netsegs[$2].fail_prob = $3;
+					fault_setnetsegfailprob(yyengine, &yyengine->netsegs[$2], $3);
 				}
 			}
 		}
@@ -1679,6 +1868,8 @@ sf_cmd		: T_QUIT '\n'
 		{
 			yyengine->cp->MEMBASE = $2;
 			yyengine->cp->TAINTMEMBASE = $2;
+			yyengine->cp->MEMEND = $2 + yyengine->cp->MEMSIZE;
+			mmemmapsetram(yyengine, yyengine->cp);
 		}
 		| T_SHOWMEMBASE
 		{
@@ -1740,6 +1931,41 @@ sf_cmd		: T_QUIT '\n'
 				cont(yyengine, yyengine->cp, $2);
 			}
 		}
+		| T_BUSARBITRATION T_STRING '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mbusarbitration(yyengine, yyengine->cp, $2);
+			}
+		}
+		| T_BUSBANKS uimm uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mbusbanks(yyengine, yyengine->cp, $2, $3);
+			}
+		}
+		| T_BUSTIMING uimm uimm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mbustiming(yyengine, yyengine->cp, $2, $3);
+			}
+		}
+		| T_BUSPRIORITY uimm simm '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mbuspriority(yyengine, yyengine->cp, $2, $3);
+			}
+		}
+		| T_BUSSTATS '\n'
+		{
+			if (!yyengine->scanning)
+			{
+				mbusstats(yyengine, yyengine->cp);
+			}
+		}
 		| T_SHAREBUS uimm '\n'
 		{
 			if (!yyengine->scanning)
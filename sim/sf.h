@@ -63,6 +63,18 @@
 #include "listutils.h"
 #include "parserlib.h"
 #include "mmalloc.h"
+#include "randstream.h"
+#include "sampling.h"
+#include "simprofile.h"
+#include "pcprofile.h"
+#include "memmap.h"
+#include "linereader.h"
+#include "trajectory.h"
+#include "mobility.h"
+#include "cmdqueue.h"
+#include "vtrace.h"
+#include "vfs.h"
+#include "bus.h"
 #include "batt.h"
 #include "physics.h"
 #include "interrupts-hitachi-sh.h"
@@ -77,6 +89,7 @@
 #include "decode-riscv.h"
 #include "power.h"
 #include "pipeline-hitachi-sh.h"
+#include "superblock-hitachi-sh.h"
 #include "pipeline-ti-msp430.h"
 #include "pipeline-riscv.h"
 #include "pau.h"
@@ -0,0 +1,186 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static char	*simprofnames[kSimprofMax] =
+{
+	[kSimprofNetwork]	= "network_clock",
+	[kSimprofFault]		= "fault_feed",
+	[kSimprofPhysics]	= "physics_feed",
+	[kSimprofTrajectory]	= "traj_feed",
+	[kSimprofBreakpoints]	= "bpts_feed",
+	[kSimprofBattery]	= "battery_feed",
+	[kSimprofNodestep]	= "node step",
+	[kSimprofBus]		= "mbusclock",
+	[kSimprofNuma]		= "mem NUMA lookup",
+	[kSimprofCachemiss]	= "mem cache miss",
+	[kSimprofDevport]	= "devport/MMIO",
+};
+
+static void	simprofline(Engine *E, State *L, char *pre, char *line);
+
+
+void
+msimprofon(Engine *E)
+{
+	Simprofile	*p = &E->simprof;
+
+
+	if (!SF_SIMPROFILE)
+	{
+		merror(E, "Simulator was built without SF_SIMPROFILE.");
+		return;
+	}
+
+	memset(p, 0, sizeof(Simprofile));
+	p->startticks = simprofticks();
+	p->startwallusecs = mwalltimeusecs();
+	p->enabled = 1;
+
+	return;
+}
+
+void
+msimprofoff(Engine *E)
+{
+	Simprofile	*p = &E->simprof;
+
+
+	if (!p->enabled)
+	{
+		return;
+	}
+
+	p->totalticks += simprofticks() - p->startticks;
+	p->totalwallusecs += mwalltimeusecs() - p->startwallusecs;
+	p->enabled = 0;
+
+	return;
+}
+
+/*									*/
+/*	Print the profile, either to the console (L == NULL) or to	*/
+/*	the log fd of L, as used by m_dumpall(). Ticks are converted	*/
+/*	to seconds using the wall-clock time over the profiled span.	*/
+/*									*/
+void
+msimprofreport(Engine *E, State *L, char *pre)
+{
+	Simprofile	*p = &E->simprof;
+	uvlong		totalticks, totalwallusecs, stepticks;
+	double		secspertick;
+	char		line[MAX_MIO_BUFSZ];
+	int		i;
+
+
+	totalticks = p->totalticks;
+	totalwallusecs = p->totalwallusecs;
+	if (p->enabled)
+	{
+		totalticks += simprofticks() - p->startticks;
+		totalwallusecs += mwalltimeusecs() - p->startwallusecs;
+	}
+
+	if (totalticks == 0)
+	{
+		simprofline(E, L, pre, "Simulator profile: no data (use SIMPROFILEON)\n");
+		return;
+	}
+	secspertick = ((double)totalwallusecs/1E6) / (double)totalticks;
+
+	snprintf(line, sizeof(line),
+		"Simulator profile (%s): " UVLONGFMT " ticks, %.6f s wall\n",
+		p->enabled ? "running" : "stopped", (unsigned long long)totalticks, (double)totalwallusecs/1E6);
+	simprofline(E, L, pre, line);
+
+	stepticks = 0;
+	for (i = 0; i <= kSimprofBus; i++)
+	{
+		stepticks += p->counters[i].ticks;
+	}
+
+	for (i = 0; i < kSimprofMax; i++)
+	{
+		Simprofcounter	*c = &p->counters[i];
+
+		if (i == kSimprofNuma)
+		{
+			simprofline(E, L, pre, "\t(the following are included in node step)\n");
+		}
+
+		snprintf(line, sizeof(line),
+			"\t%-16s\t%6.2f%%\t%.6f s\t" UVLONGFMT " calls\t%.1f ticks/call\n",
+			simprofnames[i],
+			100.0 * (double)c->ticks / (double)totalticks,
+			(double)c->ticks * secspertick,
+			(unsigned long long)c->count,
+			c->count == 0 ? 0.0 : (double)c->ticks / (double)c->count);
+		simprofline(E, L, pre, line);
+	}
+
+	/*								*/
+	/*	What is left is the scheduler itself, the command	*/
+	/*	interpreter and anything not covered by a region.	*/
+	/*								*/
+	snprintf(line, sizeof(line), "\t%-16s\t%6.2f%%\t%.6f s\n",
+		"other",
+		totalticks > stepticks ? 100.0 * (double)(totalticks - stepticks) / (double)totalticks : 0.0,
+		totalticks > stepticks ? (double)(totalticks - stepticks) * secspertick : 0.0);
+	simprofline(E, L, pre, line);
+
+	return;
+}
+
+static void
+simprofline(Engine *E, State *L, char *pre, char *line)
+{
+	if (L == NULL)
+	{
+		mprint(E, NULL, siminfo, "%s%s", pre, line);
+	}
+	else
+	{
+		mlog(E, L, "%s%s", pre, line);
+	}
+
+	return;
+}
@@ -0,0 +1,110 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Host-side profile of the simulator itself. Each region below	*/
+/*	accumulates host timestamp-counter ticks and entry counts	*/
+/*	while profiling is on (SIMPROFILEON). The scheduler phases are	*/
+/*	disjoint; the memory and devport regions are entered from	*/
+/*	within the node step, so their ticks are also included in it.	*/
+/*	See simprofile.c.						*/
+/*									*/
+typedef enum
+{
+	kSimprofNetwork,
+	kSimprofFault,
+	kSimprofPhysics,
+	kSimprofTrajectory,
+	kSimprofBreakpoints,
+	kSimprofBattery,
+	kSimprofNodestep,
+	kSimprofBus,
+	kSimprofNuma,
+	kSimprofCachemiss,
+	kSimprofDevport,
+	kSimprofMax,
+} SimprofRegion;
+
+typedef struct
+{
+	uvlong		ticks;
+	uvlong		count;
+} Simprofcounter;
+
+typedef struct
+{
+	int		enabled;
+
+	/*	Tick count and wall-clock time when profiling started,	*/
+	/*	used to convert ticks to seconds in the report.		*/
+	uvlong		startticks;
+	uvlong		startwallusecs;
+
+	/*	Accumulated over previous enabled intervals		*/
+	uvlong		totalticks;
+	uvlong		totalwallusecs;
+
+	Simprofcounter	counters[kSimprofMax];
+} Simprofile;
+
+/*									*/
+/*	The timestamp counter is read with rdtsc where available; it	*/
+/*	does not serialize, so very short regions are only approximate,	*/
+/*	but it costs tens of host cycles rather than a system call.	*/
+/*	Elsewhere we fall back to the wall-clock time in microseconds.	*/
+/*									*/
+#if defined(__x86_64__) || defined(__i386__)
+#	define	simprofticks()	((uvlong)__builtin_ia32_rdtsc())
+#else
+#	define	simprofticks()	mwalltimeusecs()
+#endif
+
+/*									*/
+/*	simprofbegin() gives 0 when profiling is off. simprofend()	*/
+/*	ignores a region whose start is 0, so toggling profiling in	*/
+/*	the middle of a region never records a bogus interval.		*/
+/*									*/
+#define	simprofbegin(E)		((SF_SIMPROFILE && (E)->simprof.enabled) ? simprofticks() : 0)
+#define	simprofend(E, r, t0)\
+	do\
+	{\
+		if (SF_SIMPROFILE && (t0) != 0)\
+		{\
+			(E)->simprof.counters[(r)].ticks += simprofticks() - (t0);\
+			(E)->simprof.counters[(r)].count++;\
+		}\
+	} while (0)
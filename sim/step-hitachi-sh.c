@@ -0,0 +1,878 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	The step loops. This file is not compiled on its own: it is	*/
+/*	included by pipeline-hitachi-sh.c once for each step-loop	*/
+/*	instance, with SF_ANALYSES fixed to a constant and SF_STEPFN()	*/
+/*	appending the instance suffix to the function names.		*/
+/*									*/
+
+/*										*/
+/*	faststep() does not emulate pipeline, doesn't perform any of the	*/
+/*	safety checks performed by step(). 					*/
+/*										*/
+static int
+SF_STEPFN(superHfaststep)(Engine *E, State *S, int drain_pipeline)
+{
+	int		i, n, ibase, timerat, tmpinstr;
+	ulong		tmpPC;
+	Picosec		gbase, now;
+
+
+	USED(drain_pipeline);
+
+	/*								*/
+	/*	Time within a step is kept as a count of the node's own	*/
+	/*	cycles. A node behind the global time loses the first	*/
+	/*	iteration catching up; after that, the global time is	*/
+	/*	always a cycle ahead of the node, advancing one cycle	*/
+	/*	per iteration from gbase, so it needs no per-instruction	*/
+	/*	time check and the timer interrupt falls due at a fixed	*/
+	/*	iteration, timerat. S->TIME is brought up to date at	*/
+	/*	the end and before system calls, as superblocks do;	*/
+	/*	devices reading the time add S->pendingcycles.		*/
+	/*								*/
+	i = 0;
+	gbase = E->globaltimepsec;
+	if ((E->quantum > 0) && E->on && S->runnable
+		&& !eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
+	{
+		gbase = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+		i = 1;
+	}
+	ibase = i;
+	timerat = superHtimerat(S, gbase, ibase);
+
+	for (S->pendingcycles = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	{
+		if (superH_check_excp_macro(S))
+		{
+			superHtake_exception(E, S);
+		}
+		else if (SF_NETWORK && superH_check_nic_intr_macro(S))
+		{
+			S->take_nic_intr(E, S);
+		}
+		else if (i >= timerat)
+		{
+			/*								*/
+			/*	Taking interrupt might fail if not interruptible, 	*/
+			/*	so do not set LASTACTIVATE til it actually succeeds	*/
+			/*								*/
+			if (S->take_timer_intr(E, S) == 0)
+			{
+				now = gbase + (i - ibase)*S->CYCLETIME;
+				S->superH->TIMER_LASTACTIVATE = now;
+				timerat = superHtimerat(S, now, i);
+			}
+		}
+
+		if (S->sleep)
+		{
+			update_energy(SUPERH_OP_SLEEP, 0, 0);
+			S->ICLK++;
+			S->pendingcycles++;
+
+			continue;
+		}
+
+		if (bptpchook(E, S, S->PC))
+		{
+			break;
+		}
+
+		/*								*/
+		/*	With the MMU off, run from translated superblocks.	*/
+		/*	A run is bounded up front to end before the timer	*/
+		/*	interrupt becomes due; other interrupts end it in	*/
+		/*	superHsbexec(), which also accounts for its time.	*/
+		/*	The PC profile and PC breakpoints need to see each	*/
+		/*	instruction, and read watchpoints each instruction	*/
+		/*	fetch, which a superblock does only at translation.	*/
+		/*								*/
+		if (!SF_BITFLIP_ANALYSIS && !(SF_PAU_DEFINED && S->superH->PAUs != NULL)
+			&& (mmucr_field_at(S->superH->MMUCR) == 0)
+			&& (S->pcprof == NULL || !S->pcprof->active)
+			&& (S->bptindex.npc == 0) && (S->bptindex.nreads == 0))
+		{
+			n = superHsbexec(E, S, max(min(timerat - i, E->quantum - i), 1));
+			if (n > 0)
+			{
+				i += n - 1;
+
+				continue;
+			}
+		}
+
+		tmpPC = S->PC;
+		tmpinstr = superHreadword(E, S, S->PC);
+		S->superH->P.EX.fptr 	= E->superHDC[tmpinstr].dc_p.fptr;
+		S->superH->P.EX.format 	= E->superHDC[tmpinstr].dc_p.format;
+		S->superH->P.EX.instr 	= tmpinstr;
+
+		if (SF_POWER_ANALYSIS)
+		{
+			update_energy(E->superHDC[tmpinstr].dc_p.op, 0, 0);
+		}
+
+		S->superH->P.EX.fetchedpc = S->PC;
+		S->PC += 2;
+		S->CLK++;
+		S->ICLK++;
+		S->dyncnt++;
+		S->pendingcycles++;
+
+		/*	System calls see the node's time as before	*/
+		if (E->superHDC[tmpinstr].dc_p.op == SUPERH_OP_TRAPA)
+		{
+			S->TIME += S->pendingcycles*S->CYCLETIME;
+			S->pendingcycles = 0;
+		}
+
+		switch (S->superH->P.EX.format)
+		{
+			case INSTR_0:
+			{
+				/*							*/
+				/* 	Instruction may be delayed branch, so fill ID 	*/
+				/*	for Delay_SLot()				*/
+				/*							*/
+				S->superH->P.ID.instr = superHreadword(E, S, S->PC);
+				S->superH->P.ID.fetchedpc = S->PC;
+
+				(*(S->superH->P.EX.fptr))(E, S);
+				break;
+			}
+
+			case INSTR_N:
+			{
+				instr_n *tmp;
+
+				/*							*/
+				/* 	Instruction may be delayed branch, so fill ID 	*/
+				/*	for Delay_SLot()				*/
+				/*							*/
+				S->superH->P.ID.instr = superHreadword(E, S, S->PC);
+				S->superH->P.ID.fetchedpc = S->PC;
+
+				tmp = (instr_n *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->dst);
+				break;
+			}
+
+			case INSTR_M:
+			{
+				instr_m *tmp = (instr_m *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->src);
+				break;
+			}
+
+			case INSTR_MBANK:
+			{
+				instr_mbank *tmp = (instr_mbank *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->reg, tmp->src);
+				break;
+			}
+
+			case INSTR_NBANK:
+			{
+				instr_nbank *tmp = (instr_nbank *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->reg, tmp->dst);
+				break;
+			}
+
+			case INSTR_NM:
+			{
+				instr_nm *tmp = (instr_nm *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->dst);
+				break;
+			}
+
+			case INSTR_MD:
+			{
+				instr_md *tmp = (instr_md *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->disp);
+				break;
+			}
+
+			case INSTR_NMD:
+			{
+				instr_nmd *tmp = (instr_nmd *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->disp, tmp->dst);
+				break;
+			}
+
+			case INSTR_D8:
+			{
+				instr_d8 *tmp;
+
+				/*							*/
+				/* 	Instruction may be delayed branch, so fill ID 	*/
+				/*	for Delay_SLot()				*/
+				/*							*/
+				S->superH->P.ID.instr = superHreadword(E, S, S->PC);
+				S->superH->P.ID.fetchedpc = S->PC;
+
+				tmp = (instr_d8 *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->disp);
+				break;
+			}
+
+			case INSTR_D12:
+			{
+				instr_d12 *tmp;
+
+				/*							*/
+				/* 	Instruction may be delayed branch, so fill ID 	*/
+				/*	for Delay_SLot()				*/
+				/*							*/
+				S->superH->P.ID.instr = superHreadword(E, S, S->PC);
+				S->superH->P.ID.fetchedpc = S->PC;
+
+				tmp = (instr_d12 *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->disp);
+				break;
+			}
+
+			case INSTR_ND4:
+			{
+				instr_nd4 *tmp = (instr_nd4 *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->disp, tmp->dst);
+				break;
+			}
+
+			case INSTR_ND8:
+			{
+				instr_nd8 *tmp = (instr_nd8 *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->disp, tmp->dst);
+				break;
+			}
+
+			case INSTR_I:
+			{
+				instr_i *tmp = (instr_i *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->imm);
+				break;
+			}
+
+			case INSTR_NI:
+			{
+				instr_ni *tmp = (instr_ni *)&S->superH->P.EX.instr;
+				(*(S->superH->P.EX.fptr))(E, S, tmp->imm, tmp->dst);
+				break;
+			}
+
+			default:
+			{
+				sfatal(E, S, "Unknown Instruction Type !!");
+				break;
+			}
+		}
+
+		if (SF_PAU_DEFINED && S->superH->PAUs != NULL)
+		{
+			pau_clk(E, S);
+		}
+
+		if (SF_BITFLIP_ANALYSIS)
+		{
+			S->Cycletrans += bit_flips_32(tmpPC, S->PC);	
+			S->energyinfo.ntrans = S->energyinfo.ntrans + S->Cycletrans;
+			S->Cycletrans = 0;
+		}
+
+		pcprofhook(E, S, tmpPC);
+	}
+	S->TIME += S->pendingcycles*S->CYCLETIME;
+	S->pendingcycles = 0;
+	S->last_stepclks = i;
+
+	return i;
+}
+
+
+static int
+SF_STEPFN(superHstep)(Engine *E, State *S, int drain_pipeline)
+{
+	int		i, exec_energy_updated = 0, stall_energy_updated = 0;
+	ulong		tmpPC;
+	Picosec		saved_globaltime;
+
+
+	saved_globaltime = E->globaltimepsec;
+	for (i = 0; (i < E->quantum) && E->on && S->runnable; i++)
+	{
+		/*	Stop before the instruction in EX executes	*/
+		if (S->superH->P.EX.valid && bptpchook(E, S, S->superH->P.EX.fetchedpc))
+		{
+			break;
+		}
+
+		/*								*/
+		/*	TODO: This will have to change when we implement	*/
+		/*	setjmp idea for simulating memory stalls		*/
+		/*								*/
+		if (	S->superH->B->pbuslock
+			&& (S->superH->B->pbuslocker == S->NODE_ID)
+			&& (S->superH->P.fetch_stall_cycles == 0)
+			&& ((S->superH->P.MA.cycles == 0) || (S->superH->P.MA.valid == 0))
+		)
+		{
+			S->superH->B->pbuslock = 0;
+			S->superH->B->pbuslocker = -1;
+		}
+
+		if (!drain_pipeline)
+		{
+			if (!eventready(E->globaltimepsec, S->TIME, S->CYCLETIME))
+			{
+				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+				continue;
+			}
+
+			if ((S->superH->SR.BL == 1) && (S->superH->excpQ->nqintrs > 0))
+			{
+				sfatal(E, S, "Exceptions are blocked and we got an exception."
+					"We don't handle this case correctly for synchronous exceptions!!!\n");
+			}
+
+			if (superH_check_excp_macro(S))
+			{
+				superHtake_exception(E, S);
+			}
+			else if (SF_NETWORK && superH_check_nic_intr_macro(S))
+			{
+				S->take_nic_intr(E, S);
+			}
+			else if (eventready(E->globaltimepsec, S->superH->TIMER_LASTACTIVATE,
+					S->superH->TIMER_INTR_DELAY))
+			{
+				if (S->take_timer_intr(E, S) == 0)
+				{
+					S->superH->TIMER_LASTACTIVATE = E->globaltimepsec;
+				}
+			}
+
+			if (S->sleep)
+			{
+				update_energy(SUPERH_OP_SLEEP, 0, 0);
+				S->ICLK++;
+				S->TIME += S->CYCLETIME;
+				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+
+				continue;
+			}
+
+			/*							*/
+			/*	Waiting for the bus or a memory bank; see bus.h	*/
+			/*							*/
+			if (S->superH->P.bus_stall_cycles > 0)
+			{
+				S->superH->P.bus_stall_cycles--;
+				update_energy(SUPERH_OP_NOP, 0, 0);
+				S->CLK++;
+				S->ICLK++;
+				S->TIME += S->CYCLETIME;
+				E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+
+				continue;
+			}
+		}
+	
+		tmpPC = S->PC;
+
+		/*								*/
+		/* 	 		Clear WB stage				*/
+	 	/*								*/
+		S->superH->P.WB.valid = 0;
+	
+
+		/*								*/
+		/*   MA cycles--. If 0, move instr in MA to WB if WB is empty	*/
+		/*								*/
+		if ((S->superH->P.MA.valid) && (S->superH->P.MA.cycles > 0))
+		{
+			S->superH->P.MA.cycles -= 1;
+	
+			/*							*/
+			/*	For mem stall, energy cost assigned is NOP	*/
+			/*							*/
+			if (SF_POWER_ANALYSIS)
+			{
+				update_energy(SUPERH_OP_NOP, 0, 0);
+				stall_energy_updated = 1;
+			}
+		}
+	
+		if ((S->superH->P.MA.valid) && (S->superH->P.MA.cycles == 0)
+			&& (!S->superH->P.WB.valid))
+		{
+			/*		Count # bits flipping in WB		*/
+			if (SF_BITFLIP_ANALYSIS)
+			{
+				S->Cycletrans += bit_flips_32(S->superH->P.MA.instr,
+							S->superH->P.WB.instr);
+			}
+	
+			memmove(&S->superH->P.WB, &S->superH->P.MA, sizeof(SuperHPipestage));
+			S->superH->P.WB.cycles = S->superH->P.WB.instr_latencies[WB];
+			S->superH->P.MA.valid = 0;
+			S->superH->P.WB.valid = 1;
+		}
+	
+	
+		/*										*/
+		/* 	 EX cycles--. If 0, exec, mark EX stage empty and move it to MA		*/
+		/*										*/
+		if ((S->superH->P.EX.valid) && (S->superH->P.EX.cycles > 0))
+		{
+			S->superH->P.EX.cycles -= 1;
+	
+			if (SF_POWER_ANALYSIS)
+			{
+				update_energy(S->superH->P.EX.op, 0, 0);
+				exec_energy_updated = 1;
+			}
+		}
+
+		if (S->superH->P.EX.valid && (S->superH->P.EX.fptr == NULL))
+		{
+			mprint(E, S, nodeinfo, "PC=0x" UHLONGFMT "\n",
+				S->superH->P.EX.fetchedpc);
+			mprint(E, S, nodeinfo, "S->superH->P.EX.instr = [0x%x]",
+				S->superH->P.EX.instr);
+			sfatal(E, S, "Illegal instruction.");
+		}
+	
+		/*								*/
+		/* 	Execution "completes" only if next stage is empty.	*/
+		/*	Since we currently do mem acceses in EX, only go	*/
+		/*	ahead if bus is not locked.				*/
+		/*								*/
+		/*	TODO: only instructions which would cause an access	*/
+		/*	to main memory (non-cacheable / miss in cache) should	*/
+		/*	wait on bus lock. This can be fixed cleanly, if we	*/
+		/*	make actual memory access happen at the end of the	*/
+		/*	stall, in the MA stage (like it should). To do this,	*/
+		/*	would have to (1) mark pipestage as "memaccess-pending"	*/
+		/*	or "re-exec-in-MA". But then how to deal with instrs	*/
+		/*	for which the mem access is not the last step of 	*/
+		/*	execution, e.g. TAS ?  The logically cleanest solution	*/
+		/*	seems to use setjmp to save context as soon as a mem	*/
+		/*	access happens, and then setting the CPU's stall cycles	*/
+		/*	when stall cycles diminish to 0, do a longjmp to cont	*/
+		/*	the simulation of that node...				*/
+		/*								*/
+		if (	(S->superH->P.EX.valid)
+			&& (S->superH->P.EX.cycles == 0)
+			&& !(S->superH->P.MA.valid)
+			&& (!S->superH->B->pbuslock ||
+				S->superH->B->pbuslocker == S->NODE_ID ||
+				!superHEXtouchesmem(S)))
+		{
+			switch (S->superH->P.EX.format)
+			{
+				case INSTR_0:
+				{
+					(*(S->superH->P.EX.fptr))(E, S);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_N:
+				{
+					instr_n *tmp = (instr_n *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_M:
+				{
+					instr_m *tmp = (instr_m *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->src);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_MBANK:
+				{
+					instr_mbank *tmp = (instr_mbank *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->reg, tmp->src);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_NBANK:
+				{
+					instr_nbank *tmp = (instr_nbank *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->reg, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_NM:
+				{
+					instr_nm *tmp = (instr_nm *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_MD:
+				{
+					instr_md *tmp = (instr_md *)&S->superH->P.EX.instr;
+	
+						
+					/*					*/
+					/*   At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->disp);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_NMD:
+				{
+					instr_nmd *tmp = (instr_nmd *)&S->superH->P.EX.instr;
+	
+					/*					*/
+					/*    At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->src, tmp->disp, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_D8:
+				{
+					instr_d8 *tmp = (instr_d8 *)&S->superH->P.EX.instr;
+	
+					/*					*/
+					/*    At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->disp);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_D12:
+				{
+					instr_d12 *tmp = (instr_d12 *)&S->superH->P.EX.instr;
+	
+					/*					*/
+					/*    At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->disp);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_ND4:
+				{
+					instr_nd4 *tmp = (instr_nd4 *)&S->superH->P.EX.instr;
+	
+					/*					*/
+					/*    At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->disp, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_ND8:
+				{
+					instr_nd8 *tmp = (instr_nd8 *)&S->superH->P.EX.instr;
+
+					/*					*/
+					/*    At this point, disp is relative	*/
+					/*					*/
+					(*(S->superH->P.EX.fptr))(E, S, tmp->disp, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+	
+				case INSTR_I:
+				{
+					instr_i *tmp = (instr_i *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->imm);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				case INSTR_NI:
+				{
+					instr_ni *tmp = (instr_ni *)&S->superH->P.EX.instr;
+	
+					(*(S->superH->P.EX.fptr))(E, S, tmp->imm, tmp->dst);
+					S->dyncnt++;
+	
+					break;
+				}
+	
+				default:
+				{
+					sfatal(E, S, "Unknown Instruction Type !!");
+					break;
+				}
+			}
+	
+			/*		Count # bits flipping in MA		*/
+			if (SF_BITFLIP_ANALYSIS)
+			{
+				S->Cycletrans += bit_flips_32(S->superH->P.EX.instr,
+							S->superH->P.MA.instr);
+			}
+	
+			memmove(&S->superH->P.MA, &S->superH->P.EX, sizeof(SuperHPipestage));
+			S->superH->P.MA.cycles = S->superH->P.MA.instr_latencies[MA];
+			S->superH->P.EX.valid = 0;
+			S->superH->P.MA.valid = 1;
+		}
+	
+		/*	     First : If fetch unit is stalled, dec its counter		*/
+		if (S->superH->P.fetch_stall_cycles > 0)
+		{
+			/*								*/
+			/*	Fetch Unit is stalled. Decrement time for it to wait.	*/
+			/*	If we have not accounted for energy cost of stall 	*/
+			/*	above (i.e. no stalled instr in MA), then cost of this	*/
+			/*	cycle is calculated as cost of a NOP.			*/
+			/*								*/
+			S->superH->P.fetch_stall_cycles--;
+	
+			if (SF_POWER_ANALYSIS)
+			{
+				if (!stall_energy_updated && !exec_energy_updated)
+				{
+					update_energy(SUPERH_OP_NOP, 0, 0);
+				}
+			}
+		}
+	
+		/*									*/
+		/* 	move instr in ID stage to EX stage if EX stage is empty.	*/
+		/*									*/
+		if (	(S->superH->P.ID.valid)
+			&& (S->superH->P.fetch_stall_cycles == 0)
+			&& (!S->superH->P.EX.valid)
+			&& (!S->superH->B->pbuslock ||
+				S->superH->B->pbuslocker == S->NODE_ID ||
+				!superHEXtouchesmem(S)))
+		{
+			/*		Count # bits flipping in EX		*/
+			if (SF_BITFLIP_ANALYSIS)
+			{
+				S->Cycletrans += bit_flips_32(S->superH->P.ID.instr,
+							S->superH->P.EX.instr);
+			}
+	
+			/*	We should decode here but instead we do it in the IF
+				so that all relevant information is available by IF		*/
+
+			memmove(&S->superH->P.EX, &S->superH->P.ID, sizeof(SuperHPipestage));
+
+			/*
+			 *	The instr in EX might be a wrong-path fetched word and might thus
+			 *	not be an instruction. If this is the case, decode() would not
+			 *	have stuffed the the pipe stage's instr_latencies (copied from ID)
+			 *	and we can't index S->superH->P.ID.instr_latencies[ID]. Note that
+			 *	the fptr field is always set by decode().
+			 */
+			if (S->superH->P.EX.instr_latencies != NULL)
+			{
+				S->superH->P.EX.cycles = S->superH->P.EX.instr_latencies[EX];
+			}
+	
+			S->superH->P.ID.valid = 0;
+			S->superH->P.EX.valid = 1;
+		}
+	
+	
+		/*									*/
+		/* 	    Move instr in IF stage to ID stage if ID stage is empty	*/
+		/*									*/
+		if (	!(S->superH->P.ID.valid)
+			&& (S->superH->P.IF.valid)
+			&& (S->superH->P.fetch_stall_cycles == 0))
+		{
+			/*		Count # bits flipping in ID		*/
+			if (SF_BITFLIP_ANALYSIS)
+			{
+				S->Cycletrans += bit_flips_32(S->superH->P.ID.instr,
+						S->superH->P.IF.instr);
+			}
+	
+			memmove(&S->superH->P.ID, &S->superH->P.IF, sizeof(SuperHPipestage));
+			
+			/*
+			 *	The instr in ID might be a wrong-path fetched word and might thus
+			 *	not be an instruction. If this is the case, decode() would not
+			 *	have stuffed the the pipe stage's instr_latencies (copied from ID)
+			 *	and we can't index S->superH->P.ID.instr_latencies[ID]. Note that
+			 *	the fptr field is always set by decode().
+			 */
+			if (S->superH->P.ID.instr_latencies != NULL)
+			{
+				S->superH->P.ID.cycles = S->superH->P.ID.instr_latencies[ID];
+			}
+
+			S->superH->P.IF.valid = 0;
+			S->superH->P.ID.valid = 1;
+		}
+	
+		/*									*/
+		/* 	  Put instr in IF stage if it is empty, and increment PC	*/
+		/*	Check against bus lock is for the enclosing longword address	*/
+		/*									*/
+		if (	!(S->superH->P.IF.valid)
+			&& (!S->superH->B->pbuslock ||
+				S->superH->B->pbuslocker == S->NODE_ID ||
+				(S->PC & ~B0011) != S->superH->B->pbuslock_addr))
+		{
+			ushort	instrword;
+
+
+			/*						*/
+			/*	Get inst from mem hierarchy or fetch	*/
+			/*	NOPs (used for draining pipeline).	*/
+			/*						*/
+			if (drain_pipeline)
+			{
+				instrword = 0x0009;
+			}
+			else
+			{
+				S->superH->mem_access_type = MEM_ACCESS_IFETCH;
+				instrword = superHreadword(E, S, S->PC);
+				S->nfetched++;
+				S->superH->mem_access_type = MEM_ACCESS_NIL;
+			}
+
+			/*   Count # bits flipping in IF		*/
+			if (SF_BITFLIP_ANALYSIS)
+			{
+				S->Cycletrans += bit_flips_32(S->superH->P.IF.instr, instrword);
+			}
+	
+			S->superH->P.IF.instr = instrword;
+			S->superH->P.IF.valid = 1;
+
+			/*						*/
+			/*	We also set this here (early) to	*/
+			/*	enable intr/excp handling, since	*/
+			/*	there, we do not drain the pipeline	*/
+			/*	if instr in IF is of type which uses	*/
+			/*	delay slot.				*/
+			/*						*/
+
+			/*	We use Decode Cache Rather than call decode()	*/
+			S->superH->P.IF.op		= E->superHDC[(int)(instrword)].dc_p.op;
+			S->superH->P.IF.fptr		= E->superHDC[(int)(instrword)].dc_p.fptr;
+			S->superH->P.IF.format		= E->superHDC[(int)(instrword)].dc_p.format;
+			S->superH->P.IF.instr_latencies	= E->superHDC[(int)(instrword)].dc_p.instr_latencies;
+
+			/*
+			 *	The instrword might be a wrong-path fetched word and might thus
+			 *	not be an instruction. If this is the case, decode() would not
+			 *	have stuffed the E->superHDC[(int)(instrword)].dc_p.instr_latencies
+			 *	and thus the .instr_latencies field would be NULL (and we can't index
+			 *	.instr_latencies[IF]). Note that the fptr field is always set by decode().
+			 */
+			if (E->superHDC[(int)(instrword)].dc_p.instr_latencies != NULL)
+			{
+				S->superH->P.IF.cycles = E->superHDC[(int)(instrword)].dc_p.instr_latencies[IF];
+			}
+
+			if (!drain_pipeline)
+			{
+				S->superH->P.IF.fetchedpc = S->PC;
+				S->PC += 2;
+			}
+		}
+	
+		S->CLK++;
+		S->ICLK++;
+		S->TIME += S->CYCLETIME;
+	
+		if (S->pipeshow)
+		{
+			superHdumppipe(E, S);
+		}
+
+		if (SF_PAU_DEFINED && S->superH->PAUs != NULL)
+		{
+			pau_clk(E, S);
+		}
+
+		if (SF_BITFLIP_ANALYSIS)
+		{
+			S->Cycletrans += bit_flips_32(tmpPC, S->PC);	
+			S->energyinfo.ntrans = S->energyinfo.ntrans + S->Cycletrans;
+			S->Cycletrans = 0;
+		}
+
+		pcprofhook(E, S, superHpipepc(S));
+
+		E->globaltimepsec = max(E->globaltimepsec, S->TIME) + S->CYCLETIME;
+	}
+	E->globaltimepsec = saved_globaltime;
+
+	return i;
+}
+
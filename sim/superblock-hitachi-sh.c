@@ -0,0 +1,783 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "sf.h"
+#include "instr-hitachi-sh.h"
+#include "endian-hitachi-sh.h"
+#include "mextern.h"
+
+
+static tuck void		sbcall0d(Engine *E, State *S, SuperHSBrec *r);
+static tuck void		sbcall1d(Engine *E, State *S, SuperHSBrec *r);
+static tuck void		sbcall1(Engine *E, State *S, SuperHSBrec *r);
+static tuck void		sbcall2(Engine *E, State *S, SuperHSBrec *r);
+static tuck void		sbcall3(Engine *E, State *S, SuperHSBrec *r);
+static tuck int			sbendsblock(int op);
+static tuck void		sbcommit(State *S, int ninstrs);
+static tuck void		sbreap(Engine *E, SuperHSBcache *C);
+static tuck void		sbkill(SuperHSBcache *C, SuperHSuperblock *b);
+static tuck void		sblink(SuperHSuperblock *b, SuperHSuperblock *nb, ulong pc);
+static tuck SuperHSBcache*	sbnewcache(Engine *E, State *S);
+static tuck void		sbflush(Engine *E, SuperHSBcache *C);
+static tuck SuperHSuperblock*	sblookup(SuperHSBcache *C, ulong pc);
+static tuck SuperHSuperblock*	sbtranslate(Engine *E, State *S, ulong pc);
+
+
+/*									*/
+/*	Handlers, one per operand shape. Those ending in 'd' are for	*/
+/*	the formats that may be delayed branches, which expect the	*/
+/*	slot instruction in P.ID, exactly as superHfaststep sets up.	*/
+/*									*/
+static tuck void
+sbcall0d(Engine *E, State *S, SuperHSBrec *r)
+{
+	S->superH->P.ID.instr = r->nextinstr;
+	S->superH->P.ID.fetchedpc = r->pc + 2;
+	(*(r->fptr))(E, S);
+}
+
+static tuck void
+sbcall1d(Engine *E, State *S, SuperHSBrec *r)
+{
+	S->superH->P.ID.instr = r->nextinstr;
+	S->superH->P.ID.fetchedpc = r->pc + 2;
+	(*(r->fptr))(E, S, r->arg0);
+}
+
+static tuck void
+sbcall1(Engine *E, State *S, SuperHSBrec *r)
+{
+	(*(r->fptr))(E, S, r->arg0);
+}
+
+static tuck void
+sbcall2(Engine *E, State *S, SuperHSBrec *r)
+{
+	(*(r->fptr))(E, S, r->arg0, r->arg1);
+}
+
+static tuck void
+sbcall3(Engine *E, State *S, SuperHSBrec *r)
+{
+	(*(r->fptr))(E, S, r->arg0, r->arg1, r->arg2);
+}
+
+/*									*/
+/*	Instructions after which a block ends: control transfers, and	*/
+/*	anything that changes SR or the MMU, since interrupt and	*/
+/*	exception state is only examined on entry to a block.		*/
+/*									*/
+static tuck int
+sbendsblock(int op)
+{
+	switch (op)
+	{
+		case SUPERH_OP_BF:
+		case SUPERH_OP_BFS:
+		case SUPERH_OP_BT:
+		case SUPERH_OP_BTS:
+		case SUPERH_OP_BRA:
+		case SUPERH_OP_BRAF:
+		case SUPERH_OP_BSR:
+		case SUPERH_OP_BSRF:
+		case SUPERH_OP_JMP:
+		case SUPERH_OP_JSR:
+		case SUPERH_OP_RTS:
+		case SUPERH_OP_RTE:
+		case SUPERH_OP_TRAPA:
+		case SUPERH_OP_SLEEP:
+		case SUPERH_OP_LDCSR:
+		case SUPERH_OP_LDCMSR:
+		case SUPERH_OP_LDTLB:
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*									*/
+/*	Charge ninstrs instructions of one cycle each, as faststep	*/
+/*	does per instruction.						*/
+/*									*/
+static tuck void
+sbcommit(State *S, int ninstrs)
+{
+	S->CLK += ninstrs;
+	S->ICLK += ninstrs;
+	S->dyncnt += ninstrs;
+	S->TIME += ninstrs*S->CYCLETIME;
+}
+
+static tuck void
+sbreap(Engine *E, SuperHSBcache *C)
+{
+	SuperHSuperblock	*b;
+
+
+	while (C->dead != NULL)
+	{
+		b = C->dead;
+		C->dead = b->next;
+		mfree(E, b, "SuperHSuperblock *b in "SF_FILE_MACRO);
+	}
+
+	return;
+}
+
+/*									*/
+/*	Unlink b from its hash chain, the lists of the pages it covers	*/
+/*	and the chain links to and from it, and move it to the dead	*/
+/*	list. Only the blocks on those lists are visited.		*/
+/*									*/
+static tuck void
+sbkill(SuperHSBcache *C, SuperHSuperblock *b)
+{
+	ulong			p;
+	SuperHSuperblock	**bp, *s;
+
+
+	for (p = b->firstpage; p <= b->lastpage; p++)
+	{
+		bp = &C->codepages[p];
+		while (*bp != b)
+		{
+			bp = &(*bp)->pagenext[p - (*bp)->firstpage];
+		}
+		*bp = b->pagenext[p - b->firstpage];
+	}
+
+	bp = &C->buckets[(b->startpc >> 1) & (SUPERH_SB_NBUCKETS - 1)];
+	while (*bp != b)
+	{
+		bp = &(*bp)->next;
+	}
+	*bp = b->next;
+
+	for (s = b->inlinks; s != NULL; s = s->linknext)
+	{
+		s->link = NULL;
+		s->linkpprev = NULL;
+	}
+	b->inlinks = NULL;
+	sblink(b, NULL, 0);
+
+	if (C->resume == b)
+	{
+		C->resume = NULL;
+	}
+
+	b->valid = 0;
+	b->next = C->dead;
+	C->dead = b;
+
+	return;
+}
+
+/*									*/
+/*	Point b's chain link at nb (NULL to clear it), moving b from	*/
+/*	the inlinks list of its old target to that of nb.		*/
+/*									*/
+static tuck void
+sblink(SuperHSuperblock *b, SuperHSuperblock *nb, ulong pc)
+{
+	if (b->link != NULL)
+	{
+		*b->linkpprev = b->linknext;
+		if (b->linknext != NULL)
+		{
+			b->linknext->linkpprev = b->linkpprev;
+		}
+	}
+
+	b->link = nb;
+	b->linkpc = pc;
+	b->linknext = NULL;
+	b->linkpprev = NULL;
+
+	if (nb != NULL)
+	{
+		b->linknext = nb->inlinks;
+		if (nb->inlinks != NULL)
+		{
+			nb->inlinks->linkpprev = &b->linknext;
+		}
+		nb->inlinks = b;
+		b->linkpprev = &nb->inlinks;
+	}
+
+	return;
+}
+
+static tuck SuperHSBcache *
+sbnewcache(Engine *E, State *S)
+{
+	SuperHSBcache	*C;
+
+
+	C = (SuperHSBcache *)mcalloc(E, 1, sizeof(SuperHSBcache),
+				"S->superH->SB in "SF_FILE_MACRO);
+	if (C == NULL)
+	{
+		mexit(E, "Failed to allocate memory for S->superH->SB.", -1);
+	}
+	C->nsharers = 1;
+	S->superH->SB = C;
+
+	return C;
+}
+
+static tuck SuperHSuperblock *
+sblookup(SuperHSBcache *C, ulong pc)
+{
+	SuperHSuperblock	*b;
+
+
+	for (b = C->buckets[(pc >> 1) & (SUPERH_SB_NBUCKETS - 1)]; b != NULL; b = b->next)
+	{
+		if (b->startpc == pc)
+		{
+			return b;
+		}
+	}
+
+	return NULL;
+}
+
+/*									*/
+/*	Only called with the MMU disabled, so physical address is the	*/
+/*	PC without its top 3 bits (see superHvmtranslate()). Blocks are	*/
+/*	only built from local RAM not covered by a NUMA mapping, so	*/
+/*	that every store that could modify them passes through the	*/
+/*	superHwrite* checks of this node, or of a node sharing its	*/
+/*	MEM and so also its cache (superHsbshare()).			*/
+/*									*/
+static tuck SuperHSuperblock *
+sbtranslate(Engine *E, State *S, ulong pc)
+{
+	int			n;
+	ulong			paddr, p;
+	ushort			instr;
+	SuperHPipestage		*dc;
+	SuperHSBrec		*r;
+	SuperHSuperblock	*b;
+	SuperHSBcache		*C = S->superH->SB;
+
+
+	if (C->codepages == NULL)
+	{
+		C->npages = (S->MEMSIZE >> SUPERH_SB_PAGESHIFT) + 1;
+		C->codepages = (SuperHSuperblock **)mcalloc(E, C->npages,
+					sizeof(SuperHSuperblock *), "C->codepages in "SF_FILE_MACRO);
+		if (C->codepages == NULL)
+		{
+			mexit(E, "Failed to allocate memory for C->codepages.", -1);
+		}
+	}
+
+	b = (SuperHSuperblock *)mcalloc(E, 1, sizeof(SuperHSuperblock),
+				"SuperHSuperblock *b in "SF_FILE_MACRO);
+	if (b == NULL)
+	{
+		mexit(E, "Failed to allocate memory for SuperHSuperblock *b.", -1);
+	}
+	b->startpc = pc;
+
+	for (n = 0; n < SUPERH_SB_MAXINSTRS; n++, pc += 2)
+	{
+		paddr = pc & ~(B0111 << 29);
+		if ((paddr < S->MEMBASE) || (paddr + 4 > S->MEMEND)
+			|| (((paddr + 2 - S->MEMBASE) >> SUPERH_SB_PAGESHIFT) >= C->npages))
+		{
+			break;
+		}
+
+		if (m_find_numa(pc, S->N, 0, S->N->count) >= 0)
+		{
+			break;
+		}
+
+		instr = superHreadword(E, S, pc);
+		dc = &E->superHDC[instr].dc_p;
+
+		/*	Illegal instructions are left to superHfaststep	*/
+		if (dc->fptr == NULL)
+		{
+			break;
+		}
+
+		r = &b->recs[n];
+		r->fptr = dc->fptr;
+		r->op = dc->op;
+		r->pc = pc;
+		r->instr = instr;
+		r->nextinstr = superHreadword(E, S, pc + 2);
+
+		switch (dc->format)
+		{
+			case INSTR_0:
+			{
+				r->handler = sbcall0d;
+				break;
+			}
+
+			case INSTR_N:
+			{
+				instr_n *tmp = (instr_n *)&r->instr;
+
+				r->handler = sbcall1d;
+				r->arg0 = tmp->dst;
+				break;
+			}
+
+			case INSTR_M:
+			{
+				instr_m *tmp = (instr_m *)&r->instr;
+
+				r->handler = sbcall1;
+				r->arg0 = tmp->src;
+				break;
+			}
+
+			case INSTR_MBANK:
+			{
+				instr_mbank *tmp = (instr_mbank *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->reg;
+				r->arg1 = tmp->src;
+				break;
+			}
+
+			case INSTR_NBANK:
+			{
+				instr_nbank *tmp = (instr_nbank *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->reg;
+				r->arg1 = tmp->dst;
+				break;
+			}
+
+			case INSTR_NM:
+			{
+				instr_nm *tmp = (instr_nm *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->src;
+				r->arg1 = tmp->dst;
+				break;
+			}
+
+			case INSTR_MD:
+			{
+				instr_md *tmp = (instr_md *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->src;
+				r->arg1 = tmp->disp;
+				break;
+			}
+
+			case INSTR_NMD:
+			{
+				instr_nmd *tmp = (instr_nmd *)&r->instr;
+
+				r->handler = sbcall3;
+				r->arg0 = tmp->src;
+				r->arg1 = tmp->disp;
+				r->arg2 = tmp->dst;
+				break;
+			}
+
+			case INSTR_D8:
+			{
+				instr_d8 *tmp = (instr_d8 *)&r->instr;
+
+				r->handler = sbcall1d;
+				r->arg0 = tmp->disp;
+				break;
+			}
+
+			case INSTR_D12:
+			{
+				instr_d12 *tmp = (instr_d12 *)&r->instr;
+
+				r->handler = sbcall1d;
+				r->arg0 = tmp->disp;
+				break;
+			}
+
+			case INSTR_ND4:
+			{
+				instr_nd4 *tmp = (instr_nd4 *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->disp;
+				r->arg1 = tmp->dst;
+				break;
+			}
+
+			case INSTR_ND8:
+			{
+				instr_nd8 *tmp = (instr_nd8 *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->disp;
+				r->arg1 = tmp->dst;
+				break;
+			}
+
+			case INSTR_I:
+			{
+				instr_i *tmp = (instr_i *)&r->instr;
+
+				r->handler = sbcall1;
+				r->arg0 = tmp->imm;
+				break;
+			}
+
+			case INSTR_NI:
+			{
+				instr_ni *tmp = (instr_ni *)&r->instr;
+
+				r->handler = sbcall2;
+				r->arg0 = tmp->imm;
+				r->arg1 = tmp->dst;
+				break;
+			}
+
+			default:
+			{
+				sfatal(E, S, "Unknown Instruction Type !!");
+				break;
+			}
+		}
+
+		if (sbendsblock(r->op))
+		{
+			n++;
+			break;
+		}
+	}
+
+	if (n == 0)
+	{
+		mfree(E, b, "SuperHSuperblock *b in "SF_FILE_MACRO);
+
+		return NULL;
+	}
+
+	/*								*/
+	/*	Pages run up to and including the word after the last	*/
+	/*	instruction, since a delay slot is read from there.	*/
+	/*								*/
+	b->ninstrs = n;
+	b->firstpage = ((b->startpc & ~(B0111 << 29)) - S->MEMBASE) >> SUPERH_SB_PAGESHIFT;
+	b->lastpage = (((b->recs[n-1].pc + 2) & ~(B0111 << 29)) - S->MEMBASE) >> SUPERH_SB_PAGESHIFT;
+	b->lastpage = min(b->lastpage, C->npages - 1);
+	b->valid = 1;
+
+	for (p = b->firstpage; p <= b->lastpage; p++)
+	{
+		b->pagenext[p - b->firstpage] = C->codepages[p];
+		C->codepages[p] = b;
+	}
+
+	b->next = C->buckets[(b->startpc >> 1) & (SUPERH_SB_NBUCKETS - 1)];
+	C->buckets[(b->startpc >> 1) & (SUPERH_SB_NBUCKETS - 1)] = b;
+
+	return b;
+}
+
+/*									*/
+/*	Run at most maxinstrs instructions from superblocks starting at	*/
+/*	S->PC, following block chains. Returns the number executed, 0	*/
+/*	if no block could be formed at S->PC and the caller should step	*/
+/*	the instruction itself. Counters are charged once per block,	*/
+/*	and always before a block's final instruction (e.g. a TRAPA	*/
+/*	into a syscall) runs, so that instruction sees exact values.	*/
+/*	The caller is responsible for having checked interrupts, and	*/
+/*	for bounding maxinstrs by the next timer interrupt.		*/
+/*									*/
+int
+superHsbexec(Engine *E, State *S, int maxinstrs)
+{
+	int			idx, n = 0, pending = 0;
+	SuperHSBrec		*r;
+	SuperHSuperblock	*b, *nb;
+	SuperHSBcache		*C = S->superH->SB;
+
+
+	if (C == NULL)
+	{
+		C = sbnewcache(E, S);
+	}
+
+	if (C->dead != NULL)
+	{
+		sbreap(E, C);
+	}
+
+	if (C->resume != NULL && C->resume->recs[C->resumeidx].pc == S->PC)
+	{
+		b = C->resume;
+		idx = C->resumeidx;
+	}
+	else
+	{
+		b = sblookup(C, S->PC);
+		if (b == NULL)
+		{
+			b = sbtranslate(E, S, S->PC);
+		}
+		if (b == NULL)
+		{
+			return 0;
+		}
+		idx = 0;
+	}
+	C->resume = NULL;
+
+	for (;;)
+	{
+		for (; idx < b->ninstrs; idx++)
+		{
+			if (n == maxinstrs)
+			{
+				sbcommit(S, pending);
+				C->resume = b;
+				C->resumeidx = idx;
+
+				return n;
+			}
+
+			r = &b->recs[idx];
+			S->superH->P.EX.instr = r->instr;
+			S->superH->P.EX.fetchedpc = r->pc;
+			S->PC = r->pc + 2;
+			n++;
+			pending++;
+
+			if (idx == b->ninstrs - 1)
+			{
+				sbcommit(S, pending);
+				pending = 0;
+			}
+
+			if (SF_POWER_ANALYSIS)
+			{
+				update_energy(r->op, 0, 0);
+			}
+
+			(*(r->handler))(E, S, r);
+
+			if (!b->valid || !E->on || !S->runnable || S->sleep
+				|| superH_check_excp_macro(S)
+				|| (SF_NETWORK && superH_check_nic_intr_macro(S)))
+			{
+				sbcommit(S, pending);
+
+				return n;
+			}
+
+			if (S->PC != r->pc + 2)
+			{
+				break;
+			}
+		}
+		sbcommit(S, pending);
+		pending = 0;
+
+		if (n == maxinstrs)
+		{
+			return n;
+		}
+
+		if (b->link != NULL && b->linkpc == S->PC)
+		{
+			nb = b->link;
+		}
+		else
+		{
+			nb = sblookup(C, S->PC);
+			if (nb == NULL)
+			{
+				nb = sbtranslate(E, S, S->PC);
+			}
+			if (nb == NULL)
+			{
+				return n;
+			}
+			sblink(b, nb, S->PC);
+		}
+
+		b = nb;
+		idx = 0;
+	}
+}
+
+/*									*/
+/*	Called for every store of nbytes at paddr to local RAM once a	*/
+/*	superblock cache exists: from the superHwrite* routines, and	*/
+/*	from syscalls that fill guest memory directly.			*/
+/*									*/
+void
+superHsbwrite(Engine *E, State *S, ulong paddr, ulong nbytes)
+{
+	ulong		page, lastpage;
+	SuperHSBcache	*C = S->superH->SB;
+
+
+	if (C->codepages == NULL || nbytes == 0 || paddr < S->MEMBASE)
+	{
+		return;
+	}
+
+	page = (paddr - S->MEMBASE) >> SUPERH_SB_PAGESHIFT;
+	lastpage = (paddr + nbytes - 1 - S->MEMBASE) >> SUPERH_SB_PAGESHIFT;
+	lastpage = min(lastpage, C->npages - 1);
+	for (; page <= lastpage; page++)
+	{
+		while (C->codepages[page] != NULL)
+		{
+			sbkill(C, C->codepages[page]);
+		}
+	}
+
+	return;
+}
+
+/*									*/
+/*	Drop all translations in C. Every block goes, so the links	*/
+/*	between them need not be cut one by one.			*/
+/*									*/
+static tuck void
+sbflush(Engine *E, SuperHSBcache *C)
+{
+	int			i;
+	SuperHSuperblock	*b;
+
+
+	if (C == NULL || C->codepages == NULL)
+	{
+		return;
+	}
+
+	for (i = 0; i < SUPERH_SB_NBUCKETS; i++)
+	{
+		while (C->buckets[i] != NULL)
+		{
+			b = C->buckets[i];
+			C->buckets[i] = b->next;
+			b->valid = 0;
+			b->next = C->dead;
+			C->dead = b;
+		}
+	}
+	C->resume = NULL;
+	mfree(E, C->codepages, "C->codepages in "SF_FILE_MACRO);
+	C->codepages = NULL;
+	C->npages = 0;
+
+	return;
+}
+
+/*									*/
+/*	Drop all translations, e.g., when MEM is reset or resized.	*/
+/*									*/
+void
+superHsbflush(Engine *E, State *S)
+{
+	sbflush(E, S->superH->SB);
+
+	return;
+}
+
+/*									*/
+/*	Called when N starts using S's MEM: N drops its own cache,	*/
+/*	which translated N's old MEM, and uses S's, so that a store	*/
+/*	through either node invalidates the blocks both execute.	*/
+/*									*/
+void
+superHsbshare(Engine *E, State *S, State *N)
+{
+	if (N->superH->SB == S->superH->SB && N->superH->SB != NULL)
+	{
+		return;
+	}
+
+	superHsbunshare(E, N);
+	if (S->superH->SB == NULL)
+	{
+		sbnewcache(E, S);
+	}
+	N->superH->SB = S->superH->SB;
+	N->superH->SB->nsharers++;
+
+	return;
+}
+
+/*									*/
+/*	Stop using a cache shared with other nodes, e.g., once S gets	*/
+/*	a MEM of its own again. S builds a fresh cache on next use.	*/
+/*									*/
+void
+superHsbunshare(Engine *E, State *S)
+{
+	SuperHSBcache	*C = S->superH->SB;
+
+
+	if (C == NULL)
+	{
+		return;
+	}
+
+	S->superH->SB = NULL;
+	if (--C->nsharers > 0)
+	{
+		return;
+	}
+
+	sbflush(E, C);
+	sbreap(E, C);
+	mfree(E, C, "S->superH->SB in "SF_FILE_MACRO);
+
+	return;
+}
@@ -0,0 +1,150 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Superblock translation for superHfaststep(). A superblock is a	*/
+/*	straight-line run of instructions, ending at the first control	*/
+/*	transfer, translated into an array of records that each carry	*/
+/*	the op routine, its operands already extracted from the	*/
+/*	instruction word, and a handler that makes the call. Blocks are	*/
+/*	found by PC in a small hash table and chained to the block that	*/
+/*	last followed them. See superblock-hitachi-sh.c.		*/
+/*									*/
+enum
+{
+	SUPERH_SB_MAXINSTRS	= 64,
+	SUPERH_SB_NBUCKETS	= 4096,
+
+	/*							*/
+	/*	Stores are matched against translated code at	*/
+	/*	this granularity (1KB pages of physical memory)	*/
+	/*							*/
+	SUPERH_SB_PAGESHIFT	= 10,
+};
+
+typedef struct
+{
+	void		(*handler)();
+	void		(*fptr)();
+	ulong		pc;
+	ulong		arg0;
+	ulong		arg1;
+	ulong		arg2;
+	ushort		instr;
+
+	/*						*/
+	/*	Word following instr, for ops that	*/
+	/*	execute a delay slot via P.ID		*/
+	/*						*/
+	ushort		nextinstr;
+	int		op;
+} SuperHSBrec;
+
+typedef struct SuperHSuperblock SuperHSuperblock;
+struct SuperHSuperblock
+{
+	ulong			startpc;
+	ulong			firstpage;
+	ulong			lastpage;
+	int			ninstrs;
+	int			valid;
+
+	/*						*/
+	/*	Block last entered on leaving this one,	*/
+	/*	and the PC it was entered at.		*/
+	/*						*/
+	SuperHSuperblock	*link;
+	ulong			linkpc;
+
+	/*	Hash chain, or dead list once invalid	*/
+	SuperHSuperblock	*next;
+
+	/*						*/
+	/*	Next block on the list of each page	*/
+	/*	the block covers. A block spans at most	*/
+	/*	SUPERH_SB_MAXINSTRS*2 + 2 bytes, so at	*/
+	/*	most two pages: firstpage and lastpage.	*/
+	/*						*/
+	SuperHSuperblock	*pagenext[2];
+
+	/*						*/
+	/*	Blocks whose link is this one, threaded	*/
+	/*	through their linknext, so that killing	*/
+	/*	a block need only cut those links.	*/
+	/*						*/
+	SuperHSuperblock	*inlinks;
+	SuperHSuperblock	*linknext;
+	SuperHSuperblock	**linkpprev;
+
+	SuperHSBrec		recs[SUPERH_SB_MAXINSTRS];
+};
+
+typedef struct
+{
+	SuperHSuperblock	*buckets[SUPERH_SB_NBUCKETS];
+
+	/*							*/
+	/*	Invalidated blocks are not freed on the spot,	*/
+	/*	since the store that invalidates a block may be	*/
+	/*	executing from it.				*/
+	/*							*/
+	SuperHSuperblock	*dead;
+
+	/*							*/
+	/*	Live blocks covering each page of MEM, chained	*/
+	/*	through pagenext[]				*/
+	/*							*/
+	SuperHSuperblock	**codepages;
+	ulong			npages;
+
+	/*							*/
+	/*	Nodes using this cache: nodes that share MEM	*/
+	/*	(superHsplit(), MMAP) share one cache, so that	*/
+	/*	a store by any of them invalidates stale code	*/
+	/*	for all.					*/
+	/*							*/
+	int			nsharers;
+
+	/*						*/
+	/*	Where to pick up when a block was cut	*/
+	/*	short by the end of a quantum. Checked	*/
+	/*	against the PC, so it is safe for the	*/
+	/*	nodes sharing the cache to share it.	*/
+	/*						*/
+	SuperHSuperblock	*resume;
+	int			resumeidx;
+} SuperHSBcache;
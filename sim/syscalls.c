@@ -55,18 +55,19 @@
 
 
 
-static ulong	sys_write(Engine *E, State *, int, char *, int);
-static ulong	sys_read(State *, int, void *, int);
-static ulong	sys_open(State *, const char *, int);
-static ulong	sys_close(State *, int);
-static ulong	sys_creat(State *, const char *, int);
+static ulong	sys_write(Engine *E, State *, int, ulong, int);
+static ulong	sys_read(Engine *E, State *, int, ulong, int);
+static ulong	sys_open(Engine *E, State *, const char *, int);
+static ulong	sys_close(Engine *E, State *, int);
+static ulong	sys_creat(Engine *E, State *, const char *, int);
 static ulong	sys_chmod(State *S, const char *, short);
 static ulong	sys_chown(State *S, const char *, short, short);
-static ulong	sys_lseek(State *S, int, int, int);
-static ulong	sys_stat(State *S, const char *, struct stat *);
+static ulong	sys_lseek(Engine *E, State *S, int, int, int);
+static ulong	sys_stat(Engine *E, State *S, const char *, struct stat *);
 static ulong	sys_pipe(State *S, int *);
 static ulong	sys_utime(State *S, const char *, const struct utimbuf *);
-static ulong	sys_fstat(State *S, int fd, struct stat *st);
+static ulong	sys_fstat(Engine *E, State *S, int fd, struct stat *st);
+static ulong	vfsstat(State *S, ulong size, struct stat *st);
 
 ulong
 sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
@@ -115,6 +116,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 			}
 			if (SF_POWER_ANALYSIS)
 			{
+				power_materialize(E, S);
 				mprint(E, S, nodeinfo,
 					"Estimated CPU-only Energy = %1.6E\n", S->energyinfo.CPUEtot);
 			}
@@ -122,6 +124,12 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 			mprint(E, S, nodeinfo, "\n\n");
 			S->runnable = 0;
 			E->on = 0;
+
+			/*	The first failing node sets a batch run's status	*/
+			if (E->exitstatus == 0)
+			{
+				E->exitstatus = (int)arg1;
+			}
 			//mexit(E, "pip: exiting on Sys_exit", 0);
 
 			break;
@@ -145,7 +153,14 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 			     mprint(E, S, nodeinfo, "SYSCALL: SYS_read fd=0x" UHLONGFMT " ptr=0x" UHLONGFMT " len=0x" UHLONGFMT "\n",\
 			     arg1, arg2, arg3);
 			}
-			return sys_read(S, (int)arg1, (char *)arg2, (int)arg3);
+
+			/*	read() fills MEM without going through superHwrite*	*/
+			if (S->superH != NULL && S->superH->SB != NULL)
+			{
+				superHsbwrite(E, S, arg2, arg3);
+			}
+
+			return sys_read(E, S, (int)arg1, arg2, (int)arg3);
 			break;
 		}
 
@@ -156,7 +171,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 			    mprint(E, S, nodeinfo, "SYSCALL: SYS_write fd=0x" UHLONGFMT " ptr=0x" UHLONGFMT " len=0x" UHLONGFMT "\n",\
 				arg1, arg2, arg3);
 			}
-			return sys_write(E, S, (int)arg1, (char *)arg2, (int)arg3);
+			return sys_write(E, S, (int)arg1, arg2, (int)arg3);
 			break;
 		}
 
@@ -167,7 +182,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 				mprint(E, S, nodeinfo, "SYSCALL: SYS_open path=%s (" UHLONGFMT ") flags=" UHLONGFMT "\n",\
 				&S->MEM[(ulong)arg1 - S->MEMBASE], arg1, arg2);
 			}
-			return sys_open(S, (const char *)arg1, (int)arg2);
+			return sys_open(E, S, (const char *)arg1, (int)arg2);
 			break;
 		}
 
@@ -177,7 +192,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 			{
 				mprint(E, S, nodeinfo, "SYSCALL: SYS_close fd=0x" UHLONGFMT " \n", arg1);
 			}
-			return sys_close(S, (int)arg1);
+			return sys_close(E, S, (int)arg1);
 			break;
 		}
 
@@ -198,7 +213,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 				mprint(E, S, nodeinfo, "SYSCALL: SYS_creat path=" UHLONGFMT " mode=" UHLONGFMT "\n",\
 				arg1, arg2);
 			}
-			return sys_creat(S, (const char *)arg1, (int)arg2);
+			return sys_creat(E, S, (const char *)arg1, (int)arg2);
 			break;
 		}
 
@@ -283,7 +298,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 				"SYSCALL: SYS_lseek file=0x" UHLONGFMT " ptr=0x" UHLONGFMT " dir=0x" UHLONGFMT "\n",\
 				arg1, arg2, arg3);
 			}
-			return sys_lseek(S, (int)arg1, (int)arg2, (int)arg3);
+			return sys_lseek(E, S, (int)arg1, (int)arg2, (int)arg3);
 			break;
 		}
 
@@ -314,7 +329,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 				mprint(E, S, nodeinfo, "SYSCALL: SYS_fstat\n");
 			}
 
-			return sys_fstat(S, (int) arg1, (struct stat *) arg2);
+			return sys_fstat(E, S, (int) arg1, (struct stat *) arg2);
 
 			break;
 		}
@@ -346,7 +361,7 @@ sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong arg3)
 				mprint(E, S, nodeinfo, "SYSCALL: SYS_stat path=0x" UHLONGFMT " st=0x" UHLONGFMT "\n",\
 				arg1, arg2);
 			}
-			return sys_stat(S, (const char *)arg1, (struct stat *)arg2);
+			return sys_stat(E, S, (const char *)arg1, (struct stat *)arg2);
 			break;
 		}
 
@@ -538,13 +553,8 @@ riscv_sim_syscall(Engine *E, State *S, ulong type, ulong arg1, ulong arg2, ulong
 }
 
 ulong
-sys_write(Engine *E, State *S, int fd, char *ptr, int len)
+sys_write(Engine *E, State *S, int fd, ulong ptr, int len)
 {
-	/*	For sys_read, sys_write, sys_close, sys_lseek,	*/
-	/*	we should maintain a table of fd's we've opened	*/
-	/*	and return -1 if sim app is trying to access an	*/
-	/*	fd we haven't opened.				*/
-
 	/*							*/
 	/*	Capture stdin and stdout to per-node buffers.	*/
 	/*	Since the (sub)string in the node's memory	*/
@@ -558,63 +568,56 @@ sys_write(Engine *E, State *S, int fd, char *ptr, int len)
 	/*							*/
 	if (fd == 1)
 	{
-		mprint(E, S, nodestdout, "%.*s", len, &S->MEM[(ulong)ptr - S->MEMBASE]);
+		mprint(E, S, nodestdout, "%.*s", len, &S->MEM[ptr - S->MEMBASE]);
 		return 0;
 	}
 	if (fd == 2)
 	{
-		mprint(E, S, nodestderr, "%.*s", len, &S->MEM[(ulong)ptr - S->MEMBASE]);
+		mprint(E, S, nodestderr, "%.*s", len, &S->MEM[ptr - S->MEMBASE]);
 		return 0;
 	}
 
-	return write(fd, &S->MEM[(ulong)ptr - S->MEMBASE], len);
+	return mvfswrite(E, S, fd, ptr, len);
 }
 
 ulong
-sys_read(State *S, int fd, void *buf, int len)
+sys_read(Engine *E, State *S, int fd, ulong buf, int len)
 {
-	/*	For now, just pass it on	*/
-	/*	For sys_read, sys_write, sys_close, sys_lseek,	*/
-	/*	we should maintain a table of fd's we've opened	*/
-	/*	and return -1 if sim app is trying to access an	*/
-	/*	fd we haven't opened.				*/
+	/*							*/
+	/*	Only stdin is passed on to the host; all other	*/
+	/*	fds are in the node's own table, see vfs.c.	*/
+	/*							*/
+	if (fd == 0)
+	{
+		return read(fd, &S->MEM[buf - S->MEMBASE], len);
+	}
 
-	return read(fd, &S->MEM[(ulong)buf - S->MEMBASE], len);
+	return mvfsread(E, S, fd, buf, len);
 }
 
 ulong
-sys_open(State *S, const char *path, int flags)
+sys_open(Engine *E, State *S, const char *path, int flags)
 {
-	/*	For now, just pass it on	*/
-	return open((char*)&S->MEM[(ulong)path - S->MEMBASE], flags);
+	return mvfsopen(E, S, (char *)&S->MEM[(ulong)path - S->MEMBASE], flags);
 }
 
 ulong
-sys_close(State *S, int fd)
+sys_close(Engine *E, State *S, int fd)
 {
-	/*	For now, just pass it on						*/
-	/*	For sys_read, sys_write, sys_close, sys_lseek,	*/
-	/*	we should maintain a table of fd's we've opened	*/
-	/*	and return -1 if sim app is trying to access an	*/
-	/*	fd we haven't opened.							*/
-	
 	/*	Avoid closing fds 0,1,2 which are needed by sf	*/
-
 	if (fd <= 2)
 	{
 		return 0;
 	}
-	else
-	{
-		return close(fd);
-	}
+
+	return mvfsclose(E, S, fd);
 }
 
 ulong
-sys_creat(State *S, const char *path, int mode)
+sys_creat(Engine *E, State *S, const char *path, int mode)
 {
-	/*	For now, just pass it on	*/
-	return creat((char*)&S->MEM[(ulong)path - S->MEMBASE], mode|S_IRWXU);
+	return mvfsopen(E, S, (char *)&S->MEM[(ulong)path - S->MEMBASE],
+		NEWLIB_O_WRONLY|NEWLIB_O_CREAT|NEWLIB_O_TRUNC);
 }
 
 ulong
@@ -640,30 +643,60 @@ sys_chown(State *S, const char *path, short owner, short group)
 }
 
 ulong
-sys_lseek(State *S, int fd, int offset, int whence)
+sys_lseek(Engine *E, State *S, int fd, int offset, int whence)
 {
-	/*		For now, just pass it on		*/
-	/*	For sys_read, sys_write, sys_close, sys_lseek,	*/
-	/*	we should maintain a table of fd's we've opened	*/
-	/*	and return -1 if sim app is trying to access an	*/
-	/*	fd we haven't opened.				*/
+	return mvfslseek(E, S, fd, offset, whence);
+}
 
-	return lseek(fd, offset, whence);
+/*								*/
+/*	Files known to the VFS report their in-memory size,	*/
+/*	which may not have reached the host yet. The guest's	*/
+/*	struct stat is taken to be the host's, as before.	*/
+/*								*/
+ulong
+vfsstat(State *S, ulong size, struct stat *st)
+{
+	struct stat	*gst = (struct stat *)&S->MEM[(ulong)st - S->MEMBASE];
+
+
+	memset(gst, 0, sizeof(struct stat));
+	gst->st_mode = S_IFREG|S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH;
+	gst->st_nlink = 1;
+	gst->st_size = size;
+
+	return 0;
 }
 
 ulong
-sys_stat(State *S, const char *path, struct stat *st)
+sys_stat(Engine *E, State *S, const char *path, struct stat *st)
 {
-	/*	For now, just pass it on	*/
+	ulong	size;
+
+
+	if (mvfssize(E, (char *)&S->MEM[(ulong)path - S->MEMBASE], &size) == 0)
+	{
+		return vfsstat(S, size, st);
+	}
+
 	return stat((char *)&S->MEM[(ulong)path - S->MEMBASE], (struct stat *)&S->MEM[(ulong)st - S->MEMBASE]);
 }
 
 ulong
-sys_fstat(State *S, int fd, struct stat *st)
+sys_fstat(Engine *E, State *S, int fd, struct stat *st)
 {
-	/*	For now, just pass it on	*/
-	/*	fd should be correct because sf opened it	*/
-	return fstat(fd, (struct stat *)&S->MEM[(ulong)st - S->MEMBASE]);
+	ulong	size;
+
+
+	if (fd <= 2)
+	{
+		return fstat(fd, (struct stat *)&S->MEM[(ulong)st - S->MEMBASE]);
+	}
+	if (mvfsfsize(E, S, fd, &size) < 0)
+	{
+		return -1;
+	}
+
+	return vfsstat(S, size, st);
 }
 
 ulong
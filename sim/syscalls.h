@@ -103,3 +103,19 @@ enum
 
 	RISCV_SYS_brk	= 214,
 };
+
+/*									*/
+/*	Flags to SYS_open, based on newlib sys/_default_fcntl.h.	*/
+/*	They differ from the host's, so are decoded in vfs.c.		*/
+/*									*/
+enum
+{
+	NEWLIB_O_RDONLY	= 0x0000,
+	NEWLIB_O_WRONLY	= 0x0001,
+	NEWLIB_O_RDWR	= 0x0002,
+	NEWLIB_O_ACCMODE	= 0x0003,
+	NEWLIB_O_APPEND	= 0x0008,
+	NEWLIB_O_CREAT	= 0x0200,
+	NEWLIB_O_TRUNC	= 0x0400,
+	NEWLIB_O_EXCL	= 0x0800,
+};
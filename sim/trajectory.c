@@ -0,0 +1,400 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static char	trajectorymagic[kSunflowerTrajectoryMagiclen] = {'S', 'F', 'T', 'R', 'A', 'J', '0', '1'};
+
+static int	trajectoryalloc(Engine *E, Trajectory *T, int nlocations);
+static int	trajectoryreadtext(Engine *E, Trajectory *T);
+static int	trajectoryreadbinary(Engine *E, Trajectory *T, int fd);
+static void	trajectorysegments(Engine *E, Trajectory *T);
+
+
+/*									*/
+/*	Load a trajectory file, or return the copy already loaded for	*/
+/*	another node or signal source. Returns NULL if the file cannot	*/
+/*	be opened or holds no records.					*/
+/*									*/
+Trajectory *
+mtrajectoryload(Engine *E, char *filename)
+{
+	Trajectory	*T;
+	char		magic[kSunflowerTrajectoryMagiclen];
+	int		fd, ok, i;
+
+
+	for (T = E->trajectories; T != NULL; T = T->next)
+	{
+		if (!strcmp(T->filename, filename))
+		{
+			return T;
+		}
+	}
+
+	fd = mopen(filename, M_OREAD);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	T = (Trajectory *)mcalloc(E, 1, sizeof(Trajectory), "Trajectory *T in trajectory.c");
+	if (T == NULL)
+	{
+		merror(E, "Could not allocate memory for Trajectory *T.");
+		mclose(fd);
+
+		return NULL;
+	}
+
+	T->filename = (char *)mcalloc(E, strlen(filename)+1, sizeof(char), "T->filename in trajectory.c");
+	if (T->filename == NULL)
+	{
+		merror(E, "Could not allocate memory for T->filename.");
+		mfree(E, T, "Trajectory *T in trajectory.c");
+		mclose(fd);
+
+		return NULL;
+	}
+	strcpy(T->filename, filename);
+
+	if ((mread(fd, magic, sizeof(magic)) == sizeof(magic)) &&
+		!memcmp(magic, trajectorymagic, sizeof(magic)))
+	{
+		ok = trajectoryreadbinary(E, T, fd);
+		mclose(fd);
+	}
+	else
+	{
+		mclose(fd);
+		ok = trajectoryreadtext(E, T);
+	}
+
+	if (!ok || (T->nlocations == 0))
+	{
+		/*	Failed loads never hold a mapping	*/
+		for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+		{
+			if (T->planes[i] != NULL)
+			{
+				mfree(E, T->planes[i], "T->planes in trajectory.c");
+			}
+		}
+		mfree(E, T->filename, "T->filename in trajectory.c");
+		mfree(E, T, "Trajectory *T in trajectory.c");
+
+		return NULL;
+	}
+
+	trajectorysegments(E, T);
+	T->next = E->trajectories;
+	E->trajectories = T;
+
+	return T;
+}
+
+/*									*/
+/*	Write a loaded trajectory in the binary format, so later runs	*/
+/*	can map it instead of parsing it.				*/
+/*									*/
+void
+mtrajectorysave(Engine *E, char *filename, char *binfilename)
+{
+	Trajectory	*T;
+	uvlong		n;
+	int		fd, i, nbytes;
+
+
+	T = mtrajectoryload(E, filename);
+	if (T == NULL)
+	{
+		merror(E, "Could not load trajectory file \"%s\".", filename);
+		return;
+	}
+
+	fd = mcreate(binfilename, M_OWRITE|M_OTRUNCATE);
+	if (fd < 0)
+	{
+		merror(E, "Could not create \"%s\".", binfilename);
+		return;
+	}
+
+	n = T->nlocations;
+	nbytes = T->nlocations*sizeof(double);
+	if ((mwrite(fd, trajectorymagic, sizeof(trajectorymagic)) != sizeof(trajectorymagic)) ||
+		(mwrite(fd, (char *)&n, sizeof(n)) != sizeof(n)))
+	{
+		merror(E, "Write to \"%s\" failed.", binfilename);
+		mclose(fd);
+
+		return;
+	}
+
+	for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+	{
+		if (mwrite(fd, (char *)T->planes[i], nbytes) != nbytes)
+		{
+			merror(E, "Write to \"%s\" failed.", binfilename);
+			break;
+		}
+	}
+	mclose(fd);
+
+	mprint(E, NULL, siminfo, "Wrote [%d] trajectory records to \"%s\"\n",
+		T->nlocations, binfilename);
+
+	return;
+}
+
+static int
+trajectoryalloc(Engine *E, Trajectory *T, int nlocations)
+{
+	int	i;
+
+
+	for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+	{
+		T->planes[i] = (double *)mcalloc(E, nlocations, sizeof(double), "T->planes in trajectory.c");
+		if (T->planes[i] == NULL)
+		{
+			merror(E, "Could not allocate memory for trajectory planes.");
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*									*/
+/*	Precompute the per-segment deltas the mobility engine steps	*/
+/*	nodes with. A trajectory whose records are all the same is	*/
+/*	marked stationary.						*/
+/*									*/
+static void
+trajectorysegments(Engine *E, Trajectory *T)
+{
+	int	i, j;
+	double	*p, *d;
+
+
+	T->moving = (uchar *)mcalloc(E, T->nlocations, sizeof(uchar), "T->moving in trajectory.c");
+	if (T->moving == NULL)
+	{
+		mexit(E, "Could not allocate memory for T->moving.", -1);
+	}
+
+	for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+	{
+		T->deltas[i] = (double *)mcalloc(E, T->nlocations, sizeof(double), "T->deltas in trajectory.c");
+		if (T->deltas[i] == NULL)
+		{
+			mexit(E, "Could not allocate memory for T->deltas.", -1);
+		}
+
+		p = T->planes[i];
+		d = T->deltas[i];
+		for (j = 0; j < T->nlocations - 1; j++)
+		{
+			d[j] = p[j+1] - p[j];
+		}
+		d[T->nlocations - 1] = p[0] - p[T->nlocations - 1];
+	}
+
+	T->stationary = 1;
+	for (j = 0; j < T->nlocations; j++)
+	{
+		for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+		{
+			T->moving[j] |= (T->deltas[i][j] != 0.0);
+		}
+		T->stationary &= !T->moving[j];
+	}
+
+	return;
+}
+
+/*									*/
+/*	The header has been consumed from fd. The planes point into a	*/
+/*	mapping of the file where the host supports it; otherwise they	*/
+/*	are read into memory.						*/
+/*									*/
+static int
+trajectoryreadbinary(Engine *E, Trajectory *T, int fd)
+{
+	uvlong		n;
+	long		size;
+	char		*map;
+	int		i, nbytes;
+
+
+	size = mfsize(fd);
+	if (mread(fd, (char *)&n, sizeof(n)) != sizeof(n))
+	{
+		merror(E, "Truncated header in binary trajectory file \"%s\".", T->filename);
+		return 0;
+	}
+
+	if ((size < kSunflowerTrajectoryHdrsize) ||
+		(n != (size - kSunflowerTrajectoryHdrsize)/(kSunflowerTrajectoryNplanes*sizeof(double))) ||
+		((size - kSunflowerTrajectoryHdrsize) % (kSunflowerTrajectoryNplanes*sizeof(double)) != 0))
+	{
+		merror(E, "Binary trajectory file \"%s\" does not match its record count "
+			"(written on a host of different byte order?).", T->filename);
+		return 0;
+	}
+	if (n == 0)
+	{
+		return 0;
+	}
+	T->nlocations = n;
+	nbytes = n*sizeof(double);
+
+	map = mmapfile(fd, size);
+	if (map != NULL)
+	{
+		for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+		{
+			T->planes[i] = (double *)&map[kSunflowerTrajectoryHdrsize + i*nbytes];
+		}
+	}
+	else
+	{
+		if (!trajectoryalloc(E, T, n))
+		{
+			return 0;
+		}
+
+		for (i = 0; i < kSunflowerTrajectoryNplanes; i++)
+		{
+			if (mread(fd, (char *)T->planes[i], nbytes) != nbytes)
+			{
+				merror(E, "Truncated binary trajectory file \"%s\".", T->filename);
+				return 0;
+			}
+		}
+	}
+
+	mprint(E, NULL, siminfo,
+		"[%d] records in trajectory file%s\n", T->nlocations, (map != NULL ? " (mapped)" : ""));
+
+	return 1;
+}
+
+/*									*/
+/*	Text format: the first line is the number of records, then one	*/
+/*	record per line of up to six whitespace-separated fields, in	*/
+/*	the order of the planes.					*/
+/*									*/
+static int
+trajectoryreadtext(Engine *E, Trajectory *T)
+{
+	char		c, buf[kSunflowerTrajectoryMaxline+1], *ep = &c;
+	char		*fieldnames[kSunflowerTrajectoryNplanes] = {"xloc", "yloc", "zloc", "rho", "theta", "phi"};
+	double		val;
+	int		linesread = 0, nrecords = 0;
+	Linereader	*L;
+
+
+	L = mlineopen(E, T->filename);
+	if (L == NULL)
+	{
+		return 0;
+	}
+
+	while (mlinegets(L, buf, kSunflowerTrajectoryMaxline) != NULL)
+	{
+		if ((strlen(buf) > 0) && buf[strlen(buf)-1] == '\n')
+		{
+			buf[strlen(buf)-1] = '\0';
+		}
+
+		if (linesread == 0)
+		{
+			val = strtod(buf, &ep);
+			if (*ep != '\0')
+			{
+				merror(E, "Invalid \"# of records\" field (\"%s\") in trajectory file.", buf);
+				continue;
+			}
+
+			nrecords = (int)val;
+			if ((nrecords <= 0) || !trajectoryalloc(E, T, nrecords))
+			{
+				mlineclose(E, L);
+				return 0;
+			}
+
+			mprint(E, NULL, siminfo,
+				"[%d] records in trajectory file\n", nrecords);
+		}
+		else if (T->nlocations == nrecords)
+		{
+			merror(E, "More records than the \"# of records\" field in trajectory file.");
+			break;
+		}
+		else
+		{
+			int	i = 0;
+			char	*p;
+
+
+			for ((p = strtok(buf, " \n\t")); p; (p = strtok(NULL, " \n\t")), i++)
+			{
+				if (i >= kSunflowerTrajectoryNplanes)
+				{
+					merror(E, "Extra field in trajectory file.");
+					break;
+				}
+
+				T->planes[i][T->nlocations] = strtod(p, &ep);
+				if (*ep != '\0')
+				{
+					merror(E, "Invalid %s in trajectory file.", fieldnames[i]);
+				}
+			}
+			T->nlocations++;
+		}
+		linesread++;
+	}
+	mlineclose(E, L);
+
+	return 1;
+}
@@ -0,0 +1,84 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Trajectories loaded from file, shared by all the nodes and	*/
+/*	signal sources that name the same file. A trajectory is held	*/
+/*	as planar arrays (x, y, z, rho, theta, phi), each of		*/
+/*	nlocations doubles.						*/
+/*									*/
+/*	Besides the text format (a record count line followed by one	*/
+/*	whitespace-separated record per line), a trajectory may be	*/
+/*	stored in binary: the 8-byte magic, a 64-bit record count,	*/
+/*	then the six planes of packed host-order doubles. Binary	*/
+/*	files are mapped rather than parsed. See trajectory.c.		*/
+/*									*/
+enum
+{
+	kSunflowerTrajectoryX		= 0,
+	kSunflowerTrajectoryY,
+	kSunflowerTrajectoryZ,
+	kSunflowerTrajectoryRho,
+	kSunflowerTrajectoryTheta,
+	kSunflowerTrajectoryPhi,
+	kSunflowerTrajectoryNplanes,
+
+	kSunflowerTrajectoryMagiclen	= 8,
+	kSunflowerTrajectoryHdrsize	= kSunflowerTrajectoryMagiclen + 8,
+	kSunflowerTrajectoryMaxline	= 1024,
+};
+
+typedef struct Trajectory Trajectory;
+struct Trajectory
+{
+	char		*filename;
+	int		nlocations;
+	double		*planes[kSunflowerTrajectoryNplanes];
+
+	/*	The file mapping, when loaded from binary	*/
+	void		*map;
+	long		mapsize;
+
+	/*	Per segment i, from record i to record i+1 (the	*/
+	/*	last wraps to record 0): the change in each plane,	*/
+	/*	and whether any plane changes at all.			*/
+	double		*deltas[kSunflowerTrajectoryNplanes];
+	uchar		*moving;
+	int		stationary;
+
+	Trajectory	*next;
+};
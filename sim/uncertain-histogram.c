@@ -38,146 +38,165 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <float.h>
 #include "sf.h"
 
 
+static tuck double	histget(Histogram *hist, int k);
+static tuck void	histput(Histogram *hist, int k, double value);
+static void		histload(Histogram *hist, double *values);
+static void		histconvolve(double *a, int na, double *b, int nb, double *out);
+static void		histfft(double *re, double *im, int n, int inverse);
+
+
 /*
- *	Add two distributions, considering overflow.
+ *	Allocate the bins of a histogram register, replacing any existing
+ *	ones. Contents start out empty.
  */
-void
-Histogram_AddDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest)
+int
+Histogram_Init(Engine *E, State *S, Histogram *hist, int nbins, HistogramBinType bintype)
 {
-	uint16_t	overflow_wid = 0;
-	uint32_t	overflow_hi = 0;
+	int	binsize;
 
-	/*
-	 *	Zero-out destination histogram
-	 */
-	for (int k = 0; k < kUncertainAluHistogramBins; k++)
+
+	if (nbins < 1 || nbins > kUncertainAluHistogramMaxBins)
 	{
-		histDest->bins[k] = 0;
+		merror(E, "Histograms must have between 1 and %d bins.", kUncertainAluHistogramMaxBins);
+		return -1;
 	}
 
-	/*
-	 *	Iterate, adding with overflow
-	 */
-	for (int j = 0; j < kUncertainAluHistogramBins; j++)\
+	switch (bintype)
 	{
-		for (int i = 0; i < kUncertainAluHistogramBins; i++)
+		case kHistogramBinUint16:	binsize = sizeof(uint16_t);	break;
+		case kHistogramBinUint32:	binsize = sizeof(uint32_t);	break;
+		case kHistogramBinFloat:	binsize = sizeof(float);	break;
+		default:
 		{
-			overflow_wid = i+j;
-
-			if (overflow_wid < kUncertainAluHistogramBins)
-			{
-				overflow_hi = histDest->bins[i+j] + (uint32_t)((uint32_t)hist1->bins[i] * hist2->bins[j]);
-
-				if (overflow_hi < 65536)
-				{
-					histDest->bins[i+j] += hist1->bins[i] * hist2->bins[j];
-				}
-				else
-				{
-					/*
-					 *	Bin overflow error
-					 */
-					mprint(E, S, nodeinfo, "WARN: encountered bin overflow in histogram operation\n");
-				}
-			}
-			else
-			{
-				/*
-				 *	Value overflow error
-				 */
-				mprint(E, S, nodeinfo, "WARN: encountered value overflow in histogram operation\n");
-			}
+			merror(E, "Unknown histogram bin type.");
+			return -1;
 		}
 	}
 
-	return;
+	Histogram_Free(E, S, hist);
+
+	hist->bins.p = mcalloc(E, nbins, binsize, "Histogram bins");
+	if (hist->bins.p == NULL)
+	{
+		mexit(E, "Could not allocate memory for histogram bins", -1);
+	}
+	hist->nbins = nbins;
+	hist->bintype = bintype;
+	hist->binoverflows = 0;
+	hist->valueoverflows = 0;
+
+	return 0;
 }
 
 
-/*
- *	Multiply each bin with a scalar
- */
 void
-Histogram_ScalarMultiply(Engine *E, State *S, Histogram *hist, HistogramBinDatatype scalar)
+Histogram_Free(Engine *E, State *S, Histogram *hist)
 {
-	for (int k = 0; k < kUncertainAluHistogramBins; k++)
+	if (hist->bins.p != NULL)
 	{
-		hist->bins[k] = scalar * hist->bins[k];
+		mfree(E, hist->bins.p, "Histogram bins");
+		hist->bins.p = NULL;
 	}
+	hist->nbins = 0;
 
 	return;
 }
 
 
 /*
- *	Subtract two distributions, considering overflow
+ *	Add two distributions, i.e., convolve them. Probability mass that
+ *	lands beyond the last bin is dropped and counted as a value overflow.
  */
 void
-Histogram_SubDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest)
+Histogram_AddDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest)
 {
-	/*
-	 *	We want to reuse the code for AddDist. To do this, we transform in-place as follows:
-	 */
-
-
-	/*
-	 *	Negate one of the histograms (pick hist2)
-	 */
-	Histogram_ScalarMultiply(E, S, hist2, -1);
+	double	a[kUncertainAluHistogramMaxBins], b[kUncertainAluHistogramMaxBins];
+	double	out[2*kUncertainAluHistogramMaxBins];
+	int	k, nout;
 
-	/*
-	 *	Add together to give the result
-	 */
-	Histogram_AddDist(E, S, hist1, hist2, histDest);
 
-	/*
-	 *	Undo the change to hist2
-	 */
-	Histogram_ScalarMultiply(E, S, hist2, -1);
+	histload(hist1, a);
+	histload(hist2, b);
+	histconvolve(a, hist1->nbins, b, hist2->nbins, out);
+	nout = hist1->nbins + hist2->nbins - 1;
 
+	for (k = 0; k < histDest->nbins; k++)
+	{
+		histput(histDest, k, (k < nout) ? out[k] : 0.0);
+	}
 
-	/*
-	 *	Caveat: Is the above equivalent to the following code in all cases?
-	 *
-	 UInt uncertain_SubDist(UInt Urs1, UInt Urs2, UInt Ud){ //Subtracts distributions
+	for (k = histDest->nbins; k < nout; k++)
+	{
+		if (out[k] != 0.0)
+		{
+			histDest->valueoverflows++;
+		}
+	}
 
-		uint32_t overflow_hi = 0;
+	return;
+}
 
 
-		int k = 0;
-		int j = 0;
-		int i = 0;
+/*
+ *	Multiply each bin with a scalar
+ */
+void
+Histogram_ScalarMultiply(Engine *E, State *S, Histogram *hist, double scalar)
+{
+	for (int k = 0; k < hist->nbins; k++)
+	{
+		histput(hist, k, scalar * histget(hist, k));
+	}
 
-		// Empty Ud (just in case)
-		for(k = 0; k < 256; k++){
-			Ud.weights[i] = 0;
-		}
+	return;
+}
 
 
-		for (j = 0; j < 256; j++){
-			for(i=0; i<256; i++){
-				if(i >= j){
+/*
+ *	Subtract two distributions: histDest[i - j] accumulates
+ *	hist1[i] * hist2[j] for i >= j. This is the convolution of hist1
+ *	with hist2 reversed; pairs with i < j are value underflows and
+ *	are dropped and counted, as with overflows in Histogram_AddDist().
+ */
+void
+Histogram_SubDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest)
+{
+	double	a[kUncertainAluHistogramMaxBins], b[kUncertainAluHistogramMaxBins];
+	double	rb[kUncertainAluHistogramMaxBins];
+	double	out[2*kUncertainAluHistogramMaxBins];
+	int	k, nb, nout;
 
-					overflow_hi = Ud.weights[i - j] + (uint32_t)((uint32_t)Urs1.weights[i] * Urs2.weights[j]); //Nasty casting here
 
-					if(overflow_hi < 65536){
-						Ud.weights[i - j] += Urs1.weights[i] * Urs2.weights[j];
+	histload(hist1, a);
+	histload(hist2, b);
+	nb = hist2->nbins;
+	for (k = 0; k < nb; k++)
+	{
+		rb[k] = b[nb - 1 - k];
+	}
+	histconvolve(a, hist1->nbins, rb, nb, out);
+	nout = hist1->nbins + nb - 1;
 
-					}else{
-						//Bin overflow error
-					}
-				}else{
-					//Value underflow error
-				}
-			}
+	/*
+	 *	out[m] holds the mass for a difference of m - (nb - 1)
+	 */
+	for (k = 0; k < nb - 1; k++)
+	{
+		if (out[k] != 0.0)
+		{
+			histDest->valueoverflows++;
 		}
+	}
 
-			return Ud;
-		}
-	*/
+	for (k = 0; k < histDest->nbins; k++)
+	{
+		histput(histDest, k, (k + nb - 1 < nout) ? out[k + nb - 1] : 0.0);
+	}
 
 	return;
 }
@@ -189,9 +208,9 @@ Histogram_SubDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histo
 void
 Histogram_CombDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Histogram *histDest)
 {
-	for (int k = 0; k < kUncertainAluHistogramBins; k++)
+	for (int k = 0; k < histDest->nbins; k++)
 	{
-		histDest->bins[k] = hist1->bins[k] * hist2->bins[k];
+		histput(histDest, k, histget(hist1, k) * histget(hist2, k));
 	}
 
 	return;
@@ -206,9 +225,9 @@ Histogram_CombDist(Engine *E, State *S, Histogram *hist1, Histogram *hist2, Hist
 int
 Histogram_LowerBound(Engine *E, State *S, Histogram *hist)
 {
-	for (int k = 0; k < kUncertainAluHistogramBins; k++)
+	for (int k = 0; k < hist->nbins; k++)
 	{
-		if (hist->bins[k] != 0)
+		if (histget(hist, k) != 0.0)
 		{
 			return k;
 		}
@@ -226,9 +245,9 @@ Histogram_LowerBound(Engine *E, State *S, Histogram *hist)
 int
 Histogram_UpperBound(Engine *E, State *S, Histogram *hist)
 {
-	for (int k = kUncertainAluHistogramBins-1; k >= 0; k--)
+	for (int k = hist->nbins-1; k >= 0; k--)
 	{
-		if (hist->bins[k] != 0)
+		if (histget(hist, k) != 0.0)
 		{
 			return k;
 		}
@@ -245,19 +264,22 @@ Histogram_UpperBound(Engine *E, State *S, Histogram *hist)
 void
 Histogram_DistLShift(Engine *E, State *S, Histogram *hist1, uint8_t Rs2, Histogram *histDest)
 {
-	int	k = 0;
-	int	i = 0;
+	double	a[kUncertainAluHistogramMaxBins];
+	int	i;
 
-	for(k = 0; k < 256; k++)
+
+	histload(hist1, a);
+
+	for (i = 0; i < histDest->nbins; i++)
 	{
-		histDest->bins[k] = 0;
+		histput(histDest, i, (i + Rs2 < hist1->nbins) ? a[i + Rs2] : 0.0);
 	}
 
-	for(i = 0; i < 256; i++)
+	for (i = 0; i < Rs2 && i < hist1->nbins; i++)
 	{
-		if(i >= Rs2)
+		if (a[i] != 0.0)
 		{
-			histDest->bins[i-Rs2] = hist1->bins[i];
+			histDest->valueoverflows++;
 		}
 	}
 
@@ -272,21 +294,22 @@ Histogram_DistLShift(Engine *E, State *S, Histogram *hist1, uint8_t Rs2, Histogr
 void
 Histogram_DistRShift(Engine *E, State *S, Histogram *hist1, uint8_t Rs2, Histogram *histDest)
 {
-	int		k = 0;
-	int		i = 0;
-	uint16_t	overflow_wid = 0;
+	double	a[kUncertainAluHistogramMaxBins];
+	int	i;
+
 
-	for(k = 0; k < 256; k++)
+	histload(hist1, a);
+
+	for (i = 0; i < histDest->nbins; i++)
 	{
-		histDest->bins[k] = 0;
+		histput(histDest, i, (i >= Rs2 && i - Rs2 < hist1->nbins) ? a[i - Rs2] : 0.0);
 	}
 
-	for(i = 0; i < 256; i++)
+	for (i = max(histDest->nbins - Rs2, 0); i < hist1->nbins; i++)
 	{
-		overflow_wid = (int16_t) (i + Rs2);
-		if(overflow_wid < 256)
+		if (a[i] != 0.0)
 		{
-			histDest->bins[i+Rs2] = hist1->bins[i];
+			histDest->valueoverflows++;
 		}
 	}
 
@@ -301,22 +324,21 @@ Histogram_DistRShift(Engine *E, State *S, Histogram *hist1, uint8_t Rs2, Histogr
 uint8_t
 Histogram_ExpectedValue(Engine *E, State *S, Histogram *hist)
 {
-	int	sum = 0;
-	int	n = 0;
-	int	mean = 0;
-	int	i = 0;
-	uint8_t	Rd = 0;
+	double	sum = 0.0;
+	double	n = 0.0;
 
-	for(i = 0; i<256; i++)
+	for (int i = 0; i < hist->nbins; i++)
 	{
-			sum += ((int)hist->bins[i] * i);
-			n += (int)hist->bins[i];
+		sum += histget(hist, i) * i;
+		n += histget(hist, i);
 	}
 
-	mean = sum / n;
-	Rd = (uint8_t) mean;
+	if (n == 0.0)
+	{
+		return 0;
+	}
 
-	return Rd;
+	return (uint8_t)(sum / n);
 }
 
 
@@ -330,37 +352,33 @@ Histogram_ExpectedValue(Engine *E, State *S, Histogram *hist)
 uint32_t
 Histogram_DistLess(Engine *E, State *S, Histogram *hist, uint32_t Rs2)
 {
-	int		i = 0;
-	int		num = 0;
-	int		denom = 0;
-	uint32_t	outcome = 0;
-	uint32_t	Rd = 0;
+	double	num = 0.0;
+	double	denom = 0.0;
 
-	for(i = 0; i < 256; i++)
+	for (int i = 0; i < hist->nbins; i++)
 	{
-			if(i < Rs2)
-			{
-					num = num + hist->bins[i]; //If it is less then
-			}
-			denom = denom + hist->bins[i];
+		if (i < Rs2)
+		{
+			num += histget(hist, i);
+		}
+		denom += histget(hist, i);
 	}
 
-	if(denom!=0)
+	if (denom == 0.0)
 	{
-			outcome = (num * 100) / denom; //Note this is integer division. Note that the times by 100 is to make it a percent rather than decimal which cannot be stored easily
-			Rd = outcome;
-			return Rd;
-	}
-	else
-	{
-			Rd = -1;
-			return Rd;
+		return -1;
 	}
+
+	/*
+	 *	Times 100 to give a percentage, truncated, which can be
+	 *	stored in an integer register.
+	 */
+	return (uint32_t)((num * 100) / denom);
 }
 
 
 /*
- *	DistLess returns the probability Pr(X >= Rs2). 
+ *	DistGrt returns the probability Pr(X >= Rs2). 
  *	X is a discrete random variable distributed according to the relative frequencies of hist1. 
  *	The probability is returned as an unsigned integer between 0 and 100 representing a percentage. 
  *	It is expected that this instruction will often be followed by one of the branch instructions 
@@ -369,49 +387,37 @@ Histogram_DistLess(Engine *E, State *S, Histogram *hist, uint32_t Rs2)
 uint32_t
 Histogram_DistGrt(Engine *E, State *S, Histogram *hist, uint32_t Rs2)
 {
-	int		i = 0;
-	int		num = 0;
-	int		denom = 0;
-	uint32_t	outcome = 0;
-	uint32_t	Rd = 0;
+	double	num = 0.0;
+	double	denom = 0.0;
 
-	for(i = 0; i < 256; i++)
+	for (int i = 0; i < hist->nbins; i++)
 	{
-			if(i >= Rs2)
-			{
-					num = num + hist->bins[i]; //If it is less then
-			}
-			denom = denom + hist->bins[i];
+		if (i >= Rs2)
+		{
+			num += histget(hist, i);
+		}
+		denom += histget(hist, i);
 	}
 
-	if(denom!=0)
+	if (denom == 0.0)
 	{
-			/*
-			 *	Note this is integer division. Note that the times by 100 is
-			 *	to make it a percent rather than decimal which cannot be stored
-			 *	easily.
-			 */
-			outcome = (num * 100) / denom;
-			Rd = outcome;
-
-			return Rd;
+		return -1;
 	}
-	else
-	{
-			Rd = -1;
 
-			return Rd;
-	}
+	return (uint32_t)((num * 100) / denom);
 }
 
 
 /*
- *	Load a kUncertainAluHistogramBins-sized array of HistogramBinDatatype into the Histogram class
+ *	Load hist->nbins values into the Histogram class
  */
 void
-Histogram_LDDist(Engine *E, State *S, Histogram *histogram, HistogramBinDatatype *bins)
+Histogram_LDDist(Engine *E, State *S, Histogram *histogram, double *bins)
 {
-	memcpy(histogram->bins, bins, sizeof(HistogramBinDatatype)*kUncertainAluHistogramBins);
+	for (int i = 0; i < histogram->nbins; i++)
+	{
+		histput(histogram, i, bins[i]);
+	}
 
 	return;
 }
@@ -423,23 +429,16 @@ Histogram_LDDist(Engine *E, State *S, Histogram *histogram, HistogramBinDatatype
 void
 Histogram_LDRandom(Engine *E, State *S, Histogram *histogram)
 {
-	/*
-	 *	Create array
-	 */
-	HistogramBinDatatype array[kUncertainAluHistogramBins] = {};
-	for (int i = 0; i < kUncertainAluHistogramBins; i++)
+	double	array[kUncertainAluHistogramMaxBins];
+
+	for (int i = 0; i < histogram->nbins; i++)
 	{
-		array[i] = (rand()/(double)RAND_MAX) * 255;
 		/*
-		 *  Picked some reasonable max value allowing by-eye debugging, increase to data type maximum later:
-		 *	array[i] = (rand()/(double)RAND_MAX) * ((HistogramBinDatatype)~(HistogramBinDatatype)0);
-		 *	The final expression finds the maximum value this datatype can take
+		 *	Picked some reasonable max value allowing by-eye debugging
 		 */
+		array[i] = (double)(int)((rand()/(double)RAND_MAX) * 255);
 	}
 
-	/*
-	 *	Load into histogram
-	 */
 	Histogram_LDDist(E, S, histogram, array);
 
 	return;
@@ -454,11 +453,11 @@ Histogram_MeanFrequency(Engine *E, State *S, Histogram *histogram)
 {
 	double sum = 0;
 
-	for (int i = 0; i < kUncertainAluHistogramBins; i++){
-		sum += histogram->bins[i];
+	for (int i = 0; i < histogram->nbins; i++){
+		sum += histget(histogram, i);
 	}
 
-	return sum / (double)kUncertainAluHistogramBins;
+	return sum / (double)histogram->nbins;
 }
 
 
@@ -479,34 +478,25 @@ Histogram_MeanFrequency(Engine *E, State *S, Histogram *histogram)
 void
 Histogram_PrettyPrint(Engine *E, State *S, Histogram *histogram)
 {
-	double	normalised[kUncertainAluHistogramBins] = {};
 	double	meanFreq = Histogram_MeanFrequency(E, S, histogram);
 
-	/*HistogramBinDatatype FULLSCALE = (HistogramBinDatatype)~(HistogramBinDatatype)0;*/
-	// This expression finds the maximum value this datatype can take
-	
 	/*
-	 *	Alternatively, auto-scaling could be done by the following:
+	 *	Auto-scale relative to the mean bin occupation
 	 */
 	double FULLSCALE = 3 * meanFreq;
 
 	const int FULLSCALE_NUMBER_OF_CHARS = 40;
 
-	for (int i = 0; i < kUncertainAluHistogramBins; i++)
-	{
-		normalised[i] = histogram->bins[i] / FULLSCALE;
-	}
-
 	mprint(E, S, nodeinfo, "Histogram mean frequency (mean bin occupation): %.3f\n", meanFreq);
-	mprint(E, S, nodeinfo, "bin | value | graphical representation (scaled rel. to mean freq)\n");
-	mprint(E, S, nodeinfo, "----+-------+----------------------------------------------------\n");
+	mprint(E, S, nodeinfo, "bin | value      | graphical representation (scaled rel. to mean freq)\n");
+	mprint(E, S, nodeinfo, "----+------------+----------------------------------------------------\n");
 
-	for (int i = 0; i < kUncertainAluHistogramBins; i++)
+	for (int i = 0; i < histogram->nbins; i++)
 	{
-		mprint(E, S, nodeinfo, "%03u | %-5u | ", i, histogram->bins[i]);
-		/*mprint(E, S, nodeinfo, "%f\n", (normalised[i]));*/
-		/*mprint(E, S, nodeinfo, "%f\n", (normalised[i]*FULLSCALE_NUMBER_OF_CHARS));*/
-		for (int j = 0; j < (int)(normalised[i]*FULLSCALE_NUMBER_OF_CHARS); j++){
+		double	normalised = (FULLSCALE == 0.0) ? 0.0 : histget(histogram, i) / FULLSCALE;
+
+		mprint(E, S, nodeinfo, "%03u | %-10.4g | ", i, histget(histogram, i));
+		for (int j = 0; j < (int)(normalised*FULLSCALE_NUMBER_OF_CHARS); j++){
 			mprint(E, S, nodeinfo, "#");
 		}
 		mprint(E, S, nodeinfo, "\n");
@@ -514,3 +504,250 @@ Histogram_PrettyPrint(Engine *E, State *S, Histogram *histogram)
 
 	return;
 }
+
+
+static tuck double
+histget(Histogram *hist, int k)
+{
+	switch (hist->bintype)
+	{
+		case kHistogramBinUint16:	return hist->bins.u16[k];
+		case kHistogramBinUint32:	return hist->bins.u32[k];
+		default:			return hist->bins.f[k];
+	}
+}
+
+
+/*
+ *	Store a bin, rounding to the bin type. Values that do not fit
+ *	saturate and are counted rather than reported one by one, since
+ *	a single convolution can overflow many bins.
+ */
+static tuck void
+histput(Histogram *hist, int k, double value)
+{
+	double	limit;
+
+
+	if (hist->bintype == kHistogramBinFloat)
+	{
+		if (fabs(value) > FLT_MAX)
+		{
+			value = (value > 0) ? FLT_MAX : -FLT_MAX;
+			hist->binoverflows++;
+		}
+		hist->bins.f[k] = value;
+
+		return;
+	}
+
+	limit = (hist->bintype == kHistogramBinUint16) ? 65535.0 : 4294967295.0;
+	value = floor(value + 0.5);
+	if (value < 0.0)
+	{
+		value = 0.0;
+		hist->binoverflows++;
+	}
+	else if (value > limit)
+	{
+		value = limit;
+		hist->binoverflows++;
+	}
+
+	if (hist->bintype == kHistogramBinUint16)
+	{
+		hist->bins.u16[k] = (uint16_t)value;
+	}
+	else
+	{
+		hist->bins.u32[k] = (uint32_t)value;
+	}
+
+	return;
+}
+
+
+static void
+histload(Histogram *hist, double *values)
+{
+	int	k;
+
+
+	switch (hist->bintype)
+	{
+		case kHistogramBinUint16:
+		{
+			for (k = 0; k < hist->nbins; k++)
+			{
+				values[k] = hist->bins.u16[k];
+			}
+			break;
+		}
+
+		case kHistogramBinUint32:
+		{
+			for (k = 0; k < hist->nbins; k++)
+			{
+				values[k] = hist->bins.u32[k];
+			}
+			break;
+		}
+
+		default:
+		{
+			for (k = 0; k < hist->nbins; k++)
+			{
+				values[k] = hist->bins.f[k];
+			}
+			break;
+		}
+	}
+
+	return;
+}
+
+
+/*
+ *	Full linear convolution of a and b into out[0 .. na+nb-2]. Small
+ *	histograms use the direct sum, written so that the inner loop is
+ *	a unit-stride multiply-add the compiler can vectorize. From
+ *	kUncertainAluHistogramFFTBins bins on, the O(B log B) FFT product
+ *	is cheaper than the O(B^2) sum.
+ */
+static void
+histconvolve(double *a, int na, double *b, int nb, double *out)
+{
+	double	are[2*kUncertainAluHistogramMaxBins], aim[2*kUncertainAluHistogramMaxBins];
+	double	bre[2*kUncertainAluHistogramMaxBins], bim[2*kUncertainAluHistogramMaxBins];
+	double	re, peak;
+	int	i, j, n, nout = na + nb - 1;
+
+
+	if (max(na, nb) < kUncertainAluHistogramFFTBins)
+	{
+		for (i = 0; i < nout; i++)
+		{
+			out[i] = 0.0;
+		}
+
+		for (j = 0; j < nb; j++)
+		{
+			double		bj = b[j];
+			double		*o = &out[j];
+
+			if (bj == 0.0)
+			{
+				continue;
+			}
+
+			for (i = 0; i < na; i++)
+			{
+				o[i] += a[i] * bj;
+			}
+		}
+
+		return;
+	}
+
+	for (n = 1; n < nout; n <<= 1)
+	{
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		are[i] = (i < na) ? a[i] : 0.0;
+		bre[i] = (i < nb) ? b[i] : 0.0;
+		aim[i] = bim[i] = 0.0;
+	}
+
+	histfft(are, aim, n, 0);
+	histfft(bre, bim, n, 0);
+	for (i = 0; i < n; i++)
+	{
+		re = are[i]*bre[i] - aim[i]*bim[i];
+		aim[i] = are[i]*bim[i] + aim[i]*bre[i];
+		are[i] = re;
+	}
+	histfft(are, aim, n, 1);
+
+	/*
+	 *	Round-off leaves small non-zero values where the exact
+	 *	result is zero; clear them so they are not mistaken for
+	 *	probability mass, e.g., when counting value overflows.
+	 */
+	peak = 0.0;
+	for (i = 0; i < nout; i++)
+	{
+		out[i] = are[i] / n;
+		peak = max(peak, fabs(out[i]));
+	}
+	for (i = 0; i < nout; i++)
+	{
+		if (fabs(out[i]) <= peak * 1E-12)
+		{
+			out[i] = 0.0;
+		}
+	}
+
+	return;
+}
+
+
+/*
+ *	In-place iterative radix-2 FFT; n must be a power of two. The
+ *	inverse is not scaled by 1/n.
+ */
+static void
+histfft(double *re, double *im, int n, int inverse)
+{
+	int	i, j, k, len;
+	double	t, ang, wre, wim, cre, cim, ure, uim, vre, vim;
+
+
+	for (i = 1, j = 0; i < n; i++)
+	{
+		int	bit = n >> 1;
+
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+
+		if (i < j)
+		{
+			t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1)
+	{
+		ang = 2 * M_PI / len * (inverse ? 1 : -1);
+		wre = cos(ang);
+		wim = sin(ang);
+
+		for (i = 0; i < n; i += len)
+		{
+			cre = 1.0;
+			cim = 0.0;
+			for (k = 0; k < len/2; k++)
+			{
+				ure = re[i+k];
+				uim = im[i+k];
+				vre = re[i+k+len/2]*cre - im[i+k+len/2]*cim;
+				vim = re[i+k+len/2]*cim + im[i+k+len/2]*cre;
+				re[i+k] = ure + vre;
+				im[i+k] = uim + vim;
+				re[i+k+len/2] = ure - vre;
+				im[i+k+len/2] = uim - vim;
+
+				t = cre*wre - cim*wim;
+				cim = cre*wim + cim*wre;
+				cre = t;
+			}
+		}
+	}
+
+	return;
+}
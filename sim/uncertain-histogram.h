@@ -37,15 +37,48 @@
 */
 
 
-typedef uint16_t	HistogramBinDatatype;
+/*
+ *	The number of bins and the type of the bins are set per node
+ *	(SETHISTFORMAT). Arithmetic is carried out in double precision and
+ *	the result stored back to the bin type, saturating and counting
+ *	bins that do not fit.
+ */
+typedef enum
+{
+	kHistogramBinUint16,
+	kHistogramBinUint32,
+	kHistogramBinFloat,
+} HistogramBinType;
 
 enum
 {
-
 	kUncertainAluHistogramBins	= 8,
+	kUncertainAluHistogramMaxBins	= 256,
+
+	/*
+	 *	Convolutions of histograms with at least this many bins
+	 *	are done by FFT rather than directly.
+	 */
+	kUncertainAluHistogramFFTBins	= 64,
 };
 
 typedef struct
 {
-	HistogramBinDatatype	bins[kUncertainAluHistogramBins];
+	int			nbins;
+	HistogramBinType	bintype;
+	union
+	{
+		uint16_t	*u16;
+		uint32_t	*u32;
+		float		*f;
+		void		*p;
+	} bins;
+
+	/*
+	 *	Results that did not fit: bin values beyond the range of
+	 *	the bin type, and probability mass beyond the last bin
+	 *	(or below the first bin, for subtraction).
+	 */
+	uvlong			binoverflows;
+	uvlong			valueoverflows;
 } Histogram;
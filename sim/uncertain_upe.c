@@ -42,6 +42,7 @@
 #include <math.h>
 #include <string.h>
 #include "sf.h"
+#include "mextern.h"
 
 enum
 {
@@ -0,0 +1,507 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "syscalls.h"
+#include "mextern.h"
+
+static Vfsfile *	vfslookup(Engine *E, char *path);
+static Vfsfile *	vfsload(Engine *E, char *path, int create);
+static int		vfsprivate(Engine *E, Vfsfile *F, ulong need);
+static Vfsfd *		vfsgetfd(State *S, int fd);
+static int		vfsinmem(State *S, ulong addr, ulong len);
+
+
+/*									*/
+/*	Open path for node S with newlib open() flags, returning the	*/
+/*	lowest free descriptor in the node's table, or -1.		*/
+/*									*/
+int
+mvfsopen(Engine *E, State *S, char *path, int flags)
+{
+	Vfsfile	*F;
+	int	fd;
+
+
+	for (fd = kSunflowerVfsFirstfd; fd < kSunflowerVfsMaxfds; fd++)
+	{
+		if (S->vfsfds[fd].file == NULL)
+		{
+			break;
+		}
+	}
+	if (fd == kSunflowerVfsMaxfds)
+	{
+		mprint(E, S, nodeinfo,
+			"Node %d has all %d guest file descriptors open.\n",
+			S->NODE_ID, kSunflowerVfsMaxfds);
+		return -1;
+	}
+
+	/*								*/
+	/*	O_EXCL fails on a file another node already opened as	*/
+	/*	well as on one that exists only on the host so far.	*/
+	/*								*/
+	F = vfslookup(E, path);
+	if ((flags & NEWLIB_O_CREAT) && (flags & NEWLIB_O_EXCL)
+		&& ((F != NULL) || mfexists(path)))
+	{
+		return -1;
+	}
+	if (F == NULL)
+	{
+		F = vfsload(E, path, flags & NEWLIB_O_CREAT);
+		if (F == NULL)
+		{
+			return -1;
+		}
+	}
+
+	if ((flags & NEWLIB_O_TRUNC) && ((flags & NEWLIB_O_ACCMODE) != NEWLIB_O_RDONLY))
+	{
+		/*							*/
+		/*	Leave any host mapping in place: other nodes	*/
+		/*	only hold F, never F->data, so nothing refers	*/
+		/*	to it once F has its own buffer.		*/
+		/*							*/
+		if (F->mapped)
+		{
+			F->data = NULL;
+			F->capacity = 0;
+			F->mapped = 0;
+		}
+		F->size = 0;
+		F->dirty = 1;
+	}
+
+	S->vfsfds[fd].file = F;
+	S->vfsfds[fd].offset = 0;
+	S->vfsfds[fd].flags = flags;
+
+	return fd;
+}
+
+int
+mvfsclose(Engine *E, State *S, int fd)
+{
+	Vfsfd	*D;
+
+
+	D = vfsgetfd(S, fd);
+	if (D == NULL)
+	{
+		return -1;
+	}
+	D->file = NULL;
+
+	return 0;
+}
+
+/*									*/
+/*	Read straight from the file's data (usually the shared host	*/
+/*	mapping) into the node's memory.				*/
+/*									*/
+long
+mvfsread(Engine *E, State *S, int fd, ulong addr, long len)
+{
+	Vfsfd	*D;
+	long	n;
+
+
+	D = vfsgetfd(S, fd);
+	if ((D == NULL) || (len < 0) || ((D->flags & NEWLIB_O_ACCMODE) == NEWLIB_O_WRONLY))
+	{
+		return -1;
+	}
+	if (!vfsinmem(S, addr, len))
+	{
+		return -1;
+	}
+
+	if (D->offset >= D->file->size)
+	{
+		return 0;
+	}
+	n = min(len, D->file->size - D->offset);
+	memmove(&S->MEM[addr - S->MEMBASE], &D->file->data[D->offset], n);
+	D->offset += n;
+
+	return n;
+}
+
+long
+mvfswrite(Engine *E, State *S, int fd, ulong addr, long len)
+{
+	Vfsfd	*D;
+	Vfsfile	*F;
+	ulong	end;
+
+
+	D = vfsgetfd(S, fd);
+	if ((D == NULL) || (len < 0) || ((D->flags & NEWLIB_O_ACCMODE) == NEWLIB_O_RDONLY))
+	{
+		return -1;
+	}
+	if (!vfsinmem(S, addr, len))
+	{
+		return -1;
+	}
+
+	F = D->file;
+	if (D->flags & NEWLIB_O_APPEND)
+	{
+		D->offset = F->size;
+	}
+
+	end = D->offset + len;
+	if (!vfsprivate(E, F, end))
+	{
+		return -1;
+	}
+
+	/*	A write past the end leaves a hole of zeros	*/
+	if (D->offset > F->size)
+	{
+		memset(&F->data[F->size], 0, D->offset - F->size);
+	}
+	memmove(&F->data[D->offset], &S->MEM[addr - S->MEMBASE], len);
+	D->offset = end;
+	F->size = max(F->size, end);
+	F->dirty = 1;
+
+	return len;
+}
+
+long
+mvfslseek(Engine *E, State *S, int fd, long offset, int whence)
+{
+	Vfsfd	*D;
+	long	base;
+
+
+	D = vfsgetfd(S, fd);
+	if (D == NULL)
+	{
+		return -1;
+	}
+
+	switch (whence)
+	{
+		case SEEK_SET:
+		{
+			base = 0;
+			break;
+		}
+
+		case SEEK_CUR:
+		{
+			base = D->offset;
+			break;
+		}
+
+		case SEEK_END:
+		{
+			base = D->file->size;
+			break;
+		}
+
+		default:
+		{
+			return -1;
+		}
+	}
+
+	if (base + offset < 0)
+	{
+		return -1;
+	}
+	D->offset = base + offset;
+
+	return D->offset;
+}
+
+/*									*/
+/*	Size of the file open on fd, or of the file at path if any	*/
+/*	node has opened it. These return -1 for files the VFS does	*/
+/*	not know, so the caller can fall back to the host.		*/
+/*									*/
+int
+mvfsfsize(Engine *E, State *S, int fd, ulong *size)
+{
+	Vfsfd	*D;
+
+
+	D = vfsgetfd(S, fd);
+	if (D == NULL)
+	{
+		return -1;
+	}
+	*size = D->file->size;
+
+	return 0;
+}
+
+int
+mvfssize(Engine *E, char *path, ulong *size)
+{
+	Vfsfile	*F;
+
+
+	F = vfslookup(E, path);
+	if (F == NULL)
+	{
+		return -1;
+	}
+	*size = F->size;
+
+	return 0;
+}
+
+/*									*/
+/*	Close all of a node's descriptors, e.g., before it is given a	*/
+/*	new program to RUN.						*/
+/*									*/
+void
+mvfsresetnode(Engine *E, State *S)
+{
+	int	fd;
+
+
+	for (fd = 0; fd < kSunflowerVfsMaxfds; fd++)
+	{
+		S->vfsfds[fd].file = NULL;
+	}
+}
+
+/*									*/
+/*	Write every file a guest has modified back to the host.		*/
+/*									*/
+void
+mvfsflush(Engine *E)
+{
+	Vfsfile	*F;
+	int	fd;
+
+
+	for (F = E->vfsfiles; F != NULL; F = F->next)
+	{
+		if (!F->dirty)
+		{
+			continue;
+		}
+
+		fd = mcreate(F->path, M_OWRITE|M_OTRUNCATE);
+		if (fd < 0)
+		{
+			merror(E, "Could not create \"%s\" for guest file contents.", F->path);
+			continue;
+		}
+		if ((F->size > 0) && (mwrite(fd, (char *)F->data, F->size) != F->size))
+		{
+			merror(E, "Could not write guest file contents to \"%s\".", F->path);
+		}
+		mclose(fd);
+		F->dirty = 0;
+
+		mprint(E, NULL, siminfo,
+			"Wrote guest file \"%s\" (" ULONGFMT " bytes)\n", F->path, F->size);
+	}
+}
+
+static Vfsfile *
+vfslookup(Engine *E, char *path)
+{
+	Vfsfile	*F;
+
+
+	for (F = E->vfsfiles; F != NULL; F = F->next)
+	{
+		if (!strcmp(F->path, path))
+		{
+			return F;
+		}
+	}
+
+	return NULL;
+}
+
+/*									*/
+/*	Add path to the engine's files, mapping the host file if it	*/
+/*	exists. A missing file is only created (empty, in memory) if	*/
+/*	create is set.							*/
+/*									*/
+static Vfsfile *
+vfsload(Engine *E, char *path, int create)
+{
+	Vfsfile	*F;
+	long	size = 0;
+	int	fd;
+
+
+	fd = mopen(path, M_OREAD);
+	if ((fd < 0) && !create)
+	{
+		return NULL;
+	}
+	if (fd >= 0)
+	{
+		size = mfsize(fd);
+		if (size < 0)
+		{
+			mclose(fd);
+			return NULL;
+		}
+	}
+
+	F = (Vfsfile *)mcalloc(E, 1, sizeof(Vfsfile), "Vfsfile *F in vfs.c");
+	if (F == NULL)
+	{
+		mclose(fd);
+		merror(E, "Could not allocate memory for Vfsfile *F.");
+		return NULL;
+	}
+	F->path = (char *)mcalloc(E, strlen(path)+1, sizeof(char), "F->path in vfs.c");
+	if (F->path == NULL)
+	{
+		mclose(fd);
+		mfree(E, F, "Vfsfile *F in vfs.c");
+		merror(E, "Could not allocate memory for F->path.");
+		return NULL;
+	}
+	strcpy(F->path, path);
+
+	if (size > 0)
+	{
+		F->data = (uchar *)mmapfile(fd, size);
+		if (F->data != NULL)
+		{
+			F->mapped = 1;
+			F->size = size;
+		}
+		else if (vfsprivate(E, F, size) && (mread(fd, (char *)F->data, size) == size))
+		{
+			F->size = size;
+		}
+		else
+		{
+			mclose(fd);
+			if (F->data != NULL)
+			{
+				mfree(E, F->data, "F->data in vfs.c");
+			}
+			mfree(E, F->path, "F->path in vfs.c");
+			mfree(E, F, "Vfsfile *F in vfs.c");
+			return NULL;
+		}
+	}
+	if (fd >= 0)
+	{
+		mclose(fd);
+	}
+
+	/*	A file created by a guest exists even if never written	*/
+	F->dirty = (fd < 0);
+
+	F->next = E->vfsfiles;
+	E->vfsfiles = F;
+
+	return F;
+}
+
+/*									*/
+/*	Make F's data a private buffer of at least need bytes, copying	*/
+/*	it out of the host mapping on the first write.			*/
+/*									*/
+static int
+vfsprivate(Engine *E, Vfsfile *F, ulong need)
+{
+	uchar	*tmp;
+	ulong	capacity;
+
+
+	if (!F->mapped && (need <= F->capacity))
+	{
+		return 1;
+	}
+
+	capacity = max(F->capacity, kSunflowerVfsMinalloc);
+	while (capacity < need)
+	{
+		capacity *= 2;
+	}
+
+	tmp = (uchar *)mcalloc(E, capacity, sizeof(uchar), "F->data in vfs.c");
+	if (tmp == NULL)
+	{
+		merror(E, "Could not grow guest file \"%s\" to " ULONGFMT " bytes.", F->path, capacity);
+		return 0;
+	}
+	if (F->data != NULL)
+	{
+		memmove(tmp, F->data, F->size);
+		if (!F->mapped)
+		{
+			mfree(E, F->data, "F->data in vfs.c");
+		}
+	}
+
+	F->data = tmp;
+	F->capacity = capacity;
+	F->mapped = 0;
+
+	return 1;
+}
+
+static Vfsfd *
+vfsgetfd(State *S, int fd)
+{
+	if ((fd < kSunflowerVfsFirstfd) || (fd >= kSunflowerVfsMaxfds) || (S->vfsfds[fd].file == NULL))
+	{
+		return NULL;
+	}
+
+	return &S->vfsfds[fd];
+}
+
+static int
+vfsinmem(State *S, ulong addr, ulong len)
+{
+	return (addr >= S->MEMBASE) && (addr <= S->MEMEND) && (len <= S->MEMEND - addr);
+}
@@ -0,0 +1,81 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	In-memory file system behind the guest file syscalls. Files	*/
+/*	are shared by all nodes of an engine and looked up by path:	*/
+/*	an input file is mapped read-only from the host once, however	*/
+/*	many nodes open it, and is copied into a private buffer only	*/
+/*	when a guest writes to it. Files written by guests are kept	*/
+/*	in memory and written back to the host by mvfsflush() at exit.	*/
+/*									*/
+/*	Each node has its own table of open descriptors, so guests	*/
+/*	never see each other's (or the simulator's) host descriptors.	*/
+/*	Descriptors 0, 1 and 2 are not in the table and keep their	*/
+/*	existing meaning. See vfs.c.					*/
+/*									*/
+enum
+{
+	kSunflowerVfsFirstfd		= 3,
+	kSunflowerVfsMaxfds		= 64,
+	kSunflowerVfsMinalloc		= 4096,
+};
+
+typedef struct Vfsfile Vfsfile;
+struct Vfsfile
+{
+	char		*path;
+
+	/*							*/
+	/*	While mapped is set, data is the shared host	*/
+	/*	mapping and must not be written to.		*/
+	/*							*/
+	uchar		*data;
+	ulong		size;
+	ulong		capacity;
+	int		mapped;
+	int		dirty;
+
+	Vfsfile		*next;
+};
+
+typedef struct
+{
+	Vfsfile		*file;
+	ulong		offset;
+	int		flags;
+} Vfsfd;
@@ -0,0 +1,433 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sf.h"
+#include "mextern.h"
+
+static char	vtracemagic[kSunflowerVtraceMagiclen] = {'S', 'F', 'V', 'T', 'R', 'C', '0', '1'};
+
+static void *	vtracewriter(void *arg);
+static void	vtracesubmit(Vtrace *V);
+static tuck uchar *	vtracereserve(Vtrace *V);
+static tuck int	vtracevarint(uchar *p, uvlong v);
+static void	vtracedefine(Vtrace *V, int *id, SunflowerVtraceKind kind, ulong pcstart, ulong where, int size, int ispointer, char *name);
+static tuck void	vtracevalue(State *S, Vtrace *V, int id, ulong *last, ulong value);
+
+
+/*									*/
+/*	Open a value trace file for node S. From here on, values seen	*/
+/*	by its NUMA and register tracers go to the file instead of to	*/
+/*	the tracers' value arrays.					*/
+/*									*/
+void
+mvtraceopen(Engine *E, State *S, char *filename)
+{
+	Vtrace	*V;
+	int	i;
+
+
+	if (S->vtrace != NULL)
+	{
+		merror(E, "Node %d already has value trace file \"%s\" open.", S->NODE_ID, S->vtrace->filename);
+		return;
+	}
+
+	V = (Vtrace *)mcalloc(E, 1, sizeof(Vtrace), "Vtrace *V in vtrace.c");
+	if (V == NULL)
+	{
+		merror(E, "Could not allocate memory for Vtrace *V.");
+		return;
+	}
+
+	V->filename = (char *)mcalloc(E, strlen(filename)+1, sizeof(char), "V->filename in vtrace.c");
+	if (V->filename == NULL)
+	{
+		merror(E, "Could not allocate memory for V->filename.");
+		mfree(E, V, "Vtrace *V in vtrace.c");
+		return;
+	}
+	strcpy(V->filename, filename);
+
+	for (i = 0; i < kSunflowerVtraceNchunks; i++)
+	{
+		V->chunks[i] = (uchar *)mcalloc(E, kSunflowerVtraceChunksize, sizeof(uchar), "V->chunks in vtrace.c");
+		if (V->chunks[i] == NULL)
+		{
+			mexit(E, "Could not allocate memory for value trace chunks.", -1);
+		}
+	}
+
+	V->fd = mcreate(filename, M_OWRITE|M_OTRUNCATE);
+	if ((V->fd < 0) || (mwrite(V->fd, vtracemagic, sizeof(vtracemagic)) != sizeof(vtracemagic)))
+	{
+		merror(E, "Could not create value trace file \"%s\".", filename);
+		for (i = 0; i < kSunflowerVtraceNchunks; i++)
+		{
+			mfree(E, V->chunks[i], "V->chunks in vtrace.c");
+		}
+		mfree(E, V->filename, "V->filename in vtrace.c");
+		mfree(E, V, "Vtrace *V in vtrace.c");
+
+		return;
+	}
+	V->lastclk = S->ICLK;
+
+	pthread_mutex_init(&V->lock, NULL);
+	pthread_cond_init(&V->ready, NULL);
+	pthread_cond_init(&V->space, NULL);
+	if (pthread_create(&V->writer, NULL, vtracewriter, V))
+	{
+		mexit(E, "Could not create value trace writer thread.", -1);
+	}
+
+	/*	Tracers are defined again in the new file	*/
+	for (i = 0; i < S->N->count; i++)
+	{
+		S->N->regions[i]->vtraceid = 0;
+	}
+	for (i = 0; i < S->Nstack->count; i++)
+	{
+		S->Nstack->regions[i]->vtraceid = 0;
+	}
+	for (i = 0; i < S->RT->count; i++)
+	{
+		S->RT->regvts[i]->vtraceid = 0;
+	}
+
+	S->vtrace = V;
+	mprint(E, NULL, siminfo, "Node %d value traces go to \"%s\"\n", S->NODE_ID, filename);
+
+	return;
+}
+
+void
+mvtraceclose(Engine *E, State *S)
+{
+	Vtrace	*V = S->vtrace;
+	int	i;
+
+
+	if (V == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&V->lock);
+	if (V->chunklen[V->head] > 0)
+	{
+		V->nfull++;
+	}
+	V->done = 1;
+	pthread_cond_signal(&V->ready);
+	pthread_mutex_unlock(&V->lock);
+	pthread_join(V->writer, NULL);
+
+	mclose(V->fd);
+	pthread_mutex_destroy(&V->lock);
+	pthread_cond_destroy(&V->ready);
+	pthread_cond_destroy(&V->space);
+
+	mprint(E, NULL, siminfo, "Node %d wrote " UVLONGFMT " value trace records (" UVLONGFMT " bytes) to \"%s\"\n",
+		S->NODE_ID, V->nrecords, V->nbytes, V->filename);
+
+	for (i = 0; i < kSunflowerVtraceNchunks; i++)
+	{
+		mfree(E, V->chunks[i], "V->chunks in vtrace.c");
+	}
+	mfree(E, V->filename, "V->filename in vtrace.c");
+	mfree(E, V, "Vtrace *V in vtrace.c");
+	S->vtrace = NULL;
+
+	return;
+}
+
+void
+mvtracecloseall(Engine *E)
+{
+	int	i;
+
+
+	for (i = 0; i < E->nnodes; i++)
+	{
+		mvtraceclose(E, E->sp[i]);
+	}
+
+	return;
+}
+
+/*									*/
+/*	Record a value written to a traced NUMA or stack region. With	*/
+/*	no trace file open, the value is kept in R->values, which is	*/
+/*	grown by doubling up to MAX_NUMAREGION_VALUETRACE entries.	*/
+/*									*/
+void
+mvtracenuma(Engine *E, State *S, Numaregion *R, ulong value)
+{
+	if (S->vtrace != NULL)
+	{
+		if (R->vtraceid == 0)
+		{
+			if (R->onstack)
+			{
+				vtracedefine(S->vtrace, &R->vtraceid, kSunflowerVtraceStack, R->pcstart,
+					R->frameoffset, R->endaddr - R->startaddr, R->ispointer, R->name);
+			}
+			else
+			{
+				vtracedefine(S->vtrace, &R->vtraceid, kSunflowerVtraceNuma, R->pcstart,
+					R->startaddr, R->endaddr - R->startaddr, R->ispointer, R->name);
+			}
+		}
+		vtracevalue(S, S->vtrace, R->vtraceid, &R->vtracelast, value);
+
+		return;
+	}
+
+	R->values[R->validx] = value;
+	if (R->validx < MAX_NUMAREGION_VALUETRACE)
+	{
+		R->validx++;
+	}
+
+	if (R->validx == R->nvalues)
+	{
+		ulong	*tmp;
+
+		R->nvalues *= 2;
+		tmp = (ulong *)mrealloc(E, R->values,
+			R->nvalues*sizeof(ulong), "realloc R->values in vtrace.c");
+		if (tmp == NULL)
+		{
+			mprint(E, NULL, siminfo,
+				"Resizing R->values to %d entries failed\n",
+				R->nvalues);
+			sfatal(E, S, "realloc failed for R->values in vtrace.c");
+		}
+		R->values = tmp;
+	}
+
+	return;
+}
+
+/*									*/
+/*	As mvtracenuma(), for register tracers.				*/
+/*									*/
+void
+mvtracereg(Engine *E, State *S, Regvt *R, ulong value)
+{
+	if (S->vtrace != NULL)
+	{
+		if (R->vtraceid == 0)
+		{
+			vtracedefine(S->vtrace, &R->vtraceid, kSunflowerVtraceReg, R->pcstart,
+				R->regnum, R->size, R->ispointer, R->name);
+		}
+		vtracevalue(S, S->vtrace, R->vtraceid, &R->vtracelast, value);
+
+		return;
+	}
+
+	R->values[R->validx] = value;
+	if (R->validx < MAX_REGTRACER_VALUETRACE)
+	{
+		R->validx++;
+	}
+
+	if (R->validx == R->nvalues)
+	{
+		ulong	*tmp;
+
+		R->nvalues *= 2;
+		tmp = (ulong *)mrealloc(E, R->values,
+			R->nvalues*sizeof(ulong),
+			"realloc R->values in vtrace.c");
+		if (tmp == NULL)
+		{
+			mprint(E, NULL, siminfo,
+				"Resizing R->values to %d entries failed\n",
+				R->nvalues);
+			sfatal(E, S, "realloc failed for R->values in vtrace.c");
+		}
+		R->values = tmp;
+	}
+
+	return;
+}
+
+/*									*/
+/*	Hand the chunk being filled to the writer, and wait for a free	*/
+/*	one only if the writer has fallen a whole ring behind.		*/
+/*									*/
+static void
+vtracesubmit(Vtrace *V)
+{
+	pthread_mutex_lock(&V->lock);
+	V->nfull++;
+	pthread_cond_signal(&V->ready);
+	while (V->nfull == kSunflowerVtraceNchunks)
+	{
+		pthread_cond_wait(&V->space, &V->lock);
+	}
+	V->head = (V->head + 1) % kSunflowerVtraceNchunks;
+	pthread_mutex_unlock(&V->lock);
+
+	V->chunklen[V->head] = 0;
+
+	return;
+}
+
+static void *
+vtracewriter(void *arg)
+{
+	Vtrace	*V = (Vtrace *)arg;
+	int	c;
+
+
+	for (;;)
+	{
+		pthread_mutex_lock(&V->lock);
+		while ((V->nfull == 0) && !V->done)
+		{
+			pthread_cond_wait(&V->ready, &V->lock);
+		}
+
+		if (V->nfull == 0)
+		{
+			pthread_mutex_unlock(&V->lock);
+			break;
+		}
+		c = V->tail;
+		pthread_mutex_unlock(&V->lock);
+
+		if (mwrite(V->fd, (char *)V->chunks[c], V->chunklen[c]) == V->chunklen[c])
+		{
+			V->nbytes += V->chunklen[c];
+		}
+
+		pthread_mutex_lock(&V->lock);
+		V->tail = (V->tail + 1) % kSunflowerVtraceNchunks;
+		V->nfull--;
+		pthread_cond_signal(&V->space);
+		pthread_mutex_unlock(&V->lock);
+	}
+
+	return NULL;
+}
+
+/*									*/
+/*	Room for one record at the end of the current chunk.		*/
+/*									*/
+static tuck uchar *
+vtracereserve(Vtrace *V)
+{
+	if (V->chunklen[V->head] + kSunflowerVtraceMaxrecord > kSunflowerVtraceChunksize)
+	{
+		vtracesubmit(V);
+	}
+
+	return &V->chunks[V->head][V->chunklen[V->head]];
+}
+
+static tuck int
+vtracevarint(uchar *p, uvlong v)
+{
+	int	n = 0;
+
+
+	while (v >= 0x80)
+	{
+		p[n++] = (uchar)(v | 0x80);
+		v >>= 7;
+	}
+	p[n++] = (uchar)v;
+
+	return n;
+}
+
+static void
+vtracedefine(Vtrace *V, int *id, SunflowerVtraceKind kind, ulong pcstart, ulong where, int size, int ispointer, char *name)
+{
+	uchar	*p = vtracereserve(V);
+	int	n = 0, namelen = strlen(name);
+
+
+	if (namelen > MAX_NUMAREGION_NAMELEN)
+	{
+		namelen = MAX_NUMAREGION_NAMELEN;
+	}
+
+	*id = ++V->nids;
+	p[n++] = kSunflowerVtraceRecDefine;
+	n += vtracevarint(&p[n], *id);
+	p[n++] = kind;
+	n += vtracevarint(&p[n], pcstart);
+	n += vtracevarint(&p[n], where);
+	n += vtracevarint(&p[n], size);
+	p[n++] = ispointer;
+	n += vtracevarint(&p[n], namelen);
+	memcpy(&p[n], name, namelen);
+	n += namelen;
+
+	V->chunklen[V->head] += n;
+	V->nrecords++;
+
+	return;
+}
+
+static tuck void
+vtracevalue(State *S, Vtrace *V, int id, ulong *last, ulong value)
+{
+	uchar	*p = vtracereserve(V);
+	int64_t	delta = (int64_t)value - (int64_t)*last;
+	int	n = 0;
+
+
+	p[n++] = kSunflowerVtraceRecValue;
+	n += vtracevarint(&p[n], id);
+	n += vtracevarint(&p[n], (uvlong)((delta << 1) ^ (delta >> 63)));
+	n += vtracevarint(&p[n], S->ICLK - V->lastclk);
+
+	*last = value;
+	V->lastclk = S->ICLK;
+	V->chunklen[V->head] += n;
+	V->nrecords++;
+
+	return;
+}
@@ -0,0 +1,105 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*									*/
+/*	Streaming sink for NUMA region and register value traces.	*/
+/*	While a node has a sink open, traced values are encoded into	*/
+/*	a ring of chunks and written to the node's trace file by a	*/
+/*	writer thread, instead of being kept in the tracers' value	*/
+/*	arrays.								*/
+/*									*/
+/*	File format: the 8-byte magic, then records. Every record has	*/
+/*	the same layout for its kind, with integer fields as LEB128	*/
+/*	varints:							*/
+/*									*/
+/*	define:	tag, id, kind, pcstart, address (NUMA), frame offset	*/
+/*		(stack) or register number, size, ispointer, name	*/
+/*		length, name bytes.					*/
+/*	value:	tag, id, zigzag(value - previous value of id),		*/
+/*		cycles since the previous value record.			*/
+/*									*/
+/*	A tracer is defined just before its first value. The offline	*/
+/*	reader in utils/vtracedump prints the same summaries as the	*/
+/*	VALUESTATS command. See vtrace.c.				*/
+/*									*/
+typedef enum
+{
+	kSunflowerVtraceNuma,
+	kSunflowerVtraceStack,
+	kSunflowerVtraceReg,
+} SunflowerVtraceKind;
+
+enum
+{
+	kSunflowerVtraceRecDefine	= 1,
+	kSunflowerVtraceRecValue	= 2,
+
+	kSunflowerVtraceMagiclen	= 8,
+	kSunflowerVtraceChunksize	= 64*1024,
+	kSunflowerVtraceNchunks		= 8,
+
+	/*	Largest record: a define with a 64-byte name	*/
+	kSunflowerVtraceMaxrecord	= 2 + 6*10 + 1 + 64,
+};
+
+typedef struct
+{
+	int		fd;
+	char		*filename;
+
+	/*							*/
+	/*	The simulator fills chunks[head]; the writer	*/
+	/*	writes out the nfull chunks from chunks[tail].	*/
+	/*							*/
+	uchar		*chunks[kSunflowerVtraceNchunks];
+	int		chunklen[kSunflowerVtraceNchunks];
+	int		head;
+	int		tail;
+	int		nfull;
+	int		done;
+
+	pthread_t	writer;
+	pthread_mutex_t	lock;
+	pthread_cond_t	ready;
+	pthread_cond_t	space;
+
+	int		nids;
+	uvlong		lastclk;
+
+	uvlong		nrecords;
+	uvlong		nbytes;
+} Vtrace;
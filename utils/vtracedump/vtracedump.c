@@ -0,0 +1,343 @@
+/*
+	Copyright (c) 1999-2008, Phillip Stanley-Marbell (author)
+ 
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without 
+	modification, are permitted provided that the following conditions
+	are met:
+
+	*	Redistributions of source code must retain the above
+		copyright notice, this list of conditions and the following
+		disclaimer.
+
+	*	Redistributions in binary form must reproduce the above
+		copyright notice, this list of conditions and the following
+		disclaimer in the documentation and/or other materials
+		provided with the distribution.
+
+	*	Neither the name of the author nor the names of its
+		contributors may be used to endorse or promote products
+		derived from this software without specific prior written 
+		permission.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+	"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+	LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+	FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+	COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+	BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+	LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define uchar   unsigned char
+#define ulong   uint32_t
+#define uvlong  uint64_t
+
+/*
+	Usage:
+		vtracedump [-s] <trace file>
+
+	Reads a value trace file written by the simulator's VALUETRACEFILE
+	command and prints, for each traced variable or register, the same
+	summary as the VALUESTATS command (without the access counts, which
+	are not in the trace). With -s, prints only the count, range, mean
+	and cycle span of each trace, without keeping the value histories.
+*/
+
+enum
+{
+	/*	Must match sim/vtrace.h		*/
+	RECDEFINE		= 1,
+	RECVALUE		= 2,
+	KINDNUMA		= 0,
+	KINDSTACK		= 1,
+	KINDREG			= 2,
+	MAGICLEN		= 8,
+
+	NAMELEN			= 64,
+	INIT_NVALUES		= 1024,
+	INIT_NTRACERS		= 64,
+	REALLOC_GROW_FACTOR	= 2,
+};
+
+typedef struct
+{
+	int	kind;
+	ulong	pcstart;
+	ulong	where;
+	ulong	size;
+	int	ispointer;
+	char	name[NAMELEN+1];
+
+	ulong	last;
+	ulong	min;
+	ulong	max;
+	double	sum;
+	uvlong	firstclk;
+	uvlong	lastclk;
+
+	ulong	*values;
+	uvlong	nvalues;
+	uvlong	valuesz;
+} Tracer;
+
+
+const char	Emalloc[] = "Malloc Failed";
+const char	Eopen[] = "Could not open input file";
+const char	Eformat[] = "Not a value trace file";
+const char	Etrunc[] = "Truncated or corrupt value trace file";
+const char	magic[MAGICLEN] = {'S', 'F', 'V', 'T', 'R', 'C', '0', '1'};
+
+void		usage(void);
+void		fatal(const char *msg);
+uvlong		getvarint(uchar *buf, long size, long *pos);
+void		printtracer(Tracer *t, int summary);
+
+int
+main(int argc, char *argv[])
+{
+	Tracer	*tracers = NULL;
+	int	ntracers = 0, tracersz = 0, summary = 0, i;
+	uchar	*buf;
+	long	size, pos;
+	uvlong	clk = 0;
+	FILE	*fp;
+
+
+	if ((argc == 3) && !strcmp(argv[1], "-s"))
+	{
+		summary = 1;
+	}
+	else if (argc != 2)
+	{
+		usage();
+	}
+
+	fp = fopen(argv[argc-1], "r");
+	if (fp == NULL)
+	{
+		fatal(Eopen);
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	buf = malloc(size > 0 ? size : 1);
+	if (buf == NULL)
+	{
+		fatal(Emalloc);
+	}
+	if ((fread(buf, 1, size, fp) != size) || (size < MAGICLEN) || memcmp(buf, magic, MAGICLEN))
+	{
+		fatal(Eformat);
+	}
+	fclose(fp);
+
+	pos = MAGICLEN;
+	while (pos < size)
+	{
+		int	tag = buf[pos++];
+		uvlong	id = getvarint(buf, size, &pos);
+		Tracer	*t;
+
+
+		if (tag == RECDEFINE)
+		{
+			ulong	namelen;
+
+			if (id != ntracers + 1)
+			{
+				fatal(Etrunc);
+			}
+
+			if (ntracers == tracersz)
+			{
+				tracersz = (tracersz == 0 ? INIT_NTRACERS : tracersz*REALLOC_GROW_FACTOR);
+				tracers = realloc(tracers, tracersz*sizeof(Tracer));
+				if (tracers == NULL)
+				{
+					fatal(Emalloc);
+				}
+			}
+			t = &tracers[ntracers++];
+			memset(t, 0, sizeof(Tracer));
+
+			if (pos >= size)
+			{
+				fatal(Etrunc);
+			}
+			t->kind = buf[pos++];
+			t->pcstart = getvarint(buf, size, &pos);
+			t->where = getvarint(buf, size, &pos);
+			t->size = getvarint(buf, size, &pos);
+			if (pos >= size)
+			{
+				fatal(Etrunc);
+			}
+			t->ispointer = buf[pos++];
+			namelen = getvarint(buf, size, &pos);
+			if ((namelen > NAMELEN) || (pos + namelen > size))
+			{
+				fatal(Etrunc);
+			}
+			memcpy(t->name, &buf[pos], namelen);
+			t->name[namelen] = '\0';
+			pos += namelen;
+			t->min = ~0U;
+		}
+		else if (tag == RECVALUE)
+		{
+			uvlong	zz;
+			int64_t	delta;
+
+			if ((id == 0) || (id > ntracers))
+			{
+				fatal(Etrunc);
+			}
+			t = &tracers[id-1];
+
+			zz = getvarint(buf, size, &pos);
+			delta = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+			clk += getvarint(buf, size, &pos);
+
+			t->last = (ulong)((int64_t)t->last + delta);
+			if (t->nvalues == 0)
+			{
+				t->firstclk = clk;
+			}
+			t->lastclk = clk;
+			t->min = (t->last < t->min ? t->last : t->min);
+			t->max = (t->last > t->max ? t->last : t->max);
+			t->sum += t->last;
+
+			if (!summary)
+			{
+				if (t->nvalues == t->valuesz)
+				{
+					t->valuesz = (t->valuesz == 0 ? INIT_NVALUES : t->valuesz*REALLOC_GROW_FACTOR);
+					t->values = realloc(t->values, t->valuesz*sizeof(ulong));
+					if (t->values == NULL)
+					{
+						fatal(Emalloc);
+					}
+				}
+				t->values[t->nvalues] = t->last;
+			}
+			t->nvalues++;
+		}
+		else
+		{
+			fatal(Etrunc);
+		}
+	}
+
+	for (i = 0; i < ntracers; i++)
+	{
+		printtracer(&tracers[i], summary);
+	}
+
+	return 0;
+}
+
+uvlong
+getvarint(uchar *buf, long size, long *pos)
+{
+	uvlong	v = 0;
+	int	shift = 0;
+
+
+	while (*pos < size)
+	{
+		uchar	b = buf[(*pos)++];
+
+		v |= (uvlong)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+		{
+			return v;
+		}
+		shift += 7;
+	}
+	fatal(Etrunc);
+
+	return 0;
+}
+
+void
+printtracer(Tracer *t, int summary)
+{
+	uvlong	i;
+
+
+	printf("\n%-20s %s\n", "Name:", t->name);
+	switch (t->kind)
+	{
+		case KINDSTACK:
+		{
+			printf("%-20s 0x%x\n", "PCstart:", t->pcstart);
+			printf("%-20s 0x%x\n", "Frame offset:", t->where);
+			printf("%-20s 0x%x\n", "Size:", t->size);
+			break;
+		}
+
+		case KINDREG:
+		{
+			printf("%-20s 0x%x\n", "PCstart:", t->pcstart);
+			printf("%-20s 0x%x\n", "Register:", t->where);
+			break;
+		}
+
+		default:
+		{
+			printf("%-20s 0x%x\n", "Start address:", t->where);
+			printf("%-20s 0x%x\n", "End address:", t->where + t->size);
+			break;
+		}
+	}
+	printf("%-20s %llu\n\n", "Values:", (unsigned long long)t->nvalues);
+
+	if (summary)
+	{
+		if (t->nvalues > 0)
+		{
+			printf("%-20s %u\n", "Min:", t->min);
+			printf("%-20s %u\n", "Max:", t->max);
+			printf("%-20s %f\n", "Mean:", t->sum/t->nvalues);
+			printf("%-20s %llu .. %llu\n", "Cycles:",
+				(unsigned long long)t->firstclk, (unsigned long long)t->lastclk);
+		}
+
+		return;
+	}
+
+	printf("Value History: ");
+	for (i = 0; i < t->nvalues; i++)
+	{
+		printf("%u ", t->values[i]);
+	}
+	printf("\n");
+}
+
+void
+usage(void)
+{
+	fprintf(stderr, "Usage: vtracedump [-s] <trace file>\n");
+	exit(-1);
+}
+
+void
+fatal(const char *msg)
+{
+	fprintf(stderr, "Vtracedump fatal: %s\n", msg);
+	exit(-1);
+}